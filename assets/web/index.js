@@ -6,6 +6,7 @@
 
 //callback回调
 // const QString getHtml();获取整个html
+// const QVariantMap getChanges(int version);获取上次同步后变化的内容块
 // const QString getAllNote();获取所有语音列表的Json
 //
 
@@ -80,6 +81,23 @@ var global_themeColor = 'transparent'  //主题色
 var scrollHide = null  //滚动条隐藏定时器
 var scrollHideFont = null  //字体滚动条定时
 var isUlOrOl = false
+var searchRanges = []  //当前笔记的搜索命中区域
+var searchCurrent = -1  //当前命中序号
+var syncVersion = 0  //内容同步版本号
+var syncedNodes = []  //上次同步时编辑区的顶层节点
+var dirtyNodes = new Set()  //上次同步后内容变化的顶层节点
+var syncObserver = null  //内容变化监听
+var pushTimer = null  //推送变更定时器
+var pushStartTime = 0  //第一个未推送修改的时间
+const pushDelay = 200  //停止输入后推送变更的等待时间，单位:毫秒
+const pushMaxDelay = 500  //连续输入时推送变更的最长间隔，单位:毫秒
+var noteCache = new Map()  //最近打开笔记的编辑区节点，淘汰由后端决定
+var lazyObserver = null  //延迟加载图片进入可视区域监听
+var ingestImages = new Map()  //等待后端存入的图片占位节点
+var ingestResults = new Map()  //占位节点插入前已返回的结果
+var inlineImageCount = 0  //内嵌图片id计数
+// 图片加载前使用的透明占位图
+const lazyPlaceholder = 'data:image/gif;base64,R0lGODlhAQABAIAAAAAAAP///yH5BAEAAAAALAAAAAABAAEAAAIBRAA7'
 const airPopoverHeight = 44  //悬浮工具栏高度
 const airPopoverWidth = 385  //悬浮工具栏宽度
 
@@ -133,14 +151,21 @@ new QWebChannel(qt.webChannelTransport,
         webobj.callJsInsertVoice.connect(insertVoiceItem);
         webobj.callJsSetPlayStatus.connect(toggleState);
         webobj.callJsSetHtml.connect(setHtml);
+        webobj.callJsSwitchNote.connect(switchNote);
         webobj.callJsSetVoiceText.connect(setVoiceText);
         webobj.callJsInsertImages.connect(insertImg);
+        webobj.callJsImageVariantsReady.connect(onImageVariantsReady);
+        webobj.callJsInsertImagePlaceholders.connect(insertImagePlaceholders);
+        webobj.callJsImageIngested.connect(onImageIngested);
+        webobj.callJsSetIngestProgress.connect(setIngestProgress);
         webobj.callJsSetTheme.connect(changeColor);
         webobj.calllJsShowEditToolbar.connect(showRightMenu);
         webobj.callJsHideEditToolbar.connect(hideRightMenu);
         webobj.callJsClipboardDataChanged.connect(shearPlateChange);
         webobj.callJsSetVoicePlayBtnEnable.connect(playButColor);
         webobj.callJsSetFontList.connect(setFontList);
+        webobj.callJsSetSearchMatches.connect(setSearchMatches);
+        webobj.callJsGotoSearchMatch.connect(gotoSearchMatch);
         //通知QT层完成通信绑定
         webobj.jsCallChannleFinish();
         // setFontList(global_fontList, "Unifont")
@@ -152,6 +177,8 @@ function setFontList(fontList, initFont) {
     global_fontList = fontList;
     setInitFont(initFont)
     initSummernote()
+    initSync()
+    initLazyLoad()
     // 通知QT，summernote初始化完成
     webobj.jsCallSummernoteInitFinish()
     // 获取翻译和字体列表后，再初始化summernote
@@ -194,6 +221,7 @@ function initSummernote() {
     // 监听窗口大小变化
     $(window).resize(function () {
         $('.note-editable').css('min-height', $(window).height())
+        drawSearchMatches()
     }).resize();
 }
 
@@ -218,8 +246,10 @@ function changeContent(we, contents, $editable) {
                 $('#summernote').summernote('airPopover.hide')
             }
         }
-        webobj.jsCallTxtChange();
+        notifyTextChange();
     }
+    // 命中区域随内容移动，重新绘制
+    drawSearchMatches()
 }
 
 // 判断编辑区是否为空
@@ -358,6 +388,7 @@ function copyVoice(event) {
         testDiv.innerHTML = ''
         testDiv.appendChild(box)
     }
+    restoreLazyImages($(testDiv))
     formatHtml = testDiv.innerHTML;
     if ($(testDiv).children().length == 1 && $(testDiv).children()[0].tagName != 'UL' && $(testDiv).find('.voiceBox').length != 0) {
         formatHtml = '<p><br></p>' + formatHtml
@@ -392,6 +423,8 @@ document.addEventListener('paste', function (event) {
     }
     setFocusScroll()
     removeNullP()
+    //浏览器粘贴的内容在事件结束后插入
+    setTimeout(() => ingestInlineImages($('.note-editable')[0]), 0)
 });
 
 // 页面滚动到光标位置
@@ -443,7 +476,7 @@ function isRangeVoice() {
         && childrenLength == 1
         && $(testDiv).find('img').parent()[0].childNodes.length == 1) {
         selectedRange.flag = 0
-        selectedRange.info = $(testDiv).find('img').attr('src')
+        selectedRange.info = imageSource($(testDiv).find('img')[0])
     } else {
         selectedRange.flag = 2
     }
@@ -469,12 +502,484 @@ $('body').on('click', '.voicebtn', function (e) {
 //获取整个处理后Html串,去除所有标签中临时状态
 function getHtml() {
     var $cloneCode = $('.note-editable').clone();
+    clearTempState($cloneCode)
+    restoreLazyImages($cloneCode)
+    return $cloneCode[0].innerHTML;
+}
+
+//去除标签中的临时状态
+function clearTempState($cloneCode) {
     $cloneCode.find('.li').removeClass('active');
     $cloneCode.find('.voicebtn').removeClass('pause').addClass('play');
     $cloneCode.find('.voicebtn').removeClass('now');
     $cloneCode.find('.wifi-circle').removeClass('first').removeClass('second').removeClass('third').removeClass('four');
     $cloneCode.find('.translate').html("")
-    return $cloneCode[0].innerHTML;
+}
+
+// 未加载及显示副本的图片还原原图地址，去除延迟加载添加的属性
+function restoreLazyImages($cloneCode) {
+    //内嵌图片存入完成前保存原内容，未存入完成的占位图不保存
+    $cloneCode.find('img[data-ingest-id^="inline-"]').removeAttr('data-ingest-id')
+    $cloneCode.find('img[data-ingest-id]').remove()
+    $cloneCode.find('img[decoding]').removeAttr('decoding')
+    $cloneCode.find('img[data-lazy-src]').each(function () {
+        this.setAttribute('src', this.getAttribute('data-lazy-src'))
+        this.removeAttribute('data-lazy-src')
+        this.classList.remove('lazy-img')
+        if (!this.className) {
+            this.removeAttribute('class')
+        }
+    })
+    $cloneCode.find('img[data-origin-src]').each(function () {
+        this.setAttribute('src', this.getAttribute('data-origin-src'))
+        this.removeAttribute('data-origin-src')
+    })
+}
+
+/**
+ * 初始化图片延迟加载，图片距离可视区域一屏以内时开始加载
+ * @date 2022-07-11
+ * @returns {any}
+ */
+function initLazyLoad() {
+    lazyObserver = new IntersectionObserver(entries => {
+        entries.forEach(entry => {
+            if (entry.isIntersecting) {
+                loadLazyImage(entry.target)
+            }
+        })
+    }, { rootMargin: '100% 0px' })
+}
+
+/**
+ * 笔记html中的图片改为占位图，原地址保存在data-lazy-src中，设置内容时不再解码全部图片
+ * @date 2022-07-11
+ * @param {string} html 笔记html内容
+ * @returns {string} 处理后的html
+ */
+function lazyHtml(html) {
+    if (!lazyObserver || html.indexOf('<img') < 0) {
+        return html
+    }
+    //template中解析不会加载图片
+    var tpl = document.createElement('template')
+    tpl.innerHTML = html
+    tpl.content.querySelectorAll('img[src]').forEach(img => {
+        img.setAttribute('data-lazy-src', img.getAttribute('src'))
+        img.setAttribute('src', lazyPlaceholder)
+        img.classList.add('lazy-img')
+    })
+    return tpl.innerHTML
+}
+
+// 监听编辑区中未加载的图片
+function observeLazyImages() {
+    if (lazyObserver) {
+        $('.note-editable img[data-lazy-src]').each(function () {
+            lazyObserver.observe(this)
+        })
+    }
+}
+
+// 加载进入可视区域的图片
+function loadLazyImage(img) {
+    lazyObserver.unobserve(img)
+    var src = img.getAttribute('data-lazy-src')
+    if (src === null) {
+        return
+    }
+    img.removeAttribute('data-lazy-src')
+    showImageVariant(img, src, true)
+}
+
+/**
+ * 笔记图片副本地址，副本与原图同名，保存在images下的display、thumb目录
+ * 附件url通过variant参数选择副本
+ * @date 2022-07-14
+ * @param {string} src 原图地址
+ * @param {string} variant 副本类型 display/thumb
+ * @returns {string} 副本地址，不是笔记图片目录中的图片返回空
+ */
+function imageVariant(src, variant) {
+    if (/^vnote:\/\/attachment\/[^/?]+$/.test(src)) {
+        return src + '?variant=' + variant
+    }
+    var rx = /\/images\/([^/]+)$/
+    if (!rx.test(src)) {
+        return ''
+    }
+    return src.replace(rx, '/images/' + variant + '/$1')
+}
+
+// 后台加载图片，完成后回调是否成功
+function preloadImage(url, callback) {
+    var loader = new Image()
+    loader.decoding = 'async'
+    loader.onload = () => callback(true)
+    loader.onerror = () => callback(false)
+    loader.src = url
+}
+
+/**
+ * 图片显示副本，先显示缩略图，显示图加载完成后替换，没有显示图时显示原图，原图地址保存在data-origin-src中
+ * @date 2022-07-14
+ * @param {Element} img 图片节点
+ * @param {string} src 原图地址
+ * @param {boolean} withThumb 是否先显示缩略图，缩略图不存在时通知后端生成副本
+ * @returns {any}
+ */
+function showImageVariant(img, src, withThumb) {
+    var display = imageVariant(src, 'display')
+    if (!display) {
+        setImageSource(img, src)
+        return
+    }
+    img.setAttribute('data-origin-src', src)
+    var shown = false
+    if (withThumb) {
+        var thumb = imageVariant(src, 'thumb')
+        preloadImage(thumb, ok => {
+            if (!ok) {
+                webobj.jsCallImageVariantMissing(src)
+            } else if (!shown) {
+                img.setAttribute('src', thumb)
+            }
+        })
+    }
+    preloadImage(display, ok => {
+        shown = true
+        setImageSource(img, ok ? display : src)
+    })
+}
+
+// 设置图片最终显示的地址，加载完成后布局变化，重新绘制搜索命中区域
+function setImageSource(img, url) {
+    img.decoding = 'async'
+    img.onload = img.onerror = function () {
+        img.onload = img.onerror = null
+        img.classList.remove('lazy-img')
+        if (!img.className) {
+            img.removeAttribute('class')
+        }
+        drawSearchMatches()
+    }
+    img.setAttribute('src', url)
+}
+
+/**
+ * 图片副本生成完成，已显示的对应图片切换为副本，未加载的图片加载时使用副本
+ * @date 2022-07-14
+ * @param {Array} images 原图地址
+ * @returns {any}
+ */
+function onImageVariantsReady(images) {
+    var keys = new Set(images.map(imageKey))
+    $('.note-editable img:not([data-lazy-src])').each(function () {
+        var src = imageSource(this)
+        if (keys.has(imageKey(src))) {
+            showImageVariant(this, src, false)
+        }
+    })
+}
+
+/**
+ * 在光标处插入图片占位图，图片由后端存入后替换
+ * @date 2022-07-20
+ * @param {Array} ids 占位图id
+ * @returns {any}
+ */
+function insertImagePlaceholders(ids) {
+    ids.forEach(id => {
+        $("#summernote").summernote('insertImage', lazyPlaceholder, $image => {
+            $image.attr('data-ingest-id', id).addClass('lazy-img')
+            ingestImages.set(id, $image[0])
+        })
+        if (ingestResults.has(id)) {
+            var image = ingestResults.get(id)
+            ingestResults.delete(id)
+            onImageIngested(id, image)
+        }
+    })
+}
+
+/**
+ * 图片存入完成，占位图显示图片，失败时删除占位图
+ * 占位图所在笔记已切换时更新缓存中的节点，再次打开时保存
+ * @date 2022-07-20
+ * @param {string} id 占位图id
+ * @param {string} image 图片路径，为空表示失败
+ * @returns {any}
+ */
+function onImageIngested(id, image) {
+    var img = ingestImages.get(id)
+    if (!img) {
+        ingestResults.set(id, image)
+        return
+    }
+    ingestImages.delete(id)
+
+    if (!image) {
+        if (id.startsWith('inline-')) {
+            //无法存入的内嵌图片保持不变
+            img.removeAttribute('data-ingest-id')
+        } else {
+            //占位图不保存，删除后内容不变
+            img.remove()
+        }
+        return
+    }
+    img.removeAttribute('data-ingest-id')
+    img.removeAttribute('data-lazy-src')
+    showImageVariant(img, image, true)
+
+    if (img.isConnected) {
+        notifyTextChange()
+        return
+    }
+    noteCache.forEach(entry => {
+        if (entry.fragment.contains(img)) {
+            entry.changed = true
+        }
+    })
+}
+
+/**
+ * data协议内嵌的图片交给后端存入附件仓库，存入后替换为附件url
+ * @date 2022-07-25
+ * @param {Element} root 查找的根节点
+ * @returns {any}
+ */
+function ingestInlineImages(root) {
+    var ids = []
+    var uris = []
+    root.querySelectorAll('img:not([data-ingest-id])').forEach(img => {
+        var src = imageSource(img)
+        if (!src.startsWith('data:image/') || src == lazyPlaceholder) {
+            return
+        }
+        var id = 'inline-' + (++inlineImageCount)
+        img.setAttribute('data-ingest-id', id)
+        ingestImages.set(id, img)
+        ids.push(id)
+        uris.push(src)
+    })
+    if (ids.length) {
+        webobj.jsCallIngestInlineImages(ids, uris)
+    }
+}
+
+/**
+ * 显示插入图片进度
+ * @date 2022-07-20
+ * @param {int} finished 已完成数
+ * @param {int} total 总数，为0时隐藏
+ * @returns {any}
+ */
+function setIngestProgress(finished, total) {
+    var $bar = $('#ingestProgress')
+    if (!total) {
+        $bar.remove()
+        return
+    }
+    if ($bar.length == 0) {
+        $bar = $('<div id="ingestProgress"></div>').appendTo('body')
+        if (global_activeColor) {
+            $bar.css('background-color', global_activeColor)
+        }
+    }
+    $bar.css('width', (finished * 100 / total) + '%')
+}
+
+// 比较图片地址时只比较文件名，附件url与本地路径的同一图片一致
+function imageKey(src) {
+    return src.replace(/[?#].*$/, '').replace(/^.*\//, '')
+}
+
+// 图片原地址，未加载时取data-lazy-src，显示副本时取data-origin-src
+function imageSource(img) {
+    if (!img) {
+        return ''
+    }
+    return img.getAttribute('data-lazy-src') || img.getAttribute('data-origin-src') || img.getAttribute('src')
+}
+
+/**
+ * 监听编辑区内容变化，记录变化的顶层节点
+ * @date 2022-06-27
+ * @returns {any}
+ */
+function initSync() {
+    syncObserver = new MutationObserver(markDirtyNodes)
+    syncObserver.observe($('.note-editable')[0], { childList: true, subtree: true, characterData: true, attributes: true })
+    resetSync()
+}
+
+// 设置新内容后重置同步状态，版本号递增，后端的版本不再匹配，下次同步返回全部内容
+function resetSync() {
+    if (syncObserver) {
+        syncObserver.takeRecords()
+    }
+    syncVersion++
+    var editable = $('.note-editable')[0]
+    syncedNodes = editable ? Array.from(editable.childNodes) : []
+    dirtyNodes.clear()
+}
+
+/**
+ * 记录变化所在的顶层节点，顶层节点的增删由同步时比较节点得到
+ * @date 2022-06-27
+ * @param {Array} records 变化记录
+ * @returns {any}
+ */
+function markDirtyNodes(records) {
+    var editable = $('.note-editable')[0]
+    records.forEach(record => {
+        var node = record.target
+        //图片延迟加载修改的属性不影响保存的内容
+        if (record.type === 'attributes' && node.tagName === 'IMG'
+            && (record.attributeName === 'src' || record.attributeName === 'data-lazy-src'
+                || record.attributeName === 'data-origin-src' || record.attributeName === 'class'
+                || record.attributeName === 'decoding')) {
+            return
+        }
+        //撤销等操作重新加入的未加载图片需要重新监听
+        if (record.type === 'childList' && lazyObserver) {
+            record.addedNodes.forEach(added => {
+                if (added.nodeType === Node.ELEMENT_NODE) {
+                    $(added).find('img[data-lazy-src]').addBack('img[data-lazy-src]').each(function () {
+                        lazyObserver.observe(this)
+                    })
+                }
+            })
+        }
+        while (node && node.parentNode !== editable) {
+            node = node.parentNode
+        }
+        if (node) {
+            dirtyNodes.add(node)
+        }
+    })
+}
+
+// 序列化一个顶层节点，与getHtml结果中对应的部分一致
+function serializeBlock(node) {
+    var $box = $('<div></div>').append(node.cloneNode(true))
+    clearTempState($box)
+    restoreLazyImages($box)
+    return $box[0].innerHTML
+}
+
+/**
+ * 获取上次同步后变化的内容块，版本号与上次同步不一致时返回全部内容块
+ * @date 2022-06-27
+ * @param {int} version 后台当前的版本号
+ * @returns {Object} 变更
+ */
+function getChanges(version) {
+    if (syncObserver) {
+        markDirtyNodes(syncObserver.takeRecords())
+    }
+
+    var nodes = Array.from($('.note-editable')[0].childNodes)
+    var changes
+    if (version !== syncVersion) {
+        changes = { full: true, blocks: nodes.map(serializeBlock) }
+    } else {
+        changes = { base: version, count: nodes.length, ops: diffBlocks(nodes) }
+    }
+    changes.version = ++syncVersion
+
+    syncedNodes = nodes
+    dirtyNodes.clear()
+    return changes
+}
+
+/**
+ * 通知后端内容变化，并在输入停顿或达到最长间隔后推送变化的内容块
+ * @date 2022-07-28
+ * @returns {any}
+ */
+function notifyTextChange() {
+    webobj.jsCallTxtChange()
+
+    var now = Date.now()
+    if (!pushTimer) {
+        pushStartTime = now
+    }
+    clearTimeout(pushTimer)
+    pushTimer = setTimeout(pushChanges, Math.max(0, Math.min(pushDelay, pushStartTime + pushMaxDelay - now)))
+}
+
+/**
+ * 推送上次同步后变化的内容块，后端收到后写入日志
+ * 推送与后端获取共用版本号，后端按版本号判断推送是否可以合并
+ * @date 2022-07-28
+ * @returns {any}
+ */
+function pushChanges() {
+    clearTimeout(pushTimer)
+    pushTimer = null
+    if (webobj && initFinish) {
+        webobj.jsCallEditorChanges(getChanges(syncVersion))
+    }
+}
+
+// 设置新内容前推送未推送的修改，推送的变更仍属于离开的内容
+function flushChanges() {
+    if (pushTimer) {
+        pushChanges()
+    }
+}
+
+/**
+ * 比较上次同步的节点，生成保留、跳过、插入操作，只序列化新增和变化的节点
+ * @date 2022-06-27
+ * @param {Array} nodes 当前顶层节点
+ * @returns {Array} 操作列表
+ */
+function diffBlocks(nodes) {
+    var ops = []
+    var pushOp = (type, value) => {
+        var last = ops[ops.length - 1]
+        if (last && last[type] !== undefined) {
+            if (type == 'insert') {
+                last.insert.push(value)
+            } else {
+                last[type] += value
+            }
+        } else {
+            var op = {}
+            op[type] = type == 'insert' ? [value] : value
+            ops.push(op)
+        }
+    }
+
+    var syncedIndex = new Map()
+    syncedNodes.forEach((node, index) => syncedIndex.set(node, index))
+
+    var pos = 0
+    nodes.forEach(node => {
+        var index = syncedIndex.has(node) ? syncedIndex.get(node) : -1
+        if (index >= pos) {
+            if (index > pos) {
+                pushOp('skip', index - pos)
+            }
+            if (dirtyNodes.has(node)) {
+                pushOp('skip', 1)
+                pushOp('insert', serializeBlock(node))
+            } else {
+                pushOp('keep', 1)
+            }
+            pos = index + 1
+        } else {
+            pushOp('insert', serializeBlock(node))
+        }
+    })
+
+    if (pos < syncedNodes.length) {
+        pushOp('skip', syncedNodes.length - pos)
+    }
+    return ops
 }
 
 //获取当前所有的语音列表
@@ -543,6 +1048,7 @@ function formatMillisecond(millisecond) {
 
 //初始化数据 
 function initData(text) {
+    flushChanges()
     initFinish = false;
     var arr = JSON.parse(text);
     var html = '';
@@ -573,7 +1079,9 @@ function initData(text) {
         }
     })
 
+    clearSearchMatches()
     $('#summernote').summernote('code', html);
+    resetSync()
     // 搜索功能
     webobj.jsCallSetDataFinsh();
     initFinish = true;
@@ -677,8 +1185,13 @@ function setHtml(html) {
     if (html == '<p></p>') {
         html = '<p><br></p>'
     }
+    flushChanges()
     initFinish = false;
-    $('#summernote').summernote('code', html);
+    clearSearchMatches()
+    $('#summernote').summernote('code', lazyHtml(html));
+    resetSync()
+    observeLazyImages()
+    ingestInlineImages($('.note-editable')[0])
     initFinish = true;
     // 搜索功能
     webobj.jsCallSetDataFinsh();
@@ -686,6 +1199,78 @@ function setHtml(html) {
     $('#summernote').summernote('editor.resetRecord')
 }
 
+/**
+ * 切换笔记，离开的笔记节点移入缓存，打开的笔记命中缓存时直接放回编辑区，不再解析html
+ * @date 2022-07-04
+ * @param {string} cacheKey 离开笔记的缓存键值，为空不缓存
+ * @param {Array} dropKeys 淘汰的缓存键值
+ * @param {string} openKey 打开笔记的缓存键值，为空时使用html或json设置内容
+ * @param {string} html 笔记html内容
+ * @param {string} json 没有html内容时使用的json数据
+ * @returns {any}
+ */
+function switchNote(cacheKey, dropKeys, openKey, html, json) {
+    flushChanges()
+    if (cacheKey) {
+        cacheNote(cacheKey)
+    }
+    dropKeys.forEach(key => noteCache.delete(key))
+
+    if (!openKey) {
+        html ? setHtml(html) : initData(json)
+        return
+    }
+
+    var entry = noteCache.get(openKey)
+    noteCache.delete(openKey)
+    if (!entry) {
+        //缓存与后端不一致时全部清除，由后端重新设置内容
+        noteCache.clear()
+        webobj.jsCallNoteCacheMiss()
+        return
+    }
+
+    initFinish = false
+    clearSearchMatches()
+    var editable = $('.note-editable')[0]
+    $(editable).empty()
+    editable.appendChild(entry.fragment)
+    resetSync()
+    observeLazyImages()
+    initFinish = true
+    webobj.jsCallSetDataFinsh();
+    //缓存期间存入完成的图片需要保存
+    if (entry.changed) {
+        syncedNodes.forEach(node => dirtyNodes.add(node))
+        notifyTextChange()
+    }
+    $(document).scrollTop(entry.scrollTop)
+    $('#summernote').summernote('editor.resetRecord')
+}
+
+/**
+ * 当前编辑区节点移入缓存，保留滚动位置，去除临时状态
+ * @date 2022-07-04
+ * @param {string} key 缓存键值
+ * @returns {any}
+ */
+function cacheNote(key) {
+    var scrollTop = $(document).scrollTop()
+    var editable = $('.note-editable')[0]
+    var fragment = document.createDocumentFragment()
+    while (editable.firstChild) {
+        fragment.appendChild(editable.firstChild)
+    }
+    clearTempState($(fragment))
+    //缓存中的图片保持未加载状态，打开时重新监听
+    if (lazyObserver) {
+        $(fragment).find('img[data-lazy-src]').each(function () {
+            lazyObserver.unobserve(this)
+        })
+    }
+    noteCache.set(key, { fragment: fragment, scrollTop: scrollTop })
+}
+
 //设置录音转文字内容 flag: 0: 转换过程中 提示性文本（＂正在转文字中＂)１:结果 文本,空代表转失败了
 function setVoiceText(text, flag) {
     if (activeTransVoice) {
@@ -694,7 +1279,7 @@ function setVoiceText(text, flag) {
             if (text) {
                 text = text.trim()
                 activeTransVoice.after('<p>' + text + '</p>');
-                webobj.jsCallTxtChange();
+                notifyTextChange();
             }
             //将转文字文本写到json属性里
             var jsonValue = activeTransVoice.attr('jsonKey');
@@ -702,7 +1287,7 @@ function setVoiceText(text, flag) {
             jsonObj.text = text;
             activeTransVoice.attr('jsonKey', JSON.stringify(jsonObj));
 
-            webobj.jsCallTxtChange();
+            notifyTextChange();
             activeTransVoice = null;
             bTransVoiceIsReady = true;
 
@@ -1087,7 +1672,7 @@ document.onkeyup = function (event) {
 $('body').on('dblclick', 'img', function (e) {
     e.stopPropagation()
     e.preventDefault()
-    let imgUrl = $(e.target).attr('src')
+    let imgUrl = imageSource(e.target)
     webobj.jsCallViewPicture(imgUrl)
 })
 
@@ -1195,3 +1780,129 @@ function setSelectColorButton($dom) {
 }
 
 
+
+/**
+ * 设置搜索命中位置，位置由后台按文本节点拼接后的字符位置计算，语音块中的文本不计入
+ * 位置与网页内容不一致时在网页中重新查找一次，并通知后台命中数量
+ * @date 2022-06-20
+ * @param {string} keyword 搜索关键字，为空时清除
+ * @param {Array} offsets 命中位置
+ * @param {int} current 当前命中序号
+ * @returns {any}
+ */
+function setSearchMatches(keyword, offsets, current) {
+    clearSearchMatches()
+    if (!keyword) {
+        return
+    }
+
+    // 语音块不参与定位，与后台计算位置的文本一致
+    var nodes = []
+    var text = ''
+    var filter = {
+        acceptNode: node => $(node.parentNode).closest('.voiceBox').length ? NodeFilter.FILTER_REJECT : NodeFilter.FILTER_ACCEPT
+    }
+    var walker = document.createTreeWalker($('.note-editable')[0], NodeFilter.SHOW_TEXT, filter, false)
+    while (walker.nextNode()) {
+        nodes.push({ node: walker.currentNode, start: text.length })
+        text += walker.currentNode.nodeValue
+    }
+
+    var lowerText = text.toLowerCase()
+    var lowerKeyword = keyword.toLowerCase()
+    var matched = offsets.every(offset => lowerText.substr(offset, keyword.length) == lowerKeyword)
+    var count = offsets.length
+    if (!matched) {
+        offsets = []
+        var pos = lowerText.indexOf(lowerKeyword)
+        while (pos != -1) {
+            offsets.push(pos)
+            pos = lowerText.indexOf(lowerKeyword, pos + keyword.length)
+        }
+    }
+
+    // 命中位置有序，依次定位所在的文本节点
+    var index = 0
+    offsets.forEach(offset => {
+        var range = document.createRange()
+        index = findTextNode(nodes, index, offset)
+        range.setStart(nodes[index].node, offset - nodes[index].start)
+        var endIndex = findTextNode(nodes, index, offset + keyword.length - 1)
+        range.setEnd(nodes[endIndex].node, offset + keyword.length - nodes[endIndex].start)
+        searchRanges.push(range)
+    })
+
+    if (searchRanges.length != count) {
+        webobj.jsCallSetSearchMatchCount(searchRanges.length)
+    }
+    gotoSearchMatch(searchRanges.length > 0 ? Math.max(0, Math.min(current, searchRanges.length - 1)) : -1)
+}
+
+/**
+ * 查找字符位置所在的文本节点
+ * @date 2022-06-20
+ * @param {Array} nodes 文本节点及起始位置
+ * @param {int} from 开始查找的节点
+ * @param {int} offset 字符位置
+ * @returns {int} 节点序号
+ */
+function findTextNode(nodes, from, offset) {
+    var index = from
+    while (index + 1 < nodes.length && nodes[index + 1].start <= offset) {
+        index++
+    }
+    return index
+}
+
+/**
+ * 跳转到命中位置，不在可见区域时滚动到中间
+ * @date 2022-06-20
+ * @param {int} index 命中序号
+ * @returns {any}
+ */
+function gotoSearchMatch(index) {
+    searchCurrent = index
+    drawSearchMatches()
+    if (index < 0 || index >= searchRanges.length) {
+        return
+    }
+
+    var rect = searchRanges[index].getBoundingClientRect()
+    if (rect.top < 0 || rect.bottom > window.innerHeight) {
+        $(document).scrollTop($(document).scrollTop() + rect.top - window.innerHeight / 2)
+    }
+}
+
+/**
+ * 绘制命中区域，高亮层不在编辑区内，不影响笔记内容
+ * @date 2022-06-20
+ * @returns {any}
+ */
+function drawSearchMatches() {
+    var $layer = $('#searchLayer')
+    $layer.html('')
+    if (searchRanges.length == 0) {
+        return
+    }
+
+    if ($layer.length == 0) {
+        $layer = $('<div id="searchLayer"></div>').appendTo('body')
+    }
+
+    var html = ''
+    var scrollTop = $(document).scrollTop()
+    var scrollLeft = $(document).scrollLeft()
+    searchRanges.forEach((range, index) => {
+        Array.from(range.getClientRects()).forEach(rect => {
+            html += `<div class="searchMatch${index == searchCurrent ? ' current' : ''}" style="left:${rect.left + scrollLeft}px;top:${rect.top + scrollTop}px;width:${rect.width}px;height:${rect.height}px"></div>`
+        })
+    })
+    $layer.html(html)
+}
+
+// 清除命中区域
+function clearSearchMatches() {
+    searchRanges = []
+    searchCurrent = -1
+    $('#searchLayer').html('')
+}
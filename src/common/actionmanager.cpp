@@ -219,7 +219,8 @@ void ActionManager::initMenu()
     QStringList notebookMenuTexts;
     notebookMenuTexts << DApplication::translate("NotebookContextMenu", "Rename")
                       << DApplication::translate("NotebookContextMenu", "Delete")
-                      << DApplication::translate("NotebookContextMenu", "New note");
+                      << DApplication::translate("NotebookContextMenu", "New note")
+                      << DApplication::translate("NotebookContextMenu", "Export notebook");
     //初始化记事本右键菜单
     m_notebookContextMenu.reset(new VNoteRightMenu());
 
@@ -44,6 +44,7 @@ public:
         NotebookDelete,
         NotebookAddNew,
         //Add notebook menu item begin {
+        NotebookExport, //导出记事本归档
 
         //Add notebook menu item end }
         NotebookMenuMax,
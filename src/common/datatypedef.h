@@ -24,9 +24,13 @@
 #include "common/opsstateinterface.h"
 
 #include <QMap>
+#include <QHash>
 #include <QVector>
 #include <QReadWriteLock>
 #include <QDateTime>
+#include <QPair>
+#include <QMetaType>
+#include <QStringList>
 
 struct VNoteFolder;
 struct VNoteItem;
@@ -139,6 +143,79 @@ struct VDataSafer {
 
 typedef QVector<VDataSafer> SafetyDatas;
 
+//语音转写文本的一个分段
+struct VNoteTranscript {
+    qint64 id {-1};
+    qint64 folderId {-1};
+    qint64 noteId {-1};
+    QString voicePath;
+    //分段在语音中的起止位置，单位:毫秒
+    qint64 startTime {0};
+    qint64 endTime {0};
+    QString text;
+};
+
+typedef QVector<VNoteTranscript> VNOTE_TRANSCRIPTS;
+
+//附件仓库中的一个文件，文件名为内容的哈希值，相同内容只保存一份
+struct VNoteAttachment {
+    enum Type {
+        Image = 0,
+        Voice
+    };
+
+    QString hash;
+    //文件名，不含目录，目录由类型决定
+    QString fileName;
+    int type {Image};
+    qint64 size {0};
+    //最近一次存入的时间，清理时跳过之后存入的附件
+    QDateTime storeTime;
+};
+
+typedef QVector<VNoteAttachment> VNOTE_ATTACHMENTS;
+
+//文本中的高亮区间，first为起始位置，second为长度
+typedef QVector<QPair<int, int>> VNOTE_TEXT_RANGES;
+
+//搜索命中的笔记，只传递id，由主线程重新获取笔记数据
+//排序分值、摘要和高亮区间在搜索线程中计算，绘制时直接使用
+struct VNoteSearchHit {
+    qint64 folderId {-1};
+    qint64 noteId {-1};
+    qreal score {0};
+    VNOTE_TEXT_RANGES titleRanges;
+    //正文中关键字附近的摘要
+    QString snippet;
+    VNOTE_TEXT_RANGES snippetRanges;
+};
+
+typedef QVector<VNoteSearchHit> VNOTE_SEARCH_HITS;
+
+//笔记可搜索内容的快照，在主线程中生成，搜索线程只读取快照，不访问可能被修改的笔记数据
+struct VNoteSearchDoc {
+    qint64 folderId {-1};
+    qint64 noteId {-1};
+    QString title;
+    QString htmlCode;
+    //没有html的旧版笔记各文本块内容
+    QStringList blockTexts;
+};
+
+typedef QVector<VNoteSearchDoc> VNOTE_SEARCH_DOCS;
+
+//笔记的修改状态，增量加载时用于判断笔记是否变化
+struct VNoteItemState {
+    qint64 folderId {-1};
+    QDateTime modifyTime;
+    bool isTop {false};
+};
+
+typedef QHash<qint64, VNoteItemState> VNOTE_ITEM_STATES;
+
+Q_DECLARE_METATYPE(VNoteSearchHit)
+Q_DECLARE_METATYPE(VNOTE_SEARCH_HITS)
+
 enum IconsType {
     DefaultIcon = 0x0,
     DefaultGrayIcon,
@@ -19,6 +19,14 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "jscontent.h"
+#include "vnoteimagevariant.h"
+#include "vnoteattachmentstore.h"
+#include "task/imagevariantworker.h"
+#include "task/imageingestworker.h"
+#include "task/imageencodeworker.h"
+#include "task/inlineimageworker.h"
+#include "setting.h"
+#include "globaldef.h"
 
 #include <QFile>
 #include <QVariant>
@@ -30,6 +38,10 @@
 #include <QJsonObject>
 #include <QClipboard>
 #include <QMimeData>
+#include <QTimer>
+#include <QThreadPool>
+#include <QThread>
+#include <QUrl>
 
 #include <DApplication>
 
@@ -38,6 +50,8 @@ DWIDGET_USE_NAMESPACE
 JsContent::JsContent()
 {
     connect(QApplication::clipboard(), &QClipboard::changed, this, &JsContent::onClipChange);
+    //图片复制受磁盘速度限制，线程数不超过MaxIngestThreads
+    m_ingestPool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), static_cast<int>(MaxIngestThreads)));
 }
 
 JsContent *JsContent::instance()
@@ -48,71 +62,206 @@ JsContent *JsContent::instance()
 
 /**
  * @brief JsContent::insertImages
- * 判断图片路径是否有效，存在有效路径则创建副本传到web端中
+ * 按后缀筛选出图片后立即插入占位图，校验、复制及生成副本在线程池中并行进行，不阻塞界面
  * @param filePaths 图片路径
  * @return 此次操作是否有效
  */
 bool JsContent::insertImages(QStringList filePaths)
 {
-    int count = 0;
-    QStringList paths;
-    //获取文件夹路径
-    QString dirPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/images";
-    //创建文件夹
-    QDir().mkdir(dirPath);
-    //获取时间戳
-    QDateTime currentDateTime = QDateTime::currentDateTime();
-    QString date = currentDateTime.toString("yyyyMMddhhmmss");
+    QSharedPointer<VNoteIngestContext> context(new VNoteIngestContext);
+    context->batchId = ++m_ingestBatchId;
 
     for (auto path : filePaths) {
         QFileInfo fileInfo(path);
         QString suffix = fileInfo.suffix();
-        if (!(suffix == "jpg" || suffix == "png" || suffix == "bmp")) {
+        if (!(suffix == "jpg" || suffix == "png" || suffix == "bmp") || !fileInfo.isFile()) {
             continue;
         }
-        //创建文件路径
-        QString newPath = QString("%1/%2_%3.%4").arg(dirPath).arg(date).arg(++count).arg(suffix);
-        if (QFile::copy(path, newPath)) {
-            paths.push_back(newPath);
-        }
+        context->files.push_back(path);
     }
-    if (paths.size() == 0) {
+    if (context->files.size() == 0) {
         return false;
     }
-    emit callJsInsertImages(paths);
+
+    QStringList ids;
+    for (int i = 0; i < context->files.size(); i++) {
+        ids.push_back(QString("%1-%2").arg(context->batchId).arg(i));
+    }
+    emit callJsInsertImagePlaceholders(ids);
+
+    m_ingestTotal += context->files.size();
+    emit callJsSetIngestProgress(m_ingestFinished, m_ingestTotal);
+
+    int workerCount = qMin(context->files.size(), m_ingestPool.maxThreadCount());
+    for (int i = 0; i < workerCount; i++) {
+        ImageIngestWorker *worker = new ImageIngestWorker(context);
+        worker->setAutoDelete(true);
+        worker->setObjectName("ImageIngestWorker");
+        connect(worker, &ImageIngestWorker::imageIngested,
+                this, &JsContent::onImageIngested, Qt::QueuedConnection);
+        m_ingestPool.start(worker);
+    }
     return true;
 }
 
+/**
+ * @brief JsContent::onImageIngested
+ * @param batchId 插入批次id
+ * @param index 图片在批次中的序号
+ * @param image 仓库中的图片路径，失败为空
+ */
+void JsContent::onImageIngested(quint64 batchId, int index, const QString &image)
+{
+    finishIngest(QString("%1-%2").arg(batchId).arg(index), image);
+}
+
+/**
+ * @brief JsContent::finishIngest
+ * @param id 网页中的图片id
+ * @param image 仓库中的图片路径，失败为空
+ */
+void JsContent::finishIngest(const QString &id, const QString &image)
+{
+    if (!image.isEmpty() && !VNoteImageVariant::hasVariants(image)) {
+        //线程中已尝试生成副本，不再重试
+        m_variantFailed.insert(image);
+    }
+    emit callJsImageIngested(id, image.isEmpty() ? image : VNoteAttachmentStore::attachmentUrl(image));
+
+    m_ingestFinished++;
+    if (m_ingestFinished >= m_ingestTotal) {
+        m_ingestFinished = m_ingestTotal = 0;
+    }
+    emit callJsSetIngestProgress(m_ingestFinished, m_ingestTotal);
+}
+
 /**
  * @brief JsContent::insertImages
- * 向web端传入图片
+ * 大尺寸截图编码耗时较长，编码及存入在线程中进行
  * @param image
  * @return 操作是否成功 true:成功
  */
 bool JsContent::insertImages(const QImage &image)
 {
-    //获取文件夹路径
-    QString dirPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/images";
-    //创建文件夹
-    QDir().mkdir(dirPath);
-    //保存文件，文件名为当前年月日时分秒
-    QDateTime currentDateTime = QDateTime::currentDateTime();
-    QString fileName = currentDateTime.toString("yyyyMMddhhmmss.png");
-    QString imgPath = dirPath + "/" + fileName;
-
-    //保存文件
-    if (!image.save(imgPath)) {
+    if (image.isNull()) {
         return false;
     }
-    emit callJsInsertImages(QStringList(imgPath));
+
+    quint64 batchId = ++m_ingestBatchId;
+    emit callJsInsertImagePlaceholders(QStringList(QString("%1-0").arg(batchId)));
+
+    m_ingestTotal++;
+    emit callJsSetIngestProgress(m_ingestFinished, m_ingestTotal);
+
+    setting *config = setting::instance();
+    QByteArray codec = config->getOption(VNOTE_IMAGE_CODEC).toString().toLatin1();
+    QVariant quality = config->getOption(VNOTE_IMAGE_QUALITY);
+
+    ImageEncodeWorker *worker = new ImageEncodeWorker(batchId, image, codec.isEmpty() ? QByteArray("png") : codec,
+                                                      quality.isValid() ? quality.toInt() : -1);
+    worker->setAutoDelete(true);
+    worker->setObjectName("ImageEncodeWorker");
+    connect(worker, &ImageEncodeWorker::imageIngested,
+            this, &JsContent::onImageIngested, Qt::QueuedConnection);
+    connect(worker, &ImageEncodeWorker::imageEncoded,
+            this, &JsContent::onImageEncoded, Qt::QueuedConnection);
+    m_ingestPool.start(worker);
     return true;
 }
 
+/**
+ * @brief JsContent::onImageEncoded
+ * @param codec 实际使用的编码格式
+ * @param size 编码后的文件大小
+ * @param elapsed 耗时
+ */
+void JsContent::onImageEncoded(const QString &codec, qint64 size, qint64 elapsed)
+{
+    ImageEncodeStatistics &stat = m_imageEncodeStatistics[codec];
+    stat.count++;
+    stat.totalTime += elapsed;
+    stat.maxTime = qMax(stat.maxTime, elapsed);
+    stat.totalSize += size;
+
+    qInfo() << "encode pasted image:" << codec << "size:" << size << "elapsed:" << elapsed << "ms";
+}
+
+/**
+ * @brief JsContent::imageEncodeStatistics
+ * @param codec 编码格式
+ * @return 耗时统计
+ */
+JsContent::ImageEncodeStatistics JsContent::imageEncodeStatistics(const QString &codec) const
+{
+    return m_imageEncodeStatistics.value(codec);
+}
+
+/**
+ * @brief JsContent::generateImageVariants
+ * 已在生成或生成失败过的图片不重复生成
+ * @param images 原图路径
+ */
+void JsContent::generateImageVariants(const QStringList &images)
+{
+    QStringList pending;
+    QStringList ready;
+    for (const QString &image : images) {
+        if (VNoteImageVariant::hasVariants(image)) {
+            //附件仓库中已有的图片副本已生成
+            ready.append(image);
+        } else if (!m_variantPending.contains(image) && !m_variantFailed.contains(image)) {
+            m_variantPending.insert(image);
+            pending.append(image);
+        }
+    }
+    if (!ready.isEmpty()) {
+        emit callJsImageVariantsReady(ready);
+    }
+    if (pending.isEmpty()) {
+        return;
+    }
+
+    ImageVariantWorker *worker = new ImageVariantWorker(pending);
+    worker->setAutoDelete(true);
+    worker->setObjectName("ImageVariantWorker");
+    connect(worker, &ImageVariantWorker::variantsReady,
+            this, &JsContent::onImageVariantsReady, Qt::QueuedConnection);
+    QThreadPool::globalInstance()->start(worker);
+}
+
+/**
+ * @brief JsContent::onImageVariantsReady
+ * @param images 生成成功的原图路径
+ * @param failed 生成失败的原图路径
+ */
+void JsContent::onImageVariantsReady(const QStringList &images, const QStringList &failed)
+{
+    for (const QString &image : images) {
+        m_variantPending.remove(image);
+    }
+    for (const QString &image : failed) {
+        m_variantPending.remove(image);
+        m_variantFailed.insert(image);
+    }
+    if (!images.isEmpty()) {
+        emit callJsImageVariantsReady(images);
+    }
+}
+
 void JsContent::jsCallTxtChange()
 {
     emit textChange();
 }
 
+/**
+ * @brief JsContent::jsCallEditorChanges
+ * @param changes 编辑区推送的变化内容块
+ */
+void JsContent::jsCallEditorChanges(const QVariant &changes)
+{
+    emit editorChanges(changes);
+}
+
 void JsContent::jsCallChannleFinish()
 {
     emit getfontinfo();
@@ -155,16 +304,164 @@ QString JsContent::jsCallGetTranslation()
     return doc.toJson(QJsonDocument::Compact);
 }
 
-QVariant JsContent::callJsSynchronous(QWebEnginePage *page, const QString &funtion)
+/**
+ * @brief JsContent::callJsAsync
+ * 结果通过runJavaScript回调返回，同时启动超时定时器，先到者结束请求
+ * @param page 页面
+ * @param function 调用的js语句
+ * @param callback 回调
+ * @param timeout 超时时间，单位:毫秒
+ * @param waitAfterTimeout true 超时后继续等待结果
+ * @return 请求id
+ */
+quint64 JsContent::callJsAsync(QWebEnginePage *page, const QString &function, const JsCallback &callback, int timeout,
+                               bool waitAfterTimeout)
+{
+    if (nullptr == page) {
+        if (callback) {
+            callback(false, QVariant());
+        }
+        return 0;
+    }
+
+    quint64 requestId = ++m_jsRequestId;
+
+    JsRequest &request = m_jsRequests[requestId];
+    //统计按接口名区分，去掉参数
+    request.name = function.left(function.indexOf('(')).trimmed();
+    request.callback = callback;
+    request.timer.start();
+    request.waitAfterTimeout = waitAfterTimeout;
+
+    //每个请求单独的定时器，请求结束时停止，避免已结束的请求在超时后仍触发
+    request.timeoutTimer = new QTimer(this);
+    request.timeoutTimer->setSingleShot(true);
+    connect(request.timeoutTimer, &QTimer::timeout, this, [this, requestId] {
+        finishJsCall(requestId, false, QVariant());
+    });
+    request.timeoutTimer->start(timeout);
+
+    page->runJavaScript(function, [this, requestId](const QVariant &result) {
+        finishJsCall(requestId, true, result);
+    });
+
+    return requestId;
+}
+
+void JsContent::cancelJsCall(quint64 requestId)
+{
+    auto it = m_jsRequests.find(requestId);
+    if (it == m_jsRequests.end()) {
+        return;
+    }
+
+    releaseJsTimer(it.value());
+    m_jsRequests.erase(it);
+}
+
+bool JsContent::isJsCallPending(quint64 requestId) const
+{
+    return m_jsRequests.contains(requestId);
+}
+
+JsContent::JsCallStatistics JsContent::jsCallStatistics(const QString &name) const
+{
+    return m_jsCallStatistics.value(name);
+}
+
+/**
+ * @brief JsContent::finishJsCall
+ * 请求已结束或已取消时忽略
+ * @param requestId 请求id
+ * @param ok false 超时
+ * @param result 调用结果
+ */
+void JsContent::finishJsCall(quint64 requestId, bool ok, const QVariant &result)
+{
+    auto it = m_jsRequests.find(requestId);
+    if (it == m_jsRequests.end()) {
+        return;
+    }
+
+    //超时后继续等待的请求先通知超时，保留请求接收之后返回的结果
+    if (!ok && it->waitAfterTimeout) {
+        it->timedOut = true;
+        releaseJsTimer(it.value());
+        m_jsCallStatistics[it->name].timeouts++;
+        qWarning() << "js call" << it->name << "timeout after" << it->timer.elapsed() << "ms, wait for result";
+
+        JsCallback callback = it->callback;
+        if (callback) {
+            callback(false, QVariant());
+        }
+        return;
+    }
+
+    JsRequest request = it.value();
+    m_jsRequests.erase(it);
+    releaseJsTimer(request);
+
+    qint64 elapsed = request.timer.elapsed();
+    JsCallStatistics &stat = m_jsCallStatistics[request.name];
+    if (ok && request.timedOut) {
+        qWarning() << "js call" << request.name << "returned after timeout," << elapsed << "ms";
+    } else if (ok) {
+        stat.count++;
+        stat.totalTime += elapsed;
+        stat.maxTime = qMax(stat.maxTime, elapsed);
+        if (elapsed > SlowJsCallTime) {
+            qInfo() << "js call" << request.name << "took" << elapsed << "ms";
+        }
+    } else {
+        stat.timeouts++;
+        qWarning() << "js call" << request.name << "timeout after" << elapsed << "ms";
+    }
+
+    if (request.callback) {
+        request.callback(ok, result);
+    }
+}
+
+/**
+ * @brief JsContent::releaseJsTimer
+ * 可能在定时器自身的timeout信号中调用，延迟释放
+ * @param request 结束的请求
+ */
+void JsContent::releaseJsTimer(JsRequest &request)
+{
+    if (nullptr != request.timeoutTimer) {
+        request.timeoutTimer->stop();
+        request.timeoutTimer->deleteLater();
+        request.timeoutTimer = nullptr;
+    }
+}
+
+/**
+ * @brief JsContent::callJsSynchronous
+ * 局部事件循环只处理非用户输入事件，并在超时后退出，避免页面无响应时卡死
+ * @param page 页面
+ * @param funtion 调用的js语句
+ * @param timeout 超时时间，单位:毫秒
+ * @return 调用结果
+ */
+QVariant JsContent::callJsSynchronous(QWebEnginePage *page, const QString &funtion, int timeout)
 {
     QVariant synResult;
+    bool finished = false;
     QEventLoop synLoop;
-    if (page) {
-        page->runJavaScript(funtion, [&](const QVariant &result) {
+
+    //返回或超时后请求即结束，回调不会在函数返回后执行
+    callJsAsync(page, funtion, [&](bool ok, const QVariant &result) {
+        finished = true;
+        if (ok) {
             synResult = result;
-            synLoop.quit();
-        });
-        synLoop.exec();
+        }
+        synLoop.quit();
+    }, timeout);
+
+    //页面无效时已直接回调
+    if (!finished) {
+        synLoop.exec(QEventLoop::ExcludeUserInputEvents);
     }
     return synResult;
 }
@@ -174,6 +471,52 @@ void JsContent::jsCallSetDataFinsh()
     emit setDataFinsh();
 }
 
+void JsContent::jsCallSetSearchMatchCount(int count)
+{
+    emit searchMatchCountChanged(count);
+}
+
+void JsContent::jsCallNoteCacheMiss()
+{
+    emit noteCacheMiss();
+}
+
+/**
+ * @brief JsContent::jsCallImageVariantMissing
+ * 旧版本插入的图片没有副本，打开笔记时补充生成，只处理笔记图片目录中的图片
+ * @param imagePath 原图路径
+ */
+void JsContent::jsCallImageVariantMissing(const QString &imagePath)
+{
+    QString path = VNoteAttachmentStore::localPath(imagePath);
+    if (VNoteImageVariant::isNoteImage(path) && !VNoteImageVariant::hasVariants(path)) {
+        generateImageVariants(QStringList(path));
+    }
+}
+
+/**
+ * @brief JsContent::jsCallIngestInlineImages
+ * 内嵌图片会使笔记内容、保存及搜索的数据量成倍增加，存入仓库后只保存附件url
+ * @param ids 网页中的图片id
+ * @param uris 图片的data协议url
+ */
+void JsContent::jsCallIngestInlineImages(const QStringList &ids, const QStringList &uris)
+{
+    if (ids.isEmpty() || ids.size() != uris.size()) {
+        return;
+    }
+
+    m_ingestTotal += ids.size();
+    emit callJsSetIngestProgress(m_ingestFinished, m_ingestTotal);
+
+    InlineImageWorker *worker = new InlineImageWorker(ids, uris);
+    worker->setAutoDelete(true);
+    worker->setObjectName("InlineImageWorker");
+    connect(worker, &InlineImageWorker::imageIngested,
+            this, &JsContent::finishIngest, Qt::QueuedConnection);
+    m_ingestPool.start(worker);
+}
+
 void JsContent::jsCallPaste(bool isVoicePaste)
 {
     emit textPaste(isVoicePaste);
@@ -23,6 +23,13 @@
 
 #include <QObject>
 #include <QClipboard>
+#include <QMap>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QThreadPool>
+
+#include <functional>
 
 #include <QtWebEngineWidgets/qwebenginepage.h>
 
@@ -42,17 +49,93 @@ public:
     };
     Q_ENUM(AsrFlag)
 
-    QVariant callJsSynchronous(QWebEnginePage *page, const QString &funtion);
+    enum {
+        DefaultJsTimeout = 3000, //异步调用默认超时时间，单位:毫秒
+        ShutdownJsTimeout = 1000, //退出时同步调用的最长等待时间
+        SlowJsCallTime = 200, //耗时超过该值的调用输出日志
+        MaxIngestThreads = 4 //插入图片的最大并行线程数
+    };
+
+    /**
+     * @brief 异步调用结果回调
+     * @param ok false 调用超时或页面无效
+     * @param result 调用结果
+     */
+    typedef std::function<void(bool ok, const QVariant &result)> JsCallback;
+
+    //每种编码格式的粘贴图片编码耗时统计，单位:毫秒
+    struct ImageEncodeStatistics {
+        int count {0};
+        qint64 totalTime {0};
+        qint64 maxTime {0};
+        qint64 totalSize {0};
+    };
+
+    //每个接口的调用耗时统计，单位:毫秒
+    struct JsCallStatistics {
+        int count {0};
+        int timeouts {0};
+        qint64 totalTime {0};
+        qint64 maxTime {0};
+    };
+
+    /**
+     * @brief 异步调用web前端，结果或超时后在主线程回调，不阻塞界面
+     * @param page 页面，为空时直接以失败回调
+     * @param function 调用的js语句
+     * @param callback 回调，可以为空
+     * @param timeout 超时时间，超时后丢弃返回结果
+     * @param waitAfterTimeout true 超时后以失败回调一次，之后返回的结果仍以成功回调，用于不能丢弃的编辑内容
+     * @return 请求id，页面为空返回0
+     */
+    quint64 callJsAsync(QWebEnginePage *page, const QString &function,
+                        const JsCallback &callback = nullptr, int timeout = DefaultJsTimeout,
+                        bool waitAfterTimeout = false);
+    /**
+     * @brief 取消异步调用，取消后不再回调
+     * @param requestId 请求id
+     */
+    void cancelJsCall(quint64 requestId);
     /**
-     * @brief 插入图片
+     * @brief 异步调用是否未返回
+     * @param requestId 请求id
+     */
+    bool isJsCallPending(quint64 requestId) const;
+    /**
+     * @brief 接口的调用耗时统计
+     * @param name 接口名，不含参数
+     */
+    JsCallStatistics jsCallStatistics(const QString &name) const;
+    /**
+     * @brief 同步调用web前端，最多等待timeout毫秒，只在程序退出时使用
+     * @param page 页面
+     * @param funtion 调用的js语句
+     * @param timeout 超时时间
+     * @return 调用结果，超时返回空
+     */
+    QVariant callJsSynchronous(QWebEnginePage *page, const QString &funtion, int timeout = ShutdownJsTimeout);
+    /**
+     * @brief 插入图片，web端先插入占位图，图片在线程中存入附件仓库后逐个替换
      * @param filePaths 图片路径
-     * @return
+     * @return 存在待插入的图片返回true
      */
     bool insertImages(QStringList filePaths);
     /**
-     * @brief 插入图片
+     * @brief 插入图片，web端先插入占位图，编码格式及质量由设置决定，在线程中编码存入后替换
+     * @param image 图片
+     * @return 图片有效返回true
      */
     bool insertImages(const QImage &image);
+    /**
+     * @brief 粘贴图片的编码耗时统计
+     * @param codec 编码格式 png/webp/jpeg
+     */
+    ImageEncodeStatistics imageEncodeStatistics(const QString &codec) const;
+    /**
+     * @brief 在线程中生成图片的显示图和缩略图，完成后通知web前端切换显示
+     * @param images 原图路径
+     */
+    void generateImageVariants(const QStringList &images);
 
 signals:
     void callJsInitData(const QString &jsonData); //调用web前端，设置json格式数据
@@ -65,6 +148,19 @@ signals:
      */
     void callJsSetVoiceText(const QString &text, int asrflag);
     void callJsInsertImages(const QStringList &images); //调用web前端，插入图片
+    void callJsImageVariantsReady(const QStringList &images); //调用web前端，图片副本已生成
+    /**
+     * @brief 调用web前端，在光标处插入图片占位图
+     * @param ids 占位图id
+     */
+    void callJsInsertImagePlaceholders(const QStringList &ids);
+    /**
+     * @brief 调用web前端，占位图对应的图片已存入
+     * @param id 占位图id
+     * @param image 图片路径，为空时删除占位图
+     */
+    void callJsImageIngested(const QString &id, const QString &image);
+    void callJsSetIngestProgress(int finished, int total); //调用web前端，设置插入图片进度，total为0时隐藏
     void callJsSetPlayStatus(int status); //调用web前端, 设置播放状态，0播放中，1暂停中 2.结束播放
     /**
      * @brief 调用web前端，设置系统主题
@@ -79,9 +175,32 @@ signals:
     void calllJsShowEditToolbar(int x, int y); //显示编辑工具栏
     void callJsHideEditToolbar(); //隐藏编辑工具栏
     void callJsSetVoicePlayBtnEnable(bool enable); //设置播放按钮是否可用
+    /**
+     * @brief 调用web前端，设置当前笔记的搜索命中位置并高亮
+     * @param keyword 搜索关键字，为空时清除高亮
+     * @param offsets 命中位置，按编辑区文本节点拼接后的字符位置计算
+     * @param current 当前命中序号
+     */
+    void callJsSetSearchMatches(const QString &keyword, const QVariantList &offsets, int current);
+    void callJsGotoSearchMatch(int index); //调用web前端，跳转到第index个命中位置
+    /**
+     * @brief 调用web前端，切换笔记，离开的笔记节点移入缓存，打开的笔记可从缓存取出
+     * @param cacheKey 离开笔记的缓存键值，为空不缓存
+     * @param dropKeys 淘汰的缓存键值
+     * @param openKey 打开笔记的缓存键值，为空时使用html或json设置内容
+     * @param html 笔记html内容
+     * @param jsonData 没有html内容时使用的json数据
+     */
+    void callJsSwitchNote(const QString &cacheKey, const QStringList &dropKeys, const QString &openKey,
+                          const QString &html, const QString &jsonData);
 
     void textPaste(bool isVoicePaste); //粘贴信号
     void textChange();
+    /**
+     * @brief 编辑区推送变化的内容块
+     * @param changes 变更，格式与getChanges返回的结果相同
+     */
+    void editorChanges(const QVariant &changes);
     void loadFinsh();
     void popupMenu(int type, const QVariant &json);
     void playVoice(const QVariant &json, bool bIsSame);
@@ -100,6 +219,15 @@ signals:
      */
     void callJsSetFontList(const QStringList &list, const QString &font);
     void getfontinfo();  //获取字体列表信息信号
+    /**
+     * @brief 网页中的命中数量与后端计算不一致时，以网页重新查找的结果为准
+     * @param count 命中数量
+     */
+    void searchMatchCountChanged(int count);
+    /**
+     * @brief 网页中没有要打开的笔记缓存，需要重新设置内容
+     */
+    void noteCacheMiss();
 
 protected:
     JsContent();
@@ -110,6 +238,7 @@ public slots:
      */
     void jsCallSetDataFinsh();
     void jsCallTxtChange(); //web前端调用后端，通知数据变化
+    void jsCallEditorChanges(const QVariant &changes); //web前端调用后端，推送变化的内容块
     void jsCallChannleFinish(); //web前端调用后端，通信建立完成
     void jsCallSummernoteInitFinish();  //summernote 加载完成
     void jsCallPopupMenu(int type, const QVariant &json); //web前端调用后端，弹出右键菜单
@@ -119,10 +248,81 @@ public slots:
     void jsCallCreateNote(); //web前端调用后端，新建笔记
     void jsCallSetClipData(const QString &text, const QString &html); //web前端调用后端，设置剪切板内容
     QString jsCallGetTranslation(); //web前端调用后端，获取翻译
+    void jsCallSetSearchMatchCount(int count); //web前端调用后端，通知重新查找后的命中数量
+    void jsCallNoteCacheMiss(); //web前端调用后端，通知笔记缓存未命中
+    void jsCallImageVariantMissing(const QString &imagePath); //web前端调用后端，通知图片没有副本
+    /**
+     * @brief web前端调用后端，粘贴或打开的内容中有data协议内嵌的图片，在线程中存入附件仓库后替换
+     * @param ids 网页中的图片id
+     * @param uris 图片的data协议url
+     */
+    void jsCallIngestInlineImages(const QStringList &ids, const QStringList &uris);
     void onClipChange(QClipboard::Mode mode);
 
 private:
+    //未返回的异步调用
+    struct JsRequest {
+        QString name;
+        JsCallback callback;
+        QElapsedTimer timer;
+        //超时定时器，请求结束或取消时停止
+        QTimer *timeoutTimer {nullptr};
+        //超时后继续等待结果
+        bool waitAfterTimeout {false};
+        bool timedOut {false};
+    };
+
+    /**
+     * @brief 异步调用返回或超时，记录耗时并回调
+     * @param requestId 请求id
+     * @param ok false 超时
+     * @param result 调用结果
+     */
+    void finishJsCall(quint64 requestId, bool ok, const QVariant &result);
+    /**
+     * @brief 停止并释放请求的超时定时器
+     * @param request 请求
+     */
+    void releaseJsTimer(JsRequest &request);
+    /**
+     * @brief 图片副本生成结束
+     * @param images 生成成功的原图路径
+     * @param failed 生成失败的原图路径
+     */
+    void onImageVariantsReady(const QStringList &images, const QStringList &failed);
+    /**
+     * @brief 一张插入的图片处理完成
+     * @param batchId 插入批次id
+     * @param index 图片在批次中的序号
+     * @param image 仓库中的图片路径，失败为空
+     */
+    void onImageIngested(quint64 batchId, int index, const QString &image);
+    /**
+     * @brief 一张图片存入完成，通知web前端并更新进度
+     * @param id 网页中的图片id
+     * @param image 仓库中的图片路径，失败为空
+     */
+    void finishIngest(const QString &id, const QString &image);
+    /**
+     * @brief 粘贴图片编码完成，记录耗时
+     * @param codec 实际使用的编码格式
+     * @param size 编码后的文件大小
+     * @param elapsed 耗时
+     */
+    void onImageEncoded(const QString &codec, qint64 size, qint64 elapsed);
+
     const QMimeData *m_clipData {nullptr};
+    quint64 m_jsRequestId {0};
+    QMap<quint64, JsRequest> m_jsRequests;
+    QMap<QString, JsCallStatistics> m_jsCallStatistics;
+    QMap<QString, ImageEncodeStatistics> m_imageEncodeStatistics;
+    QSet<QString> m_variantPending; //正在生成副本的原图
+    QSet<QString> m_variantFailed; //无法生成副本的原图，不再重试
+    QThreadPool m_ingestPool; //插入图片线程池
+    quint64 m_ingestBatchId {0};
+    //进行中的插入图片总数及已完成数，全部完成后清零
+    int m_ingestTotal {0};
+    int m_ingestFinished {0};
 };
 
 #endif // JSCONTENT_H
@@ -24,6 +24,8 @@
 
 static qint64 initializeAppStartMs = 0;
 static qint64 initializeAppFinishMs = 0;
+static qint64 firstNoteOpenStartMs = 0;
+static bool firstNoteOpened = false;
 
 /**
  * @brief PerformanceMonitor::initializeAppStart
@@ -46,3 +48,32 @@ void PerformanceMonitor::initializeAppFinish()
     qint64 time = initializeAppFinishMs - initializeAppStartMs;
     qInfo() << QString("[GRABPOINT] POINT-01 startduration=%1ms").arg(time);
 }
+
+/**
+ * @brief PerformanceMonitor::firstNoteOpenStart
+ * 记录第一个笔记开始打开的时间
+ */
+void PerformanceMonitor::firstNoteOpenStart()
+{
+    if (0 == firstNoteOpenStartMs) {
+        firstNoteOpenStartMs = QDateTime::currentMSecsSinceEpoch();
+    }
+}
+
+/**
+ * @brief PerformanceMonitor::firstNoteOpenFinish
+ * 第一个笔记内容加载完成，编辑器页面未加载完成时的等待时间也计算在内
+ */
+void PerformanceMonitor::firstNoteOpenFinish()
+{
+    if (firstNoteOpened || 0 == firstNoteOpenStartMs) {
+        return;
+    }
+
+    firstNoteOpened = true;
+    qint64 current = QDateTime::currentMSecsSinceEpoch();
+    qInfo() << QString("[GRABPOINT] POINT-02 firstnoteopen=%1ms").arg(current - firstNoteOpenStartMs);
+    if (initializeAppStartMs > 0) {
+        qInfo() << QString("[GRABPOINT] POINT-03 firstnoteeditable=%1ms").arg(current - initializeAppStartMs);
+    }
+}
@@ -26,6 +26,10 @@ class PerformanceMonitor
 public:
     static void initializeAppStart();
     static void initializeAppFinish();
+    //第一个笔记开始打开，只记录第一次
+    static void firstNoteOpenStart();
+    //第一个笔记内容在编辑区加载完成，输出打开耗时及启动后的总耗时
+    static void firstNoteOpenFinish();
 };
 
 #endif // PERFORMANCEMONITOR_H
@@ -73,3 +73,31 @@ void *StandardItemCommon::getStandardItemData(const QModelIndex &index)
     }
     return nullptr;
 }
+
+/**
+ * @brief StandardItemCommon::setStandardItemSearchHit
+ * @param item 数据项
+ * @param hit 搜索结果信息
+ */
+void StandardItemCommon::setStandardItemSearchHit(QStandardItem *item, const VNoteSearchHit &hit)
+{
+    if (nullptr != item) {
+        item->setData(QVariant::fromValue(hit), Qt::UserRole + 3);
+    }
+}
+
+/**
+ * @brief StandardItemCommon::getStandardItemSearchHit
+ * @param index
+ * @return 搜索结果信息
+ */
+VNoteSearchHit StandardItemCommon::getStandardItemSearchHit(const QModelIndex &index)
+{
+    if (index.isValid()) {
+        QVariant var = index.data(Qt::UserRole + 3);
+        if (var.isValid()) {
+            return var.value<VNoteSearchHit>();
+        }
+    }
+    return VNoteSearchHit();
+}
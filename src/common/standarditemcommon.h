@@ -21,6 +21,8 @@
 #ifndef FOLDERTREECOMMON_H
 #define FOLDERTREECOMMON_H
 
+#include "common/datatypedef.h"
+
 #include <QObject>
 #include <QStandardItemModel>
 
@@ -43,6 +45,10 @@ public:
     static StandardItemType getStandardItemType(const QModelIndex &index);
     //获取数据内容
     static void *getStandardItemData(const QModelIndex &index);
+    //设置搜索结果信息
+    static void setStandardItemSearchHit(QStandardItem *item, const VNoteSearchHit &hit);
+    //获取搜索结果信息，非搜索项返回空数据
+    static VNoteSearchHit getStandardItemSearchHit(const QModelIndex &index);
 };
 
 #endif // FOLDERTREECOMMON_H
@@ -110,12 +110,18 @@ void VlcPalyer::detachEvent()
 /**
  * @brief VlcPalyer::setFilePath
  * @param path 文件路径
+ * @param startPos 起始播放位置
  */
-void VlcPalyer::setFilePath(QString path)
+void VlcPalyer::setFilePath(QString path, qint64 startPos)
 {
     init();
     libvlc_media_t *media = libvlc_media_new_path(m_vlcInst, path.toLatin1().constData());
     if (media) {
+        //播放开始前设置起始位置，避免从头播放后再跳转
+        if (startPos > 0) {
+            QString option = QString(":start-time=%1").arg(startPos / 1000.0, 0, 'f', 3);
+            libvlc_media_add_option(media, option.toLatin1().constData());
+        }
         libvlc_media_player_set_media(m_vlcPlayer, media);
         libvlc_media_release(media);
     }
@@ -44,8 +44,8 @@ public:
     Q_ENUM(VlcState)
     explicit VlcPalyer(QObject *parent = nullptr);
     ~VlcPalyer();
-    //设置播放文件
-    void setFilePath(QString path);
+    //设置播放文件，startPos为起始播放位置，单位:毫秒
+    void setFilePath(QString path, qint64 startPos = 0);
     //跳转指定位置，单位:毫秒
     void setPosition(qint64 pos);
     //播放
@@ -0,0 +1,427 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnotearchive.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+
+#include <cstring>
+
+namespace {
+//ustar头中各字段的位置
+enum {
+    NameOffset = 0,
+    ModeOffset = 100,
+    UidOffset = 108,
+    GidOffset = 116,
+    SizeOffset = 124,
+    MtimeOffset = 136,
+    ChecksumOffset = 148,
+    TypeOffset = 156,
+    MagicOffset = 257,
+    VersionOffset = 263,
+    PrefixOffset = 345,
+    PrefixLength = 155
+};
+
+//最大可表示的条目大小，11位八进制
+const qint64 MaxEntrySize = 077777777777LL;
+
+/**
+ * @brief writeOctal
+ * 八进制数字段，不足位数时补0，以\0结尾
+ * @param field 字段起始位置
+ * @param length 字段长度
+ * @param value 数值
+ */
+void writeOctal(char *field, int length, qint64 value)
+{
+    QByteArray digits = QByteArray::number(value, 8).rightJustified(length - 1, '0');
+    memcpy(field, digits.constData(), static_cast<size_t>(length - 1));
+    field[length - 1] = '\0';
+}
+
+/**
+ * @brief readOctal
+ * @param field 字段起始位置
+ * @param length 字段长度
+ * @param ok 是否为有效数字
+ * @return 数值
+ */
+qint64 readOctal(const char *field, int length, bool *ok)
+{
+    QByteArray digits = QByteArray(field, length);
+    int end = digits.indexOf('\0');
+    if (end >= 0) {
+        digits.truncate(end);
+    }
+    digits = digits.trimmed();
+    if (digits.isEmpty()) {
+        *ok = true;
+        return 0;
+    }
+    return digits.toLongLong(ok, 8);
+}
+
+/**
+ * @brief headerChecksum
+ * 校验和计算时校验和字段按空格计算
+ * @param header 条目头
+ * @return 校验和
+ */
+qint64 headerChecksum(const char *header)
+{
+    qint64 sum = 0;
+    for (int i = 0; i < VNoteArchiveWriter::BlockSize; i++) {
+        if (i >= ChecksumOffset && i < ChecksumOffset + 8) {
+            sum += ' ';
+        } else {
+            sum += static_cast<unsigned char>(header[i]);
+        }
+    }
+    return sum;
+}
+
+/**
+ * @brief readFully
+ * 读取指定大小的数据，设备单次读取不足时继续读取
+ * @param device 输入设备
+ * @param data 数据缓存
+ * @param size 读取大小
+ * @return true 读取完整
+ */
+bool readFully(QIODevice *device, char *data, qint64 size)
+{
+    while (size > 0) {
+        qint64 len = device->read(data, size);
+        if (len <= 0 && !device->waitForReadyRead(-1)) {
+            return false;
+        }
+        if (len > 0) {
+            data += len;
+            size -= len;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief VNoteArchiveWriter::VNoteArchiveWriter
+ * @param device 输出设备，需已打开
+ */
+VNoteArchiveWriter::VNoteArchiveWriter(QIODevice *device)
+    : m_device(device)
+    , m_ok(nullptr != device && device->isWritable())
+{
+}
+
+/**
+ * @brief VNoteArchiveWriter::addData
+ * @param name 条目名称
+ * @param data 条目内容
+ * @param time 修改时间，为空时使用当前时间
+ * @return true 成功
+ */
+bool VNoteArchiveWriter::addData(const QString &name, const QByteArray &data, const QDateTime &time)
+{
+    if (!writeHeader(name, data.size(), time)) {
+        return false;
+    }
+
+    m_ok = m_device->write(data) == data.size();
+    return writePadding(data.size());
+}
+
+/**
+ * @brief VNoteArchiveWriter::addFile
+ * 写入的大小以打开文件时为准，读取时文件变短则补0，保证归档结构完整
+ * @param name 条目名称
+ * @param filePath 文件路径
+ * @return true 成功，文件无法读取时不写入条目并返回false，归档仍可继续写入
+ */
+bool VNoteArchiveWriter::addFile(const QString &name, const QString &filePath)
+{
+    if (!m_ok) {
+        return false;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "archive open file failed:" << filePath << file.errorString();
+        return false;
+    }
+
+    qint64 size = file.size();
+    if (!writeHeader(name, size, QFileInfo(file).lastModified())) {
+        return false;
+    }
+
+    QByteArray buffer(CopyChunkSize, Qt::Uninitialized);
+    qint64 remaining = size;
+    while (m_ok && remaining > 0) {
+        qint64 len = file.read(buffer.data(), qMin<qint64>(remaining, buffer.size()));
+        if (len <= 0) {
+            qWarning() << "archive read file failed:" << filePath << file.errorString();
+            buffer.fill('\0');
+            len = qMin<qint64>(remaining, buffer.size());
+        }
+        m_ok = m_device->write(buffer.constData(), len) == len;
+        remaining -= len;
+    }
+
+    return writePadding(size);
+}
+
+/**
+ * @brief VNoteArchiveWriter::finish
+ * 归档以两个全0块结束
+ * @return true 成功
+ */
+bool VNoteArchiveWriter::finish()
+{
+    if (m_ok) {
+        QByteArray end(BlockSize * 2, '\0');
+        m_ok = m_device->write(end) == end.size();
+    }
+    return m_ok;
+}
+
+/**
+ * @brief VNoteArchiveWriter::isOk
+ * @return true 全部写入成功
+ */
+bool VNoteArchiveWriter::isOk() const
+{
+    return m_ok;
+}
+
+/**
+ * @brief VNoteArchiveWriter::writeHeader
+ * @param name 条目名称
+ * @param size 条目大小
+ * @param time 修改时间
+ * @return true 成功
+ */
+bool VNoteArchiveWriter::writeHeader(const QString &name, qint64 size, const QDateTime &time)
+{
+    if (!m_ok) {
+        return false;
+    }
+
+    QByteArray fileName = name.toUtf8();
+    if (fileName.isEmpty() || fileName.size() > MaxNameLength || size < 0 || size > MaxEntrySize) {
+        qWarning() << "archive entry not supported:" << name << size;
+        return false;
+    }
+
+    char header[BlockSize];
+    memset(header, 0, sizeof(header));
+    memcpy(header + NameOffset, fileName.constData(), static_cast<size_t>(fileName.size()));
+    writeOctal(header + ModeOffset, 8, 0644);
+    writeOctal(header + UidOffset, 8, 0);
+    writeOctal(header + GidOffset, 8, 0);
+    writeOctal(header + SizeOffset, 12, size);
+    writeOctal(header + MtimeOffset, 12, (time.isValid() ? time : QDateTime::currentDateTime()).toSecsSinceEpoch());
+    header[TypeOffset] = '0';
+    memcpy(header + MagicOffset, "ustar", 6);
+    memcpy(header + VersionOffset, "00", 2);
+    //校验和为6位八进制数字，后跟\0和空格
+    writeOctal(header + ChecksumOffset, 7, headerChecksum(header));
+    header[ChecksumOffset + 7] = ' ';
+
+    m_ok = m_device->write(header, BlockSize) == BlockSize;
+    return m_ok;
+}
+
+/**
+ * @brief VNoteArchiveWriter::writePadding
+ * @param size 条目大小
+ * @return true 成功
+ */
+bool VNoteArchiveWriter::writePadding(qint64 size)
+{
+    qint64 padding = (BlockSize - size % BlockSize) % BlockSize;
+    if (m_ok && padding > 0) {
+        QByteArray zero(static_cast<int>(padding), '\0');
+        m_ok = m_device->write(zero) == padding;
+    }
+    return m_ok;
+}
+
+/**
+ * @brief VNoteArchiveReader::VNoteArchiveReader
+ * @param device 输入设备，需已打开
+ */
+VNoteArchiveReader::VNoteArchiveReader(QIODevice *device)
+    : m_device(device)
+    , m_error(nullptr == device || !device->isReadable())
+{
+}
+
+/**
+ * @brief VNoteArchiveReader::next
+ * @param entry 条目信息
+ * @return true 读取到条目
+ */
+bool VNoteArchiveReader::next(Entry &entry)
+{
+    if (m_error || m_finished || !skipRemaining()) {
+        return false;
+    }
+
+    char header[VNoteArchiveWriter::BlockSize];
+    if (!readFully(m_device, header, sizeof(header))) {
+        //没有结束标记的归档按截断处理
+        m_error = true;
+        return false;
+    }
+
+    bool isEmpty = true;
+    for (char c : header) {
+        if ('\0' != c) {
+            isEmpty = false;
+            break;
+        }
+    }
+    if (isEmpty) {
+        m_finished = true;
+        return false;
+    }
+
+    bool sumOk = false;
+    bool sizeOk = false;
+    qint64 checksum = readOctal(header + ChecksumOffset, 8, &sumOk);
+    qint64 size = readOctal(header + SizeOffset, 12, &sizeOk);
+    if (!sumOk || !sizeOk || checksum != headerChecksum(header) || size < 0) {
+        qWarning() << "archive header invalid";
+        m_error = true;
+        return false;
+    }
+
+    QByteArray name(header + NameOffset, static_cast<int>(qstrnlen(header + NameOffset, 100)));
+    if (0 == memcmp(header + MagicOffset, "ustar", 5)) {
+        QByteArray prefix(header + PrefixOffset, static_cast<int>(qstrnlen(header + PrefixOffset, PrefixLength)));
+        if (!prefix.isEmpty()) {
+            name = prefix + '/' + name;
+        }
+    }
+
+    entry.name = QString::fromUtf8(name);
+    entry.size = size;
+    entry.isFile = '0' == header[TypeOffset] || '\0' == header[TypeOffset];
+
+    m_remaining = size;
+    m_padding = (VNoteArchiveWriter::BlockSize - size % VNoteArchiveWriter::BlockSize) % VNoteArchiveWriter::BlockSize;
+    return true;
+}
+
+/**
+ * @brief VNoteArchiveReader::readAll
+ * @return 当前条目的剩余内容，读取失败返回空
+ */
+QByteArray VNoteArchiveReader::readAll()
+{
+    if (m_error || m_remaining <= 0) {
+        return QByteArray();
+    }
+
+    if (m_remaining > MaxReadAllSize) {
+        qWarning() << "archive entry too large:" << m_remaining;
+        m_error = true;
+        return QByteArray();
+    }
+
+    QByteArray data(static_cast<int>(m_remaining), Qt::Uninitialized);
+    if (!readFully(m_device, data.data(), m_remaining)) {
+        m_error = true;
+        return QByteArray();
+    }
+
+    m_remaining = 0;
+    return data;
+}
+
+/**
+ * @brief VNoteArchiveReader::copyTo
+ * @param device 输出设备
+ * @return true 全部写入成功
+ */
+bool VNoteArchiveReader::copyTo(QIODevice *device)
+{
+    QByteArray buffer(VNoteArchiveWriter::CopyChunkSize, Qt::Uninitialized);
+    while (!m_error && m_remaining > 0) {
+        qint64 len = qMin<qint64>(m_remaining, buffer.size());
+        if (!readFully(m_device, buffer.data(), len)) {
+            m_error = true;
+            return false;
+        }
+        m_remaining -= len;
+        if (device->write(buffer.constData(), len) != len) {
+            return false;
+        }
+    }
+
+    return !m_error;
+}
+
+/**
+ * @brief VNoteArchiveReader::hasError
+ * @return true 读取出错或归档不完整
+ */
+bool VNoteArchiveReader::hasError() const
+{
+    return m_error;
+}
+
+/**
+ * @brief VNoteArchiveReader::skipRemaining
+ * 顺序设备不能定位时读取后丢弃
+ * @return true 成功
+ */
+bool VNoteArchiveReader::skipRemaining()
+{
+    qint64 skip = m_remaining + m_padding;
+    m_remaining = 0;
+    m_padding = 0;
+
+    if (skip <= 0) {
+        return true;
+    }
+
+    if (!m_device->isSequential()) {
+        m_error = !m_device->seek(m_device->pos() + skip);
+        return !m_error;
+    }
+
+    QByteArray buffer(static_cast<int>(qMin<qint64>(skip, VNoteArchiveWriter::CopyChunkSize)), Qt::Uninitialized);
+    while (skip > 0) {
+        qint64 len = qMin<qint64>(skip, buffer.size());
+        if (!readFully(m_device, buffer.data(), len)) {
+            m_error = true;
+            return false;
+        }
+        skip -= len;
+    }
+    return true;
+}
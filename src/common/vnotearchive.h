@@ -0,0 +1,103 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTEARCHIVE_H
+#define VNOTEARCHIVE_H
+
+#include <QIODevice>
+#include <QString>
+#include <QDateTime>
+
+//记事本归档使用ustar格式，条目按顺序写入和读取，不需要随机访问
+//写入时文件内容直接从源文件分块复制到输出设备，读取时条目内容可分块读出
+class VNoteArchiveWriter
+{
+public:
+    enum {
+        BlockSize = 512, //tar块大小
+        CopyChunkSize = 64 * 1024, //复制文件时每次读取的大小
+        MaxNameLength = 99 //条目名称最大长度，不使用长文件名扩展
+    };
+
+    explicit VNoteArchiveWriter(QIODevice *device);
+
+    //写入数据条目
+    bool addData(const QString &name, const QByteArray &data, const QDateTime &time = QDateTime());
+    //写入文件条目，文件内容分块复制，不整体读入内存
+    bool addFile(const QString &name, const QString &filePath);
+    //写入结束标记
+    bool finish();
+    //是否全部写入成功
+    bool isOk() const;
+
+private:
+    //写入条目头
+    bool writeHeader(const QString &name, qint64 size, const QDateTime &time);
+    //内容补齐到整块
+    bool writePadding(qint64 size);
+
+    QIODevice *m_device {nullptr};
+    bool m_ok {true};
+};
+
+class VNoteArchiveReader
+{
+public:
+    //条目信息
+    struct Entry {
+        QString name;
+        qint64 size {0};
+        //普通文件为true，目录等其他类型为false
+        bool isFile {false};
+    };
+
+    enum {
+        MaxReadAllSize = 256 * 1024 * 1024 //readAll可读取的最大条目
+    };
+
+    explicit VNoteArchiveReader(QIODevice *device);
+
+    /**
+     * @brief 读取下一个条目，当前条目未读完的内容被跳过
+     * @param entry 条目信息
+     * @return 没有更多条目或格式错误时返回false，可通过hasError区分
+     */
+    bool next(Entry &entry);
+    //读取当前条目的剩余内容，超过MaxReadAllSize时按出错处理
+    QByteArray readAll();
+    //当前条目的剩余内容分块写入输出设备
+    bool copyTo(QIODevice *device);
+    //是否读取出错
+    bool hasError() const;
+
+private:
+    //跳过当前条目剩余内容及补齐部分
+    bool skipRemaining();
+
+    QIODevice *m_device {nullptr};
+    //当前条目未读取的大小
+    qint64 m_remaining {0};
+    //当前条目的补齐大小
+    qint64 m_padding {0};
+    bool m_error {false};
+    bool m_finished {false};
+};
+
+#endif // VNOTEARCHIVE_H
@@ -0,0 +1,111 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnoteattachmentschemehandler.h"
+#include "vnoteattachmentstore.h"
+
+#include <QtWebEngineCore/QWebEngineUrlRequestJob>
+#include <QtWebEngineWidgets/QWebEngineProfile>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+#include <QtWebEngineCore/QWebEngineUrlScheme>
+#endif
+
+#include <QFile>
+#include <QMimeDatabase>
+#include <QDebug>
+
+const QByteArray VNoteAttachmentSchemeHandler::Scheme = "vnote";
+
+/**
+ * @brief VNoteAttachmentSchemeHandler::VNoteAttachmentSchemeHandler
+ * @param parent
+ */
+VNoteAttachmentSchemeHandler::VNoteAttachmentSchemeHandler(QObject *parent)
+    : QWebEngineUrlSchemeHandler(parent)
+{
+}
+
+/**
+ * @brief VNoteAttachmentSchemeHandler::registerScheme
+ * 注册为本地安全协议，file协议加载的编辑器页面可以访问
+ */
+void VNoteAttachmentSchemeHandler::registerScheme()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 12, 0)
+    QWebEngineUrlScheme scheme(Scheme);
+    scheme.setSyntax(QWebEngineUrlScheme::Syntax::Host);
+    scheme.setFlags(QWebEngineUrlScheme::SecureScheme
+                    | QWebEngineUrlScheme::LocalScheme
+                    | QWebEngineUrlScheme::LocalAccessAllowed);
+    QWebEngineUrlScheme::registerScheme(scheme);
+#endif
+}
+
+/**
+ * @brief VNoteAttachmentSchemeHandler::install
+ * @param profile 网页配置
+ */
+void VNoteAttachmentSchemeHandler::install(QWebEngineProfile *profile)
+{
+    if (nullptr != profile && nullptr == profile->urlSchemeHandler(Scheme)) {
+        profile->installUrlSchemeHandler(Scheme, new VNoteAttachmentSchemeHandler(profile));
+    }
+}
+
+/**
+ * @brief VNoteAttachmentSchemeHandler::mimeType
+ * @param filePath 文件路径
+ * @return mime类型
+ */
+QByteArray VNoteAttachmentSchemeHandler::mimeType(const QString &filePath)
+{
+    static QMimeDatabase mimeDb;
+    return mimeDb.mimeTypeForFile(filePath, QMimeDatabase::MatchExtension).name().toLatin1();
+}
+
+/**
+ * @brief VNoteAttachmentSchemeHandler::requestStarted
+ * 请求的副本不存在时返回失败，网页据此通知后端生成副本
+ * @param job 请求
+ */
+void VNoteAttachmentSchemeHandler::requestStarted(QWebEngineUrlRequestJob *job)
+{
+    if (job->requestMethod() != "GET") {
+        job->fail(QWebEngineUrlRequestJob::RequestDenied);
+        return;
+    }
+
+    QString path = VNoteAttachmentStore::localPath(job->requestUrl().toString());
+    if (path.isEmpty()) {
+        job->fail(QWebEngineUrlRequestJob::UrlInvalid);
+        return;
+    }
+
+    QFile *file = new QFile(path);
+    if (!file->open(QIODevice::ReadOnly)) {
+        delete file;
+        job->fail(QWebEngineUrlRequestJob::UrlNotFound);
+        return;
+    }
+
+    //文件在请求结束后释放
+    connect(job, &QObject::destroyed, file, &QObject::deleteLater);
+    job->reply(mimeType(path), file);
+}
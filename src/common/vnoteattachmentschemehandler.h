@@ -0,0 +1,49 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTEATTACHMENTSCHEMEHANDLER_H
+#define VNOTEATTACHMENTSCHEMEHANDLER_H
+
+#include <QtWebEngineCore/QWebEngineUrlSchemeHandler>
+
+class QWebEngineProfile;
+
+//编辑区附件协议处理，vnote://attachment/文件名?variant=thumb|display
+//回复直接使用打开的文件，网页分段读取，不将文件读入内存；
+//文件可随机访问，音视频的Range请求由QtWebEngine按请求位置定位读取
+class VNoteAttachmentSchemeHandler : public QWebEngineUrlSchemeHandler
+{
+    Q_OBJECT
+public:
+    explicit VNoteAttachmentSchemeHandler(QObject *parent = nullptr);
+
+    //协议名
+    static const QByteArray Scheme;
+    //注册协议，需在创建QApplication前调用
+    static void registerScheme();
+    //为网页配置安装协议处理，已安装时不重复安装
+    static void install(QWebEngineProfile *profile);
+    //文件的mime类型
+    static QByteArray mimeType(const QString &filePath);
+
+    void requestStarted(QWebEngineUrlRequestJob *job) override;
+};
+
+#endif // VNOTEATTACHMENTSCHEMEHANDLER_H
@@ -0,0 +1,480 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnoteattachmentstore.h"
+#include "vnoteimagevariant.h"
+#include "vnotefilecopier.h"
+#include "db/vnoteattachmentoper.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QDebug>
+
+/**
+ * @brief hasTransparentPixels
+ * 截图等图片格式带透明通道但像素全部不透明，需要逐个像素判断
+ * @param image 图片
+ * @return true 存在透明像素
+ */
+static bool hasTransparentPixels(const QImage &image)
+{
+    if (!image.hasAlphaChannel()) {
+        return false;
+    }
+
+    QImage argb = image.convertToFormat(QImage::Format_ARGB32);
+    for (int y = 0; y < argb.height(); y++) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(argb.constScanLine(y));
+        for (int x = 0; x < argb.width(); x++) {
+            if (qAlpha(line[x]) < 255) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief VNoteAttachmentStore::attachmentDir
+ * @param type 附件类型
+ * @return 附件目录，与原有图片、语音目录相同
+ */
+QString VNoteAttachmentStore::attachmentDir(VNoteAttachment::Type type)
+{
+    QString dirPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    return dirPath + (VNoteAttachment::Voice == type ? "/voicenote" : "/images");
+}
+
+/**
+ * @brief VNoteAttachmentStore::isStoreFileName
+ * @param fileName 文件名
+ * @return true 哈希命名的文件
+ */
+bool VNoteAttachmentStore::isStoreFileName(const QString &fileName)
+{
+    static const QRegularExpression rx("^[0-9a-f]{64}\\.\\w+$");
+    return rx.match(fileName).hasMatch();
+}
+
+/**
+ * @brief VNoteAttachmentStore::fileHash
+ * @param filePath 文件路径
+ * @return sha256值
+ */
+QString VNoteAttachmentStore::fileHash(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file)) {
+        return QString();
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+/**
+ * @brief VNoteAttachmentStore::registerFile
+ * 先登记再写文件，清理线程不会删除刚登记的附件
+ * @param hash 哈希值
+ * @param suffix 文件后缀
+ * @param size 文件大小
+ * @param type 附件类型
+ * @return 附件路径
+ */
+QString VNoteAttachmentStore::registerFile(const QString &hash, const QString &suffix, qint64 size, VNoteAttachment::Type type)
+{
+    VNoteAttachment attachment;
+    attachment.hash = hash;
+    attachment.fileName = hash + "." + suffix;
+    attachment.type = type;
+    attachment.size = size;
+    attachment.storeTime = QDateTime::currentDateTime();
+    VNoteAttachmentOper().addAttachment(attachment);
+
+    QString dirPath = attachmentDir(type);
+    QDir().mkpath(dirPath);
+    return dirPath + "/" + attachment.fileName;
+}
+
+/**
+ * @brief VNoteAttachmentStore::storeFile
+ * @param source 源文件
+ * @param type 附件类型
+ * @param moveSource true 存入后删除源文件
+ * @return 仓库中的文件路径，失败返回空
+ */
+QString VNoteAttachmentStore::storeFile(const QString &source, VNoteAttachment::Type type, bool moveSource)
+{
+    QFileInfo fileInfo(source);
+    QString hash = fileHash(source);
+    if (hash.isEmpty()) {
+        qWarning() << "read attachment failed:" << source;
+        return QString();
+    }
+
+    QString target = registerFile(hash, fileInfo.suffix().toLower(), fileInfo.size(), type);
+    if (QFileInfo(target) == fileInfo) {
+        return target;
+    }
+
+    if (QFile::exists(target)) {
+        //相同内容已存在，不再保存
+        if (moveSource) {
+            QFile::remove(source);
+        }
+        return target;
+    }
+
+    if (moveSource && QFile::rename(source, target)) {
+        return target;
+    }
+
+    //先复制到临时文件，避免中断后留下不完整的哈希命名文件，多个线程同时存入相同内容时临时文件不冲突
+    QString tempPath = QString("%1.%2.part").arg(target).arg(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    QFile::remove(tempPath);
+    if (!VNoteFileCopier::copy(source, tempPath) || !QFile::rename(tempPath, target)) {
+        qWarning() << "store attachment failed:" << source;
+        QFile::remove(tempPath);
+        return QFile::exists(target) ? target : QString();
+    }
+
+    if (moveSource) {
+        QFile::remove(source);
+    }
+    return target;
+}
+
+/**
+ * @brief VNoteAttachmentStore::storeData
+ * @param data 文件数据
+ * @param suffix 文件后缀
+ * @param type 附件类型
+ * @return 仓库中的文件路径，失败返回空
+ */
+QString VNoteAttachmentStore::storeData(const QByteArray &data, const QString &suffix, VNoteAttachment::Type type)
+{
+    if (data.isEmpty()) {
+        return QString();
+    }
+
+    QString hash = QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+    QString target = registerFile(hash, suffix, data.size(), type);
+    if (QFile::exists(target)) {
+        return target;
+    }
+
+    QSaveFile file(target);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qWarning() << "store attachment failed:" << target;
+        return QString();
+    }
+    return target;
+}
+
+/**
+ * @brief VNoteAttachmentStore::storeImage
+ * @param image 图片
+ * @param codec 编码格式
+ * @param quality 编码质量
+ * @param usedCodec 实际使用的编码格式
+ * @return 仓库中的文件路径，失败返回空
+ */
+QString VNoteAttachmentStore::storeImage(const QImage &image, const QByteArray &codec, int quality, QByteArray *usedCodec)
+{
+    QByteArray data;
+    QByteArray format = encodeImage(image, codec, quality, data);
+    if (usedCodec) {
+        *usedCodec = format;
+    }
+    if (format.isEmpty()) {
+        return QString();
+    }
+    return storeData(data, format == "jpeg" ? "jpg" : QString::fromLatin1(format), VNoteAttachment::Image);
+}
+
+/**
+ * @brief VNoteAttachmentStore::encodeImage
+ * webp使用无损压缩，jpeg质量限制在MinJpegQuality到MaxJpegQuality之间，只用于不透明的图片
+ * @param image 图片
+ * @param codec 编码格式
+ * @param quality 编码质量
+ * @param data 编码结果
+ * @return 实际使用的编码格式，失败返回空
+ */
+QByteArray VNoteAttachmentStore::encodeImage(const QImage &image, QByteArray codec, int quality, QByteArray &data)
+{
+    if (image.isNull()) {
+        return QByteArray();
+    }
+
+    codec = codec.toLower();
+    if (codec == "jpg") {
+        codec = "jpeg";
+    }
+    if ((codec == "jpeg" && hasTransparentPixels(image))
+            || (codec != "jpeg" && codec != "webp")
+            || !QImageWriter::supportedImageFormats().contains(codec)) {
+        codec = "png";
+    }
+
+    if (codec == "webp") {
+        //质量为100时无损压缩
+        quality = 100;
+    } else if (codec == "jpeg") {
+        quality = quality < 0 ? DefaultJpegQuality : qBound(static_cast<int>(MinJpegQuality), quality, static_cast<int>(MaxJpegQuality));
+    } else if (quality < 0) {
+        quality = FastPngQuality;
+    }
+
+    data.clear();
+    QBuffer buffer(&data);
+    if (!buffer.open(QIODevice::WriteOnly) || !image.save(&buffer, codec.constData(), quality)) {
+        return QByteArray();
+    }
+    return codec;
+}
+
+/**
+ * @brief VNoteAttachmentStore::collectGarbage
+ * 引用计数为0的附件删除文件及记录，图片同时删除显示图和缩略图
+ * @param before 只清理在此时间之前存入的附件
+ * @return 删除的文件数
+ */
+int VNoteAttachmentStore::collectGarbage(const QDateTime &before)
+{
+    VNoteAttachmentOper attachmentOper;
+    int count = 0;
+
+    for (auto &attachment : attachmentOper.unusedAttachments(before)) {
+        if (!attachmentOper.removeAttachment(attachment)) {
+            continue;
+        }
+
+        QString path = attachmentDir(static_cast<VNoteAttachment::Type>(attachment.type)) + "/" + attachment.fileName;
+        if (QFile::remove(path)) {
+            count++;
+        }
+        if (VNoteAttachment::Image == attachment.type) {
+            VNoteImageVariant::removeVariants(path);
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief VNoteAttachmentStore::attachmentUrl
+ * @param filePath 附件路径
+ * @return 附件url
+ */
+QString VNoteAttachmentStore::attachmentUrl(const QString &filePath)
+{
+    QFileInfo fileInfo(filePath);
+    VNoteAttachment::Type type = fileInfo.suffix() == "mp3" ? VNoteAttachment::Voice : VNoteAttachment::Image;
+    if (fileInfo.absolutePath() != QFileInfo(attachmentDir(type)).absoluteFilePath()) {
+        return QUrl::fromLocalFile(filePath).toString();
+    }
+    return QString("vnote://attachment/%1").arg(fileInfo.fileName());
+}
+
+/**
+ * @brief VNoteAttachmentStore::localPath
+ * 附件url只能访问附件目录中的文件
+ * @param src 图片地址
+ * @return 本地路径
+ */
+QString VNoteAttachmentStore::localPath(const QString &src)
+{
+    if (src.startsWith("file://")) {
+        return QUrl(src).toLocalFile();
+    }
+    if (!src.startsWith("vnote:")) {
+        return src;
+    }
+
+    static const QRegularExpression rxName("^[\\w\\-]+\\.\\w+$");
+    QUrl url(src);
+    QString fileName = url.path().mid(1);
+    if (url.host() != "attachment" || !rxName.match(fileName).hasMatch()) {
+        return QString();
+    }
+
+    VNoteAttachment::Type type = QFileInfo(fileName).suffix() == "mp3" ? VNoteAttachment::Voice : VNoteAttachment::Image;
+    QString path = attachmentDir(type) + "/" + fileName;
+
+    QString variant = QUrlQuery(url).queryItemValue("variant");
+    if (VNoteAttachment::Image == type && variant == "thumb") {
+        return VNoteImageVariant::variantPath(path, VNoteImageVariant::Thumbnail);
+    }
+    if (VNoteAttachment::Image == type && variant == "display") {
+        return VNoteImageVariant::variantPath(path, VNoteImageVariant::Display);
+    }
+    return path;
+}
+
+/**
+ * @brief VNoteAttachmentStore::resolveUrls
+ * @param html 笔记html
+ * @return 附件url替换为本地路径的html
+ */
+QString VNoteAttachmentStore::resolveUrls(const QString &html)
+{
+    static const QRegularExpression rx("vnote://attachment/[\\w\\-]+\\.\\w+(\\?variant=\\w+)?");
+
+    if (!html.contains("vnote://")) {
+        return html;
+    }
+
+    QString result;
+    int pos = 0;
+    QRegularExpressionMatchIterator it = rx.globalMatch(html);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        result.append(html.midRef(pos, match.capturedStart() - pos));
+        result.append(localPath(match.captured(0)));
+        pos = match.capturedEnd();
+    }
+    result.append(html.midRef(pos));
+    return result;
+}
+
+/**
+ * @brief VNoteAttachmentStore::storeDataUri
+ * 保存解码后的原始数据，不重新编码，格式由文件内容判断
+ * @param uri data协议url
+ * @return 仓库中的图片路径
+ */
+QString VNoteAttachmentStore::storeDataUri(const QString &uri)
+{
+    static const QRegularExpression rx("^data:image/[\\w.+\\-]+(?:;[\\w\\-]+=[\\w\\-]+)*(;base64)?,");
+    QRegularExpressionMatch match = rx.match(uri);
+    if (!match.hasMatch()) {
+        return QString();
+    }
+
+    QByteArray payload = uri.midRef(match.capturedEnd()).toLatin1();
+    QByteArray data = match.capturedLength(1) > 0 ? QByteArray::fromBase64(payload)
+                                                   : QByteArray::fromPercentEncoding(payload);
+    QBuffer buffer(&data);
+    QByteArray format = QImageReader::imageFormat(&buffer);
+    if (format == "jpeg") {
+        format = "jpg";
+    }
+    if (format != "png" && format != "jpg" && format != "bmp") {
+        return QString();
+    }
+    return storeData(data, QString::fromLatin1(format), VNoteAttachment::Image);
+}
+
+/**
+ * @brief VNoteAttachmentStore::externalizeDataUris
+ * 只替换img标签src属性中的内容，文本中的data协议字符串不处理
+ * @param html 笔记html
+ * @param images 存入的图片路径
+ * @return 替换后的html
+ */
+QString VNoteAttachmentStore::externalizeDataUris(const QString &html, QStringList *images)
+{
+    static const QRegularExpression rx("(<img\\s(?:[^>]*?\\s)?src=)([\"'])(data:image/[^\"']*)\\2");
+
+    if (!html.contains("data:image/")) {
+        return html;
+    }
+
+    QString result;
+    int pos = 0;
+    QRegularExpressionMatchIterator it = rx.globalMatch(html);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        QString image = storeDataUri(match.captured(3));
+        if (image.isEmpty()) {
+            continue;
+        }
+        if (images) {
+            images->append(image);
+        }
+        result.append(html.midRef(pos, match.capturedStart(3) - pos));
+        result.append(attachmentUrl(image));
+        pos = match.capturedEnd(3);
+    }
+    if (0 == pos) {
+        return html;
+    }
+    result.append(html.midRef(pos));
+    return result;
+}
+
+/**
+ * @brief VNoteAttachmentStore::externalizeLocalPaths
+ * 旧版本笔记中图片目录下的本地路径存入仓库后替换为附件url，目录外的图片保持不变
+ * @param html 笔记html
+ * @param images 存入的图片路径
+ * @return 替换后的html
+ */
+QString VNoteAttachmentStore::externalizeLocalPaths(const QString &html, QStringList *images)
+{
+    static const QRegularExpression rx("(<img\\s(?:[^>]*?\\s)?src=)([\"'])((?:file://)?/[^\"']*)\\2");
+
+    QString imageDir = QFileInfo(attachmentDir(VNoteAttachment::Image)).absoluteFilePath();
+    if (!html.contains(imageDir)) {
+        return html;
+    }
+
+    QString result;
+    int pos = 0;
+    QRegularExpressionMatchIterator it = rx.globalMatch(html);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        QFileInfo fileInfo(localPath(match.captured(3)));
+        if (fileInfo.absolutePath() != imageDir || !fileInfo.isFile()) {
+            continue;
+        }
+        //时间命名的旧图片复制一份哈希命名的文件，旧文件无引用后由清理线程删除
+        QString image = storeFile(fileInfo.absoluteFilePath(), VNoteAttachment::Image);
+        if (image.isEmpty()) {
+            continue;
+        }
+        if (images) {
+            images->append(image);
+        }
+        result.append(html.midRef(pos, match.capturedStart(3) - pos));
+        result.append(attachmentUrl(image));
+        pos = match.capturedEnd(3);
+    }
+    if (0 == pos) {
+        return html;
+    }
+    result.append(html.midRef(pos));
+    return result;
+}
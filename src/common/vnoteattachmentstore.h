@@ -0,0 +1,124 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTEATTACHMENTSTORE_H
+#define VNOTEATTACHMENTSTORE_H
+
+#include "common/datatypedef.h"
+
+#include <QString>
+#include <QImage>
+
+//按内容寻址的附件仓库，文件以内容的sha256值命名，相同内容只保存一份
+//引用关系在笔记保存时由数据库记录，引用计数为0的附件由清理线程删除
+class VNoteAttachmentStore
+{
+public:
+    enum {
+        FastPngQuality = 80, //png默认质量，对应zlib压缩级别1
+        DefaultJpegQuality = 90, //jpeg默认质量
+        MinJpegQuality = 50, //jpeg质量范围
+        MaxJpegQuality = 95
+    };
+
+    //附件目录
+    static QString attachmentDir(VNoteAttachment::Type type);
+    //文件名是否为附件仓库的哈希命名
+    static bool isStoreFileName(const QString &fileName);
+    //文件内容的sha256值，读取失败返回空
+    static QString fileHash(const QString &filePath);
+    /**
+     * @brief 存入文件，仓库中已有相同内容时直接返回已有文件
+     * @param source 源文件
+     * @param type 附件类型
+     * @param moveSource true 存入后删除源文件
+     * @return 仓库中的文件路径，失败返回空
+     */
+    static QString storeFile(const QString &source, VNoteAttachment::Type type, bool moveSource = false);
+    /**
+     * @brief 存入编码后的数据
+     * @param data 文件数据
+     * @param suffix 文件后缀
+     * @param type 附件类型
+     * @return 仓库中的文件路径，失败返回空
+     */
+    static QString storeData(const QByteArray &data, const QString &suffix, VNoteAttachment::Type type);
+    /**
+     * @brief 编码并存入图片
+     * @param image 图片
+     * @param codec 编码格式 png/webp/jpeg，不支持的格式或带透明度的图片使用jpeg时改为png
+     * @param quality 编码质量，小于0使用格式的默认值，png质量越高压缩越快
+     * @param usedCodec 实际使用的编码格式
+     * @return 仓库中的文件路径，失败返回空
+     */
+    static QString storeImage(const QImage &image, const QByteArray &codec = "png", int quality = -1,
+                              QByteArray *usedCodec = nullptr);
+    /**
+     * @brief 编码图片
+     * @param image 图片
+     * @param codec 编码格式，不可用时改为png
+     * @param quality 编码质量
+     * @param data 编码结果
+     * @return 实际使用的编码格式，失败返回空
+     */
+    static QByteArray encodeImage(const QImage &image, QByteArray codec, int quality, QByteArray &data);
+    //删除没有引用的附件，返回删除的文件数
+    static int collectGarbage(const QDateTime &before);
+    /**
+     * @brief 附件在编辑区中使用的url，笔记html中不保存本地路径
+     * @param filePath 附件路径，不在附件目录中时返回file协议url
+     * @return vnote://attachment/文件名
+     */
+    static QString attachmentUrl(const QString &filePath);
+    /**
+     * @brief 编辑区中图片地址对应的本地路径
+     * @param src 附件url、file协议url或本地路径，附件url可带variant=thumb/display参数
+     * @return 本地路径，附件url无效时返回空
+     */
+    static QString localPath(const QString &src);
+    //html中的附件url替换为本地路径，用于导出等需要访问文件的场景
+    static QString resolveUrls(const QString &html);
+    /**
+     * @brief 存入data协议内嵌的图片
+     * @param uri data:image/...;base64,...
+     * @return 仓库中的图片路径，不是png/jpeg/bmp图片或失败时返回空
+     */
+    static QString storeDataUri(const QString &uri);
+    /**
+     * @brief html中内嵌的图片存入仓库，替换为附件url
+     * @param html 笔记html
+     * @param images 存入的图片路径
+     * @return 替换后的html，无法存入的图片保持不变
+     */
+    static QString externalizeDataUris(const QString &html, QStringList *images = nullptr);
+    /**
+     * @brief html中图片目录下的本地路径存入仓库，替换为附件url
+     * @param html 笔记html
+     * @param images 存入的图片路径
+     * @return 替换后的html，无法存入的图片保持不变
+     */
+    static QString externalizeLocalPaths(const QString &html, QStringList *images = nullptr);
+
+private:
+    //登记附件并返回路径
+    static QString registerFile(const QString &hash, const QString &suffix, qint64 size, VNoteAttachment::Type type);
+};
+
+#endif // VNOTEATTACHMENTSTORE_H
@@ -0,0 +1,274 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnoteattributeindex.h"
+#include "common/vnoteitem.h"
+
+/**
+ * @brief VNoteAttributeIndex::instance
+ * @return 单例对象
+ */
+VNoteAttributeIndex *VNoteAttributeIndex::instance()
+{
+    static VNoteAttributeIndex _instance;
+    return &_instance;
+}
+
+/**
+ * @brief VNoteAttributeIndex::updateNote
+ * 语音和图片标记在加锁前计算，避免阻塞查询
+ * @param note 笔记
+ */
+void VNoteAttributeIndex::updateNote(VNoteItem *note)
+{
+    if (nullptr == note) {
+        return;
+    }
+
+    NoteEntry entry;
+    entry.folderId = note->folderId;
+    entry.modifyTime = note->modifyTime.toMSecsSinceEpoch();
+    entry.isTop = (0 != note->isTop);
+    entry.hasVoice = note->haveVoice();
+    entry.hasImage = haveImage(note);
+
+    QWriteLocker locker(&m_lock);
+
+    removeEntry(note->noteId);
+
+    m_folderPostings[entry.folderId].insert(note->noteId);
+    m_timePostings.insert(entry.modifyTime, note->noteId);
+
+    if (entry.isTop) {
+        m_topPostings.insert(note->noteId);
+    }
+
+    if (entry.hasVoice) {
+        m_voicePostings.insert(note->noteId);
+    }
+
+    if (entry.hasImage) {
+        m_imagePostings.insert(note->noteId);
+    }
+
+    m_entries.insert(note->noteId, entry);
+}
+
+/**
+ * @brief VNoteAttributeIndex::removeNote
+ * @param noteId 笔记id
+ */
+void VNoteAttributeIndex::removeNote(qint64 noteId)
+{
+    QWriteLocker locker(&m_lock);
+    removeEntry(noteId);
+}
+
+/**
+ * @brief VNoteAttributeIndex::removeFolder
+ * @param folderId 记事本id
+ */
+void VNoteAttributeIndex::removeFolder(qint64 folderId)
+{
+    QWriteLocker locker(&m_lock);
+
+    for (auto noteId : m_folderPostings.value(folderId)) {
+        removeEntry(noteId);
+    }
+
+    m_folderPostings.remove(folderId);
+}
+
+/**
+ * @brief VNoteAttributeIndex::clear
+ */
+void VNoteAttributeIndex::clear()
+{
+    QWriteLocker locker(&m_lock);
+
+    m_entries.clear();
+    m_folderPostings.clear();
+    m_voicePostings.clear();
+    m_imagePostings.clear();
+    m_topPostings.clear();
+    m_timePostings.clear();
+}
+
+/**
+ * @brief VNoteAttributeIndex::query
+ * 从最短的倒排表开始，逐个检查其余条件
+ * @param filter 查询条件
+ * @return 满足条件的笔记
+ */
+VNOTE_SEARCH_HITS VNoteAttributeIndex::query(const Filter &filter) const
+{
+    VNOTE_SEARCH_HITS hits;
+
+    QReadLocker locker(&m_lock);
+
+    QList<const QSet<qint64> *> postings;
+    int postingSize = 0;
+
+    if (filter.limitFolders) {
+        for (auto folderId : filter.folderIds) {
+            auto it = m_folderPostings.find(folderId);
+            if (it != m_folderPostings.end()) {
+                postings.append(&(*it));
+                postingSize += it->size();
+            }
+        }
+
+        if (postings.isEmpty()) {
+            return hits;
+        }
+    }
+
+    //记事本条件是多个倒排表的并集，其余条件各是一个倒排表
+    auto selectPosting = [&](const QSet<qint64> &posting) {
+        if (postings.isEmpty() || posting.size() < postingSize) {
+            postings.clear();
+            postings.append(&posting);
+            postingSize = posting.size();
+        }
+    };
+
+    if (filter.hasVoice) {
+        selectPosting(m_voicePostings);
+    }
+
+    if (filter.hasImage) {
+        selectPosting(m_imagePostings);
+    }
+
+    if (1 == filter.pinned) {
+        selectPosting(m_topPostings);
+    }
+
+    auto appendHit = [&](qint64 noteId) {
+        auto it = m_entries.find(noteId);
+        if (it != m_entries.end() && matchEntry(*it, filter)) {
+            VNoteSearchHit hit;
+            hit.folderId = it->folderId;
+            hit.noteId = noteId;
+            hits.append(hit);
+        }
+    };
+
+    if (!postings.isEmpty()) {
+        for (auto posting : postings) {
+            for (auto noteId : *posting) {
+                appendHit(noteId);
+            }
+        }
+    } else if (filter.after.isValid() || filter.before.isValid()) {
+        auto begin = filter.after.isValid()
+                     ? m_timePostings.lowerBound(filter.after.toMSecsSinceEpoch())
+                     : m_timePostings.constBegin();
+        auto end = filter.before.isValid()
+                   ? m_timePostings.lowerBound(filter.before.toMSecsSinceEpoch())
+                   : m_timePostings.constEnd();
+
+        for (auto it = begin; it != end; ++it) {
+            appendHit(it.value());
+        }
+    } else {
+        for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+            appendHit(it.key());
+        }
+    }
+
+    return hits;
+}
+
+/**
+ * @brief VNoteAttributeIndex::count
+ * @return 笔记数量
+ */
+int VNoteAttributeIndex::count() const
+{
+    QReadLocker locker(&m_lock);
+    return m_entries.size();
+}
+
+/**
+ * @brief VNoteAttributeIndex::haveImage
+ * @param note 笔记
+ * @return true 包含图片
+ */
+bool VNoteAttributeIndex::haveImage(VNoteItem *note)
+{
+    return note->htmlCode.contains("<img", Qt::CaseInsensitive);
+}
+
+/**
+ * @brief VNoteAttributeIndex::removeEntry
+ * @param noteId 笔记id
+ */
+void VNoteAttributeIndex::removeEntry(qint64 noteId)
+{
+    auto it = m_entries.find(noteId);
+
+    if (it != m_entries.end()) {
+        auto folderIt = m_folderPostings.find(it->folderId);
+        if (folderIt != m_folderPostings.end()) {
+            folderIt->remove(noteId);
+            if (folderIt->isEmpty()) {
+                m_folderPostings.erase(folderIt);
+            }
+        }
+
+        m_timePostings.remove(it->modifyTime, noteId);
+        m_topPostings.remove(noteId);
+        m_voicePostings.remove(noteId);
+        m_imagePostings.remove(noteId);
+        m_entries.erase(it);
+    }
+}
+
+/**
+ * @brief VNoteAttributeIndex::matchEntry
+ * @param entry 索引项
+ * @param filter 查询条件
+ * @return true 满足条件
+ */
+bool VNoteAttributeIndex::matchEntry(const NoteEntry &entry, const Filter &filter)
+{
+    if (filter.limitFolders && !filter.folderIds.contains(entry.folderId)) {
+        return false;
+    }
+
+    if ((filter.hasVoice && !entry.hasVoice) || (filter.hasImage && !entry.hasImage)) {
+        return false;
+    }
+
+    if (-1 != filter.pinned && entry.isTop != (1 == filter.pinned)) {
+        return false;
+    }
+
+    if (filter.after.isValid() && entry.modifyTime < filter.after.toMSecsSinceEpoch()) {
+        return false;
+    }
+
+    if (filter.before.isValid() && entry.modifyTime >= filter.before.toMSecsSinceEpoch()) {
+        return false;
+    }
+
+    return true;
+}
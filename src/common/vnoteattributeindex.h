@@ -0,0 +1,99 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTEATTRIBUTEINDEX_H
+#define VNOTEATTRIBUTEINDEX_H
+
+#include "common/datatypedef.h"
+
+#include <QHash>
+#include <QSet>
+#include <QMultiMap>
+#include <QDateTime>
+#include <QReadWriteLock>
+
+struct VNoteItem;
+
+//笔记属性索引，按记事本、修改时间、置顶、语音和图片建立倒排表
+//结构化搜索条件在索引中求交集，不再逐个遍历笔记内容
+//索引在数据加载时建立，笔记增删、保存、移动、置顶时增量更新
+class VNoteAttributeIndex
+{
+public:
+    //查询条件
+    struct Filter {
+        //限定记事本，folderIds为空时没有记事本满足条件
+        bool limitFolders {false};
+        QSet<qint64> folderIds;
+        bool hasVoice {false};
+        bool hasImage {false};
+        //-1不限定，0未置顶，1置顶
+        int pinned {-1};
+        //修改时间范围[after, before)，无效时不限定
+        QDateTime after;
+        QDateTime before;
+    };
+
+    static VNoteAttributeIndex *instance();
+
+    //添加或更新笔记
+    void updateNote(VNoteItem *note);
+    //移除笔记
+    void removeNote(qint64 noteId);
+    //移除记事本下所有笔记
+    void removeFolder(qint64 folderId);
+    //清空索引
+    void clear();
+    //查找满足条件的笔记
+    VNOTE_SEARCH_HITS query(const Filter &filter) const;
+    //索引中的笔记数量
+    int count() const;
+
+    //笔记中是否包含图片
+    static bool haveImage(VNoteItem *note);
+
+private:
+    VNoteAttributeIndex() = default;
+
+    struct NoteEntry {
+        qint64 folderId {-1};
+        qint64 modifyTime {0};
+        bool isTop {false};
+        bool hasVoice {false};
+        bool hasImage {false};
+    };
+
+    //从倒排表中移除
+    void removeEntry(qint64 noteId);
+    //笔记是否满足条件
+    static bool matchEntry(const NoteEntry &entry, const Filter &filter);
+
+    QHash<qint64, NoteEntry> m_entries;
+    //倒排表
+    QHash<qint64, QSet<qint64>> m_folderPostings;
+    QSet<qint64> m_voicePostings;
+    QSet<qint64> m_imagePostings;
+    QSet<qint64> m_topPostings;
+    //修改时间（毫秒）到笔记id
+    QMultiMap<qint64, qint64> m_timePostings;
+    mutable QReadWriteLock m_lock;
+};
+
+#endif // VNOTEATTRIBUTEINDEX_H
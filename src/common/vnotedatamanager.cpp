@@ -25,6 +25,8 @@
 #include "task/loadiconsworker.h"
 #include "vnoteforlder.h"
 #include "vnoteitem.h"
+#include "vnotetitleindex.h"
+#include "vnoteattributeindex.h"
 
 #include <DLog>
 
@@ -94,6 +96,8 @@ VNoteFolder *VNoteDataManager::addFolder(VNoteFolder *folder)
 
         m_qspNoteFoldersMap->lock.unlock();
 
+        VNoteTitleIndex::instance()->updateTitle(VNoteTitleIndex::FolderName, folder->id, folder->name);
+
         retFlder = folder;
     }
 
@@ -156,6 +160,12 @@ VNoteFolder *VNoteDataManager::delFolder(qint64 folderId)
         //All note released. unlock
         m_qspAllNotesMap->lock.unlock();
 
+        updateDataVersion();
+
+        VNoteTitleIndex::instance()->removeChildren(VNoteTitleIndex::NoteTitle, folderId);
+        VNoteTitleIndex::instance()->removeTitle(VNoteTitleIndex::FolderName, folderId);
+        VNoteAttributeIndex::instance()->removeFolder(folderId);
+
         retFlder = *itFolder;
         m_qspNoteFoldersMap->folders.erase(itFolder);
     }
@@ -231,6 +241,12 @@ VNoteItem *VNoteDataManager::addNote(VNoteItem *note)
 
         m_qspAllNotesMap->lock.unlock();
 
+        updateDataVersion();
+
+        VNoteTitleIndex::instance()->updateTitle(VNoteTitleIndex::NoteTitle, note->noteId,
+                                                 note->noteTitle, note->folderId);
+        VNoteAttributeIndex::instance()->updateNote(note);
+
         retNote = note;
     }
 
@@ -313,6 +329,11 @@ VNoteItem *VNoteDataManager::delNote(qint64 folderId, qint32 noteId)
 
             //Remove voice file of voice note
             retNote->delNoteData();
+
+            updateDataVersion();
+
+            VNoteTitleIndex::instance()->removeTitle(VNoteTitleIndex::NoteTitle, noteId);
+            VNoteAttributeIndex::instance()->removeNote(noteId);
         }
 
         notesInFolder->lock.unlock();
@@ -373,6 +394,24 @@ VNOTE_ITEMS_MAP *VNoteDataManager::getFolderNotes(qint64 folderId)
     return folderNotes;
 }
 
+/**
+ * @brief VNoteDataManager::dataVersion
+ * 搜索等缓存通过版本号判断数据是否已变化
+ * @return 数据版本号
+ */
+int VNoteDataManager::dataVersion() const
+{
+    return m_dataVersion.loadAcquire();
+}
+
+/**
+ * @brief VNoteDataManager::updateDataVersion
+ */
+void VNoteDataManager::updateDataVersion()
+{
+    m_dataVersion.ref();
+}
+
 /**
  * @brief VNoteDataManager::getDefaultIcon
  * @param index
@@ -24,6 +24,7 @@
 #include "datatypedef.h"
 
 #include <QObject>
+#include <QAtomicInt>
 
 class LoadFolderWorker;
 class LoadNoteItemsWorker;
@@ -50,6 +51,8 @@ public:
     void reqNoteFolders();
     //加载记事项数据
     void reqNoteItems();
+    //数据版本号，笔记增删改后递增
+    int dataVersion() const;
 signals:
     //记事本数据加载完成
     void onNoteFoldersLoaded();
@@ -85,6 +88,8 @@ protected:
     VNOTE_ITEMS_MAP *getFolderNotes(qint64 folderId);
     //获取记事本图标
     QPixmap getDefaultIcon(qint32 index, IconsType type);
+    //更新数据版本号
+    void updateDataVersion();
 
 private:
     QScopedPointer<VNOTE_FOLDERS_MAP> m_qspNoteFoldersMap;
@@ -103,6 +108,8 @@ private:
 
     int m_fDataState = {DataNotLoaded};
 
+    QAtomicInt m_dataVersion {0};
+
     bool isAllDatasReady() const;
 
     static VNoteDataManager *_instance;
@@ -0,0 +1,132 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnoteeditorcache.h"
+
+/**
+ * @brief VNoteEditorCache::noteKey
+ * @param note 笔记
+ * @return 记事本id、笔记id与修改时间组成的键值
+ */
+QString VNoteEditorCache::noteKey(const VNoteItem *note)
+{
+    return QString("%1_%2_%3").arg(note->folderId).arg(note->noteId).arg(note->modifyTime.toMSecsSinceEpoch());
+}
+
+/**
+ * @brief VNoteEditorCache::setLimit
+ * @param limit 缓存上限，小于等于0时不缓存
+ * @return 淘汰的键值
+ */
+QStringList VNoteEditorCache::setLimit(qint64 limit)
+{
+    QStringList evicted;
+    m_limit = qMax(limit, qint64(0));
+    evict(evicted);
+    return evicted;
+}
+
+qint64 VNoteEditorCache::limit() const
+{
+    return m_limit;
+}
+
+/**
+ * @brief VNoteEditorCache::insert
+ * @param key 键值
+ * @param size 内容大小
+ * @param evicted 淘汰的键值
+ * @return false 未缓存
+ */
+bool VNoteEditorCache::insert(const QString &key, qint64 size, QStringList &evicted)
+{
+    take(key);
+
+    if (size > m_limit) {
+        return false;
+    }
+
+    CacheEntry entry;
+    entry.key = key;
+    entry.size = size;
+    m_entries.append(entry);
+    m_size += size;
+
+    evict(evicted);
+    return true;
+}
+
+/**
+ * @brief VNoteEditorCache::take
+ * @param key 键值
+ * @return true 缓存存在并已移除
+ */
+bool VNoteEditorCache::take(const QString &key)
+{
+    for (int i = m_entries.size() - 1; i >= 0; i--) {
+        if (m_entries.at(i).key == key) {
+            m_size -= m_entries.at(i).size;
+            m_entries.removeAt(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool VNoteEditorCache::contains(const QString &key) const
+{
+    for (auto &entry : m_entries) {
+        if (entry.key == key) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void VNoteEditorCache::clear()
+{
+    m_entries.clear();
+    m_size = 0;
+}
+
+int VNoteEditorCache::count() const
+{
+    return m_entries.size();
+}
+
+qint64 VNoteEditorCache::size() const
+{
+    return m_size;
+}
+
+/**
+ * @brief VNoteEditorCache::evict
+ * @param evicted 淘汰的键值
+ */
+void VNoteEditorCache::evict(QStringList &evicted)
+{
+    while (m_size > m_limit && !m_entries.isEmpty()) {
+        CacheEntry entry = m_entries.takeFirst();
+        m_size -= entry.size;
+        evicted.append(entry.key);
+    }
+}
@@ -0,0 +1,72 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTEEDITORCACHE_H
+#define VNOTEEDITORCACHE_H
+
+#include "common/vnoteitem.h"
+
+#include <QList>
+#include <QStringList>
+
+//最近打开笔记缓存的索引，编辑区节点保存在网页中，后端按相同顺序记录键值与大小
+//后端决定命中和淘汰，网页只按指令移入、取出、删除节点
+//键值包含修改时间，笔记修改后旧缓存不会命中，最终被淘汰
+class VNoteEditorCache
+{
+public:
+    //默认缓存上限，单位:字符
+    enum {
+        DefaultLimit = 8 * 1024 * 1024
+    };
+
+    //笔记对应的键值
+    static QString noteKey(const VNoteItem *note);
+
+    //设置缓存上限，超出部分立即淘汰，返回淘汰的键值
+    QStringList setLimit(qint64 limit);
+    qint64 limit() const;
+    //加入缓存，内容超过上限时不缓存返回false，evicted返回淘汰的键值
+    bool insert(const QString &key, qint64 size, QStringList &evicted);
+    //取出缓存，存在返回true
+    bool take(const QString &key);
+    bool contains(const QString &key) const;
+    void clear();
+    //缓存数量
+    int count() const;
+    //缓存内容总大小
+    qint64 size() const;
+
+private:
+    //超出上限时从最久未使用的开始淘汰
+    void evict(QStringList &evicted);
+
+    struct CacheEntry {
+        QString key;
+        qint64 size {0};
+    };
+
+    //最近使用的在最后
+    QList<CacheEntry> m_entries;
+    qint64 m_size {0};
+    qint64 m_limit {DefaultLimit};
+};
+
+#endif // VNOTEEDITORCACHE_H
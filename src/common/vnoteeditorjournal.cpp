@@ -0,0 +1,251 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnoteeditorjournal.h"
+#include "common/vnoteitem.h"
+#include "task/journalsyncworker.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QtEndian>
+#include <QDebug>
+
+#include <unistd.h>
+
+/**
+ * @brief VNoteEditorJournal::VNoteEditorJournal
+ * @param filePath 日志路径
+ * @param parent
+ */
+VNoteEditorJournal::VNoteEditorJournal(const QString &filePath, QObject *parent)
+    : QObject(parent)
+    , m_file(filePath)
+{
+    m_syncTimer.setSingleShot(true);
+    m_syncTimer.setInterval(SyncDelay);
+    connect(&m_syncTimer, &QTimer::timeout, this, [this] {
+        if (m_unsynced && m_file.isOpen()) {
+            m_unsynced = false;
+            //复制文件描述符，落盘期间日志可以继续写入或关闭
+            int fd = ::dup(m_file.handle());
+            if (fd >= 0) {
+                JournalSyncWorker *worker = new JournalSyncWorker(fd);
+                worker->setAutoDelete(true);
+                worker->setObjectName("JournalSyncWorker");
+                QThreadPool::globalInstance()->start(worker);
+            }
+        }
+    });
+}
+
+VNoteEditorJournal::~VNoteEditorJournal()
+{
+    sync();
+}
+
+/**
+ * @brief VNoteEditorJournal::defaultPath
+ * @return 日志路径
+ */
+QString VNoteEditorJournal::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/editor.journal";
+}
+
+/**
+ * @brief VNoteEditorJournal::append
+ * @param note 笔记
+ * @param changes 编辑区返回的变更
+ * @param sync 合并变更后的内容块
+ * @return true 写入成功
+ */
+bool VNoteEditorJournal::append(const VNoteItem *note, const QVariantMap &changes, const VNoteEditorSync &sync)
+{
+    VNoteJournalKey key(note->folderId, note->noteId);
+
+    QVariantMap record;
+    record.insert("f", note->folderId);
+    record.insert("n", note->noteId);
+    //检查点后的增量变更没有基准内容，写入全部内容块
+    record.insert("c", m_pending.contains(key) ? changes : sync.snapshot());
+
+    if (!writeRecord(record)) {
+        return false;
+    }
+
+    m_pending.insert(key);
+    return true;
+}
+
+/**
+ * @brief VNoteEditorJournal::checkpoint
+ * @param note 笔记
+ */
+void VNoteEditorJournal::checkpoint(const VNoteItem *note)
+{
+    if (!m_pending.remove(VNoteJournalKey(note->folderId, note->noteId))) {
+        return;
+    }
+
+    if (m_pending.isEmpty()) {
+        //所有笔记都已保存，日志不再需要
+        m_file.resize(0);
+        return;
+    }
+
+    QVariantMap record;
+    record.insert("f", note->folderId);
+    record.insert("n", note->noteId);
+    record.insert("k", true);
+    writeRecord(record);
+}
+
+/**
+ * @brief VNoteEditorJournal::isPending
+ * @param note 笔记
+ * @return true 有未保存到数据库的记录
+ */
+bool VNoteEditorJournal::isPending(const VNoteItem *note) const
+{
+    return nullptr != note && m_pending.contains(VNoteJournalKey(note->folderId, note->noteId));
+}
+
+/**
+ * @brief VNoteEditorJournal::sync
+ */
+void VNoteEditorJournal::sync()
+{
+    m_syncTimer.stop();
+    if (m_unsynced && m_file.isOpen()) {
+        m_unsynced = false;
+        ::fdatasync(m_file.handle());
+    }
+}
+
+/**
+ * @brief VNoteEditorJournal::writeRecord
+ * 记录一次写入，不经过缓冲
+ * @param record 记录
+ * @return true 成功
+ */
+bool VNoteEditorJournal::writeRecord(const QVariantMap &record)
+{
+    if (!m_file.isOpen()) {
+        QDir().mkpath(QFileInfo(m_file).absolutePath());
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered)) {
+            qWarning() << "open editor journal failed:" << m_file.errorString();
+            return false;
+        }
+    }
+
+    QByteArray payload = QJsonDocument::fromVariant(record).toJson(QJsonDocument::Compact);
+    QByteArray data(HeaderSize, Qt::Uninitialized);
+    qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), data.data());
+    qToLittleEndian<quint32>(qChecksum(payload.constData(), static_cast<uint>(payload.size())), data.data() + 4);
+    data.append(payload);
+
+    if (m_file.write(data) != data.size()) {
+        qWarning() << "write editor journal failed:" << m_file.errorString();
+        return false;
+    }
+
+    scheduleSync();
+    return true;
+}
+
+/**
+ * @brief VNoteEditorJournal::scheduleSync
+ * 延迟内的多次写入合并为一次落盘
+ */
+void VNoteEditorJournal::scheduleSync()
+{
+    m_unsynced = true;
+    if (!m_syncTimer.isActive()) {
+        m_syncTimer.start();
+    }
+}
+
+/**
+ * @brief VNoteEditorJournal::replay
+ * 增量变更无法合并时丢弃该笔记之后的记录，直到下一条全部内容块
+ * @param filePath 日志路径
+ * @return 笔记最终的html内容
+ */
+QMap<VNoteJournalKey, QString> VNoteEditorJournal::replay(const QString &filePath)
+{
+    QMap<VNoteJournalKey, VNoteEditorSync> states;
+    QFile file(filePath);
+
+    if (file.open(QIODevice::ReadOnly)) {
+        QByteArray data = file.readAll();
+        int pos = 0;
+
+        while (pos + HeaderSize <= data.size()) {
+            quint32 size = qFromLittleEndian<quint32>(data.constData() + pos);
+            quint32 checksum = qFromLittleEndian<quint32>(data.constData() + pos + 4);
+            if (size > static_cast<quint32>(data.size() - pos - HeaderSize)) {
+                qWarning() << "editor journal truncated at:" << pos;
+                break;
+            }
+
+            const char *payload = data.constData() + pos + HeaderSize;
+            if (qChecksum(payload, size) != checksum) {
+                qWarning() << "editor journal corrupted at:" << pos;
+                break;
+            }
+            pos += HeaderSize + static_cast<int>(size);
+
+            QVariantMap record = QJsonDocument::fromJson(QByteArray::fromRawData(payload, static_cast<int>(size))).toVariant().toMap();
+            VNoteJournalKey key(record.value("f").toLongLong(), record.value("n").toInt());
+
+            if (record.value("k").toBool()) {
+                states.remove(key);
+                continue;
+            }
+
+            QVariantMap changes = record.value("c").toMap();
+            if (!states.contains(key) && !changes.value("full").toBool()) {
+                continue;
+            }
+            if (!states[key].applyChanges(changes)) {
+                qWarning() << "editor journal replay failed, note:" << key.second;
+                states.remove(key);
+            }
+        }
+    }
+
+    QMap<VNoteJournalKey, QString> notes;
+    for (auto it = states.begin(); it != states.end(); ++it) {
+        notes.insert(it.key(), it.value().html());
+    }
+    return notes;
+}
+
+/**
+ * @brief VNoteEditorJournal::discard
+ * @param filePath 日志路径
+ */
+void VNoteEditorJournal::discard(const QString &filePath)
+{
+    QFile::remove(filePath);
+}
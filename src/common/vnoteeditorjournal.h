@@ -0,0 +1,92 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTEEDITORJOURNAL_H
+#define VNOTEEDITORJOURNAL_H
+
+#include "common/vnoteeditorsync.h"
+
+#include <QObject>
+#include <QFile>
+#include <QMap>
+#include <QSet>
+#include <QPair>
+#include <QTimer>
+
+struct VNoteItem;
+
+//笔记键值：记事本id、笔记id
+typedef QPair<qint64, qint32> VNoteJournalKey;
+
+//编辑区变更日志，只追加写入，笔记完整内容保存到数据库前的变更先写入日志
+//笔记在检查点后的第一条记录为全部内容块，之后为增量变更，完整内容保存后写入检查点
+//写入不经过缓冲，程序或网页崩溃不丢失；落盘在延迟后批量进行
+//记录格式：长度(4字节) + 校验和(4字节) + json，启动时重放，末尾不完整的记录丢弃
+class VNoteEditorJournal : public QObject
+{
+    Q_OBJECT
+public:
+    enum {
+        SyncDelay = 1000, //写入后延迟落盘的时间，单位:毫秒
+        HeaderSize = 8 //记录头长度
+    };
+
+    explicit VNoteEditorJournal(const QString &filePath = defaultPath(), QObject *parent = nullptr);
+    ~VNoteEditorJournal() override;
+
+    //默认日志路径
+    static QString defaultPath();
+    /**
+     * @brief 追加笔记的变更
+     * @param note 笔记
+     * @param changes 编辑区返回的变更
+     * @param sync 合并变更后的内容块，检查点后的第一条记录写入全部内容块
+     * @return true 写入成功
+     */
+    bool append(const VNoteItem *note, const QVariantMap &changes, const VNoteEditorSync &sync);
+    //笔记完整内容已保存，没有其他笔记的记录时清空日志
+    void checkpoint(const VNoteItem *note);
+    //笔记是否有检查点后的记录
+    bool isPending(const VNoteItem *note) const;
+    //立即落盘
+    void sync();
+
+    /**
+     * @brief 重放日志
+     * @param filePath 日志路径
+     * @return 检查点后有记录的笔记最终的html内容
+     */
+    static QMap<VNoteJournalKey, QString> replay(const QString &filePath = defaultPath());
+    //删除日志，重放的内容保存后调用
+    static void discard(const QString &filePath = defaultPath());
+
+private:
+    //写入一条记录
+    bool writeRecord(const QVariantMap &record);
+    //延迟落盘
+    void scheduleSync();
+
+    QFile m_file;
+    QSet<VNoteJournalKey> m_pending; //检查点后有记录的笔记
+    QTimer m_syncTimer;
+    bool m_unsynced {false}; //有未落盘的记录
+};
+
+#endif // VNOTEEDITORJOURNAL_H
@@ -0,0 +1,141 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnoteeditorsync.h"
+
+/**
+ * @brief VNoteEditorSync::reset
+ */
+void VNoteEditorSync::reset()
+{
+    m_blocks.clear();
+    m_version = -1;
+}
+
+/**
+ * @brief VNoteEditorSync::version
+ * @return 版本号
+ */
+int VNoteEditorSync::version() const
+{
+    return m_version;
+}
+
+/**
+ * @brief VNoteEditorSync::applyChanges
+ * @param changes 网页返回的变更
+ * @return true 成功
+ */
+bool VNoteEditorSync::applyChanges(const QVariantMap &changes)
+{
+    if (!changes.contains("version")) {
+        reset();
+        return false;
+    }
+
+    if (changes.value("full").toBool()) {
+        m_blocks = changes.value("blocks").toStringList();
+    } else if (changes.value("base").toInt() != m_version
+               || !applyOps(changes.value("ops").toList(), changes.value("count").toInt())) {
+        reset();
+        return false;
+    }
+
+    m_version = changes.value("version").toInt();
+
+    return true;
+}
+
+/**
+ * @brief VNoteEditorSync::html
+ * @return 各块拼接的html
+ */
+QString VNoteEditorSync::html() const
+{
+    return m_blocks.join("");
+}
+
+/**
+ * @brief VNoteEditorSync::blockCount
+ * @return 块数量
+ */
+int VNoteEditorSync::blockCount() const
+{
+    return m_blocks.size();
+}
+
+/**
+ * @brief VNoteEditorSync::applyOps
+ * 按顺序保留、跳过旧块或插入新块，剩余的旧块保留
+ * @param ops 变更操作
+ * @param count 变更后的块数
+ * @return true 成功
+ */
+bool VNoteEditorSync::applyOps(const QVariantList &ops, int count)
+{
+    QStringList blocks;
+    int pos = 0;
+
+    for (auto &it : ops) {
+        QVariantMap op = it.toMap();
+
+        if (op.contains("keep")) {
+            int keep = op.value("keep").toInt();
+            if (keep < 0 || pos + keep > m_blocks.size()) {
+                return false;
+            }
+            blocks.append(m_blocks.mid(pos, keep));
+            pos += keep;
+        } else if (op.contains("skip")) {
+            int skip = op.value("skip").toInt();
+            if (skip < 0 || pos + skip > m_blocks.size()) {
+                return false;
+            }
+            pos += skip;
+        } else if (op.contains("insert")) {
+            blocks.append(op.value("insert").toStringList());
+        } else {
+            return false;
+        }
+    }
+
+    blocks.append(m_blocks.mid(pos));
+
+    if (blocks.size() != count) {
+        return false;
+    }
+
+    m_blocks = blocks;
+
+    return true;
+}
+
+/**
+ * @brief VNoteEditorSync::snapshot
+ * @return 全部内容块，格式与网页返回的全部内容相同
+ */
+QVariantMap VNoteEditorSync::snapshot() const
+{
+    QVariantMap changes;
+    changes.insert("version", m_version);
+    changes.insert("full", true);
+    changes.insert("blocks", m_blocks);
+    return changes;
+}
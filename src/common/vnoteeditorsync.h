@@ -0,0 +1,55 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTEEDITORSYNC_H
+#define VNOTEEDITORSYNC_H
+
+#include <QStringList>
+#include <QVariantMap>
+
+//编辑区内容同步，按编辑区顶层节点分块保存html
+//网页只返回上次同步后变化的块，版本号不一致时返回全部块
+//变更格式：{"version":版本, "full":true, "blocks":[...]}
+//     或 {"version":版本, "base":基准版本, "count":块数, "ops":[{"keep":n}|{"skip":n}|{"insert":[...]}]}
+class VNoteEditorSync
+{
+public:
+    //重置，下次同步获取全部内容
+    void reset();
+    //当前版本号，未同步时为-1
+    int version() const;
+    //应用网页返回的变更，基准版本或块数不一致时返回false，需重新获取全部内容
+    bool applyChanges(const QVariantMap &changes);
+    //当前html
+    QString html() const;
+    //块数量
+    int blockCount() const;
+    //全部内容块，日志中作为笔记的初始内容
+    QVariantMap snapshot() const;
+
+private:
+    //应用增量变更
+    bool applyOps(const QVariantList &ops, int count);
+
+    QStringList m_blocks;
+    int m_version {-1};
+};
+
+#endif // VNOTEEDITORSYNC_H
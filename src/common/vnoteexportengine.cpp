@@ -0,0 +1,124 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnoteexportengine.h"
+#include "common/setting.h"
+#include "globaldef.h"
+
+#include <QThread>
+
+/**
+ * @brief VNoteExportEngine::VNoteExportEngine
+ * @param parent
+ */
+VNoteExportEngine::VNoteExportEngine(QObject *parent)
+    : QObject(parent)
+{
+    m_exportPool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), static_cast<int>(MaxExportThreads)));
+}
+
+/**
+ * @brief VNoteExportEngine::~VNoteExportEngine
+ */
+VNoteExportEngine::~VNoteExportEngine()
+{
+    cancel();
+    m_exportPool.waitForDone();
+}
+
+/**
+ * @brief VNoteExportEngine::exportNotes
+ * 线程数不超过笔记数，每个线程循环领取笔记
+ * @param dirPath 导出目录
+ * @param exportType 导出类型
+ * @param notes 待导出的笔记
+ * @param defaultName 指定的文件名
+ * @return 开始导出返回true
+ */
+bool VNoteExportEngine::exportNotes(const QString &dirPath, ExportNoteWorker::ExportType exportType,
+                                    const QList<VNoteItem *> &notes, const QString &defaultName)
+{
+    if (isExporting()) {
+        return false;
+    }
+
+    m_context.reset(new VNoteExportContext);
+    m_context->exportType = exportType;
+    m_context->exportPath = dirPath;
+    m_context->exportName = defaultName;
+    m_context->notes = notes;
+
+    int workerCount = qBound(1, notes.size(), m_exportPool.maxThreadCount());
+    m_context->runningWorkers = workerCount;
+
+    for (int i = 0; i < workerCount; i++) {
+        ExportNoteWorker *worker = new ExportNoteWorker(m_context);
+        worker->setAutoDelete(true);
+        worker->setObjectName("ExportNoteWorker");
+        connect(worker, &ExportNoteWorker::exportProgress,
+                this, &VNoteExportEngine::exportProgress, Qt::QueuedConnection);
+        connect(worker, &ExportNoteWorker::exportFinished,
+                this, &VNoteExportEngine::onExportFinished, Qt::QueuedConnection);
+        m_exportPool.start(worker);
+    }
+    return true;
+}
+
+/**
+ * @brief VNoteExportEngine::cancel
+ */
+void VNoteExportEngine::cancel()
+{
+    if (!m_context.isNull()) {
+        m_context->cancelled.storeRelease(1);
+    }
+}
+
+/**
+ * @brief VNoteExportEngine::isExporting
+ * @return true 正在导出
+ */
+bool VNoteExportEngine::isExporting() const
+{
+    return !m_context.isNull();
+}
+
+/**
+ * @brief VNoteExportEngine::onExportFinished
+ * 导出成功后记录导出目录
+ * @param state 导出结果
+ */
+void VNoteExportEngine::onExportFinished(int state)
+{
+    if (m_context.isNull()) {
+        return;
+    }
+
+    if (ExportNoteWorker::ExportOK == state || ExportNoteWorker::ExportCancelled == state) {
+        if (ExportNoteWorker::ExportVoice == m_context->exportType) {
+            setting::instance()->setOption(VNOTE_EXPORT_VOICE_PATH_KEY, m_context->exportPath);
+        } else if (ExportNoteWorker::ExportNothing != m_context->exportType) {
+            setting::instance()->setOption(VNOTE_EXPORT_TEXT_PATH_KEY, m_context->exportPath);
+        }
+    }
+
+    m_context.reset();
+    emit exportFinished(state);
+}
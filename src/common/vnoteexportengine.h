@@ -0,0 +1,71 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTEEXPORTENGINE_H
+#define VNOTEEXPORTENGINE_H
+
+#include "task/exportnoteworker.h"
+
+#include <QObject>
+#include <QThreadPool>
+
+//笔记导出引擎，多线程并行导出，逐个笔记返回进度，可取消
+class VNoteExportEngine : public QObject
+{
+    Q_OBJECT
+public:
+    enum {
+        MaxExportThreads = 4 //导出受磁盘速度限制，线程数不超过该值
+    };
+
+    explicit VNoteExportEngine(QObject *parent = nullptr);
+    ~VNoteExportEngine() override;
+
+    /**
+     * @brief 开始导出，正在导出时不处理
+     * @param dirPath 导出目录
+     * @param exportType 导出类型
+     * @param notes 待导出的笔记
+     * @param defaultName 指定的文件名，只导出一个笔记时使用
+     * @return 开始导出返回true
+     */
+    bool exportNotes(const QString &dirPath, ExportNoteWorker::ExportType exportType,
+                     const QList<VNoteItem *> &notes, const QString &defaultName = "");
+    //取消当前导出，正在写入的文件完成后结束
+    void cancel();
+    //是否正在导出
+    bool isExporting() const;
+
+signals:
+    //导出进度
+    void exportProgress(int finished, int total);
+    //导出完成，state参考ExportNoteWorker::ExportError
+    void exportFinished(int state);
+
+protected slots:
+    //导出线程全部结束
+    void onExportFinished(int state);
+
+private:
+    QThreadPool m_exportPool;
+    QSharedPointer<VNoteExportContext> m_context;
+};
+
+#endif // VNOTEEXPORTENGINE_H
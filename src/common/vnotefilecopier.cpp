@@ -0,0 +1,318 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnotefilecopier.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QDebug>
+
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+
+//glibc 2.27开始提供copy_file_range
+#if defined(__GLIBC__)
+#if __GLIBC_PREREQ(2, 27)
+#define VNOTE_HAVE_COPY_FILE_RANGE
+#endif
+#endif
+
+QMutex VNoteFileCopier::m_statisticsLock;
+VNoteFileCopier::Statistics VNoteFileCopier::m_statistics[VNoteFileCopier::MethodCount];
+
+/**
+ * @brief VNoteFileCopier::copy
+ * 依次尝试各复制方式，一种方式不可用时由下一种方式从已复制的位置继续
+ * @param source 源文件
+ * @param target 目标文件，不能已存在
+ * @param usedMethod 最后使用的复制方式
+ * @return true 复制成功
+ */
+bool VNoteFileCopier::copy(const QString &source, const QString &target, Method *usedMethod)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    int sourceFd = ::open(QFile::encodeName(source).constData(), O_RDONLY | O_CLOEXEC);
+    if (sourceFd < 0) {
+        qWarning() << "open copy source failed:" << source << strerror(errno);
+        return false;
+    }
+
+    struct stat sourceStat;
+    if (::fstat(sourceFd, &sourceStat) != 0 || !S_ISREG(sourceStat.st_mode)) {
+        qWarning() << "copy source is not a regular file:" << source;
+        ::close(sourceFd);
+        return false;
+    }
+
+    mode_t mode = sourceStat.st_mode & 0777;
+    int targetFd = ::open(QFile::encodeName(target).constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+    if (targetFd < 0) {
+        qWarning() << "open copy target failed:" << target << strerror(errno);
+        ::close(sourceFd);
+        return false;
+    }
+
+    qint64 size = sourceStat.st_size;
+    qint64 copied = 0;
+    Method method = Reflink;
+    CopyResult result = CopyUnsupported;
+
+    //大小为0的文件可能是/proc等虚拟文件，内容只能读取
+    if (size > 0) {
+        result = copyReflink(sourceFd, targetFd);
+        if (CopyDone == result) {
+            copied = size;
+        }
+        if (CopyUnsupported == result) {
+            method = CopyFileRange;
+            result = copyFileRange(sourceFd, targetFd, size, copied);
+        }
+        if (CopyUnsupported == result) {
+            method = SendFile;
+            result = copySendFile(sourceFd, targetFd, size, copied);
+        }
+    }
+    if (CopyUnsupported == result) {
+        method = Buffered;
+        result = copyBuffered(sourceFd, targetFd, copied);
+    }
+
+    //umask可能去掉部分权限，与QFile::copy一致使用源文件的权限
+    bool ok = CopyDone == result && ::fchmod(targetFd, mode) == 0;
+    if (!ok) {
+        qWarning() << "copy file failed:" << source << target << methodName(method) << strerror(errno);
+    }
+
+    if (::close(targetFd) != 0) {
+        ok = false;
+    }
+    ::close(sourceFd);
+
+    if (!ok) {
+        QFile::remove(target);
+        return false;
+    }
+
+    record(method, copied, timer.elapsed());
+    if (nullptr != usedMethod) {
+        *usedMethod = method;
+    }
+    return true;
+}
+
+/**
+ * @brief VNoteFileCopier::copyReflink
+ * 目标文件与源文件共享数据块，只在同一个支持reflink的文件系统(btrfs、xfs等)上可用
+ * @param sourceFd 源文件
+ * @param targetFd 目标文件
+ * @return 复制结果，失败时目标文件不变
+ */
+VNoteFileCopier::CopyResult VNoteFileCopier::copyReflink(int sourceFd, int targetFd)
+{
+#ifdef FICLONE
+    if (::ioctl(targetFd, FICLONE, sourceFd) == 0) {
+        return CopyDone;
+    }
+#else
+    Q_UNUSED(sourceFd);
+    Q_UNUSED(targetFd);
+#endif
+    return CopyUnsupported;
+}
+
+/**
+ * @brief VNoteFileCopier::copyFileRange
+ * @param sourceFd 源文件
+ * @param targetFd 目标文件
+ * @param size 源文件大小
+ * @param copied 已复制的大小
+ * @return 复制结果
+ */
+VNoteFileCopier::CopyResult VNoteFileCopier::copyFileRange(int sourceFd, int targetFd, qint64 size, qint64 &copied)
+{
+#ifdef VNOTE_HAVE_COPY_FILE_RANGE
+    while (copied < size) {
+        loff_t sourceOffset = copied;
+        loff_t targetOffset = copied;
+        ssize_t count = ::copy_file_range(sourceFd, &sourceOffset, targetFd, &targetOffset,
+                                          static_cast<size_t>(size - copied), 0);
+        if (count > 0) {
+            copied += count;
+        } else if (count < 0 && EINTR == errno) {
+            continue;
+        } else if (count == 0 || ENOSYS == errno || EXDEV == errno || EINVAL == errno
+                   || EOPNOTSUPP == errno || EBADF == errno) {
+            //不支持或文件在复制过程中变小，由下一种方式继续
+            return CopyUnsupported;
+        } else {
+            return CopyError;
+        }
+    }
+    return CopyDone;
+#else
+    Q_UNUSED(sourceFd);
+    Q_UNUSED(targetFd);
+    Q_UNUSED(size);
+    Q_UNUSED(copied);
+    return CopyUnsupported;
+#endif
+}
+
+/**
+ * @brief VNoteFileCopier::copySendFile
+ * @param sourceFd 源文件
+ * @param targetFd 目标文件
+ * @param size 源文件大小
+ * @param copied 已复制的大小
+ * @return 复制结果
+ */
+VNoteFileCopier::CopyResult VNoteFileCopier::copySendFile(int sourceFd, int targetFd, qint64 size, qint64 &copied)
+{
+    //sendfile写入目标文件的当前位置
+    if (::lseek(targetFd, copied, SEEK_SET) < 0) {
+        return CopyError;
+    }
+
+    while (copied < size) {
+        off_t sourceOffset = copied;
+        ssize_t count = ::sendfile(targetFd, sourceFd, &sourceOffset, static_cast<size_t>(size - copied));
+        if (count > 0) {
+            copied += count;
+        } else if (count < 0 && EINTR == errno) {
+            continue;
+        } else if (count == 0 || ENOSYS == errno || EINVAL == errno) {
+            return CopyUnsupported;
+        } else {
+            return CopyError;
+        }
+    }
+    return CopyDone;
+}
+
+/**
+ * @brief VNoteFileCopier::copyBuffered
+ * 读取到文件结束，复制后通知内核不再缓存源文件，避免大文件挤占页缓存
+ * @param sourceFd 源文件
+ * @param targetFd 目标文件
+ * @param copied 已复制的大小
+ * @return 复制结果
+ */
+VNoteFileCopier::CopyResult VNoteFileCopier::copyBuffered(int sourceFd, int targetFd, qint64 &copied)
+{
+    if (::lseek(targetFd, copied, SEEK_SET) < 0) {
+        return CopyError;
+    }
+
+    ::posix_fadvise(sourceFd, copied, 0, POSIX_FADV_SEQUENTIAL);
+
+    QByteArray buffer(BufferSize, Qt::Uninitialized);
+    CopyResult result = CopyDone;
+
+    for (;;) {
+        ssize_t count = ::pread(sourceFd, buffer.data(), static_cast<size_t>(buffer.size()), copied);
+        if (count < 0 && EINTR == errno) {
+            continue;
+        }
+        if (count <= 0) {
+            result = count == 0 ? CopyDone : CopyError;
+            break;
+        }
+
+        const char *data = buffer.constData();
+        ssize_t remaining = count;
+        while (remaining > 0) {
+            ssize_t written = ::write(targetFd, data, static_cast<size_t>(remaining));
+            if (written < 0 && EINTR == errno) {
+                continue;
+            }
+            if (written <= 0) {
+                return CopyError;
+            }
+            data += written;
+            remaining -= written;
+        }
+        copied += count;
+    }
+
+    ::posix_fadvise(sourceFd, 0, 0, POSIX_FADV_DONTNEED);
+    return result;
+}
+
+/**
+ * @brief VNoteFileCopier::record
+ * @param method 复制方式
+ * @param size 复制的大小
+ * @param elapsed 耗时，单位:毫秒
+ */
+void VNoteFileCopier::record(Method method, qint64 size, qint64 elapsed)
+{
+    {
+        QMutexLocker locker(&m_statisticsLock);
+        Statistics &stat = m_statistics[method];
+        stat.count++;
+        stat.totalSize += size;
+        stat.totalTime += elapsed;
+    }
+
+    //吞吐量，单位:MB/s
+    double throughput = static_cast<double>(size) / (1024 * 1024) / (qMax<qint64>(elapsed, 1) / 1000.0);
+    qInfo() << "copy file:" << methodName(method) << "size:" << size << "elapsed:" << elapsed << "ms"
+            << "throughput:" << QString::number(throughput, 'f', 1) << "MB/s";
+}
+
+/**
+ * @brief VNoteFileCopier::statistics
+ * @param method 复制方式
+ * @return 耗时统计
+ */
+VNoteFileCopier::Statistics VNoteFileCopier::statistics(Method method)
+{
+    QMutexLocker locker(&m_statisticsLock);
+    return method >= 0 && method < MethodCount ? m_statistics[method] : Statistics();
+}
+
+/**
+ * @brief VNoteFileCopier::methodName
+ * @param method 复制方式
+ * @return 名称
+ */
+const char *VNoteFileCopier::methodName(Method method)
+{
+    switch (method) {
+    case Reflink:
+        return "reflink";
+    case CopyFileRange:
+        return "copy_file_range";
+    case SendFile:
+        return "sendfile";
+    case Buffered:
+        return "buffered";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,85 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTEFILECOPIER_H
+#define VNOTEFILECOPIER_H
+
+#include <QString>
+#include <QMutex>
+
+//文件复制，优先由内核完成复制避免数据经过用户态：
+//同一文件系统支持时使用reflink共享数据块，其次copy_file_range/sendfile，都不可用时使用缓冲区读写
+//与QFile::copy相同，目标文件已存在时复制失败，复制后的文件权限与源文件相同
+class VNoteFileCopier
+{
+public:
+    //复制方式
+    enum Method {
+        Reflink, //FICLONE共享数据块，不复制数据
+        CopyFileRange, //copy_file_range，内核内复制，部分文件系统在服务端复制
+        SendFile, //sendfile，内核内复制
+        Buffered, //用户态缓冲区读写
+        MethodCount
+    };
+
+    enum {
+        BufferSize = 256 * 1024 //缓冲区读写每次的大小
+    };
+
+    //每种复制方式的耗时统计
+    struct Statistics {
+        int count {0}; //复制文件数
+        qint64 totalSize {0}; //复制的总大小
+        qint64 totalTime {0}; //总耗时，单位:毫秒
+    };
+
+    /**
+     * @brief 复制文件
+     * @param source 源文件
+     * @param target 目标文件，不能已存在
+     * @param usedMethod 最后使用的复制方式
+     * @return true 复制成功，失败时不留下目标文件
+     */
+    static bool copy(const QString &source, const QString &target, Method *usedMethod = nullptr);
+    //复制方式的统计
+    static Statistics statistics(Method method);
+    //复制方式名称
+    static const char *methodName(Method method);
+
+private:
+    //复制结果
+    enum CopyResult {
+        CopyDone, //复制完成
+        CopyUnsupported, //当前方式不可用，使用下一种方式从已复制的位置继续
+        CopyError //复制出错
+    };
+
+    static CopyResult copyReflink(int sourceFd, int targetFd);
+    static CopyResult copyFileRange(int sourceFd, int targetFd, qint64 size, qint64 &copied);
+    static CopyResult copySendFile(int sourceFd, int targetFd, qint64 size, qint64 &copied);
+    static CopyResult copyBuffered(int sourceFd, int targetFd, qint64 &copied);
+    //记录一次复制的耗时并输出吞吐量
+    static void record(Method method, qint64 size, qint64 elapsed);
+
+    static QMutex m_statisticsLock;
+    static Statistics m_statistics[MethodCount];
+};
+
+#endif // VNOTEFILECOPIER_H
@@ -0,0 +1,141 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnotehtmlwriter.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QImage>
+#include <QImageReader>
+#include <QDebug>
+
+/**
+ * @brief VNoteHtmlWriter::VNoteHtmlWriter
+ * @param device 输出设备，需已打开
+ */
+VNoteHtmlWriter::VNoteHtmlWriter(QIODevice *device)
+    : m_device(device)
+    , m_ok(nullptr != device && device->isWritable())
+{
+}
+
+/**
+ * @brief VNoteHtmlWriter::write
+ * @param text 文本
+ */
+void VNoteHtmlWriter::write(const QString &text)
+{
+    if (!m_ok || text.isEmpty()) {
+        return;
+    }
+
+    QByteArray data = text.toUtf8();
+    m_ok = m_device->write(data) == data.size();
+}
+
+/**
+ * @brief VNoteHtmlWriter::isImage
+ * 只读取文件头判断格式，不解码图片
+ * @param imagePath 图片路径
+ * @return true 可以写入
+ */
+bool VNoteHtmlWriter::isImage(const QString &imagePath)
+{
+    QImageReader reader(imagePath);
+    return reader.canRead() && reader.size().isValid();
+}
+
+/**
+ * @brief VNoteHtmlWriter::writeImage
+ * 宽度超过MaxImageWidth的图片解码时直接缩小后重新编码
+ * @param imagePath 图片路径
+ */
+void VNoteHtmlWriter::writeImage(const QString &imagePath)
+{
+    if (!m_ok) {
+        return;
+    }
+
+    QImageReader reader(imagePath);
+    QByteArray format = reader.format();
+    QSize size = reader.size();
+
+    if (size.width() <= MaxImageWidth) {
+        QFile file(imagePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "open image failed:" << imagePath;
+            return;
+        }
+        write(QString("data:image/%1;base64,").arg(QString::fromLatin1(format)));
+        writeBase64(&file);
+        return;
+    }
+
+    reader.setScaledSize(size.scaled(MaxImageWidth, size.height(), Qt::KeepAspectRatio));
+    QImage image = reader.read();
+    if (format != "jpeg") {
+        format = "png";
+    }
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, format.constData());
+    //已编码，尽早释放
+    image = QImage();
+
+    buffer.close();
+    buffer.open(QIODevice::ReadOnly);
+    write(QString("data:image/%1;base64,").arg(QString::fromLatin1(format)));
+    writeBase64(&buffer);
+}
+
+/**
+ * @brief VNoteHtmlWriter::isOk
+ * @return true 全部写入成功
+ */
+bool VNoteHtmlWriter::isOk() const
+{
+    return m_ok;
+}
+
+/**
+ * @brief VNoteHtmlWriter::writeBase64
+ * @param source 数据来源
+ */
+void VNoteHtmlWriter::writeBase64(QIODevice *source)
+{
+    while (m_ok && !source->atEnd()) {
+        QByteArray chunk = source->read(Base64ChunkSize);
+        //不足一块时继续读取，中间的块长度必须为3的倍数
+        while (chunk.size() < Base64ChunkSize && !source->atEnd()) {
+            QByteArray more = source->read(Base64ChunkSize - chunk.size());
+            if (more.isEmpty()) {
+                break;
+            }
+            chunk.append(more);
+        }
+        if (chunk.isEmpty()) {
+            break;
+        }
+        QByteArray encoded = chunk.toBase64();
+        m_ok = m_device->write(encoded) == encoded.size();
+    }
+}
@@ -0,0 +1,58 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTEHTMLWRITER_H
+#define VNOTEHTMLWRITER_H
+
+#include <QIODevice>
+#include <QString>
+
+//导出html时直接写入输出设备，图片按块编码为base64写入，内存占用与笔记大小无关
+class VNoteHtmlWriter
+{
+public:
+    enum {
+        Base64ChunkSize = 3 * 16384, //每次编码的图片数据，3的倍数保证分块编码结果可直接拼接
+        MaxImageWidth = 712 //导出图片的最大宽度
+    };
+
+    explicit VNoteHtmlWriter(QIODevice *device);
+
+    //写入文本
+    void write(const QString &text);
+    //图片是否可以写入
+    static bool isImage(const QString &imagePath);
+    /**
+     * @brief 写入图片的data协议url，宽度不超过MaxImageWidth的图片直接读取文件编码
+     * @param imagePath 图片路径
+     */
+    void writeImage(const QString &imagePath);
+    //是否全部写入成功
+    bool isOk() const;
+
+private:
+    //分块写入base64编码
+    void writeBase64(QIODevice *source);
+
+    QIODevice *m_device {nullptr};
+    bool m_ok {true};
+};
+
+#endif // VNOTEHTMLWRITER_H
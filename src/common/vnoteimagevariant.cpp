@@ -0,0 +1,187 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnoteimagevariant.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+/**
+ * @brief VNoteImageVariant::imageDir
+ * @return 笔记图片目录
+ */
+QString VNoteImageVariant::imageDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/images";
+}
+
+/**
+ * @brief VNoteImageVariant::isNoteImage
+ * @param original 原图路径
+ * @return true 图片在笔记图片目录中
+ */
+bool VNoteImageVariant::isNoteImage(const QString &original)
+{
+    QFileInfo fileInfo(original);
+    return fileInfo.isFile() && fileInfo.absolutePath() == QFileInfo(imageDir()).absoluteFilePath();
+}
+
+/**
+ * @brief VNoteImageVariant::variantPath
+ * @param original 原图路径
+ * @param variant 副本类型
+ * @return 副本路径
+ */
+QString VNoteImageVariant::variantPath(const QString &original, Variant variant)
+{
+    QFileInfo fileInfo(original);
+    switch (variant) {
+    case Display:
+        return fileInfo.absolutePath() + "/display/" + fileInfo.fileName();
+    case Thumbnail:
+        return fileInfo.absolutePath() + "/thumb/" + fileInfo.fileName();
+    default:
+        break;
+    }
+    return original;
+}
+
+/**
+ * @brief VNoteImageVariant::bestPath
+ * @param original 原图路径
+ * @param variant 需要的副本类型
+ * @return 存在的图片路径
+ */
+QString VNoteImageVariant::bestPath(const QString &original, Variant variant)
+{
+    for (int i = variant; i > Original; i--) {
+        QString path = variantPath(original, static_cast<Variant>(i));
+        if (QFile::exists(path)) {
+            return path;
+        }
+    }
+    return original;
+}
+
+/**
+ * @brief VNoteImageVariant::pathForSize
+ * @param original 原图路径
+ * @param size 显示区域大小
+ * @return 满足显示区域的最小图片路径
+ */
+QString VNoteImageVariant::pathForSize(const QString &original, const QSize &size)
+{
+    int maxSide = qMax(size.width(), size.height());
+    if (maxSide <= ThumbnailSize) {
+        return bestPath(original, Thumbnail);
+    }
+    if (maxSide <= DisplaySize) {
+        return bestPath(original, Display);
+    }
+    return original;
+}
+
+/**
+ * @brief VNoteImageVariant::generate
+ * 按显示图尺寸解码一次原图，再缩放得到缩略图，副本写入完成后才替换目标文件
+ * @param original 原图路径
+ * @return true 生成成功
+ */
+bool VNoteImageVariant::generate(const QString &original)
+{
+    QImageReader reader(original);
+    reader.setAutoTransform(true);
+    QByteArray format = reader.format();
+    QSize size = reader.size();
+    if (!size.isValid()) {
+        qWarning() << "invalid image:" << original << reader.errorString();
+        return false;
+    }
+
+    bool large = qMax(size.width(), size.height()) > DisplaySize;
+    if (large) {
+        //jpeg等格式解码时直接缩小，不解码完整原图
+        reader.setScaledSize(size.scaled(DisplaySize, DisplaySize, Qt::KeepAspectRatio));
+    }
+
+    QImage image;
+    if (!reader.read(&image)) {
+        qWarning() << "read image failed:" << original << reader.errorString();
+        return false;
+    }
+
+    auto save = [&format](const QImage &img, const QString &path) {
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            return false;
+        }
+        int quality = (format == "jpeg" || format == "jpg") ? JpegQuality : -1;
+        if (!img.save(&file, format.constData(), quality)) {
+            file.cancelWriting();
+            return false;
+        }
+        return file.commit();
+    };
+
+    if (!large) {
+        //同名原图被覆盖时清除旧的显示图
+        QFile::remove(variantPath(original, Display));
+    } else if (!save(image, variantPath(original, Display))) {
+        qWarning() << "save display image failed:" << original;
+        return false;
+    }
+
+    QImage thumbnail = image;
+    if (qMax(image.width(), image.height()) > ThumbnailSize) {
+        thumbnail = image.scaled(ThumbnailSize, ThumbnailSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    if (!save(thumbnail, variantPath(original, Thumbnail))) {
+        qWarning() << "save thumbnail failed:" << original;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief VNoteImageVariant::hasVariants
+ * @param original 原图路径
+ * @return true 副本已生成
+ */
+bool VNoteImageVariant::hasVariants(const QString &original)
+{
+    return QFile::exists(variantPath(original, Thumbnail));
+}
+
+/**
+ * @brief VNoteImageVariant::removeVariants
+ * @param original 原图路径
+ */
+void VNoteImageVariant::removeVariants(const QString &original)
+{
+    QFile::remove(variantPath(original, Display));
+    QFile::remove(variantPath(original, Thumbnail));
+}
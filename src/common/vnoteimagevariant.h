@@ -0,0 +1,63 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTEIMAGEVARIANT_H
+#define VNOTEIMAGEVARIANT_H
+
+#include <QString>
+#include <QSize>
+
+//笔记图片的多尺寸副本，原图保存在images目录，显示图和缩略图保存在其下的display、thumb目录，文件名与原图相同
+//笔记html中只保存原图路径，编辑区、图片预览、导出按需要选择副本，副本不存在时使用原图
+class VNoteImageVariant
+{
+public:
+    enum Variant {
+        Original, //原图
+        Display, //编辑区显示及导出使用
+        Thumbnail //缩略图，图片加载过程中的占位
+    };
+
+    //副本最长边的像素数
+    enum {
+        DisplaySize = 1600,
+        ThumbnailSize = 256,
+        JpegQuality = 85
+    };
+
+    //笔记图片目录
+    static QString imageDir();
+    //是否是笔记图片目录中的图片
+    static bool isNoteImage(const QString &original);
+    //副本路径，不判断文件是否存在
+    static QString variantPath(const QString &original, Variant variant);
+    //存在的副本中最接近要求的一个，依次退回到更大的副本和原图
+    static QString bestPath(const QString &original, Variant variant);
+    //显示区域为size时使用的图片路径
+    static QString pathForSize(const QString &original, const QSize &size);
+    //生成副本，原图不大于显示图尺寸时不生成显示图，缩略图最后生成
+    static bool generate(const QString &original);
+    //副本是否已生成
+    static bool hasVariants(const QString &original);
+    //删除副本
+    static void removeVariants(const QString &original);
+};
+
+#endif // VNOTEIMAGEVARIANT_H
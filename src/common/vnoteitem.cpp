@@ -19,11 +19,14 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 #include "vnoteitem.h"
-#include "common/utils.h"
+#include "common/vnoteimagevariant.h"
+#include "common/vnoteattachmentstore.h"
+#include "common/vnotehtmlwriter.h"
 
 #include <DLog>
 #include <DGuiApplicationHelper>
 
+#include <QBuffer>
 #include <QFile>
 #include <QFileInfo>
 #include <QRegExp>
@@ -336,16 +339,33 @@ QStringList VNoteItem::getVoiceJsons() const
  */
 QString VNoteItem::getFullHtml() const
 {
-    //html字符串
-    QString html = htmlHead;
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    writeFullHtml(&buffer);
+    return QString::fromUtf8(data);
+}
+
+/**
+ * @brief VNoteItem::writeFullHtml
+ * 补全css样式，图片按块编码为base64后直接写入，不在内存中拼接完整html
+ * @param device 输出设备
+ * @return 写入成功返回true
+ */
+bool VNoteItem::writeFullHtml(QIODevice *device) const
+{
+    VNoteHtmlWriter writer(device);
+    //html头部
+    QString head = htmlHead;
 
     DPalette dp = DGuiApplicationHelper::instance()->applicationPalette();
     //获取系统高亮色
     QString activeHightColor = dp.color(DPalette::Active, DPalette::Highlight).name();
     //替换颜色
-    html.replace("#00a48a", activeHightColor);
+    head.replace("#00a48a", activeHightColor);
+    writer.write(head);
 
-    html.append("<body> <div class=\"note-editable\" contenteditable=\"false\">");
+    writer.write("<body> <div class=\"note-editable\" contenteditable=\"false\">");
     //匹配图片块标签的正则表达式
     QRegExp rx("<img.+src=.+>");
     rx.setMinimal(true); //最小匹配
@@ -354,33 +374,34 @@ QString VNoteItem::getFullHtml() const
     rxPath.setMinimal(false); //最大匹配
     int pos = 0;
     int last = 0;
-    //查找语音块
-    while ((last = rx.indexIn(htmlCode, pos)) != -1) {
-        html.append(htmlCode.mid(pos, last - pos));
+    //附件url转换为本地路径后再转换为base64编码
+    QString noteHtml = VNoteAttachmentStore::resolveUrls(htmlCode);
+    //查找图片块
+    while (writer.isOk() && (last = rx.indexIn(noteHtml, pos)) != -1) {
+        writer.write(noteHtml.mid(pos, last - pos));
         pos = last;
         //图片标签
         QString imgLabel = rx.cap(0);
-        if ((last = rxPath.indexIn(imgLabel)) == -1) {
-            //不存在路径
-            html.append(imgLabel);
+        //导出使用显示图，没有显示图时使用原图
+        QString imagePath;
+        if ((last = rxPath.indexIn(imgLabel)) != -1) {
+            imagePath = VNoteImageVariant::bestPath(rxPath.cap(0), VNoteImageVariant::Display);
+        }
+        if (imagePath.isEmpty() || !VNoteHtmlWriter::isImage(imagePath)) {
+            //不存在路径或无效图片路径
+            writer.write(imgLabel);
         } else {
-            //转换图片
-            QString base64 = "";
-            if (!Utils::pictureToBase64(rxPath.cap(0), base64)) {
-                //无效图片路径
-                html.append(imgLabel);
-            } else {
-                //图片路径转换为base64编码
-                html.append(imgLabel.mid(0, last))
-                    .append(base64)
-                    .append(imgLabel.mid(last + rxPath.matchedLength(), imgLabel.size() - last - rxPath.matchedLength()));
-            }
+            //图片路径替换为base64编码
+            writer.write(imgLabel.left(last));
+            writer.writeImage(imagePath);
+            writer.write(imgLabel.mid(last + rxPath.matchedLength()));
         }
         pos += rx.matchedLength();
     }
     //html文件添加尾部
-    html.append(htmlCode.mid(pos, htmlCode.size() - pos)).append("</div> </body> </html>");
-    return html;
+    writer.write(noteHtml.mid(pos));
+    writer.write("</div> </body> </html>");
+    return writer.isOk();
 }
 
 QDebug &operator<<(QDebug &out, VNoteItem &noteItem)
@@ -34,6 +34,7 @@ DWIDGET_USE_NAMESPACE
 
 struct VNoteBlock;
 struct VNoteFolder;
+class QIODevice;
 
 struct VNoteItem {
 public:
@@ -113,6 +114,8 @@ public:
     QStringList getVoiceJsons() const;
     //获取html
     QString getFullHtml() const;
+    //html直接写入输出设备
+    bool writeFullHtml(QIODevice *device) const;
 
 protected:
     QVariant metaData;
@@ -0,0 +1,294 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnotelibraryarchive.h"
+#include "common/vnoteitem.h"
+#include "common/vnoteattachmentstore.h"
+#include "db/vnoteattachmentoper.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QFileInfo>
+#include <QDebug>
+
+namespace {
+const QString JsonVersion = "version";
+const QString JsonFolders = "folders";
+const QString JsonId = "id";
+const QString JsonName = "name";
+const QString JsonIcon = "icon";
+const QString JsonFolderId = "folderId";
+const QString JsonNoteId = "noteId";
+const QString JsonType = "type";
+const QString JsonTitle = "title";
+const QString JsonTop = "isTop";
+const QString JsonCreateTime = "createTime";
+const QString JsonModifyTime = "modifyTime";
+const QString JsonMetaData = "metaData";
+const QString ImageDir = "images";
+const QString VoiceDir = "voicenote";
+} // namespace
+
+/**
+ * @brief VNoteLibraryData::~VNoteLibraryData
+ */
+VNoteLibraryData::~VNoteLibraryData()
+{
+    qDeleteAll(notes);
+}
+
+/**
+ * @brief VNoteLibraryArchive::makeManifest
+ * @param folders 导出的记事本
+ * @return manifest.json内容
+ */
+QByteArray VNoteLibraryArchive::makeManifest(const QVector<VNoteLibraryFolder> &folders)
+{
+    QJsonArray folderArray;
+    for (auto &folder : folders) {
+        QJsonObject folderObject;
+        folderObject.insert(JsonId, QString::number(folder.id));
+        folderObject.insert(JsonName, folder.name);
+        folderObject.insert(JsonIcon, folder.defaultIcon);
+        folderObject.insert(JsonCreateTime, folder.createTime.toString(Qt::ISODateWithMs));
+        folderObject.insert(JsonModifyTime, folder.modifyTime.toString(Qt::ISODateWithMs));
+        folderArray.append(folderObject);
+    }
+
+    QJsonObject manifest;
+    manifest.insert(JsonVersion, FormatVersion);
+    manifest.insert(JsonFolders, folderArray);
+    return QJsonDocument(manifest).toJson(QJsonDocument::Compact);
+}
+
+/**
+ * @brief VNoteLibraryArchive::parseManifest
+ * @param data manifest.json内容
+ * @param folders 记事本列表
+ * @return true 成功
+ */
+bool VNoteLibraryArchive::parseManifest(const QByteArray &data, QVector<VNoteLibraryFolder> &folders)
+{
+    QJsonObject manifest = QJsonDocument::fromJson(data).object();
+    int version = manifest.value(JsonVersion).toInt();
+    if (version <= 0 || version > FormatVersion) {
+        qWarning() << "library archive version not supported:" << version;
+        return false;
+    }
+
+    for (auto value : manifest.value(JsonFolders).toArray()) {
+        QJsonObject folderObject = value.toObject();
+        VNoteLibraryFolder folder;
+        bool idOk = false;
+        folder.id = folderObject.value(JsonId).toString().toLongLong(&idOk);
+        folder.name = folderObject.value(JsonName).toString();
+        folder.defaultIcon = folderObject.value(JsonIcon).toInt();
+        folder.createTime = QDateTime::fromString(folderObject.value(JsonCreateTime).toString(), Qt::ISODateWithMs);
+        folder.modifyTime = QDateTime::fromString(folderObject.value(JsonModifyTime).toString(), Qt::ISODateWithMs);
+        if (idOk && !folder.name.isEmpty()) {
+            folders.append(folder);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief VNoteLibraryArchive::noteEntryName
+ * @param note 笔记
+ * @return notes/<记事本id>-<笔记id>.json
+ */
+QString VNoteLibraryArchive::noteEntryName(const VNoteItem *note)
+{
+    return QString("%1%2-%3.json").arg(NotePrefix).arg(note->folderId).arg(note->noteId);
+}
+
+/**
+ * @brief VNoteLibraryArchive::makeNote
+ * 加密的笔记在内存中已解密，归档中保存明文
+ * @param note 笔记
+ * @return 条目内容
+ */
+QByteArray VNoteLibraryArchive::makeNote(const VNoteItem *note)
+{
+    QJsonObject noteObject;
+    noteObject.insert(JsonFolderId, QString::number(note->folderId));
+    noteObject.insert(JsonNoteId, note->noteId);
+    noteObject.insert(JsonType, note->noteType);
+    noteObject.insert(JsonTitle, note->noteTitle);
+    noteObject.insert(JsonTop, note->isTop);
+    noteObject.insert(JsonCreateTime, note->createTime.toString(Qt::ISODateWithMs));
+    noteObject.insert(JsonModifyTime, note->modifyTime.toString(Qt::ISODateWithMs));
+    noteObject.insert(JsonMetaData, note->metaDataConstRef().toString());
+    return QJsonDocument(noteObject).toJson(QJsonDocument::Compact);
+}
+
+/**
+ * @brief VNoteLibraryArchive::parseNote
+ * @param note 笔记
+ * @return true 成功
+ */
+bool VNoteLibraryArchive::parseNote(VNoteLibraryNote *note)
+{
+    QJsonParseError error;
+    QJsonObject noteObject = QJsonDocument::fromJson(note->json, &error).object();
+    note->json.clear();
+
+    if (QJsonParseError::NoError != error.error) {
+        qWarning() << "parse archive note failed:" << error.errorString();
+        note->valid = false;
+        return false;
+    }
+
+    bool idOk = false;
+    note->folderId = noteObject.value(JsonFolderId).toString().toLongLong(&idOk);
+    note->noteType = noteObject.value(JsonType).toInt();
+    note->title = noteObject.value(JsonTitle).toString();
+    note->isTop = noteObject.value(JsonTop).toInt();
+    note->createTime = QDateTime::fromString(noteObject.value(JsonCreateTime).toString(), Qt::ISODateWithMs);
+    note->modifyTime = QDateTime::fromString(noteObject.value(JsonModifyTime).toString(), Qt::ISODateWithMs);
+    note->metaData = relocateAttachments(noteObject.value(JsonMetaData).toString());
+    note->hashes = VNoteAttachmentOper::attachmentHashes(note->metaData);
+
+    if (!note->createTime.isValid()) {
+        note->createTime = QDateTime::currentDateTime();
+    }
+    if (!note->modifyTime.isValid()) {
+        note->modifyTime = note->createTime;
+    }
+
+    note->valid = idOk && !note->title.isEmpty();
+    return note->valid;
+}
+
+/**
+ * @brief VNoteLibraryArchive::attachmentEntryName
+ * @param attachment 附件
+ * @return attachments/<images|voicenote>/<哈希文件名>
+ */
+QString VNoteLibraryArchive::attachmentEntryName(const VNoteAttachment &attachment)
+{
+    return QString("%1%2/%3").arg(AttachmentPrefix).arg(VNoteAttachment::Voice == attachment.type ? VoiceDir : ImageDir).arg(attachment.fileName);
+}
+
+/**
+ * @brief VNoteLibraryArchive::parseAttachmentEntry
+ * 只接受哈希命名的文件，避免归档中的条目名称写到附件目录以外
+ * @param name 条目名称
+ * @param type 附件类型
+ * @param fileName 附件文件名
+ * @return true 附件条目
+ */
+bool VNoteLibraryArchive::parseAttachmentEntry(const QString &name, VNoteAttachment::Type &type, QString &fileName)
+{
+    if (!name.startsWith(AttachmentPrefix)) {
+        return false;
+    }
+
+    QStringList parts = name.mid(static_cast<int>(qstrlen(AttachmentPrefix))).split('/');
+    if (parts.size() != 2 || !VNoteAttachmentStore::isStoreFileName(parts.at(1))) {
+        return false;
+    }
+
+    if (parts.at(0) == ImageDir) {
+        type = VNoteAttachment::Image;
+    } else if (parts.at(0) == VoiceDir) {
+        type = VNoteAttachment::Voice;
+    } else {
+        return false;
+    }
+
+    fileName = parts.at(1);
+    return true;
+}
+
+/**
+ * @brief VNoteLibraryArchive::hashLegacyAttachments
+ * 旧版本的图片以时间命名，语音使用录音时的文件名，不在附件仓库中，
+ * 导出时按内容哈希命名写入归档，导入时与其他附件一样替换为本机附件目录
+ * @param content 笔记内容
+ * @param files 哈希命名的附件路径与本地旧文件的对应关系
+ * @return 本机附件目录中的旧文件路径替换为哈希命名路径后的内容
+ */
+QString VNoteLibraryArchive::hashLegacyAttachments(const QString &content, QMap<QString, QString> &files)
+{
+    static const QRegularExpression rx("(?:/[^/\"'\\s<>&;\\\\]+)*/(images|voicenote)/([\\w\\-]+\\.\\w+)");
+
+    QString result;
+    int pos = 0;
+    QRegularExpressionMatchIterator it = rx.globalMatch(content);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        if (VNoteAttachmentStore::isStoreFileName(match.captured(2))) {
+            continue;
+        }
+
+        //只处理本机附件目录中存在的文件
+        VNoteAttachment::Type type = match.captured(1) == VoiceDir ? VNoteAttachment::Voice : VNoteAttachment::Image;
+        QString dirPath = VNoteAttachmentStore::attachmentDir(type);
+        QFileInfo fileInfo(match.captured(0));
+        if (fileInfo.absolutePath() != QFileInfo(dirPath).absoluteFilePath() || !fileInfo.isFile()) {
+            continue;
+        }
+
+        QString hash = VNoteAttachmentStore::fileHash(fileInfo.absoluteFilePath());
+        if (hash.isEmpty()) {
+            continue;
+        }
+
+        QString hashPath = QString("%1/%2.%3").arg(dirPath).arg(hash).arg(fileInfo.suffix().toLower());
+        files.insert(hashPath, fileInfo.absoluteFilePath());
+        result.append(content.midRef(pos, match.capturedStart() - pos));
+        result.append(hashPath);
+        pos = match.capturedEnd();
+    }
+    if (0 == pos) {
+        return content;
+    }
+    result.append(content.midRef(pos));
+    return result;
+}
+
+/**
+ * @brief VNoteLibraryArchive::relocateAttachments
+ * 语音路径和旧版本的图片路径是绝对路径，附件url不含目录，不需要替换
+ * @param content 笔记内容
+ * @return 替换后的内容
+ */
+QString VNoteLibraryArchive::relocateAttachments(const QString &content)
+{
+    //路径在json和html属性中出现，不匹配引号、转义符和html实体
+    static const QRegularExpression rx("(?:/[^/\"'\\s<>&;\\\\]+)*/(images|voicenote)/([0-9a-f]{64}\\.\\w+)");
+
+    QString result;
+    int pos = 0;
+    QRegularExpressionMatchIterator it = rx.globalMatch(content);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        VNoteAttachment::Type type = match.captured(1) == VoiceDir ? VNoteAttachment::Voice : VNoteAttachment::Image;
+        result.append(content.midRef(pos, match.capturedStart() - pos));
+        result.append(VNoteAttachmentStore::attachmentDir(type) + "/" + match.captured(2));
+        pos = match.capturedEnd();
+    }
+    result.append(content.midRef(pos));
+    return result;
+}
@@ -0,0 +1,120 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTELIBRARYARCHIVE_H
+#define VNOTELIBRARYARCHIVE_H
+
+#include "common/datatypedef.h"
+
+#include <QDateTime>
+#include <QMap>
+#include <QStringList>
+#include <QVector>
+
+//归档中的记事本
+struct VNoteLibraryFolder {
+    //归档中的id
+    qint64 id {-1};
+    //导入后的id
+    qint64 newId {-1};
+    //图标索引
+    qint32 defaultIcon {0};
+    QString name;
+    QDateTime createTime;
+    QDateTime modifyTime;
+};
+
+//归档中的笔记
+struct VNoteLibraryNote {
+    //条目原始内容，解析后释放
+    QByteArray json;
+    //解析成功且内容有效
+    bool valid {false};
+    //归档中的记事本id
+    qint64 folderId {-1};
+    //导入后的记事本id和笔记id
+    qint64 newFolderId {-1};
+    qint32 newNoteId {-1};
+    qint32 noteType {0};
+    qint32 isTop {0};
+    QString title;
+    //笔记内容，附件路径已替换为本机附件目录
+    QString metaData;
+    QDateTime createTime;
+    QDateTime modifyTime;
+    //引用的附件哈希值
+    QStringList hashes;
+};
+
+//导入的记事本和笔记，笔记按归档中的顺序保存
+struct VNoteLibraryData {
+    ~VNoteLibraryData();
+
+    QVector<VNoteLibraryFolder> folders;
+    QVector<VNoteLibraryNote *> notes;
+};
+
+//记事本归档格式：
+//  manifest.json                       格式版本及记事本列表
+//  notes/<记事本id>-<笔记id>.json       笔记标题、时间及内容
+//  attachments/<images|voicenote>/<哈希文件名>  笔记引用的附件
+//附件按内容寻址，旧版本不在附件仓库中的附件导出时按内容哈希命名，
+//导入时重新存入附件仓库，笔记中的附件路径替换为本机附件目录
+class VNoteLibraryArchive
+{
+public:
+    enum {
+        FormatVersion = 1 //归档格式版本
+    };
+
+    static constexpr char const *ManifestName = "manifest.json";
+    static constexpr char const *NotePrefix = "notes/";
+    static constexpr char const *AttachmentPrefix = "attachments/";
+
+    //记事本列表
+    static QByteArray makeManifest(const QVector<VNoteLibraryFolder> &folders);
+    //解析记事本列表，版本不支持时返回false
+    static bool parseManifest(const QByteArray &data, QVector<VNoteLibraryFolder> &folders);
+    //笔记条目名称
+    static QString noteEntryName(const VNoteItem *note);
+    //笔记条目内容
+    static QByteArray makeNote(const VNoteItem *note);
+    /**
+     * @brief 解析笔记条目，可在多个线程中同时解析不同的笔记
+     * @param note json为条目内容，解析结果写入其他字段
+     * @return true 解析成功
+     */
+    static bool parseNote(VNoteLibraryNote *note);
+    //附件条目名称
+    static QString attachmentEntryName(const VNoteAttachment &attachment);
+    //解析附件条目名称，不是附件仓库中的文件时返回false
+    static bool parseAttachmentEntry(const QString &name, VNoteAttachment::Type &type, QString &fileName);
+    /**
+     * @brief 笔记内容中不在附件仓库中的旧附件路径替换为哈希命名的路径
+     * @param content 笔记内容
+     * @param files 哈希命名的附件路径与本地旧文件的对应关系，写入归档时读取旧文件
+     * @return 替换后的内容
+     */
+    static QString hashLegacyAttachments(const QString &content, QMap<QString, QString> &files);
+    //笔记内容中其他设备的附件路径替换为本机附件目录
+    static QString relocateAttachments(const QString &content);
+};
+
+#endif // VNOTELIBRARYARCHIVE_H
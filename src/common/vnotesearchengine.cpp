@@ -0,0 +1,452 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnotesearchengine.h"
+#include "common/vnotedatamanager.h"
+#include "db/vnoteitemoper.h"
+#include "db/vnotetranscriptoper.h"
+#include "common/vnotesearchranker.h"
+#include "common/vnoteitem.h"
+#include "common/vnotetitleindex.h"
+#include "common/vnotesearchquery.h"
+
+#include <QThread>
+#include <QDebug>
+
+/**
+ * @brief VNoteSearchEngine::VNoteSearchEngine
+ * @param parent
+ */
+VNoteSearchEngine::VNoteSearchEngine(QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<VNOTE_SEARCH_HITS>("VNOTE_SEARCH_HITS");
+
+    m_searchPool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+}
+
+/**
+ * @brief VNoteSearchEngine::~VNoteSearchEngine
+ */
+VNoteSearchEngine::~VNoteSearchEngine()
+{
+    cancel();
+    m_searchPool.waitForDone();
+}
+
+/**
+ * @brief VNoteSearchEngine::search
+ * 包含过滤条件时先在属性索引中求出候选笔记，只在候选中匹配关键字
+ * @param key 搜索框内容
+ * @return 本次搜索id
+ */
+quint64 VNoteSearchEngine::search(const QString &key)
+{
+    cancel();
+    removeInvalidCache();
+
+    VNoteSearchQuery query = VNoteSearchQuery::parse(key);
+    QString keyword = query.keyword();
+
+    m_context.reset(new VNoteSearchContext);
+    m_context->queryId = ++m_queryId;
+    m_context->key = keyword;
+    m_context->averageLength = m_averageLength;
+    m_query = key;
+    m_filtered = query.hasFilters();
+    m_resultCount = 0;
+    m_resultHits.clear();
+    m_dataVersion = VNoteDataManager::instance()->dataVersion();
+    m_searching = true;
+    m_completed = false;
+
+    //转写分段保存在数据库中，每次搜索重新查询命中位置
+    VNOTE_SEARCH_HITS transcriptHits;
+    if (!keyword.isEmpty()) {
+        transcriptHits = searchTranscripts(keyword);
+    }
+
+    //关键字回退到搜索过的内容，直接返回缓存结果
+    int cacheIndex = findCache(key);
+    if (-1 != cacheIndex) {
+        m_cache.move(cacheIndex, m_cache.size() - 1);
+        onSearchBatch(m_queryId, m_cache.last().hits);
+        onSearchFinished(m_queryId);
+        return m_queryId;
+    }
+
+    //标题拼音和模糊匹配从索引中查询，不再逐个转换标题
+    QHash<qint64, qint64> titleHits;
+    if (!keyword.isEmpty()) {
+        titleHits = VNoteTitleIndex::instance()->search(VNoteTitleIndex::NoteTitle, keyword);
+    }
+    for (auto it = titleHits.constBegin(); it != titleHits.constEnd(); ++it) {
+        m_context->titleIndexHits.insert(it.key());
+    }
+
+    if (m_filtered) {
+        //过滤条件编译为索引查询，候选笔记即为满足条件的全部笔记
+        m_context->narrowing = true;
+        VNOTE_SEARCH_HITS candidates = query.execute();
+
+        QSet<qint64> candidateIds;
+        for (auto &candidate : candidates) {
+            candidateIds.insert(candidate.noteId);
+        }
+
+        for (auto it = transcriptHits.begin(); it != transcriptHits.end();) {
+            if (!candidateIds.contains(it->noteId)) {
+                it = transcriptHits.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        m_context->docs = collectDocs(&candidates);
+    } else if (-1 != (cacheIndex = findNarrowingCache(key))) {
+        //关键字在搜索过的内容上扩展，只需在缓存结果中查找
+        m_context->narrowing = true;
+        VNOTE_SEARCH_HITS candidates = m_cache.at(cacheIndex).hits;
+
+        //模糊匹配不满足关键字包含关系，索引命中但不在缓存结果中的笔记需加入候选
+        QSet<qint64> candidateIds;
+        for (auto &candidate : candidates) {
+            candidateIds.insert(candidate.noteId);
+        }
+        for (auto it = titleHits.constBegin(); it != titleHits.constEnd(); ++it) {
+            if (!candidateIds.contains(it.key())) {
+                VNoteSearchHit hit;
+                hit.folderId = it.value();
+                hit.noteId = it.key();
+                candidates.append(hit);
+            }
+        }
+        m_context->docs = collectDocs(&candidates);
+    } else {
+        m_context->docs = collectDocs(nullptr);
+    }
+
+    if (!transcriptHits.isEmpty()) {
+        for (auto &hit : transcriptHits) {
+            m_context->matchedNoteIds.insert(hit.noteId);
+        }
+        onSearchBatch(m_queryId, transcriptHits);
+    }
+
+    //线程数不超过任务数量，至少一个线程负责发送完成信号
+    int taskCount = (m_context->docs.size() + SearchNoteWorker::DocChunkSize - 1) / SearchNoteWorker::DocChunkSize;
+    int workerCount = qBound(1, taskCount, m_searchPool.maxThreadCount());
+    m_context->runningWorkers.storeRelease(workerCount);
+
+    for (int i = 0; i < workerCount; i++) {
+        SearchNoteWorker *worker = new SearchNoteWorker(m_context);
+        worker->setAutoDelete(true);
+        worker->setObjectName("SearchNoteWorker");
+
+        connect(worker, &SearchNoteWorker::searchBatch,
+                this, &VNoteSearchEngine::onSearchBatch, Qt::QueuedConnection);
+        connect(worker, &SearchNoteWorker::searchFinished,
+                this, &VNoteSearchEngine::onSearchFinished, Qt::QueuedConnection);
+
+        m_searchPool.start(worker);
+    }
+
+    return m_queryId;
+}
+
+/**
+ * @brief VNoteSearchEngine::cancel
+ * 取消当前搜索，已发出但未处理的结果会因搜索id不匹配而丢弃
+ */
+void VNoteSearchEngine::cancel()
+{
+    if (!m_context.isNull()) {
+        m_context->cancelled.storeRelease(1);
+    }
+
+    m_searching = false;
+}
+
+/**
+ * @brief VNoteSearchEngine::currentQueryId
+ * @return 当前搜索id
+ */
+quint64 VNoteSearchEngine::currentQueryId() const
+{
+    return m_queryId;
+}
+
+/**
+ * @brief VNoteSearchEngine::isSearching
+ * @return true 正在搜索
+ */
+bool VNoteSearchEngine::isSearching() const
+{
+    return m_searching;
+}
+
+/**
+ * @brief VNoteSearchEngine::isCompleted
+ * @return true 最近一次搜索完整结束
+ */
+bool VNoteSearchEngine::isCompleted() const
+{
+    return m_completed;
+}
+
+/**
+ * @brief VNoteSearchEngine::onSearchBatch
+ * @param queryId 搜索id
+ * @param hits 命中的笔记
+ */
+void VNoteSearchEngine::onSearchBatch(quint64 queryId, const VNOTE_SEARCH_HITS &hits)
+{
+    if (queryId != m_queryId || !m_searching) {
+        return;
+    }
+
+    //结果返回前笔记可能已被删除，需重新获取
+    QList<VNoteItem *> notes;
+    VNOTE_SEARCH_HITS validHits;
+    VNoteItemOper noteOper;
+    for (auto &hit : hits) {
+        VNoteItem *note = noteOper.getNote(hit.folderId, static_cast<qint32>(hit.noteId));
+        if (nullptr != note) {
+            notes.append(note);
+            validHits.append(hit);
+        }
+    }
+
+    if (!notes.isEmpty()) {
+        m_resultCount += notes.size();
+        m_resultHits.append(validHits);
+        emit searchResultReady(queryId, notes, validHits);
+    }
+}
+
+/**
+ * @brief VNoteSearchEngine::onSearchFinished
+ * @param queryId 搜索id
+ */
+void VNoteSearchEngine::onSearchFinished(quint64 queryId)
+{
+    if (queryId != m_queryId || !m_searching) {
+        return;
+    }
+
+    m_searching = false;
+    m_completed = true;
+    saveCache(m_query, m_filtered, m_resultHits);
+
+    //完整搜索后更新文档平均长度，下次搜索排序使用
+    int docCount = m_context->docCount.loadAcquire();
+    if (!m_context->narrowing && docCount > 0) {
+        m_averageLength = static_cast<qreal>(m_context->totalLength.loadAcquire()) / docCount;
+    }
+    emit searchFinished(queryId, m_resultCount);
+}
+
+/**
+ * @brief VNoteSearchEngine::clearCache
+ */
+void VNoteSearchEngine::clearCache()
+{
+    m_cache.clear();
+}
+
+/**
+ * @brief VNoteSearchEngine::transcriptOffset
+ * @param voicePath 语音路径
+ * @return 命中位置，未命中返回-1
+ */
+qint64 VNoteSearchEngine::transcriptOffset(const QString &voicePath) const
+{
+    return m_transcriptOffsets.value(voicePath, -1);
+}
+
+/**
+ * @brief VNoteSearchEngine::findCache
+ * @param key 搜索关键字
+ * @return 缓存位置
+ */
+int VNoteSearchEngine::findCache(const QString &key) const
+{
+    for (int i = 0; i < m_cache.size(); i++) {
+        if (0 == m_cache.at(i).key.compare(key, Qt::CaseInsensitive)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief VNoteSearchEngine::findNarrowingCache
+ * 包含缓存关键字的笔记一定包含在缓存结果中，带过滤条件的缓存不满足包含关系
+ * @param key 搜索关键字
+ * @return 缓存位置
+ */
+int VNoteSearchEngine::findNarrowingCache(const QString &key) const
+{
+    int index = -1;
+    int keyLength = 0;
+
+    for (int i = 0; i < m_cache.size(); i++) {
+        const QString &cacheKey = m_cache.at(i).key;
+        if (!m_cache.at(i).filtered && cacheKey.length() > keyLength && key.contains(cacheKey, Qt::CaseInsensitive)) {
+            index = i;
+            keyLength = cacheKey.length();
+        }
+    }
+
+    return index;
+}
+
+/**
+ * @brief VNoteSearchEngine::removeInvalidCache
+ */
+void VNoteSearchEngine::removeInvalidCache()
+{
+    int dataVersion = VNoteDataManager::instance()->dataVersion();
+
+    for (auto it = m_cache.begin(); it != m_cache.end();) {
+        if (it->dataVersion != dataVersion) {
+            it = m_cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * @brief VNoteSearchEngine::saveCache
+ * @param key 搜索框内容
+ * @param filtered 是否包含过滤条件
+ * @param hits 搜索结果
+ */
+void VNoteSearchEngine::saveCache(const QString &key, bool filtered, const VNOTE_SEARCH_HITS &hits)
+{
+    int index = findCache(key);
+    if (-1 != index) {
+        m_cache.removeAt(index);
+    }
+
+    SearchCache cache;
+    cache.key = key;
+    cache.filtered = filtered;
+    cache.dataVersion = m_dataVersion;
+    cache.hits = hits;
+    m_cache.append(cache);
+
+    while (m_cache.size() > MaxCacheCount) {
+        m_cache.removeFirst();
+    }
+}
+
+/**
+ * @brief VNoteSearchEngine::collectDocs
+ * 在主线程中生成快照，搜索线程不直接读取可能正在被编辑的笔记
+ * @param candidates 候选笔记，为空时搜索所有笔记
+ * @return 笔记内容快照
+ */
+VNOTE_SEARCH_DOCS VNoteSearchEngine::collectDocs(const VNOTE_SEARCH_HITS *candidates) const
+{
+    VNOTE_SEARCH_DOCS docs;
+    VNOTE_ALL_NOTES_MAP *noteAll = VNoteDataManager::instance()->getAllNotesInFolder();
+    if (nullptr == noteAll) {
+        return docs;
+    }
+
+    noteAll->lock.lockForRead();
+
+    if (nullptr != candidates) {
+        docs.reserve(candidates->size());
+        for (auto &candidate : *candidates) {
+            VNOTE_ITEMS_MAP *folderNotes = noteAll->notes.value(candidate.folderId, nullptr);
+            if (nullptr == folderNotes) {
+                continue;
+            }
+
+            folderNotes->lock.lockForRead();
+            //上次搜索后笔记可能已被删除
+            VNoteItem *note = folderNotes->folderNotes.value(candidate.noteId, nullptr);
+            if (nullptr != note) {
+                docs.append(VNoteSearchRanker::makeDoc(note));
+            }
+            folderNotes->lock.unlock();
+        }
+    } else {
+        for (auto folderNotes : noteAll->notes) {
+            folderNotes->lock.lockForRead();
+            for (auto note : folderNotes->folderNotes) {
+                docs.append(VNoteSearchRanker::makeDoc(note));
+            }
+            folderNotes->lock.unlock();
+        }
+    }
+
+    noteAll->lock.unlock();
+
+    return docs;
+}
+
+/**
+ * @brief VNoteSearchEngine::searchTranscripts
+ * 笔记中删除语音后转写记录可能残留，需确认语音仍在笔记中
+ * @param key 搜索关键字
+ * @return 命中的笔记
+ */
+VNOTE_SEARCH_HITS VNoteSearchEngine::searchTranscripts(const QString &key)
+{
+    VNOTE_SEARCH_HITS hits;
+    QSet<qint64> noteIds;
+    VNoteItemOper noteOper;
+    VNoteTranscriptOper transcriptOper;
+
+    m_transcriptOffsets.clear();
+
+    //结果按语音和起始时间排序，每个语音第一条为最早命中位置
+    for (auto &transcript : transcriptOper.searchTranscripts(key)) {
+        if (m_transcriptOffsets.contains(transcript.voicePath)) {
+            continue;
+        }
+
+        VNoteItem *note = noteOper.getNote(transcript.folderId, static_cast<qint32>(transcript.noteId));
+        if (nullptr == note || !note->htmlCode.contains(transcript.voicePath)) {
+            continue;
+        }
+
+        m_transcriptOffsets.insert(transcript.voicePath, transcript.startTime);
+
+        if (!noteIds.contains(note->noteId)) {
+            noteIds.insert(note->noteId);
+            //在主线程中执行，只使用标题和命中的转写分段计算分值及摘要，不解析笔记内容
+            VNoteSearchHit hit;
+            hit.folderId = note->folderId;
+            hit.noteId = note->noteId;
+            hit.score = VNoteSearchRanker::score(note->noteTitle, transcript.text, key, m_averageLength);
+            hit.titleRanges = VNoteSearchRanker::findRanges(note->noteTitle, key);
+            hit.snippet = VNoteSearchRanker::makeSnippet(transcript.text, key, hit.snippetRanges);
+            hits.append(hit);
+        }
+    }
+
+    return hits;
+}
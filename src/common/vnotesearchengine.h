@@ -0,0 +1,117 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTESEARCHENGINE_H
+#define VNOTESEARCHENGINE_H
+
+#include "task/searchnoteworker.h"
+
+#include <QObject>
+#include <QThreadPool>
+#include <QMap>
+
+//笔记搜索引擎，多线程并行搜索，结果分批返回，新的搜索会取消正在进行的搜索
+//已完成的搜索结果会被缓存，关键字扩展时只在缓存结果中查找，关键字回退时直接返回缓存
+//语音转写命中的笔记在搜索开始时直接返回，并记录命中位置用于定位播放
+//搜索框中的结构化条件（folder:、has:、before:等）在属性索引中求出候选笔记
+class VNoteSearchEngine : public QObject
+{
+    Q_OBJECT
+public:
+    //最多缓存的搜索结果数
+    enum {
+        MaxCacheCount = 16
+    };
+
+    explicit VNoteSearchEngine(QObject *parent = nullptr);
+    ~VNoteSearchEngine() override;
+
+    //开始搜索，返回本次搜索id
+    quint64 search(const QString &key);
+    //取消当前搜索
+    void cancel();
+    //当前搜索id
+    quint64 currentQueryId() const;
+    //当前搜索是否正在进行
+    bool isSearching() const;
+    //最近一次搜索是否完整结束（未被取消）
+    bool isCompleted() const;
+    //清空缓存的搜索结果
+    void clearCache();
+    //当前搜索在语音转写中命中的位置，单位:毫秒，未命中返回-1
+    qint64 transcriptOffset(const QString &voicePath) const;
+
+signals:
+    //一批搜索结果，hits与notes一一对应
+    void searchResultReady(quint64 queryId, const QList<VNoteItem *> &notes, const VNOTE_SEARCH_HITS &hits);
+    //搜索完成
+    void searchFinished(quint64 queryId, int count);
+
+protected slots:
+    //搜索线程返回一批结果
+    void onSearchBatch(quint64 queryId, const VNOTE_SEARCH_HITS &hits);
+    //搜索线程全部结束
+    void onSearchFinished(quint64 queryId);
+
+private:
+    //缓存的搜索结果
+    struct SearchCache {
+        QString key;
+        //包含过滤条件
+        bool filtered {false};
+        int dataVersion {0};
+        VNOTE_SEARCH_HITS hits;
+    };
+
+    //查找关键字完全相同的缓存，没有返回-1
+    int findCache(const QString &key) const;
+    //查找关键字被包含的最长缓存，没有返回-1
+    int findNarrowingCache(const QString &key) const;
+    //移除数据已变化的缓存
+    void removeInvalidCache();
+    //保存搜索结果
+    void saveCache(const QString &key, bool filtered, const VNOTE_SEARCH_HITS &hits);
+    //生成待搜索笔记的内容快照
+    VNOTE_SEARCH_DOCS collectDocs(const VNOTE_SEARCH_HITS *candidates) const;
+    //查找语音转写命中的笔记，记录命中位置
+    VNOTE_SEARCH_HITS searchTranscripts(const QString &key);
+
+    QThreadPool m_searchPool;
+    QSharedPointer<VNoteSearchContext> m_context;
+    quint64 m_queryId {0};
+    //当前搜索框内容及是否包含过滤条件
+    QString m_query;
+    bool m_filtered {false};
+    int m_resultCount {0};
+    //搜索开始时的数据版本号
+    int m_dataVersion {0};
+    //最近一次完整搜索统计的文档平均长度
+    qreal m_averageLength {0};
+    bool m_searching {false};
+    bool m_completed {false};
+    //当前搜索已返回的结果
+    VNOTE_SEARCH_HITS m_resultHits;
+    //按使用时间排序，最近使用的在最后
+    QList<SearchCache> m_cache;
+    //语音路径对应的最早命中位置
+    QMap<QString, qint64> m_transcriptOffsets;
+};
+
+#endif // VNOTESEARCHENGINE_H
@@ -0,0 +1,238 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnotesearchquery.h"
+#include "common/vnotetitleindex.h"
+
+#include <QRegularExpression>
+
+/**
+ * @brief VNoteSearchQuery::parse
+ * 无法识别的条件按普通关键字处理
+ * @param text 搜索框内容
+ * @return 查询
+ */
+VNoteSearchQuery VNoteSearchQuery::parse(const QString &text)
+{
+    VNoteSearchQuery query;
+    QStringList keywords;
+
+    for (auto &token : tokenize(text)) {
+        //兼容中文冒号
+        int pos = token.indexOf(QRegularExpression("[:：]"));
+        if (pos > 0 && pos < token.length() - 1) {
+            QString value = token.mid(pos + 1);
+            if (value.length() > 1 && value.startsWith('"') && value.endsWith('"')) {
+                value = value.mid(1, value.length() - 2);
+            }
+
+            if (query.parseFilter(token.left(pos).toLower(), value)) {
+                continue;
+            }
+        }
+
+        if (token.length() > 1 && token.startsWith('"') && token.endsWith('"')) {
+            keywords.append(token.mid(1, token.length() - 2));
+        } else {
+            keywords.append(token);
+        }
+    }
+
+    query.m_keyword = keywords.join(' ');
+
+    return query;
+}
+
+/**
+ * @brief VNoteSearchQuery::keyword
+ * @return 搜索关键字
+ */
+QString VNoteSearchQuery::keyword() const
+{
+    return m_keyword;
+}
+
+/**
+ * @brief VNoteSearchQuery::hasFilters
+ * @return true 包含过滤条件
+ */
+bool VNoteSearchQuery::hasFilters() const
+{
+    return !m_folderNames.isEmpty() || m_hasVoice || m_hasImage
+           || -1 != m_pinned || m_after.isValid() || m_before.isValid();
+}
+
+/**
+ * @brief VNoteSearchQuery::compile
+ * 多个记事本条件取并集，其余条件取交集
+ * @return 属性索引查询条件
+ */
+VNoteAttributeIndex::Filter VNoteSearchQuery::compile() const
+{
+    VNoteAttributeIndex::Filter filter;
+
+    if (!m_folderNames.isEmpty()) {
+        filter.limitFolders = true;
+        for (auto &name : m_folderNames) {
+            QHash<qint64, qint64> folders = VNoteTitleIndex::instance()->search(VNoteTitleIndex::FolderName, name);
+            for (auto it = folders.constBegin(); it != folders.constEnd(); ++it) {
+                filter.folderIds.insert(it.key());
+            }
+        }
+    }
+
+    filter.hasVoice = m_hasVoice;
+    filter.hasImage = m_hasImage;
+    filter.pinned = m_pinned;
+
+    if (m_after.isValid()) {
+        filter.after = QDateTime(m_after);
+    }
+
+    if (m_before.isValid()) {
+        filter.before = QDateTime(m_before);
+    }
+
+    return filter;
+}
+
+/**
+ * @brief VNoteSearchQuery::execute
+ * @return 满足过滤条件的笔记
+ */
+VNOTE_SEARCH_HITS VNoteSearchQuery::execute() const
+{
+    return VNoteAttributeIndex::instance()->query(compile());
+}
+
+/**
+ * @brief VNoteSearchQuery::parseDate
+ * @param value 日期
+ * @param today 基准日期
+ * @return 日期，无法解析时无效
+ */
+QDate VNoteSearchQuery::parseDate(const QString &value, const QDate &today)
+{
+    QString lowerValue = value.toLower();
+
+    if (lowerValue == "today") {
+        return today;
+    }
+
+    if (lowerValue == "yesterday") {
+        return today.addDays(-1);
+    }
+
+    QRegularExpressionMatch match = QRegularExpression("^(\\d+)([dw])$").match(lowerValue);
+    if (match.hasMatch()) {
+        int count = match.captured(1).toInt();
+        return today.addDays(-count * (match.captured(2) == "w" ? 7 : 1));
+    }
+
+    QDate date = QDate::fromString(value, "yyyy-MM-dd");
+    if (!date.isValid()) {
+        date = QDate::fromString(value, "yyyy/MM/dd");
+    }
+
+    return date;
+}
+
+/**
+ * @brief VNoteSearchQuery::tokenize
+ * @param text 搜索框内容
+ * @return 拆分结果
+ */
+QStringList VNoteSearchQuery::tokenize(const QString &text)
+{
+    QStringList tokens;
+    QString token;
+    bool quoted = false;
+
+    for (auto ch : text) {
+        if (ch == '"') {
+            quoted = !quoted;
+        }
+
+        if (ch.isSpace() && !quoted) {
+            if (!token.isEmpty()) {
+                tokens.append(token);
+                token.clear();
+            }
+        } else {
+            token.append(ch);
+        }
+    }
+
+    if (!token.isEmpty()) {
+        tokens.append(token);
+    }
+
+    return tokens;
+}
+
+/**
+ * @brief VNoteSearchQuery::parseFilter
+ * @param name 条件名称（小写）
+ * @param value 条件值
+ * @return true 是有效条件
+ */
+bool VNoteSearchQuery::parseFilter(const QString &name, const QString &value)
+{
+    if (value.isEmpty()) {
+        return false;
+    }
+
+    QString lowerValue = value.toLower();
+
+    if (name == "folder") {
+        m_folderNames.append(value);
+    } else if (name == "has") {
+        if (lowerValue == "voice") {
+            m_hasVoice = true;
+        } else if (lowerValue == "image") {
+            m_hasImage = true;
+        } else {
+            return false;
+        }
+    } else if (name == "pinned") {
+        if (lowerValue == "yes" || lowerValue == "true") {
+            m_pinned = 1;
+        } else if (lowerValue == "no" || lowerValue == "false") {
+            m_pinned = 0;
+        } else {
+            return false;
+        }
+    } else if (name == "before" || name == "after") {
+        QDate date = parseDate(value);
+        if (!date.isValid()) {
+            return false;
+        }
+
+        if (name == "before") {
+            m_before = date;
+        } else {
+            m_after = date;
+        }
+    } else {
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,70 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTESEARCHQUERY_H
+#define VNOTESEARCHQUERY_H
+
+#include "common/vnoteattributeindex.h"
+
+#include <QString>
+#include <QStringList>
+#include <QDate>
+
+//搜索框中的结构化查询，支持以下条件，条件之外的内容作为搜索关键字
+//  folder:名称   记事本名称匹配（支持拼音和模糊匹配）
+//  has:voice     包含语音      has:image  包含图片
+//  before:日期   修改时间早于  after:日期 修改时间不早于
+//  pinned:yes/no 是否置顶
+//日期支持yyyy-MM-dd、yyyy/MM/dd、today、yesterday及Nd、Nw（N天、N周前）
+//值中包含空格时使用双引号
+class VNoteSearchQuery
+{
+public:
+    //解析搜索框内容
+    static VNoteSearchQuery parse(const QString &text);
+
+    //去除条件后的搜索关键字
+    QString keyword() const;
+    //是否包含过滤条件
+    bool hasFilters() const;
+    //编译为属性索引查询条件，记事本名称在标题索引中解析为记事本id
+    VNoteAttributeIndex::Filter compile() const;
+    //执行查询，返回满足过滤条件的笔记
+    VNOTE_SEARCH_HITS execute() const;
+
+    //解析日期，today为基准日期
+    static QDate parseDate(const QString &value, const QDate &today = QDate::currentDate());
+
+private:
+    //按空白拆分，双引号内的空白不拆分
+    static QStringList tokenize(const QString &text);
+    //解析一个条件，不是条件返回false
+    bool parseFilter(const QString &name, const QString &value);
+
+    QString m_keyword;
+    QStringList m_folderNames;
+    bool m_hasVoice {false};
+    bool m_hasImage {false};
+    int m_pinned {-1};
+    QDate m_after;
+    QDate m_before;
+};
+
+#endif // VNOTESEARCHQUERY_H
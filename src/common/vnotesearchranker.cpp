@@ -0,0 +1,379 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnotesearchranker.h"
+#include "common/vnoteitem.h"
+
+#include <QTextDocument>
+#include <QRegularExpression>
+
+//BM25参数
+static const qreal BM25_K1 = 1.2;
+static const qreal BM25_B = 0.75;
+//标题命中的权重
+static const qreal TITLE_WEIGHT = 3.0;
+
+/**
+ * @brief VNoteSearchRanker::makeDoc
+ * 字符串为隐式共享，只增加引用计数，笔记之后被修改不影响快照
+ * @param note 笔记
+ * @return 可搜索内容
+ */
+VNoteSearchDoc VNoteSearchRanker::makeDoc(VNoteItem *note)
+{
+    VNoteSearchDoc doc;
+    doc.folderId = note->folderId;
+    doc.noteId = note->noteId;
+    doc.title = note->noteTitle;
+    doc.htmlCode = note->htmlCode;
+
+    if (doc.htmlCode.isEmpty()) {
+        for (auto it : note->datas.dataConstRef()) {
+            if (!it->blockText.isEmpty()) {
+                doc.blockTexts.append(it->blockText);
+            }
+        }
+    }
+
+    return doc;
+}
+
+/**
+ * @brief VNoteSearchRanker::rankNote
+ * @param doc 笔记内容
+ * @param key 搜索关键字
+ * @param averageLength 文档平均长度
+ * @param titleIndexMatched 标题拼音或模糊匹配
+ * @param hit 计算结果
+ * @param textLength 返回笔记文本长度，用于统计平均长度
+ * @return true 命中
+ */
+bool VNoteSearchRanker::rankNote(const VNoteSearchDoc &doc, const QString &key, qreal averageLength, bool titleIndexMatched,
+                                 VNoteSearchHit &hit, int *textLength)
+{
+    QString body = noteText(doc);
+
+    if (nullptr != textLength) {
+        *textLength = doc.title.length() + body.length();
+    }
+
+    hit.titleRanges = findRanges(doc.title, key);
+    hit.snippet = makeSnippet(body, key, hit.snippetRanges);
+
+    //标题未直接包含关键字时，索引匹配按一次标题命中计算
+    bool indexOnly = hit.titleRanges.isEmpty() && titleIndexMatched;
+
+    if (hit.titleRanges.isEmpty() && !indexOnly && !body.contains(key, Qt::CaseInsensitive)) {
+        return false;
+    }
+
+    hit.folderId = doc.folderId;
+    hit.noteId = doc.noteId;
+    hit.score = score(doc.title, body, key, averageLength, indexOnly ? TITLE_WEIGHT : 0);
+
+    return true;
+}
+
+/**
+ * @brief VNoteSearchRanker::score
+ * 标题和正文合并为一个文档，标题中的词频按权重放大
+ * @param title 标题
+ * @param body 正文
+ * @param key 搜索关键字
+ * @param averageLength 文档平均长度
+ * @param extraFrequency 文本外额外命中的词频
+ * @return 相关度
+ */
+qreal VNoteSearchRanker::score(const QString &title, const QString &body, const QString &key,
+                               qreal averageLength, qreal extraFrequency)
+{
+    qreal length = title.length() * TITLE_WEIGHT + body.length();
+    qreal total = 0;
+
+    for (auto &term : splitTerms(key)) {
+        qreal termFrequency = title.count(term, Qt::CaseInsensitive) * TITLE_WEIGHT
+                              + body.count(term, Qt::CaseInsensitive)
+                              + extraFrequency;
+        total += bm25(termFrequency, length, averageLength);
+    }
+
+    return total;
+}
+
+/**
+ * @brief VNoteSearchRanker::noteText
+ * @param doc 笔记内容
+ * @return 纯文本内容
+ */
+QString VNoteSearchRanker::noteText(const VNoteSearchDoc &doc)
+{
+    QString text;
+
+    if (!doc.htmlCode.isEmpty()) {
+        QTextDocument textDoc;
+        textDoc.setHtml(doc.htmlCode);
+        text = textDoc.toPlainText();
+    } else {
+        for (auto &blockText : doc.blockTexts) {
+            text.append(blockText);
+            text.append('\n');
+        }
+    }
+
+    return text;
+}
+
+/**
+ * @brief VNoteSearchRanker::htmlText
+ * 只去除标签和解码字符实体，不合并空白、不添加换行
+ * @param html 笔记html
+ * @return 文本节点内容
+ */
+QString VNoteSearchRanker::htmlText(const QString &html)
+{
+    QString text = html;
+    text.remove(tagRegExp());
+
+    return decodeEntities(text);
+}
+
+/**
+ * @brief VNoteSearchRanker::editorText
+ * 与网页中计算命中位置的文本一致：跳过语音块，只拼接其余文本节点
+ * @param html 笔记html
+ * @return 文本节点内容
+ */
+QString VNoteSearchRanker::editorText(const QString &html)
+{
+    static const QRegularExpression voiceRegExp("^<div\\b[^>]*\\bclass=\"[^\"]*\\bvoiceBox\\b",
+                                                QRegularExpression::CaseInsensitiveOption);
+
+    QString text;
+    int pos = 0;
+    //语音块内嵌套的div层数，0表示不在语音块中
+    int voiceDepth = 0;
+    QRegularExpressionMatchIterator it = tagRegExp().globalMatch(html);
+
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        if (0 == voiceDepth) {
+            text.append(html.midRef(pos, match.capturedStart() - pos));
+        }
+        pos = match.capturedEnd();
+
+        QStringRef tag = match.capturedRef(0);
+        if (voiceDepth > 0) {
+            if (tag.startsWith("<div", Qt::CaseInsensitive)) {
+                voiceDepth++;
+            } else if (tag.startsWith("</div", Qt::CaseInsensitive)) {
+                voiceDepth--;
+            }
+        } else if (voiceRegExp.match(tag).hasMatch()) {
+            voiceDepth = 1;
+        }
+    }
+
+    if (0 == voiceDepth) {
+        text.append(html.midRef(pos));
+    }
+
+    return decodeEntities(text);
+}
+
+/**
+ * @brief VNoteSearchRanker::noteEditorText
+ * 没有html的旧版笔记按网页initData的方式生成段落，每行一个段落
+ * @param note 笔记
+ * @return 编辑区中用于定位命中的文本
+ */
+QString VNoteSearchRanker::noteEditorText(VNoteItem *note)
+{
+    if (!note->htmlCode.isEmpty()) {
+        return editorText(note->htmlCode);
+    }
+
+    QString html;
+    for (auto block : note->datas.dataConstRef()) {
+        if (VNoteBlock::Text == block->getType()) {
+            for (auto &line : block->blockText.split('\n')) {
+                html += "<p>" + line + "</p>";
+            }
+        }
+    }
+
+    return editorText(html);
+}
+
+/**
+ * @brief VNoteSearchRanker::tagRegExp
+ * 属性值中可能包含'>'，按引号匹配完整标签
+ * @return 标签表达式
+ */
+const QRegularExpression &VNoteSearchRanker::tagRegExp()
+{
+    static const QRegularExpression regExp("<(?:[^>\"']|\"[^\"]*\"|'[^']*')*>");
+    return regExp;
+}
+
+/**
+ * @brief VNoteSearchRanker::decodeEntities
+ * 网页序列化的html只包含以下字符实体，其他实体保持原样
+ * @param text 去除标签后的文本
+ * @return 解码后的文本
+ */
+QString VNoteSearchRanker::decodeEntities(const QString &text)
+{
+    static const QRegularExpression entityRegExp("&(#[0-9]+|#[xX][0-9a-fA-F]+|[a-zA-Z]+);");
+
+    QString result;
+    int pos = 0;
+    QRegularExpressionMatchIterator it = entityRegExp.globalMatch(text);
+
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        QString name = match.captured(1);
+        QString decoded;
+
+        if (name.startsWith('#')) {
+            uint code = name.startsWith("#x", Qt::CaseInsensitive) ? name.mid(2).toUInt(nullptr, 16)
+                                                                   : name.mid(1).toUInt();
+            decoded = QString::fromUcs4(&code, 1);
+        } else if (name == "amp") {
+            decoded = "&";
+        } else if (name == "lt") {
+            decoded = "<";
+        } else if (name == "gt") {
+            decoded = ">";
+        } else if (name == "quot") {
+            decoded = "\"";
+        } else if (name == "apos") {
+            decoded = "'";
+        } else if (name == "nbsp") {
+            decoded = QChar(0x00a0);
+        } else {
+            continue;
+        }
+
+        result.append(text.midRef(pos, match.capturedStart() - pos));
+        result.append(decoded);
+        pos = match.capturedEnd();
+    }
+
+    result.append(text.midRef(pos));
+
+    return result;
+}
+
+/**
+ * @brief VNoteSearchRanker::findRanges
+ * @param text 文本
+ * @param key 搜索关键字
+ * @return 高亮区间
+ */
+VNOTE_TEXT_RANGES VNoteSearchRanker::findRanges(const QString &text, const QString &key)
+{
+    VNOTE_TEXT_RANGES ranges;
+
+    if (!key.isEmpty()) {
+        int pos = 0;
+        while ((pos = text.indexOf(key, pos, Qt::CaseInsensitive)) != -1) {
+            ranges.append(qMakePair(pos, key.length()));
+            pos += key.length();
+        }
+    }
+
+    return ranges;
+}
+
+/**
+ * @brief VNoteSearchRanker::makeSnippet
+ * 从第一个命中位置前截取，未命中时截取正文开头
+ * @param text 正文
+ * @param key 搜索关键字
+ * @param ranges 摘要中的高亮区间
+ * @return 摘要
+ */
+QString VNoteSearchRanker::makeSnippet(const QString &text, const QString &key, VNOTE_TEXT_RANGES &ranges)
+{
+    ranges.clear();
+
+    int pos = key.isEmpty() ? -1 : text.indexOf(key, 0, Qt::CaseInsensitive);
+    int start = (-1 == pos) ? 0 : qMax(0, pos - SnippetLeadLength);
+    int length = qMin(static_cast<int>(SnippetLength), text.length() - start);
+
+    //换行替换为空格，摘要单行显示，长度不变保证区间位置正确
+    QString snippet = text.mid(start, length);
+    snippet.replace(QRegularExpression("\\s"), " ");
+
+    if (-1 != pos) {
+        for (auto &range : findRanges(snippet, key)) {
+            ranges.append(range);
+        }
+    }
+
+    //截断处添加省略号
+    if (start > 0) {
+        snippet.prepend(QChar(0x2026));
+        for (auto &range : ranges) {
+            range.first += 1;
+        }
+    }
+
+    if (start + length < text.length()) {
+        snippet.append(QChar(0x2026));
+    }
+
+    return snippet;
+}
+
+/**
+ * @brief VNoteSearchRanker::splitTerms
+ * @param key 搜索关键字
+ * @return 词项
+ */
+QStringList VNoteSearchRanker::splitTerms(const QString &key)
+{
+    QStringList terms = key.split(QRegularExpression("\\s+"), QString::SkipEmptyParts);
+
+    if (terms.isEmpty() && !key.isEmpty()) {
+        terms.append(key);
+    }
+
+    return terms;
+}
+
+/**
+ * @brief VNoteSearchRanker::bm25
+ * @param termFrequency 词频
+ * @param length 文档长度
+ * @param averageLength 文档平均长度，未知时不做长度归一化
+ * @return 分值
+ */
+qreal VNoteSearchRanker::bm25(qreal termFrequency, qreal length, qreal averageLength)
+{
+    if (termFrequency <= 0) {
+        return 0;
+    }
+
+    qreal lengthRatio = (averageLength > 0) ? (length / averageLength) : 1.0;
+
+    return termFrequency * (BM25_K1 + 1)
+           / (termFrequency + BM25_K1 * (1 - BM25_B + BM25_B * lengthRatio));
+}
@@ -0,0 +1,75 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTESEARCHRANKER_H
+#define VNOTESEARCHRANKER_H
+
+#include "common/datatypedef.h"
+
+#include <QStringList>
+
+class QRegularExpression;
+
+//搜索结果排序，按BM25计算标题和正文的相关度，同时生成摘要和高亮区间
+//搜索为整个关键字匹配，命中的笔记都包含全部词项，逆文档频率相同，计算时省略
+class VNoteSearchRanker
+{
+public:
+    enum {
+        //摘要最大长度
+        SnippetLength = 60,
+        //摘要中关键字前保留的长度
+        SnippetLeadLength = 16
+    };
+
+    //生成笔记可搜索内容的快照，需在修改笔记数据的线程中调用
+    static VNoteSearchDoc makeDoc(VNoteItem *note);
+    //计算笔记的相关度，未命中返回false；averageLength为文档平均长度，未知时传0
+    //titleIndexMatched为标题索引的拼音或模糊匹配结果
+    static bool rankNote(const VNoteSearchDoc &doc, const QString &key, qreal averageLength, bool titleIndexMatched,
+                         VNoteSearchHit &hit, int *textLength = nullptr);
+    //计算已有文本的相关度，extraFrequency为文本外额外命中的词频
+    static qreal score(const QString &title, const QString &body, const QString &key,
+                       qreal averageLength, qreal extraFrequency = 0);
+    //获取笔记纯文本内容
+    static QString noteText(const VNoteSearchDoc &doc);
+    //按文本节点顺序拼接html中的文本
+    static QString htmlText(const QString &html);
+    //编辑区中定位命中的文本，跳过语音块，与网页中的文本位置一一对应
+    static QString editorText(const QString &html);
+    //笔记在编辑区中定位命中的文本，旧版笔记按文本块生成
+    static QString noteEditorText(VNoteItem *note);
+    //查找关键字在文本中的所有位置
+    static VNOTE_TEXT_RANGES findRanges(const QString &text, const QString &key);
+    //生成关键字附近的摘要，ranges返回摘要中的高亮区间
+    static QString makeSnippet(const QString &text, const QString &key, VNOTE_TEXT_RANGES &ranges);
+
+private:
+    //html标签
+    static const QRegularExpression &tagRegExp();
+    //解码字符实体
+    static QString decodeEntities(const QString &text);
+    //关键字按空白拆分为词项
+    static QStringList splitTerms(const QString &key);
+    //BM25词频饱和及长度归一化
+    static qreal bm25(qreal termFrequency, qreal length, qreal averageLength);
+};
+
+#endif // VNOTESEARCHRANKER_H
@@ -0,0 +1,303 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnotetitleindex.h"
+
+#include <DPinyin>
+
+#include <QRegularExpression>
+#include <QtMath>
+
+DCORE_USE_NAMESPACE
+
+/**
+ * @brief VNoteTitleIndex::instance
+ * @return 单例对象
+ */
+VNoteTitleIndex *VNoteTitleIndex::instance()
+{
+    static VNoteTitleIndex _instance;
+    return &_instance;
+}
+
+/**
+ * @brief VNoteTitleIndex::updateTitle
+ * 拼音转换在加锁前完成，避免阻塞查询
+ * @param type 标题类型
+ * @param id 笔记或记事本id
+ * @param title 标题
+ * @param parentId 所属记事本id
+ */
+void VNoteTitleIndex::updateTitle(TitleType type, qint64 id, const QString &title, qint64 parentId)
+{
+    TitleEntry entry = makeEntry(title, parentId);
+
+    QWriteLocker locker(&m_lock);
+    TitleTable &table = m_tables[type];
+
+    removeEntry(table, id);
+
+    for (auto &gram : entry.trigrams) {
+        table.postings[gram].insert(id);
+    }
+
+    table.entries.insert(id, entry);
+}
+
+/**
+ * @brief VNoteTitleIndex::updateParent
+ * @param type 标题类型
+ * @param id 笔记id
+ * @param parentId 所属记事本id
+ */
+void VNoteTitleIndex::updateParent(TitleType type, qint64 id, qint64 parentId)
+{
+    QWriteLocker locker(&m_lock);
+    auto it = m_tables[type].entries.find(id);
+
+    if (it != m_tables[type].entries.end()) {
+        it->parentId = parentId;
+    }
+}
+
+/**
+ * @brief VNoteTitleIndex::removeTitle
+ * @param type 标题类型
+ * @param id 笔记或记事本id
+ */
+void VNoteTitleIndex::removeTitle(TitleType type, qint64 id)
+{
+    QWriteLocker locker(&m_lock);
+    removeEntry(m_tables[type], id);
+}
+
+/**
+ * @brief VNoteTitleIndex::removeChildren
+ * @param type 标题类型
+ * @param parentId 记事本id
+ */
+void VNoteTitleIndex::removeChildren(TitleType type, qint64 parentId)
+{
+    QWriteLocker locker(&m_lock);
+    TitleTable &table = m_tables[type];
+
+    QList<qint64> ids;
+    for (auto it = table.entries.constBegin(); it != table.entries.constEnd(); ++it) {
+        if (it->parentId == parentId) {
+            ids.append(it.key());
+        }
+    }
+
+    for (auto id : ids) {
+        removeEntry(table, id);
+    }
+}
+
+/**
+ * @brief VNoteTitleIndex::clear
+ * @param type 标题类型
+ */
+void VNoteTitleIndex::clear(TitleType type)
+{
+    QWriteLocker locker(&m_lock);
+    m_tables[type].entries.clear();
+    m_tables[type].postings.clear();
+}
+
+/**
+ * @brief VNoteTitleIndex::search
+ * 短关键字逐项比较预先计算的字符串，长关键字通过三元组倒排表查找候选并支持模糊匹配
+ * @param type 标题类型
+ * @param keyword 关键字
+ * @return 匹配项id到所属记事本id的映射
+ */
+QHash<qint64, qint64> VNoteTitleIndex::search(TitleType type, const QString &keyword) const
+{
+    static const QRegularExpression spaceExp("\\s");
+
+    QHash<qint64, qint64> results;
+    QString lowerKeyword = keyword.toLower();
+    QString compactKeyword = lowerKeyword;
+    compactKeyword.remove(spaceExp);
+
+    if (compactKeyword.isEmpty()) {
+        return results;
+    }
+
+    QSet<QString> keywordGrams = trigrams(compactKeyword);
+
+    QReadLocker locker(&m_lock);
+    const TitleTable &table = m_tables[type];
+
+    //三元组数量较少时模糊匹配误差大，只做包含匹配
+    if (keywordGrams.size() < 3) {
+        for (auto it = table.entries.constBegin(); it != table.entries.constEnd(); ++it) {
+            if (containsKeyword(*it, lowerKeyword, compactKeyword)) {
+                results.insert(it.key(), it->parentId);
+            }
+        }
+    } else {
+        //包含关键字的标题一定包含关键字的全部三元组
+        QHash<qint64, int> sharedCount;
+        for (auto &gram : keywordGrams) {
+            auto posting = table.postings.constFind(gram);
+            if (posting != table.postings.constEnd()) {
+                for (auto id : *posting) {
+                    sharedCount[id]++;
+                }
+            }
+        }
+
+        int minShared = qCeil(keywordGrams.size() * FuzzyMatchRatio);
+        for (auto it = sharedCount.constBegin(); it != sharedCount.constEnd(); ++it) {
+            if (it.value() >= minShared) {
+                results.insert(it.key(), table.entries.value(it.key()).parentId);
+            }
+        }
+    }
+
+    return results;
+}
+
+/**
+ * @brief VNoteTitleIndex::count
+ * @param type 标题类型
+ * @return 标题数量
+ */
+int VNoteTitleIndex::count(TitleType type) const
+{
+    QReadLocker locker(&m_lock);
+    return m_tables[type].entries.size();
+}
+
+/**
+ * @brief VNoteTitleIndex::toPinyin
+ * 汉字转换为不带声调的拼音，多音字取第一个读音，其他字符转为小写保留
+ * @param text 文本
+ * @param fullPinyin 全拼
+ * @param initials 首字母
+ */
+void VNoteTitleIndex::toPinyin(const QString &text, QString &fullPinyin, QString &initials)
+{
+    static const QRegularExpression toneExp("[0-9]");
+
+    fullPinyin.clear();
+    initials.clear();
+
+    for (auto &ch : text) {
+        if (ch.isSpace()) {
+            continue;
+        }
+
+        QString pinyin;
+        if (ch.unicode() >= 0x4E00 && ch.unicode() <= 0x9FA5) {
+            pinyin = Chinese2Pinyin(QString(ch)).section(',', 0, 0);
+            pinyin.remove(toneExp);
+        }
+
+        if (pinyin.isEmpty() || pinyin == QString(ch)) {
+            fullPinyin.append(ch.toLower());
+            initials.append(ch.toLower());
+        } else {
+            fullPinyin.append(pinyin.toLower());
+            initials.append(pinyin.at(0).toLower());
+        }
+    }
+}
+
+/**
+ * @brief VNoteTitleIndex::trigrams
+ * @param text 文本
+ * @return 三元组，文本长度不足3时为空
+ */
+QSet<QString> VNoteTitleIndex::trigrams(const QString &text)
+{
+    QSet<QString> grams;
+
+    for (int i = 0; i + 3 <= text.length(); i++) {
+        grams.insert(text.mid(i, 3));
+    }
+
+    return grams;
+}
+
+/**
+ * @brief VNoteTitleIndex::makeEntry
+ * @param title 标题
+ * @param parentId 所属记事本id
+ * @return 索引项
+ */
+VNoteTitleIndex::TitleEntry VNoteTitleIndex::makeEntry(const QString &title, qint64 parentId)
+{
+    static const QRegularExpression spaceExp("\\s");
+
+    TitleEntry entry;
+    entry.parentId = parentId;
+    entry.title = title.toLower();
+    toPinyin(title, entry.fullPinyin, entry.initials);
+
+    QString compactTitle = entry.title;
+    compactTitle.remove(spaceExp);
+
+    entry.trigrams = trigrams(compactTitle);
+    entry.trigrams.unite(trigrams(entry.fullPinyin));
+    entry.trigrams.unite(trigrams(entry.initials));
+
+    return entry;
+}
+
+/**
+ * @brief VNoteTitleIndex::containsKeyword
+ * @param entry 索引项
+ * @param keyword 小写关键字
+ * @param compactKeyword 去除空白的小写关键字
+ * @return true 包含
+ */
+bool VNoteTitleIndex::containsKeyword(const TitleEntry &entry, const QString &keyword, const QString &compactKeyword)
+{
+    return entry.title.contains(keyword)
+           || entry.fullPinyin.contains(compactKeyword)
+           || entry.initials.contains(compactKeyword);
+}
+
+/**
+ * @brief VNoteTitleIndex::removeEntry
+ * @param table 索引表
+ * @param id 笔记或记事本id
+ */
+void VNoteTitleIndex::removeEntry(TitleTable &table, qint64 id)
+{
+    auto it = table.entries.find(id);
+    if (it == table.entries.end()) {
+        return;
+    }
+
+    for (auto &gram : it->trigrams) {
+        auto posting = table.postings.find(gram);
+        if (posting != table.postings.end()) {
+            posting->remove(id);
+            if (posting->isEmpty()) {
+                table.postings.erase(posting);
+            }
+        }
+    }
+
+    table.entries.erase(it);
+}
@@ -0,0 +1,96 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTETITLEINDEX_H
+#define VNOTETITLEINDEX_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QReadWriteLock>
+
+//笔记标题和记事本名称索引，预先计算全拼、首字母和三元组
+//支持拼音、首字母及少量错字的模糊匹配，查询时不再逐个转换标题
+//索引在数据加载时建立，增删、重命名、移动时增量更新，可在搜索线程中查询
+class VNoteTitleIndex
+{
+public:
+    enum TitleType {
+        NoteTitle = 0,
+        FolderName,
+        TitleTypeCount
+    };
+
+    //模糊匹配时关键字三元组的最低命中比例
+    static constexpr qreal FuzzyMatchRatio = 0.6;
+
+    static VNoteTitleIndex *instance();
+
+    //添加或更新标题，parentId为笔记所属记事本id
+    void updateTitle(TitleType type, qint64 id, const QString &title, qint64 parentId = -1);
+    //更新笔记所属记事本
+    void updateParent(TitleType type, qint64 id, qint64 parentId);
+    //移除标题
+    void removeTitle(TitleType type, qint64 id);
+    //移除记事本下所有笔记
+    void removeChildren(TitleType type, qint64 parentId);
+    //清空索引
+    void clear(TitleType type);
+    //查找匹配的标题，返回id到parentId的映射
+    QHash<qint64, qint64> search(TitleType type, const QString &keyword) const;
+    //索引中的标题数量
+    int count(TitleType type) const;
+
+    //获取全拼和首字母
+    static void toPinyin(const QString &text, QString &fullPinyin, QString &initials);
+    //生成三元组
+    static QSet<QString> trigrams(const QString &text);
+
+private:
+    VNoteTitleIndex() = default;
+
+    struct TitleEntry {
+        qint64 parentId {-1};
+        //小写标题
+        QString title;
+        QString fullPinyin;
+        QString initials;
+        QSet<QString> trigrams;
+    };
+
+    struct TitleTable {
+        QHash<qint64, TitleEntry> entries;
+        //三元组倒排表
+        QHash<QString, QSet<qint64>> postings;
+    };
+
+    //创建索引项
+    static TitleEntry makeEntry(const QString &title, qint64 parentId);
+    //标题、全拼或首字母包含关键字
+    static bool containsKeyword(const TitleEntry &entry, const QString &keyword, const QString &compactKeyword);
+    //从倒排表中移除
+    void removeEntry(TitleTable &table, qint64 id);
+
+    TitleTable m_tables[TitleTypeCount];
+    mutable QReadWriteLock m_lock;
+};
+
+#endif // VNOTETITLEINDEX_H
@@ -22,11 +22,13 @@
 #include "globaldef.h"
 #include "db/vnotefolderoper.h"
 #include "db/vnoteitemoper.h"
+#include "db/vnoteattachmentoper.h"
 #include "common/datatypedef.h"
 #include "common/metadataparser.h"
 #include "common/vnotedatamanager.h"
 #include "common/vnoteforlder.h"
 #include "common/vnoteitem.h"
+#include "common/vnotelibraryarchive.h"
 #include "common/setting.h"
 
 #include "db/vnotedbmanager.h"
@@ -34,6 +36,7 @@
 #include <DLog>
 
 #include <QVariant>
+#include <QHash>
 
 const QStringList DbVisitor::DBFolder::folderColumnsName = {
     "folder_id",
@@ -73,6 +76,31 @@ const QStringList DbVisitor::DBSafer::saferColumnsName = {
     "create_time",
 };
 
+const QStringList DbVisitor::DBTranscript::transcriptColumnsName = {
+    "id",
+    "folder_id",
+    "note_id",
+    "voice_path",
+    "start_time",
+    "end_time",
+    "segment_text",
+    "create_time",
+};
+
+const QStringList DbVisitor::DBAttachment::attachmentColumnsName = {
+    "hash",
+    "file_name",
+    "file_type",
+    "file_size",
+    "store_time",
+};
+
+const QStringList DbVisitor::DBAttachmentRef::attachmentRefColumnsName = {
+    "hash",
+    "folder_id",
+    "note_id",
+};
+
 /**
  * @brief DbVisitor::DbVisitor
  * @param db 数据库对象
@@ -139,6 +167,103 @@ void DbVisitor::checkSqlStr(QString &sql)
     sql.replace("'", "''");
 }
 
+/**
+ * @brief DbVisitor::appendAttachmentRefSqls
+ * 附件引用由笔记内容决定，每次保存时删除旧引用后按内容重新添加
+ * @param note 笔记
+ * @param metaData 笔记内容
+ * @param newNote true 新插入的笔记，id取记事本中最大的笔记id
+ */
+void DbVisitor::appendAttachmentRefSqls(const VNoteItem *note, const QString &metaData, bool newNote)
+{
+    static constexpr char const *DEL_REF_FMT = "DELETE FROM %s WHERE %s=%lld AND %s=%d;";
+    static constexpr char const *INSERT_REF_FMT = "INSERT INTO %s (%s,%s,%s) VALUES ('%s',%lld,%d);";
+    static constexpr char const *INSERT_NEW_REF_FMT = "INSERT INTO %s (%s,%s,%s) SELECT '%s',%lld,MAX(%s) FROM %s WHERE %s=%lld;";
+
+    QStringList hashes = VNoteAttachmentOper::attachmentHashes(metaData);
+
+    if (!newNote) {
+        QString deleteSql;
+        deleteSql.sprintf(DEL_REF_FMT,
+                          VNoteDbManager::ATTACHMENT_REF_TABLE_NAME,
+                          DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::folder_id].toUtf8().data(),
+                          note->folderId,
+                          DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::note_id].toUtf8().data(),
+                          note->noteId);
+        m_dbvSqls.append(deleteSql);
+    }
+
+    for (auto &hash : hashes) {
+        QString insertSql;
+        if (newNote) {
+            insertSql.sprintf(INSERT_NEW_REF_FMT,
+                              VNoteDbManager::ATTACHMENT_REF_TABLE_NAME,
+                              DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::hash].toUtf8().data(),
+                              DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::folder_id].toUtf8().data(),
+                              DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::note_id].toUtf8().data(),
+                              hash.toUtf8().data(),
+                              note->folderId,
+                              DBNote::noteColumnsName[DBNote::note_id].toUtf8().data(),
+                              VNoteDbManager::NOTES_TABLE_NAME,
+                              DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(),
+                              note->folderId);
+        } else {
+            insertSql.sprintf(INSERT_REF_FMT,
+                              VNoteDbManager::ATTACHMENT_REF_TABLE_NAME,
+                              DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::hash].toUtf8().data(),
+                              DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::folder_id].toUtf8().data(),
+                              DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::note_id].toUtf8().data(),
+                              hash.toUtf8().data(),
+                              note->folderId,
+                              note->noteId);
+        }
+        m_dbvSqls.append(insertSql);
+    }
+}
+
+/**
+ * @brief DbVisitor::appendTranscriptCopySqls
+ * 附件仓库中相同内容的语音只保存一份，复制或导入语音的笔记与原笔记共用语音文件，
+ * 转写分段按笔记保存，笔记中还没有该语音的分段时从其他笔记复制
+ * @param folderId 记事本id，可以是子查询
+ * @param noteId 笔记id，可以是子查询
+ * @param metaData 笔记内容
+ */
+void DbVisitor::appendTranscriptCopySqls(const QString &folderId, const QString &noteId, const QString &metaData)
+{
+    static constexpr char const *COPY_TRANSCRIPT_FMT =
+        "INSERT INTO %s (%s,%s,%s,%s,%s,%s) SELECT %s,%s,%s,%s,%s,%s FROM %s WHERE %s='%s' "
+        "AND %s=(SELECT MIN(%s) FROM %s WHERE %s='%s' AND %s<>%s) "
+        "AND NOT EXISTS (SELECT 1 FROM %s WHERE %s='%s' AND %s=%s);";
+
+    QByteArray table = VNoteDbManager::TRANSCRIPT_TABLE_NAME;
+    QByteArray folderIdName = DBTranscript::transcriptColumnsName[DBTranscript::folder_id].toUtf8();
+    QByteArray noteIdName = DBTranscript::transcriptColumnsName[DBTranscript::note_id].toUtf8();
+    QByteArray voicePathName = DBTranscript::transcriptColumnsName[DBTranscript::voice_path].toUtf8();
+    QByteArray startTimeName = DBTranscript::transcriptColumnsName[DBTranscript::start_time].toUtf8();
+    QByteArray endTimeName = DBTranscript::transcriptColumnsName[DBTranscript::end_time].toUtf8();
+    QByteArray textName = DBTranscript::transcriptColumnsName[DBTranscript::segment_text].toUtf8();
+    QByteArray folderIdValue = folderId.toUtf8();
+    QByteArray noteIdValue = noteId.toUtf8();
+
+    for (auto voicePath : VNoteAttachmentOper::voiceAttachmentPaths(metaData)) {
+        checkSqlStr(voicePath);
+        QByteArray path = voicePath.toUtf8();
+
+        QString copySql;
+        copySql.sprintf(COPY_TRANSCRIPT_FMT,
+                        table.data(), folderIdName.data(), noteIdName.data(), voicePathName.data(),
+                        startTimeName.data(), endTimeName.data(), textName.data(),
+                        folderIdValue.data(), noteIdValue.data(), voicePathName.data(),
+                        startTimeName.data(), endTimeName.data(), textName.data(),
+                        table.data(), voicePathName.data(), path.data(),
+                        noteIdName.data(), noteIdName.data(), table.data(), voicePathName.data(), path.data(),
+                        noteIdName.data(), noteIdValue.data(),
+                        table.data(), voicePathName.data(), path.data(), noteIdName.data(), noteIdValue.data());
+        m_dbvSqls.append(copySql);
+    }
+}
+
 /**
  * @brief FolderQryDbVisitor::FolderQryDbVisitor
  * @param db
@@ -186,8 +311,11 @@ bool FolderQryDbVisitor::visitorData()
             //************Expand fileds end************
 
             //Get default icon image
-            folder->UI.icon = VNoteDataManager::instance()->getDefaultIcon(folder->defaultIcon, IconsType::DefaultIcon);
-            folder->UI.grayIcon = VNoteDataManager::instance()->getDefaultIcon(folder->defaultIcon, IconsType::DefaultGrayIcon);
+            //flag为true时不加载图标，用于没有图形界面的搜索服务
+            if (!m_extraData.data.flag) {
+                folder->UI.icon = VNoteDataManager::instance()->getDefaultIcon(folder->defaultIcon, IconsType::DefaultIcon);
+                folder->UI.grayIcon = VNoteDataManager::instance()->getDefaultIcon(folder->defaultIcon, IconsType::DefaultGrayIcon);
+            }
 
             results.folders->folders.insert(folder->id, folder);
         }
@@ -302,9 +430,80 @@ bool NoteQryDbVisitor::visitorData()
 bool NoteQryDbVisitor::prepareSqls()
 {
     static constexpr char const *QUERY_NOTES_FMT = "SELECT * FROM %s ORDER BY %s;";
+    static constexpr char const *QUERY_NOTES_BY_ID_FMT = "SELECT * FROM %s WHERE %s IN (%s) ORDER BY %s;";
+
+    QString querySql;
+
+    //指定笔记id时只查询这些笔记
+    if (nullptr != param.ids) {
+        QStringList ids;
+        for (auto id : *param.ids) {
+            ids.append(QString::number(id));
+        }
+
+        querySql.sprintf(QUERY_NOTES_BY_ID_FMT, VNoteDbManager::NOTES_TABLE_NAME,
+                         DBNote::noteColumnsName[DBNote::note_id].toUtf8().data(),
+                         ids.join(",").toUtf8().data(),
+                         DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data());
+    } else {
+        querySql.sprintf(QUERY_NOTES_FMT, VNoteDbManager::NOTES_TABLE_NAME, DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data());
+    }
+
+    m_dbvSqls.append(querySql);
+
+    return true;
+}
+
+/**
+ * @brief NoteStateQryDbVisitor::NoteStateQryDbVisitor
+ * @param db
+ * @param inParam 参数
+ * @param result 结果
+ */
+NoteStateQryDbVisitor::NoteStateQryDbVisitor(QSqlDatabase &db, const void *inParam, void *result)
+    : DbVisitor(db, inParam, result)
+{
+}
+
+/**
+ * @brief NoteStateQryDbVisitor::visitorData
+ * @return true 成功
+ */
+bool NoteStateQryDbVisitor::visitorData()
+{
+    bool isOK = false;
+
+    if (nullptr != results.itemStates) {
+        isOK = true;
+
+        while (m_sqlQuery->next()) {
+            VNoteItemState state;
+            state.folderId = m_sqlQuery->value(1).toLongLong();
+            state.modifyTime = m_sqlQuery->value(2).toDateTime();
+            state.isTop = m_sqlQuery->value(3).toInt();
+
+            results.itemStates->insert(m_sqlQuery->value(0).toLongLong(), state);
+        }
+    }
+
+    return isOK;
+}
+
+/**
+ * @brief NoteStateQryDbVisitor::prepareSqls
+ * @return true 成功
+ */
+bool NoteStateQryDbVisitor::prepareSqls()
+{
+    static constexpr char const *QUERY_STATES_FMT = "SELECT %s, %s, %s, %s FROM %s;";
 
     QString querySql;
-    querySql.sprintf(QUERY_NOTES_FMT, VNoteDbManager::NOTES_TABLE_NAME, DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data());
+    querySql.sprintf(QUERY_STATES_FMT,
+                     DBNote::noteColumnsName[DBNote::note_id].toUtf8().data(),
+                     DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(),
+                     DBNote::noteColumnsName[DBNote::modify_time].toUtf8().data(),
+                     DBNote::noteColumnsName[DBNote::is_top].toUtf8().data(),
+                     VNoteDbManager::NOTES_TABLE_NAME);
 
     m_dbvSqls.append(querySql);
 
@@ -539,8 +738,18 @@ bool DelFolderDbVisitor::prepareSqls()
 
         deleteNotesSql.sprintf(DEL_FNOTE_FMT, VNoteDbManager::NOTES_TABLE_NAME, DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(), QString("%1").arg(folderId).toUtf8().data());
 
+        QString deleteTranscriptsSql;
+
+        deleteTranscriptsSql.sprintf(DEL_FNOTE_FMT, VNoteDbManager::TRANSCRIPT_TABLE_NAME, DBTranscript::transcriptColumnsName[DBTranscript::folder_id].toUtf8().data(), QString("%1").arg(folderId).toUtf8().data());
+
+        QString deleteRefsSql;
+
+        deleteRefsSql.sprintf(DEL_FNOTE_FMT, VNoteDbManager::ATTACHMENT_REF_TABLE_NAME, DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::folder_id].toUtf8().data(), QString("%1").arg(folderId).toUtf8().data());
+
         m_dbvSqls.append(deleteFolderSql);
         m_dbvSqls.append(deleteNotesSql);
+        m_dbvSqls.append(deleteTranscriptsSql);
+        m_dbvSqls.append(deleteRefsSql);
     } else {
         fPrepareOK = false;
     }
@@ -662,6 +871,15 @@ bool AddNoteDbVisitor::prepareSqls()
 
         m_dbvSqls.append(insertSql);
         m_dbvSqls.append(updateSql);
+        //复制的笔记直接引用已有附件，不复制文件
+        appendAttachmentRefSqls(note, note->metaDataConstRef().toString(), true);
+        appendTranscriptCopySqls(QString::number(note->folderId),
+                                 QString("(SELECT MAX(%1) FROM %2 WHERE %3=%4)")
+                                     .arg(DBNote::noteColumnsName[DBNote::note_id])
+                                     .arg(VNoteDbManager::NOTES_TABLE_NAME)
+                                     .arg(DBNote::noteColumnsName[DBNote::folder_id])
+                                     .arg(note->folderId),
+                                 note->metaDataConstRef().toString());
         m_dbvSqls.append(queryNewRec);
     } else {
         fPrepareOK = false;
@@ -771,6 +989,9 @@ bool UpdateNoteDbVisitor::prepareSqls()
 
         m_dbvSqls.append(modifyNoteTextSql);
         m_dbvSqls.append(updateSql);
+        appendAttachmentRefSqls(note, note->metaDataConstRef().toString());
+        appendTranscriptCopySqls(QString::number(note->folderId), QString::number(note->noteId),
+                                 note->metaDataConstRef().toString());
     } else {
         fPrepareOK = false;
     }
@@ -840,7 +1061,24 @@ bool UpdateNoteFolderIdDbVisitor::prepareSqls()
                           note->folderId,
                           DBNote::noteColumnsName[DBNote::note_id].toUtf8().data(),
                           note->noteId);
+        //笔记移动后同步更新语音转写分段所属记事本
+        QString updateTranscriptSql;
+        updateTranscriptSql.sprintf(UPDATE_NOTE_FOLDERID,
+                                    VNoteDbManager::TRANSCRIPT_TABLE_NAME,
+                                    DBTranscript::transcriptColumnsName[DBTranscript::folder_id].toUtf8().data(),
+                                    note->folderId,
+                                    DBTranscript::transcriptColumnsName[DBTranscript::note_id].toUtf8().data(),
+                                    note->noteId);
+        QString updateRefSql;
+        updateRefSql.sprintf(UPDATE_NOTE_FOLDERID,
+                             VNoteDbManager::ATTACHMENT_REF_TABLE_NAME,
+                             DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::folder_id].toUtf8().data(),
+                             note->folderId,
+                             DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::note_id].toUtf8().data(),
+                             note->noteId);
         m_dbvSqls.append(updateSql);
+        m_dbvSqls.append(updateTranscriptSql);
+        m_dbvSqls.append(updateRefSql);
     } else {
         fPrepareOK = false;
     }
@@ -879,11 +1117,556 @@ bool DelNoteDbVisitor::prepareSqls()
 
         updateSql.sprintf(UPDATE_FOLDER_TIME, VNoteDbManager::FOLDER_TABLE_NAME, DBFolder::folderColumnsName[DBFolder::max_noteid].toUtf8().data(), QString("%1").arg(note->folder()->maxNoteIdRef()).toUtf8().data(), DBFolder::folderColumnsName[DBFolder::modify_time].toUtf8().data(), modifyTime.toString(VNOTE_TIME_FMT).toUtf8().data(), DBFolder::folderColumnsName[DBFolder::folder_id].toUtf8().data(), QString("%1").arg(note->folderId).toUtf8().data());
 
+        QString deleteTranscriptsSql;
+
+        deleteTranscriptsSql.sprintf(DEL_NOTE_FMT, VNoteDbManager::TRANSCRIPT_TABLE_NAME, DBTranscript::transcriptColumnsName[DBTranscript::folder_id].toUtf8().data(), QString("%1").arg(note->folderId).toUtf8().data(), DBTranscript::transcriptColumnsName[DBTranscript::note_id].toUtf8().data(), QString("%1").arg(note->noteId).toUtf8().data());
+
+        QString deleteRefsSql;
+
+        deleteRefsSql.sprintf(DEL_NOTE_FMT, VNoteDbManager::ATTACHMENT_REF_TABLE_NAME, DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::folder_id].toUtf8().data(), QString("%1").arg(note->folderId).toUtf8().data(), DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::note_id].toUtf8().data(), QString("%1").arg(note->noteId).toUtf8().data());
+
         m_dbvSqls.append(deleteSql);
         m_dbvSqls.append(updateSql);
+        m_dbvSqls.append(deleteTranscriptsSql);
+        m_dbvSqls.append(deleteRefsSql);
+    } else {
+        fPrepareOK = false;
+    }
+
+    return fPrepareOK;
+}
+
+/**
+ * @brief AddTranscriptDbVisitor::AddTranscriptDbVisitor
+ * @param db
+ * @param inParam
+ * @param result
+ */
+AddTranscriptDbVisitor::AddTranscriptDbVisitor(QSqlDatabase &db, const void *inParam, void *result)
+    : DbVisitor(db, inParam, result)
+{
+}
+
+/**
+ * @brief AddTranscriptDbVisitor::prepareSqls
+ * @return true 成功
+ */
+bool AddTranscriptDbVisitor::prepareSqls()
+{
+    bool fPrepareOK = true;
+    const VNOTE_TRANSCRIPTS *transcripts = param.transcripts;
+
+    if (nullptr != transcripts && !transcripts->isEmpty()) {
+        static constexpr char const *DEL_TRANSCRIPT_FMT = "DELETE FROM %s WHERE %s=%lld AND %s='%s';";
+        static constexpr char const *INSERT_FMT = "INSERT INTO %s (%s,%s,%s,%s,%s,%s) VALUES (%lld,%lld,'%s',%lld,%lld,'%s');";
+
+        //同一笔记中的语音重新转写时先删除旧的分段，其他笔记共用同一语音文件时保留其分段
+        QString voicePath = transcripts->first().voicePath;
+        checkSqlStr(voicePath);
+
+        QString deleteSql;
+        deleteSql.sprintf(DEL_TRANSCRIPT_FMT,
+                          VNoteDbManager::TRANSCRIPT_TABLE_NAME,
+                          DBTranscript::transcriptColumnsName[DBTranscript::note_id].toUtf8().data(),
+                          transcripts->first().noteId,
+                          DBTranscript::transcriptColumnsName[DBTranscript::voice_path].toUtf8().data(),
+                          voicePath.toUtf8().data());
+        m_dbvSqls.append(deleteSql);
+
+        for (auto &it : *transcripts) {
+            QString segmentText = it.text;
+            checkSqlStr(segmentText);
+
+            QString insertSql;
+            insertSql.sprintf(INSERT_FMT,
+                              VNoteDbManager::TRANSCRIPT_TABLE_NAME,
+                              DBTranscript::transcriptColumnsName[DBTranscript::folder_id].toUtf8().data(),
+                              DBTranscript::transcriptColumnsName[DBTranscript::note_id].toUtf8().data(),
+                              DBTranscript::transcriptColumnsName[DBTranscript::voice_path].toUtf8().data(),
+                              DBTranscript::transcriptColumnsName[DBTranscript::start_time].toUtf8().data(),
+                              DBTranscript::transcriptColumnsName[DBTranscript::end_time].toUtf8().data(),
+                              DBTranscript::transcriptColumnsName[DBTranscript::segment_text].toUtf8().data(),
+                              it.folderId,
+                              it.noteId,
+                              voicePath.toUtf8().data(),
+                              it.startTime,
+                              it.endTime,
+                              segmentText.toUtf8().data());
+            m_dbvSqls.append(insertSql);
+        }
     } else {
         fPrepareOK = false;
     }
 
     return fPrepareOK;
 }
+
+/**
+ * @brief TranscriptQryDbVisitor::TranscriptQryDbVisitor
+ * @param db
+ * @param inParam 搜索关键字
+ * @param result 结果
+ */
+TranscriptQryDbVisitor::TranscriptQryDbVisitor(QSqlDatabase &db, const void *inParam, void *result)
+    : DbVisitor(db, inParam, result)
+{
+}
+
+/**
+ * @brief TranscriptQryDbVisitor::visitorData
+ * @return true 成功
+ */
+bool TranscriptQryDbVisitor::visitorData()
+{
+    bool isOK = false;
+
+    if (nullptr != results.transcripts) {
+        isOK = true;
+
+        while (m_sqlQuery->next()) {
+            VNoteTranscript transcript;
+
+            transcript.id = m_sqlQuery->value(DBTranscript::id).toLongLong();
+            transcript.folderId = m_sqlQuery->value(DBTranscript::folder_id).toLongLong();
+            transcript.noteId = m_sqlQuery->value(DBTranscript::note_id).toLongLong();
+            transcript.voicePath = m_sqlQuery->value(DBTranscript::voice_path).toString();
+            transcript.startTime = m_sqlQuery->value(DBTranscript::start_time).toLongLong();
+            transcript.endTime = m_sqlQuery->value(DBTranscript::end_time).toLongLong();
+            transcript.text = m_sqlQuery->value(DBTranscript::segment_text).toString();
+
+            results.transcripts->append(transcript);
+        }
+    }
+
+    return isOK;
+}
+
+/**
+ * @brief TranscriptQryDbVisitor::prepareSqls
+ * @return true 成功
+ */
+bool TranscriptQryDbVisitor::prepareSqls()
+{
+    bool fPrepareOK = true;
+
+    if (nullptr != param.text) {
+        static constexpr char const *QUERY_TRANSCRIPT_FMT = "SELECT * FROM %s WHERE %s LIKE '%%%s%%' ESCAPE '\\' ORDER BY %s, %s;";
+
+        //转义LIKE通配符
+        QString keyword = *param.text;
+        keyword.replace("\\", "\\\\");
+        keyword.replace("%", "\\%");
+        keyword.replace("_", "\\_");
+        checkSqlStr(keyword);
+
+        QString querySql;
+        querySql.sprintf(QUERY_TRANSCRIPT_FMT,
+                         VNoteDbManager::TRANSCRIPT_TABLE_NAME,
+                         DBTranscript::transcriptColumnsName[DBTranscript::segment_text].toUtf8().data(),
+                         keyword.toUtf8().data(),
+                         DBTranscript::transcriptColumnsName[DBTranscript::voice_path].toUtf8().data(),
+                         DBTranscript::transcriptColumnsName[DBTranscript::start_time].toUtf8().data());
+
+        m_dbvSqls.append(querySql);
+    } else {
+        fPrepareOK = false;
+    }
+
+    return fPrepareOK;
+}
+
+/**
+ * @brief AddAttachmentDbVisitor::AddAttachmentDbVisitor
+ * @param db
+ * @param inParam 附件
+ * @param result
+ */
+AddAttachmentDbVisitor::AddAttachmentDbVisitor(QSqlDatabase &db, const void *inParam, void *result)
+    : DbVisitor(db, inParam, result)
+{
+}
+
+/**
+ * @brief AddAttachmentDbVisitor::prepareSqls
+ * 已存在的附件更新存入时间，避免清理线程删除刚刚重新存入的文件
+ * @return true 成功
+ */
+bool AddAttachmentDbVisitor::prepareSqls()
+{
+    bool fPrepareOK = true;
+    const VNoteAttachment *attachment = param.attachment;
+
+    if (nullptr != attachment && !attachment->hash.isEmpty()) {
+        static constexpr char const *REPLACE_FMT = "INSERT OR REPLACE INTO %s (%s,%s,%s,%s,%s) VALUES ('%s','%s',%d,%lld,'%s');";
+
+        QString hash = attachment->hash;
+        checkSqlStr(hash);
+        QString fileName = attachment->fileName;
+        checkSqlStr(fileName);
+        QDateTime storeTime = attachment->storeTime.isValid() ? attachment->storeTime : QDateTime::currentDateTime();
+
+        QString insertSql;
+        insertSql.sprintf(REPLACE_FMT,
+                          VNoteDbManager::ATTACHMENT_TABLE_NAME,
+                          DBAttachment::attachmentColumnsName[DBAttachment::hash].toUtf8().data(),
+                          DBAttachment::attachmentColumnsName[DBAttachment::file_name].toUtf8().data(),
+                          DBAttachment::attachmentColumnsName[DBAttachment::file_type].toUtf8().data(),
+                          DBAttachment::attachmentColumnsName[DBAttachment::file_size].toUtf8().data(),
+                          DBAttachment::attachmentColumnsName[DBAttachment::store_time].toUtf8().data(),
+                          hash.toUtf8().data(),
+                          fileName.toUtf8().data(),
+                          attachment->type,
+                          attachment->size,
+                          storeTime.toString(VNOTE_TIME_FMT).toUtf8().data());
+        m_dbvSqls.append(insertSql);
+    } else {
+        fPrepareOK = false;
+    }
+
+    return fPrepareOK;
+}
+
+/**
+ * @brief readAttachments
+ * 读取附件查询结果
+ * @param query 查询对象
+ * @param attachments 结果
+ */
+static void readAttachments(QSqlQuery *query, VNOTE_ATTACHMENTS *attachments)
+{
+    while (query->next()) {
+        VNoteAttachment attachment;
+
+        attachment.hash = query->value(DbVisitor::DBAttachment::hash).toString();
+        attachment.fileName = query->value(DbVisitor::DBAttachment::file_name).toString();
+        attachment.type = query->value(DbVisitor::DBAttachment::file_type).toInt();
+        attachment.size = query->value(DbVisitor::DBAttachment::file_size).toLongLong();
+        attachment.storeTime = QDateTime::fromString(query->value(DbVisitor::DBAttachment::store_time).toString(), VNOTE_TIME_FMT);
+
+        attachments->append(attachment);
+    }
+}
+
+/**
+ * @brief UnusedAttachmentQryDbVisitor::UnusedAttachmentQryDbVisitor
+ * @param db
+ * @param inParam 时间，只查询在此之前存入的附件
+ * @param result 结果
+ */
+UnusedAttachmentQryDbVisitor::UnusedAttachmentQryDbVisitor(QSqlDatabase &db, const void *inParam, void *result)
+    : DbVisitor(db, inParam, result)
+{
+}
+
+/**
+ * @brief UnusedAttachmentQryDbVisitor::visitorData
+ * @return true 成功
+ */
+bool UnusedAttachmentQryDbVisitor::visitorData()
+{
+    if (nullptr == results.attachments) {
+        return false;
+    }
+
+    readAttachments(m_sqlQuery.get(), results.attachments);
+    return true;
+}
+
+/**
+ * @brief UnusedAttachmentQryDbVisitor::prepareSqls
+ * @return true 成功
+ */
+bool UnusedAttachmentQryDbVisitor::prepareSqls()
+{
+    bool fPrepareOK = true;
+
+    if (nullptr != param.time) {
+        static constexpr char const *QUERY_UNUSED_FMT = "SELECT * FROM %s WHERE %s<'%s' AND NOT EXISTS (SELECT 1 FROM %s WHERE %s.%s=%s.%s);";
+
+        QString querySql;
+        querySql.sprintf(QUERY_UNUSED_FMT,
+                         VNoteDbManager::ATTACHMENT_TABLE_NAME,
+                         DBAttachment::attachmentColumnsName[DBAttachment::store_time].toUtf8().data(),
+                         param.time->toString(VNOTE_TIME_FMT).toUtf8().data(),
+                         VNoteDbManager::ATTACHMENT_REF_TABLE_NAME,
+                         VNoteDbManager::ATTACHMENT_REF_TABLE_NAME,
+                         DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::hash].toUtf8().data(),
+                         VNoteDbManager::ATTACHMENT_TABLE_NAME,
+                         DBAttachment::attachmentColumnsName[DBAttachment::hash].toUtf8().data());
+        m_dbvSqls.append(querySql);
+    } else {
+        fPrepareOK = false;
+    }
+
+    return fPrepareOK;
+}
+
+/**
+ * @brief AttachmentQryDbVisitor::AttachmentQryDbVisitor
+ * @param db
+ * @param inParam 哈希值
+ * @param result 结果
+ */
+AttachmentQryDbVisitor::AttachmentQryDbVisitor(QSqlDatabase &db, const void *inParam, void *result)
+    : DbVisitor(db, inParam, result)
+{
+}
+
+/**
+ * @brief AttachmentQryDbVisitor::visitorData
+ * @return true 成功
+ */
+bool AttachmentQryDbVisitor::visitorData()
+{
+    if (nullptr == results.attachments) {
+        return false;
+    }
+
+    readAttachments(m_sqlQuery.get(), results.attachments);
+    return true;
+}
+
+/**
+ * @brief AttachmentQryDbVisitor::prepareSqls
+ * @return true 成功
+ */
+bool AttachmentQryDbVisitor::prepareSqls()
+{
+    bool fPrepareOK = true;
+
+    if (nullptr != param.text) {
+        static constexpr char const *QUERY_FMT = "SELECT * FROM %s WHERE %s='%s';";
+
+        QString hash = *param.text;
+        checkSqlStr(hash);
+
+        QString querySql;
+        querySql.sprintf(QUERY_FMT,
+                         VNoteDbManager::ATTACHMENT_TABLE_NAME,
+                         DBAttachment::attachmentColumnsName[DBAttachment::hash].toUtf8().data(),
+                         hash.toUtf8().data());
+        m_dbvSqls.append(querySql);
+    } else {
+        fPrepareOK = false;
+    }
+
+    return fPrepareOK;
+}
+
+/**
+ * @brief DelAttachmentDbVisitor::DelAttachmentDbVisitor
+ * @param db
+ * @param inParam 附件，存入时间为查询到的存入时间
+ * @param result
+ */
+DelAttachmentDbVisitor::DelAttachmentDbVisitor(QSqlDatabase &db, const void *inParam, void *result)
+    : DbVisitor(db, inParam, result)
+{
+}
+
+/**
+ * @brief DelAttachmentDbVisitor::prepareSqls
+ * @return true 成功
+ */
+bool DelAttachmentDbVisitor::prepareSqls()
+{
+    bool fPrepareOK = true;
+    const VNoteAttachment *attachment = param.attachment;
+
+    if (nullptr != attachment && !attachment->hash.isEmpty()) {
+        static constexpr char const *DEL_FMT = "DELETE FROM %s WHERE %s='%s' AND %s<='%s' AND NOT EXISTS (SELECT 1 FROM %s WHERE %s='%s');";
+
+        QString hash = attachment->hash;
+        checkSqlStr(hash);
+
+        QString deleteSql;
+        deleteSql.sprintf(DEL_FMT,
+                          VNoteDbManager::ATTACHMENT_TABLE_NAME,
+                          DBAttachment::attachmentColumnsName[DBAttachment::hash].toUtf8().data(),
+                          hash.toUtf8().data(),
+                          DBAttachment::attachmentColumnsName[DBAttachment::store_time].toUtf8().data(),
+                          attachment->storeTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
+                          VNoteDbManager::ATTACHMENT_REF_TABLE_NAME,
+                          DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::hash].toUtf8().data(),
+                          hash.toUtf8().data());
+        m_dbvSqls.append(deleteSql);
+    } else {
+        fPrepareOK = false;
+    }
+
+    return fPrepareOK;
+}
+
+/**
+ * @brief ImportLibraryDbVisitor::ImportLibraryDbVisitor
+ * @param db
+ * @param inParam 导入的记事本和笔记
+ * @param result 写入新的记事本和笔记id
+ */
+ImportLibraryDbVisitor::ImportLibraryDbVisitor(QSqlDatabase &db, const void *inParam, void *result)
+    : DbVisitor(db, inParam, result)
+{
+}
+
+/**
+ * @brief ImportLibraryDbVisitor::visitorData
+ * 临时表中记事本以kind=0、笔记以kind=1记录在导入数据中的序号和新的id
+ * @return true 成功
+ */
+bool ImportLibraryDbVisitor::visitorData()
+{
+    bool isOK = false;
+
+    if (nullptr != results.library) {
+        isOK = true;
+
+        VNoteLibraryData *library = results.library;
+        QHash<qint64, qint64> folderIds;
+
+        while (m_sqlQuery->next()) {
+            int kind = m_sqlQuery->value(0).toInt();
+            int index = m_sqlQuery->value(1).toInt();
+            qint64 newId = m_sqlQuery->value(2).toLongLong();
+
+            if (0 == kind && index >= 0 && index < library->folders.size()) {
+                library->folders[index].newId = newId;
+                folderIds.insert(library->folders[index].id, newId);
+            } else if (1 == kind && index >= 0 && index < library->notes.size()) {
+                library->notes[index]->newNoteId = static_cast<qint32>(newId);
+            }
+        }
+
+        for (auto note : library->notes) {
+            note->newFolderId = folderIds.value(note->folderId, -1);
+        }
+    }
+
+    return isOK;
+}
+
+/**
+ * @brief ImportLibraryDbVisitor::prepareSqls
+ * 新记录的id由数据库分配，笔记的记事本id和附件引用的笔记id从临时表中查询
+ * @return true 成功
+ */
+bool ImportLibraryDbVisitor::prepareSqls()
+{
+    const VNoteLibraryData *library = param.library;
+
+    if (nullptr == library || library->folders.isEmpty()) {
+        return false;
+    }
+
+    static constexpr char const *MAP_TABLE_NAME = "vnote_import_map_tbl";
+    static constexpr char const *CREATE_MAP_FMT = "CREATE TEMP TABLE IF NOT EXISTS %s (kind INT, old_id INTEGER, new_id INTEGER);";
+    static constexpr char const *CLEAR_MAP_FMT = "DELETE FROM %s;";
+    static constexpr char const *INSERT_MAP_FMT = "INSERT INTO %s VALUES (%d, %d, last_insert_rowid());";
+    static constexpr char const *INSERT_FOLDER_FMT = "INSERT INTO %s (%s,%s,%s,%s,%s,%s,%s) VALUES ('%s', %d, %d, '%s', '%s', '%s', %d);";
+    static constexpr char const *INSERT_NOTE_FMT = "INSERT INTO %s (%s,%s,%s,%s,%s,%s,%s,%s,%s) VALUES ((SELECT new_id FROM %s WHERE kind=0 AND old_id=%d),%d,'%s','%s','%s','%s','%s',%d,%d);";
+    static constexpr char const *INSERT_REF_FMT = "INSERT INTO %s (%s,%s,%s) SELECT '%s',%s,%s FROM %s WHERE %s=(SELECT new_id FROM %s WHERE kind=1 AND old_id=%d);";
+    static constexpr char const *QUERY_MAP_FMT = "SELECT kind, old_id, new_id FROM %s;";
+
+    QString sql;
+    sql.sprintf(CREATE_MAP_FMT, MAP_TABLE_NAME);
+    m_dbvSqls.append(sql);
+    sql.sprintf(CLEAR_MAP_FMT, MAP_TABLE_NAME);
+    m_dbvSqls.append(sql);
+
+    //按记事本分组，同一记事本的笔记在记事本之后插入
+    QHash<qint64, QVector<int>> folderNotes;
+    for (int i = 0; i < library->notes.size(); i++) {
+        if (library->notes.at(i)->valid) {
+            folderNotes[library->notes.at(i)->folderId].append(i);
+        }
+    }
+
+    for (int folderIndex = 0; folderIndex < library->folders.size(); folderIndex++) {
+        const VNoteLibraryFolder &folder = library->folders.at(folderIndex);
+        const QVector<int> notes = folderNotes.value(folder.id);
+
+        QString folderName = folder.name;
+        checkSqlStr(folderName);
+        QDateTime createTime = folder.createTime.isValid() ? folder.createTime : QDateTime::currentDateTime();
+        QDateTime modifyTime = folder.modifyTime.isValid() ? folder.modifyTime : createTime;
+
+        sql.sprintf(INSERT_FOLDER_FMT,
+                    VNoteDbManager::FOLDER_TABLE_NAME,
+                    DBFolder::folderColumnsName[DBFolder::folder_name].toUtf8().data(),
+                    DBFolder::folderColumnsName[DBFolder::default_icon].toUtf8().data(),
+                    DBFolder::folderColumnsName[DBFolder::max_noteid].toUtf8().data(),
+                    DBFolder::folderColumnsName[DBFolder::create_time].toUtf8().data(),
+                    DBFolder::folderColumnsName[DBFolder::modify_time].toUtf8().data(),
+                    DBFolder::folderColumnsName[DBFolder::delete_time].toUtf8().data(),
+                    DBFolder::folderColumnsName[DBFolder::encrypt].toUtf8().data(),
+                    folderName.toUtf8().data(),
+                    folder.defaultIcon,
+                    notes.size(),
+                    createTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
+                    modifyTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
+                    modifyTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
+                    0);
+        m_dbvSqls.append(sql);
+        sql.sprintf(INSERT_MAP_FMT, MAP_TABLE_NAME, 0, folderIndex);
+        m_dbvSqls.append(sql);
+
+        for (int noteIndex : notes) {
+            const VNoteLibraryNote *note = library->notes.at(noteIndex);
+
+            QString noteTitle = note->title;
+            checkSqlStr(noteTitle);
+            QString metaData = note->metaData;
+            checkSqlStr(metaData);
+
+            sql.sprintf(INSERT_NOTE_FMT,
+                        VNoteDbManager::NOTES_TABLE_NAME,
+                        DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(),
+                        DBNote::noteColumnsName[DBNote::note_type].toUtf8().data(),
+                        DBNote::noteColumnsName[DBNote::note_title].toUtf8().data(),
+                        DBNote::noteColumnsName[DBNote::meta_data].toUtf8().data(),
+                        DBNote::noteColumnsName[DBNote::create_time].toUtf8().data(),
+                        DBNote::noteColumnsName[DBNote::modify_time].toUtf8().data(),
+                        DBNote::noteColumnsName[DBNote::delete_time].toUtf8().data(),
+                        DBNote::noteColumnsName[DBNote::is_top].toUtf8().data(),
+                        DBNote::noteColumnsName[DBNote::encrypt].toUtf8().data(),
+                        MAP_TABLE_NAME,
+                        folderIndex,
+                        note->noteType,
+                        noteTitle.toUtf8().data(),
+                        metaData.toUtf8().data(),
+                        note->createTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
+                        note->modifyTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
+                        note->modifyTime.toString(VNOTE_TIME_FMT).toUtf8().data(),
+                        note->isTop,
+                        0);
+            m_dbvSqls.append(sql);
+            sql.sprintf(INSERT_MAP_FMT, MAP_TABLE_NAME, 1, noteIndex);
+            m_dbvSqls.append(sql);
+
+            for (auto &hash : note->hashes) {
+                sql.sprintf(INSERT_REF_FMT,
+                            VNoteDbManager::ATTACHMENT_REF_TABLE_NAME,
+                            DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::hash].toUtf8().data(),
+                            DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::folder_id].toUtf8().data(),
+                            DBAttachmentRef::attachmentRefColumnsName[DBAttachmentRef::note_id].toUtf8().data(),
+                            hash.toUtf8().data(),
+                            DBNote::noteColumnsName[DBNote::folder_id].toUtf8().data(),
+                            DBNote::noteColumnsName[DBNote::note_id].toUtf8().data(),
+                            VNoteDbManager::NOTES_TABLE_NAME,
+                            DBNote::noteColumnsName[DBNote::note_id].toUtf8().data(),
+                            MAP_TABLE_NAME,
+                            noteIndex);
+                m_dbvSqls.append(sql);
+            }
+
+            //导入的语音与已有笔记中的语音相同时复制已有的转写分段
+            appendTranscriptCopySqls(QString("(SELECT new_id FROM %1 WHERE kind=0 AND old_id=%2)").arg(MAP_TABLE_NAME).arg(folderIndex),
+                                     QString("(SELECT new_id FROM %1 WHERE kind=1 AND old_id=%2)").arg(MAP_TABLE_NAME).arg(noteIndex),
+                                     note->metaData);
+        }
+    }
+
+    sql.sprintf(QUERY_MAP_FMT, MAP_TABLE_NAME);
+    m_dbvSqls.append(sql);
+
+    return true;
+}
@@ -26,6 +26,8 @@
 #include <QSqlQuery>
 #include <QScopedPointer>
 
+struct VNoteLibraryData;
+
 class DbVisitor
 {
 public:
@@ -101,17 +103,62 @@ public:
 
         static const QStringList saferColumnsName;
     };
+    //语音转写分段表字段
+    struct DBTranscript {
+        enum {
+            id = 0,
+            folder_id,
+            note_id,
+            voice_path,
+            start_time,
+            end_time,
+            segment_text,
+            create_time,
+        };
+
+        static const QStringList transcriptColumnsName;
+    };
+    //附件表字段
+    struct DBAttachment {
+        enum {
+            hash = 0,
+            file_name,
+            file_type,
+            file_size,
+            store_time,
+        };
+
+        static const QStringList attachmentColumnsName;
+    };
+    //附件引用表字段，一个笔记引用一个附件对应一行，附件的引用计数为行数
+    struct DBAttachmentRef {
+        enum {
+            hash = 0,
+            folder_id,
+            note_id,
+        };
+
+        static const QStringList attachmentRefColumnsName;
+    };
 
 protected:
     //Check & replace the "'" in the string.
     void checkSqlStr(QString &sql);
+    //按笔记内容重建笔记的附件引用，newNote为true时笔记id取新插入的记录
+    void appendAttachmentRefSqls(const VNoteItem *note, const QString &metaData, bool newNote = false);
+    //笔记引用其他笔记已转写的语音时复制转写分段，记事本id和笔记id为sql表达式
+    void appendTranscriptCopySqls(const QString &folderId, const QString &noteId, const QString &metaData);
     //sql处理的结果
     union {
         VNOTE_FOLDERS_MAP *folders;
         VNOTE_ALL_NOTES_MAP *notes;
+        VNOTE_ITEM_STATES *itemStates;
         VNoteFolder *newFolder;
         VNoteItem *newNote;
         SafetyDatas *safetyDatas;
+        VNOTE_TRANSCRIPTS *transcripts;
+        VNOTE_ATTACHMENTS *attachments;
+        VNoteLibraryData *library;
         qint32 *count;
         qint64 *id;
         void *ptr;
@@ -121,6 +168,12 @@ protected:
         const VNoteFolder *newFolder;
         const VNoteItem *newNote;
         const VDataSafer *safer;
+        const VNOTE_TRANSCRIPTS *transcripts;
+        const VNoteAttachment *attachment;
+        const VNoteLibraryData *library;
+        const QDateTime *time;
+        const QString *text;
+        const QVector<qint64> *ids;
         const qint32 *count;
         const qint64 *id;
         const void *ptr;
@@ -191,6 +244,16 @@ public:
     virtual bool prepareSqls() override;
 };
 
+//记事项修改状态查询，不读取笔记内容
+class NoteStateQryDbVisitor : public DbVisitor
+{
+public:
+    explicit NoteStateQryDbVisitor(QSqlDatabase &db, const void *inParam, void *result);
+
+    virtual bool visitorData() override;
+    virtual bool prepareSqls() override;
+};
+
 //添加记事项
 class AddNoteDbVisitor : public DbVisitor
 {
@@ -245,4 +308,71 @@ public:
 
     virtual bool prepareSqls() override;
 };
+
+//添加语音转写分段，同一语音的旧分段会被替换
+class AddTranscriptDbVisitor : public DbVisitor
+{
+public:
+    explicit AddTranscriptDbVisitor(QSqlDatabase &db, const void *inParam, void *result);
+
+    virtual bool prepareSqls() override;
+};
+
+//按关键字查询语音转写分段
+class TranscriptQryDbVisitor : public DbVisitor
+{
+public:
+    explicit TranscriptQryDbVisitor(QSqlDatabase &db, const void *inParam, void *result);
+
+    virtual bool visitorData() override;
+    virtual bool prepareSqls() override;
+};
+
+//登记附件，已存在时忽略
+class AddAttachmentDbVisitor : public DbVisitor
+{
+public:
+    explicit AddAttachmentDbVisitor(QSqlDatabase &db, const void *inParam, void *result);
+
+    virtual bool prepareSqls() override;
+};
+
+//查询指定时间前登记且没有笔记引用的附件
+class UnusedAttachmentQryDbVisitor : public DbVisitor
+{
+public:
+    explicit UnusedAttachmentQryDbVisitor(QSqlDatabase &db, const void *inParam, void *result);
+
+    virtual bool visitorData() override;
+    virtual bool prepareSqls() override;
+};
+
+//按哈希值查询附件
+class AttachmentQryDbVisitor : public DbVisitor
+{
+public:
+    explicit AttachmentQryDbVisitor(QSqlDatabase &db, const void *inParam, void *result);
+
+    virtual bool visitorData() override;
+    virtual bool prepareSqls() override;
+};
+
+//删除没有引用的附件记录，删除前重新存入或被引用的附件保留
+class DelAttachmentDbVisitor : public DbVisitor
+{
+public:
+    explicit DelAttachmentDbVisitor(QSqlDatabase &db, const void *inParam, void *result);
+
+    virtual bool prepareSqls() override;
+};
+
+//导入记事本归档，记事本和笔记使用新的id，新旧id对应关系记录在临时表中并返回
+class ImportLibraryDbVisitor : public DbVisitor
+{
+public:
+    explicit ImportLibraryDbVisitor(QSqlDatabase &db, const void *inParam, void *result);
+
+    virtual bool visitorData() override;
+    virtual bool prepareSqls() override;
+};
 #endif
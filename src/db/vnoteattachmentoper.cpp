@@ -0,0 +1,137 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnoteattachmentoper.h"
+#include "db/vnotedbmanager.h"
+#include "db/dbvisitor.h"
+#include "common/vnoteattachmentstore.h"
+
+#include <DLog>
+
+#include <QRegularExpression>
+
+/**
+ * @brief VNoteAttachmentOper::addAttachment
+ * @param attachment 附件
+ * @return true 成功
+ */
+bool VNoteAttachmentOper::addAttachment(const VNoteAttachment &attachment)
+{
+    AddAttachmentDbVisitor addVisitor(VNoteDbManager::instance()->getVNoteDb(), &attachment, nullptr);
+
+    if (Q_UNLIKELY(!VNoteDbManager::instance()->insertData(&addVisitor))) {
+        qCritical() << "Add attachment failed:" << attachment.fileName;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief VNoteAttachmentOper::getAttachment
+ * @param hash 哈希值
+ * @param attachment 查询结果
+ * @return true 附件存在
+ */
+bool VNoteAttachmentOper::getAttachment(const QString &hash, VNoteAttachment &attachment)
+{
+    VNOTE_ATTACHMENTS attachments;
+    AttachmentQryDbVisitor qryVisitor(VNoteDbManager::instance()->getVNoteDb(), &hash, &attachments);
+
+    if (!VNoteDbManager::instance()->queryData(&qryVisitor) || attachments.isEmpty()) {
+        return false;
+    }
+
+    attachment = attachments.first();
+    return true;
+}
+
+/**
+ * @brief VNoteAttachmentOper::unusedAttachments
+ * @param before 存入时间上限
+ * @return 引用计数为0的附件
+ */
+VNOTE_ATTACHMENTS VNoteAttachmentOper::unusedAttachments(const QDateTime &before)
+{
+    VNOTE_ATTACHMENTS attachments;
+    UnusedAttachmentQryDbVisitor qryVisitor(VNoteDbManager::instance()->getVNoteDb(), &before, &attachments);
+    VNoteDbManager::instance()->queryData(&qryVisitor);
+    return attachments;
+}
+
+/**
+ * @brief VNoteAttachmentOper::removeAttachment
+ * 查询后重新存入或被笔记引用的附件不会删除
+ * @param attachment 查询到的附件
+ * @return true 记录已删除，可以删除文件
+ */
+bool VNoteAttachmentOper::removeAttachment(const VNoteAttachment &attachment)
+{
+    DelAttachmentDbVisitor delVisitor(VNoteDbManager::instance()->getVNoteDb(), &attachment, nullptr);
+
+    if (!VNoteDbManager::instance()->deleteData(&delVisitor)) {
+        return false;
+    }
+
+    VNoteAttachment current;
+    return !getAttachment(attachment.hash, current);
+}
+
+/**
+ * @brief VNoteAttachmentOper::attachmentHashes
+ * 附件文件名为64位十六进制的sha256值，笔记中出现附件路径或附件url即视为引用
+ * @param content 笔记内容
+ * @return 去重后的哈希值
+ */
+QStringList VNoteAttachmentOper::attachmentHashes(const QString &content)
+{
+    static const QRegularExpression rx("(?:/images/|/voicenote/|vnote://attachment/)([0-9a-f]{64})\\.\\w+");
+
+    QStringList hashes;
+    QRegularExpressionMatchIterator it = rx.globalMatch(content);
+    while (it.hasNext()) {
+        QString hash = it.next().captured(1);
+        if (!hashes.contains(hash)) {
+            hashes.append(hash);
+        }
+    }
+    return hashes;
+}
+
+/**
+ * @brief VNoteAttachmentOper::voiceAttachmentPaths
+ * @param content 笔记内容
+ * @return 去重后的语音路径
+ */
+QStringList VNoteAttachmentOper::voiceAttachmentPaths(const QString &content)
+{
+    static const QRegularExpression rx("/voicenote/([0-9a-f]{64}\\.\\w+)");
+
+    QString voiceDir = VNoteAttachmentStore::attachmentDir(VNoteAttachment::Voice);
+    QStringList paths;
+    QRegularExpressionMatchIterator it = rx.globalMatch(content);
+    while (it.hasNext()) {
+        QString path = voiceDir + "/" + it.next().captured(1);
+        if (!paths.contains(path)) {
+            paths.append(path);
+        }
+    }
+    return paths;
+}
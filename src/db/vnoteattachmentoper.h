@@ -0,0 +1,46 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTEATTACHMENTOPER_H
+#define VNOTEATTACHMENTOPER_H
+
+#include "common/datatypedef.h"
+
+#include <QStringList>
+
+//附件表及附件引用表操作
+class VNoteAttachmentOper
+{
+public:
+    //登记附件，已存在时更新存入时间
+    bool addAttachment(const VNoteAttachment &attachment);
+    //查询附件，不存在时返回false
+    bool getAttachment(const QString &hash, VNoteAttachment &attachment);
+    //查询指定时间前存入且没有笔记引用的附件
+    VNOTE_ATTACHMENTS unusedAttachments(const QDateTime &before);
+    //删除没有引用的附件记录，返回记录是否已删除
+    bool removeAttachment(const VNoteAttachment &attachment);
+    //笔记内容中引用的附件哈希值
+    static QStringList attachmentHashes(const QString &content);
+    //笔记内容中引用的附件仓库语音路径，同一语音可能被多个笔记引用
+    static QStringList voiceAttachmentPaths(const QString &content);
+};
+
+#endif // VNOTEATTACHMENTOPER_H
@@ -254,6 +254,68 @@ bool VNoteDbManager::deleteData(DbVisitor *visitor /*in/out*/)
     return deleteOK;
 }
 
+/**
+ * @brief VNoteDbManager::insertDataInTransaction
+ * 批量插入时只在结束时写入一次磁盘，失败时不留下部分数据
+ * @param visitor
+ * @return true 成功
+ */
+bool VNoteDbManager::insertDataInTransaction(DbVisitor *visitor /*in/out*/)
+{
+    CHECK_DB_INIT();
+
+    bool insertOK = true;
+
+    if (nullptr == visitor) {
+        qCritical() << "insertDataInTransaction invalid parameter: visitor is null";
+        return false;
+    }
+
+    if (Q_UNLIKELY(!visitor->prepareSqls())) {
+        qCritical() << "prepare sqls failed!";
+        return false;
+    }
+
+    m_dbLock.lock();
+
+    if (!m_vnoteDB.transaction()) {
+        qCritical() << "begin transaction failed:" << m_vnoteDB.lastError().text();
+        m_dbLock.unlock();
+        return false;
+    }
+
+    for (auto it : visitor->dbvSqls()) {
+        if (!it.trimmed().isEmpty()) {
+            if (!visitor->sqlQuery()->exec(it)) {
+                qCritical() << "insert data failed:" << it
+                            << " reason:" << visitor->sqlQuery()->lastError().text();
+                insertOK = false;
+                break;
+            }
+        }
+    }
+
+    //提交前读取结果并释放查询，未结束的查询语句会导致提交失败
+    if (insertOK && !visitor->visitorData()) {
+        insertOK = false;
+        qCritical() << "Query new data failed: visitorData failed.";
+    }
+    visitor->sqlQuery()->finish();
+
+    if (insertOK && !m_vnoteDB.commit()) {
+        qCritical() << "commit transaction failed:" << m_vnoteDB.lastError().text();
+        insertOK = false;
+    }
+
+    if (!insertOK) {
+        m_vnoteDB.rollback();
+    }
+
+    m_dbLock.unlock();
+
+    return insertOK;
+}
+
 /**
  * @brief VNoteDbManager::hasOldDataBase
  * @return true 存在老数据库
@@ -44,6 +44,9 @@ public:
     static constexpr char const *NOTES_TABLE_NAME = "vnote_items_tbl";
     static constexpr char const *NOTES_KEY = "note_id";
     static constexpr char const *CATEGORY_TABLE_NAME = "vnote_category_tbl";
+    static constexpr char const *TRANSCRIPT_TABLE_NAME = "vnote_transcript_tbl";
+    static constexpr char const *ATTACHMENT_TABLE_NAME = "vnote_attachment_tbl";
+    static constexpr char const *ATTACHMENT_REF_TABLE_NAME = "vnote_attachment_ref_tbl";
 
     //icon_path: Not used, maybe used in future
     //expand_fields are place holder, will be used in future
@@ -99,7 +102,35 @@ public:
             expand_filed4 TEXT, \
             expand_filed5 TEXT, \
             expand_filed6 TEXT \
-         );";
+         ); \
+         CREATE TABLE IF NOT EXISTS vnote_transcript_tbl(\
+            id INTEGER PRIMARY KEY AUTOINCREMENT, \
+            folder_id INTEGER, \
+            note_id INTEGER, \
+            voice_path TEXT NOT NULL, \
+            start_time INT DEFAULT 0, \
+            end_time INT DEFAULT 0, \
+            segment_text TEXT, \
+            create_time DATETIME NOT NULL DEFAULT (STRFTIME ('%Y-%m-%d %H:%M:%f','now','localtime')), \
+            expand_filed1 INT, \
+            expand_filed2 TEXT \
+         ); \
+         CREATE INDEX IF NOT EXISTS vnote_transcript_voice_idx ON vnote_transcript_tbl(voice_path); \
+         CREATE INDEX IF NOT EXISTS vnote_transcript_note_idx ON vnote_transcript_tbl(note_id); \
+         CREATE TABLE IF NOT EXISTS vnote_attachment_tbl(\
+            hash TEXT PRIMARY KEY, \
+            file_name TEXT NOT NULL, \
+            file_type INT DEFAULT 0, \
+            file_size INT DEFAULT 0, \
+            store_time DATETIME NOT NULL DEFAULT (STRFTIME ('%Y-%m-%d %H:%M:%f','now','localtime')) \
+         ); \
+         CREATE TABLE IF NOT EXISTS vnote_attachment_ref_tbl(\
+            hash TEXT NOT NULL, \
+            folder_id INTEGER, \
+            note_id INTEGER \
+         ); \
+         CREATE INDEX IF NOT EXISTS vnote_attachment_ref_hash_idx ON vnote_attachment_ref_tbl(hash); \
+         CREATE INDEX IF NOT EXISTS vnote_attachment_ref_note_idx ON vnote_attachment_ref_tbl(note_id);";
 
     enum DB_TABLE {
         VNOTE_FOLDER_TBL,
@@ -116,6 +147,8 @@ public:
     bool queryData(DbVisitor *visitor /*in/out*/);
     //执行删除操作
     bool deleteData(DbVisitor *visitor /*in/out*/);
+    //在一个事务中执行插入操作，任一语句失败时全部回滚
+    bool insertDataInTransaction(DbVisitor *visitor /*in/out*/);
     //是否存在老记事本数据库
     static bool hasOldDataBase();
 signals:
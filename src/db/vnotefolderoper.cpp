@@ -22,6 +22,10 @@
 #include "common/utils.h"
 #include "common/vnoteforlder.h"
 #include "common/vnotedatamanager.h"
+#include "common/vnotetitleindex.h"
+#include "common/vnoteitem.h"
+#include "common/vnotelibraryarchive.h"
+#include "common/metadataparser.h"
 #include "db/vnotedbmanager.h"
 #include "db/dbvisitor.h"
 #include "globaldef.h"
@@ -31,6 +35,7 @@
 #include <QVariant>
 #include <QObject>
 #include <QDateTime>
+#include <QHash>
 
 /**
  * @brief VNoteFolderOper::VNoteFolderOper
@@ -108,6 +113,8 @@ bool VNoteFolderOper::renameVNoteFolder(const QString &folderName)
             m_folder->modifyTime = oldModifyTime;
 
             isUpdateOK = false;
+        } else {
+            VNoteTitleIndex::instance()->updateTitle(VNoteTitleIndex::FolderName, m_folder->id, m_folder->name);
         }
     }
 
@@ -116,9 +123,10 @@ bool VNoteFolderOper::renameVNoteFolder(const QString &folderName)
 
 /**
  * @brief VNoteFolderOper::loadVNoteFolders
+ * @param loadIcon 是否加载图标
  * @return 所有记事本数据
  */
-VNOTE_FOLDERS_MAP *VNoteFolderOper::loadVNoteFolders()
+VNOTE_FOLDERS_MAP *VNoteFolderOper::loadVNoteFolders(bool loadIcon)
 {
     VNOTE_FOLDERS_MAP *foldersMap = new VNOTE_FOLDERS_MAP();
 
@@ -126,6 +134,7 @@ VNOTE_FOLDERS_MAP *VNoteFolderOper::loadVNoteFolders()
     foldersMap->autoRelease = true;
 
     FolderQryDbVisitor folderVisitor(VNoteDbManager::instance()->getVNoteDb(), nullptr, foldersMap);
+    folderVisitor.extraData().data.flag = !loadIcon;
 
     if (!VNoteDbManager::instance()->queryData(&folderVisitor)) {
         qCritical() << "Query failed!";
@@ -283,3 +292,73 @@ QPixmap VNoteFolderOper::getDefaultIcon(qint32 index, IconsType type)
 {
     return VNoteDataManager::instance()->getDefaultIcon(index, type);
 }
+
+/**
+ * @brief VNoteFolderOper::addImportedFolders
+ * 在主线程中调用，图标在此时加载
+ * @param library 导入数据，id已替换为数据库中的新id
+ * @return 新的记事本
+ */
+QList<VNoteFolder *> VNoteFolderOper::addImportedFolders(const VNoteLibraryData *library)
+{
+    const int defalutIconCnt = 10;
+
+    QList<VNoteFolder *> newFolders;
+    //归档中的记事本id对应的新记事本
+    QHash<qint64, VNoteFolder *> folderMap;
+
+    for (auto &folderData : library->folders) {
+        if (folderData.newId < 0) {
+            continue;
+        }
+
+        VNoteFolder *folder = new VNoteFolder();
+        folder->id = folderData.newId;
+        folder->name = folderData.name;
+        folder->defaultIcon = (folderData.defaultIcon >= 0 && folderData.defaultIcon < defalutIconCnt)
+                                  ? folderData.defaultIcon
+                                  : getDefaultIcon();
+        folder->createTime = folderData.createTime;
+        folder->modifyTime = folderData.modifyTime;
+        folder->deleteTime = folderData.modifyTime;
+        folder->UI.icon = VNoteDataManager::instance()->getDefaultIcon(folder->defaultIcon, IconsType::DefaultIcon);
+        folder->UI.grayIcon = VNoteDataManager::instance()->getDefaultIcon(folder->defaultIcon, IconsType::DefaultGrayIcon);
+
+        VNoteDataManager::instance()->addFolder(folder);
+        folderMap.insert(folderData.id, folder);
+        newFolders.append(folder);
+    }
+
+    MetaDataParser metaParser;
+
+    for (auto noteData : library->notes) {
+        VNoteFolder *folder = folderMap.value(noteData->folderId, nullptr);
+        if (nullptr == folder || noteData->newNoteId < 0) {
+            continue;
+        }
+
+        VNoteItem *note = new VNoteItem();
+        note->noteId = noteData->newNoteId;
+        note->folderId = folder->id;
+        note->noteType = noteData->noteType;
+        note->isTop = noteData->isTop;
+        note->noteTitle = noteData->title;
+        note->createTime = noteData->createTime;
+        note->modifyTime = noteData->modifyTime;
+        note->deleteTime = noteData->modifyTime;
+
+        QVariant metaData(noteData->metaData);
+        note->setMetadata(metaData);
+        metaParser.parse(metaData, note);
+        note->setFolder(folder);
+        folder->maxNoteIdRef()++;
+
+        if (nullptr == VNoteDataManager::instance()->addNote(note)) {
+            QScopedPointer<VNoteItem> autoRelease(note);
+        }
+    }
+
+    qInfo() << "Imported folders:" << newFolders.size() << "notes:" << library->notes.size();
+
+    return newFolders;
+}
@@ -25,6 +25,8 @@
 
 #include <QPixmap>
 
+struct VNoteLibraryData;
+
 //记事本表操作
 class VNoteFolderOper
 {
@@ -32,8 +34,8 @@ public:
     explicit VNoteFolderOper(VNoteFolder *folder = nullptr);
     //所有记事项是否加载
     inline bool isNoteItemLoaded();
-    //获取数据
-    VNOTE_FOLDERS_MAP *loadVNoteFolders();
+    //获取数据，loadIcon为false时不加载图标
+    VNOTE_FOLDERS_MAP *loadVNoteFolders(bool loadIcon = true);
     //添加记事本
     VNoteFolder *addFolder(VNoteFolder &folder);
     //获取记事本数据
@@ -55,6 +57,8 @@ public:
     bool deleteVNoteFolder(VNoteFolder *folder);
     //重命名记事本
     bool renameVNoteFolder(const QString &folderName);
+    //已写入数据库的导入记事本及笔记加入内存数据，返回新的记事本
+    QList<VNoteFolder *> addImportedFolders(const VNoteLibraryData *library);
 
 protected:
     VNoteFolder *m_folder {nullptr};
@@ -26,6 +26,8 @@
 #include "common/vnoteitem.h"
 #include "common/vnoteforlder.h"
 #include "common/vnotedatamanager.h"
+#include "common/vnotetitleindex.h"
+#include "common/vnoteattributeindex.h"
 #include "db/dbvisitor.h"
 
 #include <DLog>
@@ -67,6 +69,47 @@ VNOTE_ALL_NOTES_MAP *VNoteItemOper::loadAllVNotes()
     return notesMap;
 }
 
+/**
+ * @brief VNoteItemOper::loadVNotes
+ * @param noteIds 记事项id
+ * @return 记事项数据
+ */
+VNOTE_ALL_NOTES_MAP *VNoteItemOper::loadVNotes(const QVector<qint64> &noteIds)
+{
+    VNOTE_ALL_NOTES_MAP *notesMap = new VNOTE_ALL_NOTES_MAP();
+    notesMap->autoRelease = true;
+
+    if (noteIds.isEmpty()) {
+        return notesMap;
+    }
+
+    NoteQryDbVisitor noteVisitor(VNoteDbManager::instance()->getVNoteDb(), &noteIds, notesMap);
+
+    if (!VNoteDbManager::instance()->queryData(&noteVisitor)) {
+        qCritical() << "Query notes failed!";
+    }
+
+    return notesMap;
+}
+
+/**
+ * @brief VNoteItemOper::loadNoteStates
+ * 只查询id、记事本、修改时间和置顶属性，用于判断哪些笔记需要重新加载
+ * @return 所有记事项的修改状态
+ */
+VNOTE_ITEM_STATES VNoteItemOper::loadNoteStates()
+{
+    VNOTE_ITEM_STATES states;
+
+    NoteStateQryDbVisitor stateVisitor(VNoteDbManager::instance()->getVNoteDb(), nullptr, &states);
+
+    if (!VNoteDbManager::instance()->queryData(&stateVisitor)) {
+        qCritical() << "Query note states failed!";
+    }
+
+    return states;
+}
+
 /**
  * @brief VNoteItemOper::modifyNoteTitle
  * @param title
@@ -92,6 +135,11 @@ bool VNoteItemOper::modifyNoteTitle(const QString &title)
             m_note->modifyTime = oldModifyTime;
 
             isUpdateOK = false;
+        } else {
+            VNoteDataManager::instance()->updateDataVersion();
+            VNoteTitleIndex::instance()->updateTitle(VNoteTitleIndex::NoteTitle, m_note->noteId,
+                                                     m_note->noteTitle, m_note->folderId);
+            VNoteAttributeIndex::instance()->updateNote(m_note);
         }
     }
 
@@ -100,9 +148,10 @@ bool VNoteItemOper::modifyNoteTitle(const QString &title)
 
 /**
  * @brief VNoteItemOper::updateNote
+ * @param touch 是否更新修改时间，数据迁移等非用户修改时为false
  * @return true 成功
  */
-bool VNoteItemOper::updateNote()
+bool VNoteItemOper::updateNote(bool touch)
 {
     bool isUpdateOK = true;
 
@@ -116,7 +165,9 @@ bool VNoteItemOper::updateNote()
 
         metaParser.makeMetaData(m_note, m_note->metaDataRef());
 
-        m_note->modifyTime = QDateTime::currentDateTime();
+        if (touch) {
+            m_note->modifyTime = QDateTime::currentDateTime();
+        }
 
         //Reset the max voice id when no voice file.
         if (!m_note->haveVoice()) {
@@ -131,6 +182,9 @@ bool VNoteItemOper::updateNote()
             m_note->modifyTime = oldModifyTime;
 
             isUpdateOK = false;
+        } else {
+            VNoteDataManager::instance()->updateDataVersion();
+            VNoteAttributeIndex::instance()->updateNote(m_note);
         }
     }
 
@@ -308,6 +362,9 @@ bool VNoteItemOper::updateTop(int value)
         UpdateNoteTopDbVisitor updateNoteVisitor(VNoteDbManager::instance()->getVNoteDb(), m_note, nullptr);
         if (!Q_UNLIKELY(!VNoteDbManager::instance()->updateData(&updateNoteVisitor))) {
             updateOK = true;
+            //置顶状态参与搜索过滤，缓存的搜索结果需失效
+            VNoteDataManager::instance()->updateDataVersion();
+            VNoteAttributeIndex::instance()->updateNote(m_note);
         } else {
             m_note->isTop = !value;
         }
@@ -327,6 +384,9 @@ bool VNoteItemOper::updateFolderId(VNoteItem *data)
         UpdateNoteFolderIdDbVisitor updateNoteVisitor(VNoteDbManager::instance()->getVNoteDb(), data, nullptr);
         if (!Q_UNLIKELY(!VNoteDbManager::instance()->updateData(&updateNoteVisitor))) {
             updateOK = true;
+            VNoteDataManager::instance()->updateDataVersion();
+            VNoteTitleIndex::instance()->updateParent(VNoteTitleIndex::NoteTitle, data->noteId, data->folderId);
+            VNoteAttributeIndex::instance()->updateNote(data);
         }
     }
     return updateOK;
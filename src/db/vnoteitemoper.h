@@ -30,10 +30,14 @@ public:
     explicit VNoteItemOper(VNoteItem *note = nullptr);
     //获取所有记事项数据
     VNOTE_ALL_NOTES_MAP *loadAllVNotes();
+    //获取指定的记事项数据
+    VNOTE_ALL_NOTES_MAP *loadVNotes(const QVector<qint64> &noteIds);
+    //获取所有记事项的修改状态
+    VNOTE_ITEM_STATES loadNoteStates();
     //修改名称
     bool modifyNoteTitle(const QString &title);
-    //更新数据
-    bool updateNote();
+    //更新数据，touch为false时不改变修改时间
+    bool updateNote(bool touch = true);
     //添加记事项
     VNoteItem *addNote(VNoteItem &note);
     //获取记事项
@@ -0,0 +1,132 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnotetranscriptoper.h"
+#include "common/vnoteitem.h"
+#include "db/vnotedbmanager.h"
+#include "db/dbvisitor.h"
+
+#include <DLog>
+
+/**
+ * @brief VNoteTranscriptOper::VNoteTranscriptOper
+ * @param note 语音所属笔记
+ */
+VNoteTranscriptOper::VNoteTranscriptOper(VNoteItem *note)
+    : m_note(note)
+{
+}
+
+/**
+ * @brief VNoteTranscriptOper::saveTranscript
+ * @param voicePath 语音路径
+ * @param voiceSize 语音时长
+ * @param text 转写文本
+ * @return true 成功
+ */
+bool VNoteTranscriptOper::saveTranscript(const QString &voicePath, qint64 voiceSize, const QString &text)
+{
+    if (nullptr == m_note || voicePath.isEmpty()) {
+        return false;
+    }
+
+    VNOTE_TRANSCRIPTS transcripts = splitTranscript(text, voiceSize);
+    for (auto &it : transcripts) {
+        it.folderId = m_note->folderId;
+        it.noteId = m_note->noteId;
+        it.voicePath = voicePath;
+    }
+
+    return addTranscripts(transcripts);
+}
+
+/**
+ * @brief VNoteTranscriptOper::addTranscripts
+ * @param transcripts 同一语音的转写分段
+ * @return true 成功
+ */
+bool VNoteTranscriptOper::addTranscripts(const VNOTE_TRANSCRIPTS &transcripts)
+{
+    if (transcripts.isEmpty()) {
+        return false;
+    }
+
+    AddTranscriptDbVisitor addVisitor(VNoteDbManager::instance()->getVNoteDb(), &transcripts, nullptr);
+
+    if (Q_UNLIKELY(!VNoteDbManager::instance()->insertData(&addVisitor))) {
+        qCritical() << "Add transcript failed:" << transcripts.first().voicePath;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief VNoteTranscriptOper::searchTranscripts
+ * @param keyword 搜索关键字
+ * @return 包含关键字的分段，按语音和起始时间排序
+ */
+VNOTE_TRANSCRIPTS VNoteTranscriptOper::searchTranscripts(const QString &keyword)
+{
+    VNOTE_TRANSCRIPTS transcripts;
+
+    if (!keyword.isEmpty()) {
+        TranscriptQryDbVisitor qryVisitor(VNoteDbManager::instance()->getVNoteDb(), &keyword, &transcripts);
+        VNoteDbManager::instance()->queryData(&qryVisitor);
+    }
+
+    return transcripts;
+}
+
+/**
+ * @brief VNoteTranscriptOper::splitTranscript
+ * 转写服务只返回整段文本，分段时间按每句字数占总字数的比例估算
+ * @param text 转写文本
+ * @param voiceSize 语音时长
+ * @return 分段数据
+ */
+VNOTE_TRANSCRIPTS VNoteTranscriptOper::splitTranscript(const QString &text, qint64 voiceSize)
+{
+    static const QString sentenceEnd = QString::fromUtf8("。！？；.!?;\n");
+
+    VNOTE_TRANSCRIPTS transcripts;
+    int totalLength = text.length();
+
+    if (0 == totalLength) {
+        return transcripts;
+    }
+
+    int begin = 0;
+    for (int i = 0; i < totalLength; i++) {
+        if (sentenceEnd.contains(text.at(i)) || i == totalLength - 1) {
+            QString sentence = text.mid(begin, i - begin + 1).trimmed();
+            if (!sentence.isEmpty()) {
+                VNoteTranscript transcript;
+                transcript.startTime = voiceSize * begin / totalLength;
+                transcript.endTime = voiceSize * (i + 1) / totalLength;
+                transcript.text = sentence;
+                transcripts.append(transcript);
+            }
+            begin = i + 1;
+        }
+    }
+
+    return transcripts;
+}
@@ -0,0 +1,44 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTETRANSCRIPTOPER_H
+#define VNOTETRANSCRIPTOPER_H
+
+#include "common/datatypedef.h"
+
+//语音转写分段表操作
+class VNoteTranscriptOper
+{
+public:
+    explicit VNoteTranscriptOper(VNoteItem *note = nullptr);
+    //保存一段语音的转写结果
+    bool saveTranscript(const QString &voicePath, qint64 voiceSize, const QString &text);
+    //添加转写分段
+    bool addTranscripts(const VNOTE_TRANSCRIPTS &transcripts);
+    //按关键字查询转写分段
+    VNOTE_TRANSCRIPTS searchTranscripts(const QString &keyword);
+    //按句子拆分转写文本，并按字数比例估算每句的起止时间
+    static VNOTE_TRANSCRIPTS splitTranscript(const QString &text, qint64 voiceSize);
+
+protected:
+    VNoteItem *m_note {nullptr};
+};
+
+#endif // VNOTETRANSCRIPTOPER_H
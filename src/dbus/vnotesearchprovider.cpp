@@ -0,0 +1,374 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "vnotesearchprovider.h"
+#include "common/vnoteitem.h"
+#include "common/vnoteforlder.h"
+#include "common/vnotesearchranker.h"
+#include "common/vnotesearchquery.h"
+#include "common/vnotetitleindex.h"
+#include "common/vnoteattributeindex.h"
+#include "db/vnotedbmanager.h"
+#include "db/vnoteitemoper.h"
+#include "db/vnotefolderoper.h"
+#include "db/vnotetranscriptoper.h"
+
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+
+#include <algorithm>
+
+/**
+ * @brief VNoteSearchProvider::serviceName
+ * @return D-Bus服务名
+ */
+const char *VNoteSearchProvider::serviceName()
+{
+    return "com.deepin.voicenote.SearchProvider";
+}
+
+/**
+ * @brief VNoteSearchProvider::servicePath
+ * @return D-Bus对象路径
+ */
+const char *VNoteSearchProvider::servicePath()
+{
+    return "/com/deepin/voicenote/SearchProvider";
+}
+
+/**
+ * @brief VNoteSearchProvider::VNoteSearchProvider
+ * @param parent
+ */
+VNoteSearchProvider::VNoteSearchProvider(QObject *parent)
+    : QObject(parent)
+{
+    //长时间没有查询时退出，由D-Bus按需重新启动
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(IdleTimeout);
+    connect(&m_idleTimer, &QTimer::timeout, qApp, &QCoreApplication::quit);
+}
+
+/**
+ * @brief VNoteSearchProvider::registerService
+ * @return true 注册成功
+ */
+bool VNoteSearchProvider::registerService()
+{
+    QDBusConnection connection = QDBusConnection::sessionBus();
+
+    if (!connection.registerService(serviceName())) {
+        qCritical() << "Register search provider service failed:" << connection.lastError().message();
+        return false;
+    }
+
+    if (!connection.registerObject(servicePath(), this, QDBusConnection::ExportAllSlots)) {
+        qCritical() << "Register search provider object failed:" << connection.lastError().message();
+        connection.unregisterService(serviceName());
+        return false;
+    }
+
+    m_idleTimer.start();
+
+    return true;
+}
+
+/**
+ * @brief VNoteSearchProvider::Search
+ * @param query 查询内容，支持结构化查询条件
+ * @param offset 起始位置
+ * @param limit 最多返回的结果数，不大于MaxResultLimit，小于等于0时使用默认值
+ * @return json格式结果
+ */
+QString VNoteSearchProvider::Search(const QString &query, int offset, int limit)
+{
+    m_idleTimer.start();
+
+    reloadIfNeed();
+
+    QString key = query.trimmed();
+    if (key != m_lastQuery || key.isEmpty()) {
+        m_lastQuery = key;
+        m_lastHits = key.isEmpty() ? VNOTE_SEARCH_HITS() : searchNotes(key);
+    }
+
+    if (limit <= 0) {
+        limit = DefaultResultLimit;
+    }
+
+    return makeResult(m_lastHits, qMax(0, offset), qMin(limit, static_cast<int>(MaxResultLimit)));
+}
+
+/**
+ * @brief VNoteSearchProvider::reloadIfNeed
+ */
+void VNoteSearchProvider::reloadIfNeed()
+{
+    QFileInfo dbInfo(VNoteDbManager::instance()->getVNoteDb().databaseName());
+    QDateTime dataTime = dbInfo.lastModified();
+
+    if (!m_dataTime.isValid() || dataTime != m_dataTime) {
+        m_dataTime = dataTime;
+        m_lastQuery.clear();
+        m_lastHits.clear();
+        loadFolders();
+        loadNotes();
+    }
+}
+
+/**
+ * @brief VNoteSearchProvider::loadFolders
+ * 记事本数量少，每次全部重新加载，不加载图标
+ */
+void VNoteSearchProvider::loadFolders()
+{
+    m_folderNames.clear();
+    VNoteTitleIndex::instance()->clear(VNoteTitleIndex::FolderName);
+
+    VNoteFolderOper folderOper;
+    QScopedPointer<VNOTE_FOLDERS_MAP> foldersMap(folderOper.loadVNoteFolders(false));
+    for (auto folder : foldersMap->folders) {
+        m_folderNames.insert(folder->id, folder->name);
+        VNoteTitleIndex::instance()->updateTitle(VNoteTitleIndex::FolderName, folder->id, folder->name);
+    }
+}
+
+/**
+ * @brief VNoteSearchProvider::loadNotes
+ * 先只查询笔记的修改状态，与缓存比较后只读取新增和修改过的笔记，
+ * 编辑器定时保存后的查询只需要重新加载正在编辑的笔记
+ */
+void VNoteSearchProvider::loadNotes()
+{
+    VNoteItemOper noteOper;
+    VNOTE_ITEM_STATES states = noteOper.loadNoteStates();
+
+    for (auto noteId : m_notes.keys()) {
+        if (!states.contains(noteId)) {
+            removeNote(noteId);
+        }
+    }
+
+    QVector<qint64> changedIds;
+    for (auto it = states.constBegin(); it != states.constEnd(); ++it) {
+        auto noteIt = m_notes.constFind(it.key());
+        if (noteIt == m_notes.constEnd() || noteIt->modifyTime != it->modifyTime
+                || noteIt->folderId != it->folderId || noteIt->isTop != it->isTop) {
+            changedIds.append(it.key());
+        }
+    }
+
+    if (!changedIds.isEmpty()) {
+        //首次加载时直接查询全部笔记
+        QScopedPointer<VNOTE_ALL_NOTES_MAP> notesMap(m_notes.isEmpty() ? noteOper.loadAllVNotes()
+                                                                         : noteOper.loadVNotes(changedIds));
+        for (auto folderNotes : notesMap->notes) {
+            for (auto note : folderNotes->folderNotes) {
+                addNote(note);
+            }
+        }
+    }
+
+    m_averageLength = m_notes.isEmpty() ? 0 : static_cast<qreal>(m_totalLength) / m_notes.size();
+
+    qInfo() << "Search provider loaded notes:" << changedIds.size() << "total:" << m_notes.size();
+}
+
+/**
+ * @brief VNoteSearchProvider::addNote
+ * 正文只去除标签，不经过富文本解析，加载大量笔记时也不占用过多时间
+ * @param note 笔记
+ */
+void VNoteSearchProvider::addNote(VNoteItem *note)
+{
+    removeNote(note->noteId);
+
+    ProviderNote providerNote;
+    providerNote.folderId = note->folderId;
+    providerNote.title = note->noteTitle;
+    providerNote.modifyTime = note->modifyTime;
+    providerNote.isTop = note->isTop;
+
+    if (!note->htmlCode.isEmpty()) {
+        providerNote.text = VNoteSearchRanker::htmlText(note->htmlCode);
+        if (note->haveVoice()) {
+            providerNote.voiceData = note->htmlCode;
+        }
+    } else {
+        for (auto block : note->datas.dataConstRef()) {
+            if (VNoteBlock::Voice == block->getType()) {
+                providerNote.voiceData.append(block->ptrVoice->voicePath);
+                providerNote.voiceData.append('\n');
+            }
+
+            if (!block->blockText.isEmpty()) {
+                providerNote.text.append(block->blockText);
+                providerNote.text.append('\n');
+            }
+        }
+    }
+
+    m_totalLength += providerNote.title.length() + providerNote.text.length();
+    m_notes.insert(note->noteId, providerNote);
+
+    VNoteTitleIndex::instance()->updateTitle(VNoteTitleIndex::NoteTitle, note->noteId,
+                                             note->noteTitle, note->folderId);
+    VNoteAttributeIndex::instance()->updateNote(note);
+}
+
+/**
+ * @brief VNoteSearchProvider::removeNote
+ * @param noteId 笔记id
+ */
+void VNoteSearchProvider::removeNote(qint64 noteId)
+{
+    auto it = m_notes.find(noteId);
+    if (it == m_notes.end()) {
+        return;
+    }
+
+    m_totalLength -= it->title.length() + it->text.length();
+    m_notes.erase(it);
+
+    VNoteTitleIndex::instance()->removeTitle(VNoteTitleIndex::NoteTitle, noteId);
+    VNoteAttributeIndex::instance()->removeNote(noteId);
+}
+
+/**
+ * @brief VNoteSearchProvider::searchNotes
+ * @param query 查询内容
+ * @return 按相关度排序的结果
+ */
+VNOTE_SEARCH_HITS VNoteSearchProvider::searchNotes(const QString &query)
+{
+    VNOTE_SEARCH_HITS hits;
+    VNoteSearchQuery searchQuery = VNoteSearchQuery::parse(query);
+    QString keyword = searchQuery.keyword();
+
+    //过滤条件在属性索引中求出候选笔记
+    QList<qint64> candidates;
+    if (searchQuery.hasFilters()) {
+        for (auto &hit : searchQuery.execute()) {
+            candidates.append(hit.noteId);
+        }
+    } else {
+        candidates = m_notes.keys();
+    }
+
+    QHash<qint64, qint64> titleHits;
+    QHash<qint64, QString> transcriptHits;
+    if (!keyword.isEmpty()) {
+        titleHits = VNoteTitleIndex::instance()->search(VNoteTitleIndex::NoteTitle, keyword);
+
+        //转写命中的笔记使用转写分段作为摘要
+        VNoteTranscriptOper transcriptOper;
+        for (auto &transcript : transcriptOper.searchTranscripts(keyword)) {
+            if (!transcriptHits.contains(transcript.noteId)
+                    && m_notes.value(transcript.noteId).voiceData.contains(transcript.voicePath)) {
+                transcriptHits.insert(transcript.noteId, transcript.text);
+            }
+        }
+    }
+
+    for (auto noteId : candidates) {
+        auto it = m_notes.constFind(noteId);
+        if (it == m_notes.constEnd()) {
+            continue;
+        }
+
+        VNoteSearchHit hit;
+        hit.folderId = it->folderId;
+        hit.noteId = noteId;
+        hit.titleRanges = VNoteSearchRanker::findRanges(it->title, keyword);
+
+        bool transcriptMatched = transcriptHits.contains(noteId);
+        bool indexOnly = hit.titleRanges.isEmpty() && titleHits.contains(noteId);
+        bool bodyMatched = it->text.contains(keyword, Qt::CaseInsensitive);
+
+        if (!keyword.isEmpty() && hit.titleRanges.isEmpty() && !indexOnly && !bodyMatched && !transcriptMatched) {
+            continue;
+        }
+
+        if (!bodyMatched && transcriptMatched) {
+            hit.snippet = VNoteSearchRanker::makeSnippet(transcriptHits.value(noteId), keyword, hit.snippetRanges);
+        } else {
+            hit.snippet = VNoteSearchRanker::makeSnippet(it->text, keyword, hit.snippetRanges);
+        }
+
+        //标题索引命中按一次标题命中（权重3）计算，转写命中按一次正文命中计算
+        qreal extraFrequency = (indexOnly ? 3 : 0) + (transcriptMatched ? 1 : 0);
+        hit.score = VNoteSearchRanker::score(it->title, it->text, keyword, m_averageLength, extraFrequency);
+        hits.append(hit);
+    }
+
+    //相关度相同时最近修改的在前
+    std::sort(hits.begin(), hits.end(), [this](const VNoteSearchHit &hit1, const VNoteSearchHit &hit2) {
+        if (!qFuzzyCompare(hit1.score, hit2.score)) {
+            return hit1.score > hit2.score;
+        }
+        return m_notes.value(hit1.noteId).modifyTime > m_notes.value(hit2.noteId).modifyTime;
+    });
+
+    return hits;
+}
+
+/**
+ * @brief VNoteSearchProvider::makeResult
+ * @param hits 排序后的结果
+ * @param offset 起始位置
+ * @param limit 结果数
+ * @return json格式结果
+ */
+QString VNoteSearchProvider::makeResult(const VNOTE_SEARCH_HITS &hits, int offset, int limit) const
+{
+    QJsonArray results;
+
+    //offset和limit来自D-Bus调用方，先限制在结果范围内，避免相加溢出
+    int count = hits.size();
+    offset = qBound(0, offset, count);
+    int end = offset + qMin(qMax(0, limit), count - offset);
+
+    for (int i = offset; i < end; i++) {
+        const VNoteSearchHit &hit = hits.at(i);
+        const ProviderNote note = m_notes.value(hit.noteId);
+
+        QJsonObject result;
+        result.insert("noteId", hit.noteId);
+        result.insert("folderId", hit.folderId);
+        result.insert("folderName", m_folderNames.value(hit.folderId));
+        result.insert("title", note.title);
+        result.insert("snippet", hit.snippet);
+        result.insert("modifyTime", note.modifyTime.toString(Qt::ISODate));
+        result.insert("score", hit.score);
+        results.append(result);
+    }
+
+    QJsonObject object;
+    object.insert("total", hits.size());
+    object.insert("offset", offset);
+    object.insert("results", results);
+
+    return QString::fromUtf8(QJsonDocument(object).toJson(QJsonDocument::Compact));
+}
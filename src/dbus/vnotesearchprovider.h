@@ -0,0 +1,101 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef VNOTESEARCHPROVIDER_H
+#define VNOTESEARCHPROVIDER_H
+
+#include "common/datatypedef.h"
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QTimer>
+
+//桌面搜索服务，供启动器查询笔记标题、正文和语音转写内容
+//以--search-provider参数单独启动，不创建主窗口和网页编辑器
+//笔记纯文本在加载时预先提取，数据库更新后只重新加载变化的笔记
+class VNoteSearchProvider : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.deepin.voicenote.SearchProvider")
+public:
+    enum {
+        //默认返回的结果数
+        DefaultResultLimit = 20,
+        //单次最多返回的结果数
+        MaxResultLimit = 100,
+        //空闲超时退出，单位:毫秒
+        IdleTimeout = 5 * 60 * 1000
+    };
+
+    static const char *serviceName();
+    static const char *servicePath();
+
+    explicit VNoteSearchProvider(QObject *parent = nullptr);
+
+    //注册D-Bus服务
+    bool registerService();
+
+public slots:
+    //查询笔记，返回json：{"total":总数,"offset":起始位置,"results":[...]}
+    //结果按相关度排序，同一查询翻页时使用缓存的结果
+    QString Search(const QString &query, int offset, int limit);
+
+private:
+    //预先提取的笔记内容
+    struct ProviderNote {
+        qint64 folderId {-1};
+        QString title;
+        QString text;
+        QDateTime modifyTime;
+        bool isTop {false};
+        //语音笔记的html或语音路径，用于确认转写对应的语音仍在笔记中
+        QString voiceData;
+    };
+
+    //数据库更新后重新加载
+    void reloadIfNeed();
+    //加载记事本名称
+    void loadFolders();
+    //按修改状态增量加载笔记并更新索引
+    void loadNotes();
+    //提取笔记内容并加入索引
+    void addNote(VNoteItem *note);
+    //从缓存和索引中删除笔记
+    void removeNote(qint64 noteId);
+    //查询并排序
+    VNOTE_SEARCH_HITS searchNotes(const QString &query);
+    //生成一页结果
+    QString makeResult(const VNOTE_SEARCH_HITS &hits, int offset, int limit) const;
+
+    QHash<qint64, ProviderNote> m_notes;
+    QHash<qint64, QString> m_folderNames;
+    qreal m_averageLength {0};
+    //所有笔记标题和正文的总长度，用于增量更新平均长度
+    qint64 m_totalLength {0};
+    //已加载数据对应的数据库修改时间
+    QDateTime m_dataTime;
+    //最近一次查询的结果
+    QString m_lastQuery;
+    VNOTE_SEARCH_HITS m_lastHits;
+    QTimer m_idleTimer;
+};
+
+#endif // VNOTESEARCHPROVIDER_H
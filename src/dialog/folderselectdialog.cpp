@@ -212,6 +212,9 @@ void FolderSelectDialog::initUI()
     m_view->expand(notepadRootIndex);
     m_view->setFrameShape(DTreeView::NoFrame);
 
+    m_searchEdit = new DSearchEdit(this);
+    m_searchEdit->setFixedWidth(VNOTE_SELECTDIALOG_W - 30);
+
     m_labMove = new DLabel(this);
     DFontSizeManager::instance()->bind(m_labMove, DFontSizeManager::T6, QFont::Medium);
     m_labMove->setText(DApplication::translate("FolderSelectDialog", "Move Notes"));
@@ -280,6 +283,8 @@ void FolderSelectDialog::initUI()
     //    mainLayout->addWidget(m_noteInfo, 0, Qt::AlignCenter);
     mainLayout->addLayout(noteInfoLayout, 0);
     mainLayout->addSpacing(10);
+    mainLayout->addWidget(m_searchEdit, 0, Qt::AlignHCenter);
+    mainLayout->addSpacing(10);
     mainLayout->addWidget(viewFrame, 1);
     mainLayout->addSpacing(10);
     mainLayout->addLayout(actionBarLayout);
@@ -313,6 +318,8 @@ void FolderSelectDialog::initConnections()
     });
     //字体切换长度适应
     connect(qGuiApp, &QGuiApplication::fontChanged, this, &FolderSelectDialog::onFontChanged);
+
+    connect(m_searchEdit, &DSearchEdit::textChanged, this, &FolderSelectDialog::onFilterTextChanged);
 }
 
 /**
@@ -440,6 +447,21 @@ void FolderSelectDialog::onVNoteFolderSelectChange(const QItemSelection &selecte
     m_confirmBtn->setEnabled(!!selected.indexes().size());
 }
 
+/**
+ * @brief FolderSelectDialog::onFilterTextChanged
+ * @param text 过滤关键字
+ */
+void FolderSelectDialog::onFilterTextChanged(const QString &text)
+{
+    m_model->setFilterKeyword(text);
+    //根节点可能被重新过滤，保持展开
+    m_view->expand(m_model->index(0, 0));
+    //选中项被过滤后确定按钮不可用
+    if (!m_view->selectionModel()->hasSelection()) {
+        m_confirmBtn->setEnabled(false);
+    }
+}
+
 /**
  * @brief FolderSelectDialog::hideEvent
  * @param event
@@ -449,6 +471,8 @@ void FolderSelectDialog::hideEvent(QHideEvent *event)
 {
     //取消按钮的hover状态
     m_closeButton->setAttribute(Qt::WA_UnderMouse, false);
+    //对话框会被复用，关闭时清除过滤
+    m_searchEdit->clear();
     m_view->setFocus(Qt::MouseFocusReason);
     DAbstractDialog::hideEvent(event);
 }
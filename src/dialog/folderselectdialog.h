@@ -30,6 +30,7 @@
 #include <DSuggestButton>
 #include <DLabel>
 #include <DAbstractDialog>
+#include <DSearchEdit>
 
 #include <QStandardItemModel>
 #include <QList>
@@ -90,6 +91,8 @@ public:
     void onVNoteFolderSelectChange(const QItemSelection &selected, const QItemSelection &deselected);
     //字体切换长度适应
     void onFontChanged();
+    //过滤记事本
+    void onFilterTextChanged(const QString &text);
 
 protected:
     //初始化布局
@@ -115,6 +118,7 @@ private:
     int m_notesNumber = 0;
     DLabel *m_labMove {nullptr};
     FolderSelectView *m_view {nullptr};
+    DSearchEdit *m_searchEdit {nullptr};
     DWindowCloseButton *m_closeButton {nullptr};
     LeftViewSortFilter *m_model {nullptr};
     LeftViewDelegate *m_delegate {nullptr};
@@ -20,6 +20,7 @@
 */
 
 #include "dialog/imageviewerdialog.h"
+#include "common/vnoteimagevariant.h"
 
 #include <DLog>
 #include <DGuiApplicationHelper>
@@ -55,18 +56,19 @@ ImageViewerDialog::~ImageViewerDialog()
  */
 void ImageViewerDialog::open(const QString &filepath)
 {
+    //获取图片显示的最大大小（显示屏大小的80%）
+    const QRect screenRect = qApp->desktop()->screenGeometry(QCursor::pos());
+    int maxWidth = int(screenRect.width() * 0.8);
+    int maxHeight = int(screenRect.height() * 0.8);
+
+    //显示区域不超过显示图尺寸时使用显示图，不解码完整原图
     QImage image;
-    QImageReader reader(filepath);
+    QImageReader reader(VNoteImageVariant::pathForSize(filepath, QSize(maxWidth, maxHeight)));
     reader.setDecideFormatFromContent(true);
     if (!reader.canRead() || !reader.read(&image)) {
         return;
     }
 
-    //获取图片显示的最大大小（显示屏大小的80%）
-    const QRect screenRect = qApp->desktop()->screenGeometry(QCursor::pos());
-    int maxWidth = int(screenRect.width() * 0.8);
-    int maxHeight = int(screenRect.height() * 0.8);
-
     //当图片过大时缩放图片
     if (image.width() > maxWidth || image.height() > maxHeight) {
         //设置图片保存纵横比平滑模式自适应控件大小
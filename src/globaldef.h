@@ -49,14 +49,22 @@
 //Audio device polling time in milliseconds
 #define AUDIO_DEV_CHECK_TIME 1000
 
+//Search as you type delay time in milliseconds
+#define SEARCH_INPUT_DELAY_TIME 300
+
 //********App setting data key****************
 #define VNOTE_MAINWND_SZ_KEY "old._app_main_wnd_sz_key_"
 #define VNOTE_EXPORT_TEXT_PATH_KEY "old._app_export_text_path_key"
 #define VNOTE_EXPORT_VOICE_PATH_KEY "old._app_export_voice_path_key"
+#define VNOTE_INLINE_IMAGE_MIGRATED_KEY "old._app_inline_image_migrated_key"
+#define VNOTE_TRANSCRIPT_BACKFILLED_KEY "old._app_transcript_backfilled_key"
 #define VNOTE_AUDIO_SELECT "base.audiosource.select"
 #define VNOTE_FOLDER_SORT "base.folder_sort.folder_sort_data"
 #define VNOTE_NOTEPAD_LIST_SHOW "base.notepadlist.show"
 #define VNOTE_NOTEPAD_ENCRYPTION_KEY "base.encryption.key"
+#define VNOTE_EDITOR_CACHE_SIZE "base.editor.cache_size"
+#define VNOTE_IMAGE_CODEC "base.image.codec"
+#define VNOTE_IMAGE_QUALITY "base.image.quality"
 //********************************************
 
 //Time format
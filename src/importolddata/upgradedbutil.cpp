@@ -25,6 +25,7 @@
 #include "db/vnoteitemoper.h"
 #include "common/vnoteforlder.h"
 #include "common/vnoteitem.h"
+#include "common/vnotefilecopier.h"
 #include "globaldef.h"
 #include "setting.h"
 
@@ -223,11 +224,8 @@ void UpgradeDbUtil::doFolderNoteUpgrade(qint64 newFolderId, qint64 oldFolderId)
 
                         QString targetPath = appAudioPath + newVoiceName;
 
-                        QFile oldFile(ptrBlock->ptrVoice->voicePath);
-
-                        if (!oldFile.copy(targetPath)) {
-                            qInfo() << "Copy file failed:" << targetPath
-                                    << " error:" << oldFile.errorString();
+                        if (!VNoteFileCopier::copy(ptrBlock->ptrVoice->voicePath, targetPath)) {
+                            qInfo() << "Copy file failed:" << targetPath;
                         } else {
                             ptrBlock->ptrVoice->voicePath = targetPath;
                         }
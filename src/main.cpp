@@ -24,8 +24,11 @@
 #include "globaldef.h"
 #include "common/performancemonitor.h"
 #include "common/utils.h"
+#include "common/vnoteattachmentschemehandler.h"
+#include "dbus/vnotesearchprovider.h"
 
 #include <QDir>
+#include <QCoreApplication>
 #include <QOpenGLContext>
 #include <QSurfaceFormat>
 
@@ -42,6 +45,23 @@ DWIDGET_USE_NAMESPACE
 
 int main(int argc, char *argv[])
 {
+    //桌面搜索服务只查询数据，不创建界面
+    if (2 == argc && "--search-provider" == QString(argv[1])) {
+        QCoreApplication app(argc, argv);
+        app.setOrganizationName("deepin");
+        app.setApplicationName(DEEPIN_VOICE_NOTE);
+
+        DLogManager::registerConsoleAppender();
+        DLogManager::registerFileAppender();
+
+        VNoteSearchProvider provider;
+        if (!provider.registerService()) {
+            return 1;
+        }
+
+        return app.exec();
+    }
+
     PerformanceMonitor::initializeAppStart();
     if (!QString(qgetenv("XDG_CURRENT_DESKTOP")).toLower().startsWith("deepin")) {
         setenv("XDG_CURRENT_DESKTOP", "Deepin", 1);
@@ -64,6 +84,9 @@ int main(int argc, char *argv[])
         dir.removeRecursively();
     }
 
+    //编辑区附件协议需在创建应用前注册
+    VNoteAttachmentSchemeHandler::registerScheme();
+
     VNoteApplication app(argc, argv);
     if (!DPlatformWindowHandle::pluginVersion().isEmpty()) {
         app.setAttribute(Qt::AA_DontCreateNativeWidgetSiblings, true);
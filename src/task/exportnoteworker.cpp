@@ -22,8 +22,8 @@
 #include "globaldef.h"
 #include "common/vnoteitem.h"
 #include "common/metadataparser.h"
-#include "common/setting.h"
 #include "common/utils.h"
+#include "common/vnotefilecopier.h"
 
 #include <DLog>
 
@@ -31,9 +31,11 @@
 #include <QDateTime>
 #include <QFile>
 #include <QFileInfo>
+#include <QMutexLocker>
 
 /**
  * @brief ExportNoteWorker::ExportNoteWorker
+ * 单线程导出
  * @param dirPath 导出目录
  * @param exportType 导出类型
  * @param note 绑定记事项数据
@@ -43,53 +45,86 @@
 ExportNoteWorker::ExportNoteWorker(const QString &dirPath, ExportType exportType,
                                    const QList<VNoteItem *> &noteList, const QString &defaultName, QObject *parent)
     : VNTask(parent)
-    , m_exportType(exportType)
-    , m_exportPath(dirPath)
-    , m_exportName(defaultName)
+    , m_context(new VNoteExportContext)
+{
+    m_context->exportType = exportType;
+    m_context->exportPath = dirPath;
+    m_context->exportName = defaultName;
     //笔记列表
-    , m_noteList(noteList)
+    m_context->notes = noteList;
+    m_context->runningWorkers = 1;
+}
+
+/**
+ * @brief ExportNoteWorker::ExportNoteWorker
+ * 多个线程共享上下文并行导出，创建者需设置上下文中的线程数
+ * @param context 导出共享上下文
+ * @param parent
+ */
+ExportNoteWorker::ExportNoteWorker(const QSharedPointer<VNoteExportContext> &context, QObject *parent)
+    : VNTask(parent)
+    , m_context(context)
 {
 }
 
 /**
  * @brief ExportNoteWorker::run
- * 执行导出操作
+ * 循环领取笔记导出，直到全部领取、出错或被取消
  */
 void ExportNoteWorker::run()
 {
-    ExportError error = checkPath();
+    ExportError error = m_context->notes.isEmpty() ? NoteInvalid : checkPath();
 
     if (ExportOK == error) {
-        if (ExportText == m_exportType) {
-            error = exportText();
-            setting::instance()->setOption(VNOTE_EXPORT_TEXT_PATH_KEY, m_exportPath);
-        } else if (ExportVoice == m_exportType) {
-            error = exportAllVoice();
-            setting::instance()->setOption(VNOTE_EXPORT_VOICE_PATH_KEY, m_exportPath);
-        } else if (ExportHtml == m_exportType) {
-            error = exportAsHtml();
-            setting::instance()->setOption(VNOTE_EXPORT_TEXT_PATH_KEY, m_exportPath);
+        int total = m_context->notes.size();
+        while (0 == m_context->cancelled.loadAcquire()) {
+            int index = m_context->nextNote.fetchAndAddOrdered(1);
+            if (index >= total) {
+                break;
+            }
+
+            error = exportNote(m_context->notes.at(index));
+            if (ExportOK != error && NoteInvalid != error) {
+                break;
+            }
+            emit exportProgress(m_context->finishedNotes.fetchAndAddOrdered(1) + 1, total);
         }
-    } else {
-        qCritical() << "Export note error: m_exportType=" << m_exportType;
     }
 
-    emit exportFinished(error);
+    if (ExportOK != error && NoteInvalid != error) {
+        //保留第一个错误，其他线程不再继续
+        m_context->error.testAndSetOrdered(ExportOK, error);
+        m_context->cancelled.storeRelease(1);
+        qCritical() << "Export note error:" << error << "exportType:" << m_context->exportType;
+    } else if (m_context->notes.isEmpty()) {
+        m_context->error.storeRelease(NoteInvalid);
+    }
+
+    //最后一个结束的线程通知导出完成
+    if (!m_context->runningWorkers.deref()) {
+        int state = m_context->error.loadAcquire();
+        if (ExportOK == state && m_context->nextNote.loadAcquire() < m_context->notes.size()) {
+            state = ExportCancelled;
+        }
+        emit exportFinished(state);
+    }
 }
 
 /**
  * @brief ExportNoteWorker::checkPath
+ * 每个线程开始时检查，目录已存在时创建操作直接成功
  * @return 错误码
  */
 ExportNoteWorker::ExportError ExportNoteWorker::checkPath()
 {
     ExportError error = ExportOK;
 
-    QFileInfo exportDir(m_exportPath);
+    const QString &exportPath = m_context->exportPath;
+    QFileInfo exportDir(exportPath);
 
-    if (!m_exportPath.isEmpty()) {
+    if (!exportPath.isEmpty()) {
         if (!exportDir.exists()) {
-            if (!QDir().mkpath(m_exportPath)) {
+            if (!QDir().mkpath(exportPath)) {
                 error = PathDenied;
             }
         } else if (!exportDir.isWritable()) {
@@ -102,94 +137,108 @@ ExportNoteWorker::ExportError ExportNoteWorker::checkPath()
     return error;
 }
 
+/**
+ * @brief ExportNoteWorker::exportNote
+ * @param note 笔记
+ * @return 错误码
+ */
+ExportNoteWorker::ExportError ExportNoteWorker::exportNote(VNoteItem *note)
+{
+    ExportError error = NoteInvalid;
+
+    if (ExportText == m_context->exportType) {
+        error = exportText(note);
+    } else if (ExportVoice == m_context->exportType) {
+        error = exportAllVoice(note);
+    } else if (ExportHtml == m_context->exportType) {
+        error = exportAsHtml(note);
+    }
+
+    return error;
+}
+
 /**
  * @brief ExportNoteWorker::exportText
+ * @param note 笔记
  * @return 错误码
  * 导出文本
  */
-ExportNoteWorker::ExportError ExportNoteWorker::exportText()
+ExportNoteWorker::ExportError ExportNoteWorker::exportText(VNoteItem *note)
 {
-    ExportError error = ExportOK;
-    //存在note
-    if (m_noteList.size()) {
-        for (auto noteData : m_noteList) {
-            if (!noteData->haveText()) {
-                continue;
-            }
-            QString filePath = "";
-            //没有指定保存名称，则设置默认名称为笔记标题
-            if (m_exportName.isEmpty()) {
-                QString baseFileName = m_exportPath + "/" + Utils::filteredFileName(noteData->noteTitle, "note");
-                QString fileSuffix = ".txt";
-                filePath = getExportFileName(baseFileName, fileSuffix);
-            } else {
-                filePath = m_exportPath + "/" + m_exportName;
-            }
-            QFile out(filePath);
-            if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) {
-                return Savefailed; //保存失败
-            }
-            //富文本数据需要转换为纯文本
-            if (!noteData->htmlCode.isEmpty()) {
-                QTextDocument doc;
-                doc.setHtml(noteData->htmlCode);
-                out.write(doc.toPlainText().toUtf8());
-            } else {
-                for (auto it : noteData->datas.datas) {
-                    if (VNoteBlock::Text == it->getType()) {
-                        out.write(it->blockText.toUtf8());
-                        out.write("\n");
-                    }
-                }
+    if (nullptr == note) {
+        return NoteInvalid;
+    }
+    if (!note->haveText()) {
+        return ExportOK;
+    }
+
+    QString filePath = "";
+    //没有指定保存名称，则设置默认名称为笔记标题
+    if (m_context->exportName.isEmpty()) {
+        QString baseFileName = m_context->exportPath + "/" + Utils::filteredFileName(note->noteTitle, "note");
+        QString fileSuffix = ".txt";
+        filePath = getExportFileName(baseFileName, fileSuffix);
+    } else {
+        filePath = m_context->exportPath + "/" + m_context->exportName;
+    }
+    QFile out(filePath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return Savefailed; //保存失败
+    }
+    //富文本数据需要转换为纯文本
+    if (!note->htmlCode.isEmpty()) {
+        QTextDocument doc;
+        doc.setHtml(note->htmlCode);
+        out.write(doc.toPlainText().toUtf8());
+    } else {
+        for (auto it : note->datas.datas) {
+            if (VNoteBlock::Text == it->getType()) {
+                out.write(it->blockText.toUtf8());
+                out.write("\n");
             }
-            out.close();
         }
-    } else {
-        error = NoteInvalid;
     }
-    return error;
+    out.close();
+    return ExportOK;
 }
 
 /**
  * @brief ExportNoteWorker::exportAllVoice
+ * @param note 笔记
  * @return 错误码
  * 导出语音
  */
-ExportNoteWorker::ExportError ExportNoteWorker::exportAllVoice()
+ExportNoteWorker::ExportError ExportNoteWorker::exportAllVoice(VNoteItem *note)
 {
     ExportError error = ExportOK;
-    //存在note
-    if (m_noteList.size()) {
-        for (auto noteData : m_noteList) {
-            if (!noteData->haveVoice()) {
-                continue;
-            }
-            if (noteData->htmlCode.isEmpty()) {
-                for (auto it : noteData->datas.datas) {
-                    error = exportOneVoice(it);
-                    //某一个保存失败则后续的不再进行保存操作
-                    if (Savefailed == error) {
-                        return error;
-                    }
-                }
-            } else {
-                //富文本笔记
-                for (auto it : noteData->getVoiceJsons()) {
-                    error = exportOneVoice(it);
-                    //某一个保存失败则后续的不再进行保存操作
-                    if (Savefailed == error) {
-                        return error;
-                    }
-                }
+
+    if (nullptr == note) {
+        return NoteInvalid;
+    }
+    if (!note->haveVoice()) {
+        return error;
+    }
+    if (note->htmlCode.isEmpty()) {
+        for (auto it : note->datas.datas) {
+            error = exportOneVoice(it);
+            //某一个保存失败则后续的不再进行保存操作
+            if (Savefailed == error) {
+                return error;
             }
         }
     } else {
-        error = NoteInvalid;
+        //富文本笔记
+        for (auto it : note->getVoiceJsons()) {
+            error = exportOneVoice(it);
+            //某一个保存失败则后续的不再进行保存操作
+            if (Savefailed == error) {
+                return error;
+            }
+        }
     }
 
     return error;
 }
-
 /**
  * @brief ExportNoteWorker::exportOneVoice
  * 导出语音
@@ -217,10 +266,10 @@ ExportNoteWorker::ExportError ExportNoteWorker::exportOneVoice(VNoteBlock *noteb
     ExportError error = ExportOK;
 
     if (noteblock && noteblock->blockType == VNoteBlock::Voice) {
-        QString baseFileName = m_exportPath + "/" + noteblock->ptrVoice->voiceTitle;
+        QString baseFileName = m_context->exportPath + "/" + noteblock->ptrVoice->voiceTitle;
         QString fileSuffix = ".mp3";
         QString dstFileName = getExportFileName(baseFileName, fileSuffix);
-        if (!QFile::copy(noteblock->ptrVoice->voicePath, dstFileName)) {
+        if (!VNoteFileCopier::copy(noteblock->ptrVoice->voicePath, dstFileName)) {
             error = Savefailed; //保存失败
         }
     } else {
@@ -233,45 +282,77 @@ ExportNoteWorker::ExportError ExportNoteWorker::exportOneVoice(VNoteBlock *noteb
 /**
  * @brief ExportNoteWorker::exportAsHtml
  * 将笔记导出为Html
+ * @param note 笔记
  * @return 错误码
  */
-ExportNoteWorker::ExportError ExportNoteWorker::exportAsHtml()
+ExportNoteWorker::ExportError ExportNoteWorker::exportAsHtml(VNoteItem *note)
 {
-    ExportError error = ExportOK;
-    for (auto note : m_noteList) {
-        if (!note->haveText()) {
-            continue;
-        }
-        QString filePath = "";
-        //没有指定保存名称，则设置默认名称为笔记标题
-        if (m_exportName.isEmpty()) {
-            QString baseFileName = m_exportPath + "/" + Utils::filteredFileName(note->noteTitle, "note");
-            QString fileSuffix = ".html";
-            filePath = getExportFileName(baseFileName, fileSuffix);
-        } else {
-            filePath = m_exportPath + "/" + m_exportName;
-        }
-        QFile out(filePath);
-        if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            return Savefailed; //保存失败
-        }
-        if (!out.write(note->getFullHtml().toUtf8())) {
-            return Savefailed; //保存失败
-        }
+    if (nullptr == note) {
+        return NoteInvalid;
     }
-    return error;
+    if (!note->haveText()) {
+        return ExportOK;
+    }
+
+    QString filePath = "";
+    //没有指定保存名称，则设置默认名称为笔记标题
+    if (m_context->exportName.isEmpty()) {
+        QString baseFileName = m_context->exportPath + "/" + Utils::filteredFileName(note->noteTitle, "note");
+        QString fileSuffix = ".html";
+        filePath = getExportFileName(baseFileName, fileSuffix);
+    } else {
+        filePath = m_context->exportPath + "/" + m_context->exportName;
+    }
+    QFile out(filePath);
+    if (!out.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return Savefailed; //保存失败
+    }
+    //html及图片数据直接写入文件
+    if (!note->writeFullHtml(&out)) {
+        return Savefailed; //保存失败
+    }
+    return ExportOK;
 }
 
+/**
+ * @brief ExportNoteWorker::getExportFileName
+ * @param baseName 不含后缀的文件路径
+ * @param fileSuffix 文件后缀
+ * @return 不重复的文件路径
+ */
 QString ExportNoteWorker::getExportFileName(const QString &baseName, const QString &fileSuffix)
 {
-    QString filePath = baseName + fileSuffix;
-    int count = 1;
-    while (1) {
-        QFile file(filePath);
-        if (!file.exists()) {
-            break;
+    return m_context->reserveFileName(baseName, fileSuffix);
+}
+
+/**
+ * @brief VNoteExportContext::reserveFileName
+ * 大量同名笔记导出时不再逐个序号判断文件是否存在
+ * @param baseName 不含后缀的文件路径
+ * @param fileSuffix 文件后缀
+ * @return 文件路径
+ */
+QString VNoteExportContext::reserveFileName(const QString &baseName, const QString &fileSuffix)
+{
+    QMutexLocker locker(&nameLock);
+
+    //已有文件按与baseName相同的目录前缀记录
+    QString dirPrefix = baseName.left(baseName.lastIndexOf('/') + 1);
+    if (!scannedDirs.contains(dirPrefix)) {
+        scannedDirs.insert(dirPrefix);
+        QDir dir(dirPrefix.isEmpty() ? QString(".") : dirPrefix);
+        for (auto fileName : dir.entryList(QDir::AllEntries | QDir::Hidden | QDir::System | QDir::NoDotAndDotDot)) {
+            usedNames.insert(dirPrefix + fileName);
         }
-        filePath = baseName + "(" + QString::number(count++) + ")" + fileSuffix;
     }
+
+    QString key = baseName + fileSuffix;
+    int &index = nextIndexes[key];
+    QString filePath = 0 == index ? key : baseName + "(" + QString::number(index) + ")" + fileSuffix;
+    while (usedNames.contains(filePath)) {
+        filePath = baseName + "(" + QString::number(++index) + ")" + fileSuffix;
+    }
+    index++;
+    usedNames.insert(filePath);
     return filePath;
 }
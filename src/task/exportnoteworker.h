@@ -26,8 +26,15 @@
 
 #include <QObject>
 #include <QRunnable>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QHash>
+#include <QSet>
+#include <QSharedPointer>
 
-//一个记事项文本，语音导出线程
+struct VNoteExportContext;
+
+//笔记文本，语音导出线程，多个线程从共享上下文中逐个领取笔记
 class ExportNoteWorker : public VNTask
 {
     Q_OBJECT
@@ -45,6 +52,7 @@ public:
         PathDenied,
         PathInvalid,
         Savefailed, //保存失败
+        ExportCancelled, //导出已取消
     };
 
     explicit ExportNoteWorker(const QString &dirPath,
@@ -52,32 +60,70 @@ public:
                               const QList<VNoteItem *> &noteList,
                               const QString &defaultName = "",
                               QObject *parent = nullptr);
+    explicit ExportNoteWorker(const QSharedPointer<VNoteExportContext> &context, QObject *parent = nullptr);
 
 signals:
-    //导出完成信号
+    //一个笔记导出完成
+    void exportProgress(int finished, int total);
+    //导出完成信号，只由最后一个结束的线程发送
     void exportFinished(int state);
 public slots:
 protected:
     virtual void run() override;
     //检查路径
     ExportError checkPath();
+    //导出一个笔记
+    ExportError exportNote(VNoteItem *note);
     //导出文本
-    ExportError exportText();
-    //导出所有语音
-    ExportError exportAllVoice();
+    ExportError exportText(VNoteItem *note);
+    //导出笔记中所有语音
+    ExportError exportAllVoice(VNoteItem *note);
     //导出语音
     ExportError exportOneVoice(VNoteBlock *block);
     ExportError exportOneVoice(const QString &);
     //导出为HTML
-    ExportError exportAsHtml();
+    ExportError exportAsHtml(VNoteItem *note);
     //获取导出文件名，同名时创建副本
     QString getExportFileName(const QString &baseName, const QString &fileSuffix);
 
-    ExportType m_exportType {ExportNothing};
-    QString m_exportPath {""};
-    //默认导出名称
-    QString m_exportName {""};
-    QList<VNoteItem *> m_noteList {nullptr};
+    QSharedPointer<VNoteExportContext> m_context;
+};
+
+//一次导出所有线程共享的上下文
+struct VNoteExportContext {
+    ExportNoteWorker::ExportType exportType {ExportNoteWorker::ExportNothing};
+    QString exportPath;
+    //默认导出名称，只导出一个文件时使用
+    QString exportName;
+    //待导出的笔记，线程通过nextNote领取
+    QList<VNoteItem *> notes;
+    QAtomicInt nextNote {0};
+    //已完成的笔记数
+    QAtomicInt finishedNotes {0};
+    //第一个错误，出错后其他线程不再领取
+    QAtomicInt error {ExportNoteWorker::ExportOK};
+    //取消标志
+    QAtomicInt cancelled {0};
+    //未结束的线程数
+    QAtomicInt runningWorkers {0};
+
+    /**
+     * @brief 分配不重复的导出文件名，同名时依次添加(1)、(2)...
+     * 每个名称记录下次使用的序号，目录中已有的文件只在首次分配时读取一次
+     * @param baseName 不含后缀的文件路径
+     * @param fileSuffix 文件后缀
+     * @return 文件路径
+     */
+    QString reserveFileName(const QString &baseName, const QString &fileSuffix);
+
+private:
+    QMutex nameLock;
+    //已读取文件列表的目录前缀
+    QSet<QString> scannedDirs;
+    //目录中已有的及已分配的文件路径
+    QSet<QString> usedNames;
+    //每个名称下次尝试的序号
+    QHash<QString, int> nextIndexes;
 };
 
 #endif // EXPORTNOTEWORKER_H
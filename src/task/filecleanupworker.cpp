@@ -20,6 +20,8 @@
 */
 #include "filecleanupworker.h"
 #include "common/vnoteitem.h"
+#include "common/vnoteimagevariant.h"
+#include "common/vnoteattachmentstore.h"
 
 #include <QDir>
 #include <QStandardPaths>
@@ -28,6 +30,7 @@
 FileCleanupWorker::FileCleanupWorker(VNOTE_ALL_NOTES_MAP *qspAllNotesMap, QObject *parent)
     : VNTask(parent)
     , m_qspAllNotesMap(qspAllNotesMap)
+    , m_startTime(QDateTime::currentDateTime())
 {
 }
 void FileCleanupWorker::run()
@@ -36,15 +39,27 @@ void FileCleanupWorker::run()
         return;
     }
 
+    //附件仓库中的文件按引用计数清理，不需要遍历笔记
+    int count = VNoteAttachmentStore::collectGarbage(m_startTime);
+    if (count > 0) {
+        qInfo() << "remove unused attachments:" << count;
+    }
+
     //获取所有语音文件路径
     fillVoiceSet();
     //获取所有图片文件路径
     fillPictureSet();
+    //没有旧版本命名的文件时不遍历笔记
+    if (m_voiceSet.isEmpty() && m_pictureSet.isEmpty()) {
+        cleanPictureVariants();
+        return;
+    }
     //遍历笔记
     if (scanAllNotes()) {
         //清空数据
         cleanVoice();
         cleanPicture();
+        cleanPictureVariants();
     }
 }
 
@@ -71,6 +86,27 @@ void FileCleanupWorker::cleanPicture()
         if (!QFile::remove(path)) {
             qCritical() << "remove file " << path << " failed!";
         }
+        VNoteImageVariant::removeVariants(path);
+    }
+}
+
+/**
+ * @brief FileCleanupWorker::cleanPictureVariants
+ * 清理原图已不存在的图片副本
+ */
+void FileCleanupWorker::cleanPictureVariants()
+{
+    QString dirPath = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/images";
+    for (auto variantDir : {QString("/display"), QString("/thumb")}) {
+        QDir dir(dirPath + variantDir);
+        if (!dir.exists()) {
+            continue;
+        }
+        for (auto fileName : dir.entryList(QDir::Files | QDir::NoSymLinks)) {
+            if (!QFile::exists(dirPath + "/" + fileName)) {
+                QFile::remove(dir.filePath(fileName));
+            }
+        }
     }
 }
 
@@ -89,7 +125,9 @@ void FileCleanupWorker::fillVoiceSet()
 
     //存放文件路径
     for (auto fileName : dir.entryList(QStringList("*.mp3"), QDir::Files | QDir::NoSymLinks)) {
-        m_voiceSet.insert(dirPath + "/" + fileName);
+        if (!VNoteAttachmentStore::isStoreFileName(fileName)) {
+            m_voiceSet.insert(dirPath + "/" + fileName);
+        }
     }
 }
 
@@ -108,7 +146,9 @@ void FileCleanupWorker::fillPictureSet()
 
     QStringList filters = {"*.png", "*.jpg", "*.bmp"};
     for (auto fileName : dir.entryList(filters, QDir::Files | QDir::NoSymLinks)) {
-        m_pictureSet.insert(dirPath + "/" + fileName);
+        if (!VNoteAttachmentStore::isStoreFileName(fileName)) {
+            m_pictureSet.insert(dirPath + "/" + fileName);
+        }
     }
 }
 
@@ -196,8 +236,10 @@ void FileCleanupWorker::scanVoiceByHtml(const QString &htmlCode)
  * 遍历笔记中的图片
  * @param html 笔记html文本
  */
-void FileCleanupWorker::scanPictureByHtml(const QString &htmlCode)
+void FileCleanupWorker::scanPictureByHtml(const QString &html)
 {
+    //附件url转换为本地路径
+    QString htmlCode = VNoteAttachmentStore::resolveUrls(html);
     //匹配图片块标签的正则表达式
     QRegExp rx("<img.+src=.+>");
     rx.setMinimal(true); //最小匹配
@@ -25,6 +25,7 @@
 #include "datatypedef.h"
 
 #include <QSet>
+#include <QDateTime>
 
 /**
  * @brief The FileCleanupWorker class
@@ -48,6 +49,8 @@ private:
     void cleanVoice();
     //清理图片
     void cleanPicture();
+    //清理原图已不存在的图片副本
+    void cleanPictureVariants();
     //获取项目下用户所有的语音完整路径
     void fillVoiceSet();
     //获取项目下用户所有的图片完整路径
@@ -69,6 +72,7 @@ private:
     VNOTE_ALL_NOTES_MAP *m_qspAllNotesMap {nullptr}; //所有笔记数据
     QSet<QString> m_pictureSet; //图片路径集合
     QSet<QString> m_voiceSet; //语音路径集合
+    QDateTime m_startTime; //清理开始时间，之后存入的附件不清理
 };
 
 #endif // FILECLEANUPWORKER_H
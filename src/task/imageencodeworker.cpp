@@ -0,0 +1,67 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "imageencodeworker.h"
+#include "common/vnoteattachmentstore.h"
+#include "common/vnoteimagevariant.h"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+
+/**
+ * @brief ImageEncodeWorker::ImageEncodeWorker
+ * @param batchId 插入批次id
+ * @param image 图片
+ * @param codec 编码格式
+ * @param quality 编码质量
+ * @param parent
+ */
+ImageEncodeWorker::ImageEncodeWorker(quint64 batchId, const QImage &image, const QByteArray &codec, int quality, QObject *parent)
+    : VNTask(parent)
+    , m_batchId(batchId)
+    , m_image(image)
+    , m_codec(codec)
+    , m_quality(quality)
+{
+}
+
+/**
+ * @brief ImageEncodeWorker::run
+ * 编码、存入后生成显示图和缩略图，耗时只统计编码及存入
+ */
+void ImageEncodeWorker::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QByteArray codec;
+    QString image = VNoteAttachmentStore::storeImage(m_image, m_codec, m_quality, &codec);
+    qint64 elapsed = timer.elapsed();
+    //图片数据已编码，尽早释放
+    m_image = QImage();
+
+    if (!image.isEmpty()) {
+        emit imageEncoded(QString::fromLatin1(codec), QFileInfo(image).size(), elapsed);
+        if (!VNoteImageVariant::hasVariants(image)) {
+            VNoteImageVariant::generate(image);
+        }
+    }
+    emit imageIngested(m_batchId, 0, image);
+}
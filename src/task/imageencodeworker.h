@@ -0,0 +1,69 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef IMAGEENCODEWORKER_H
+#define IMAGEENCODEWORKER_H
+
+#include "vntask.h"
+
+#include <QImage>
+
+//编码粘贴的图片并存入附件仓库的线程
+class ImageEncodeWorker : public VNTask
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief ImageEncodeWorker
+     * @param batchId 插入批次id
+     * @param image 图片
+     * @param codec 编码格式
+     * @param quality 编码质量，小于0使用格式的默认值
+     * @param parent
+     */
+    ImageEncodeWorker(quint64 batchId, const QImage &image, const QByteArray &codec, int quality, QObject *parent = nullptr);
+
+signals:
+    /**
+     * @brief 图片存入完成
+     * @param batchId 插入批次id
+     * @param index 图片在批次中的序号，固定为0
+     * @param image 仓库中的图片路径，失败为空
+     */
+    void imageIngested(quint64 batchId, int index, const QString &image);
+    /**
+     * @brief 编码耗时
+     * @param codec 实际使用的编码格式
+     * @param size 编码后的文件大小
+     * @param elapsed 编码及存入耗时，单位:毫秒
+     */
+    void imageEncoded(const QString &codec, qint64 size, qint64 elapsed);
+
+protected:
+    virtual void run() override;
+
+private:
+    quint64 m_batchId {0};
+    QImage m_image;
+    QByteArray m_codec;
+    int m_quality {-1};
+};
+
+#endif // IMAGEENCODEWORKER_H
@@ -0,0 +1,80 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "imageingestworker.h"
+#include "common/vnoteattachmentstore.h"
+#include "common/vnoteimagevariant.h"
+
+#include <QImageReader>
+#include <QDebug>
+
+/**
+ * @brief ImageIngestWorker::ImageIngestWorker
+ * @param context 插入批次共享上下文
+ * @param parent
+ */
+ImageIngestWorker::ImageIngestWorker(const QSharedPointer<VNoteIngestContext> &context, QObject *parent)
+    : VNTask(parent)
+    , m_context(context)
+{
+}
+
+/**
+ * @brief ImageIngestWorker::run
+ * 循环领取图片，直到队列为空
+ */
+void ImageIngestWorker::run()
+{
+    if (m_context.isNull()) {
+        return;
+    }
+
+    forever {
+        int index = m_context->nextFile.fetchAndAddOrdered(1);
+        if (index >= m_context->files.size()) {
+            break;
+        }
+
+        emit imageIngested(m_context->batchId, index, ingestImage(m_context->files.at(index)));
+    }
+}
+
+/**
+ * @brief ImageIngestWorker::ingestImage
+ * 按文件内容判断格式，后缀与内容不符的文件也能插入
+ * @param filePath 图片路径
+ * @return 仓库中的图片路径
+ */
+QString ImageIngestWorker::ingestImage(const QString &filePath)
+{
+    QImageReader reader(filePath);
+    QByteArray format = reader.format();
+    if (!reader.canRead() || !(format == "jpeg" || format == "png" || format == "bmp")) {
+        qWarning() << "not a valid image:" << filePath;
+        return QString();
+    }
+
+    QString image = VNoteAttachmentStore::storeFile(filePath, VNoteAttachment::Image);
+    if (!image.isEmpty() && !VNoteImageVariant::hasVariants(image)) {
+        //副本生成失败时显示原图
+        VNoteImageVariant::generate(image);
+    }
+    return image;
+}
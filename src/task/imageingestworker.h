@@ -0,0 +1,68 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef IMAGEINGESTWORKER_H
+#define IMAGEINGESTWORKER_H
+
+#include "vntask.h"
+
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QStringList>
+
+//一次插入图片所有线程共享的上下文
+struct VNoteIngestContext {
+    quint64 batchId {0};
+    //待存入的图片，线程通过nextFile领取
+    QStringList files;
+    QAtomicInt nextFile {0};
+};
+
+//存入插入图片的线程，多个线程从共享队列中领取图片，校验、复制并生成副本，每完成一张返回一次结果
+class ImageIngestWorker : public VNTask
+{
+    Q_OBJECT
+public:
+    explicit ImageIngestWorker(const QSharedPointer<VNoteIngestContext> &context, QObject *parent = nullptr);
+
+    /**
+     * @brief 校验图片内容并存入附件仓库，然后生成显示图和缩略图
+     * @param filePath 图片路径
+     * @return 仓库中的图片路径，不是有效图片或存入失败返回空
+     */
+    static QString ingestImage(const QString &filePath);
+
+signals:
+    /**
+     * @brief 一张图片处理完成
+     * @param batchId 插入批次id
+     * @param index 图片在批次中的序号
+     * @param image 仓库中的图片路径，失败为空
+     */
+    void imageIngested(quint64 batchId, int index, const QString &image);
+
+protected:
+    virtual void run() override;
+
+private:
+    QSharedPointer<VNoteIngestContext> m_context;
+};
+
+#endif // IMAGEINGESTWORKER_H
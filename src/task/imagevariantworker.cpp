@@ -0,0 +1,50 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "imagevariantworker.h"
+#include "common/vnoteimagevariant.h"
+
+/**
+ * @brief ImageVariantWorker::ImageVariantWorker
+ * @param images 原图路径
+ * @param parent
+ */
+ImageVariantWorker::ImageVariantWorker(const QStringList &images, QObject *parent)
+    : VNTask(parent)
+    , m_images(images)
+{
+}
+
+/**
+ * @brief ImageVariantWorker::run
+ */
+void ImageVariantWorker::run()
+{
+    QStringList images;
+    QStringList failed;
+    for (const QString &image : m_images) {
+        if (VNoteImageVariant::generate(image)) {
+            images.append(image);
+        } else {
+            failed.append(image);
+        }
+    }
+    emit variantsReady(images, failed);
+}
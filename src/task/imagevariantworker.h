@@ -0,0 +1,50 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef IMAGEVARIANTWORKER_H
+#define IMAGEVARIANTWORKER_H
+
+#include "vntask.h"
+
+#include <QStringList>
+
+//生成图片显示图和缩略图的线程
+class ImageVariantWorker : public VNTask
+{
+    Q_OBJECT
+public:
+    explicit ImageVariantWorker(const QStringList &images, QObject *parent = nullptr);
+
+signals:
+    /**
+     * @brief 副本生成完成
+     * @param images 生成成功的原图路径
+     * @param failed 生成失败的原图路径
+     */
+    void variantsReady(const QStringList &images, const QStringList &failed);
+
+protected:
+    virtual void run() override;
+
+private:
+    QStringList m_images; //原图路径
+};
+
+#endif // IMAGEVARIANTWORKER_H
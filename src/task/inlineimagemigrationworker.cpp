@@ -0,0 +1,74 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "inlineimagemigrationworker.h"
+#include "common/vnoteitem.h"
+#include "common/vnoteattachmentstore.h"
+
+#include <QDebug>
+#include <QFileInfo>
+
+InlineImageMigrationWorker::InlineImageMigrationWorker(VNOTE_ALL_NOTES_MAP *allNotesMap, QObject *parent)
+    : VNTask(parent)
+    , m_allNotesMap(allNotesMap)
+{
+}
+
+/**
+ * @brief InlineImageMigrationWorker::run
+ * 先复制需要迁移的笔记内容，解码存入时不持有笔记数据锁
+ */
+void InlineImageMigrationWorker::run()
+{
+    struct InlineNote {
+        qint64 folderId;
+        qint32 noteId;
+        QString html;
+    };
+    QList<InlineNote> inlineNotes;
+    QString imageDir = QFileInfo(VNoteAttachmentStore::attachmentDir(VNoteAttachment::Image)).absoluteFilePath();
+
+    if (nullptr != m_allNotesMap) {
+        m_allNotesMap->lock.lockForRead();
+        for (VNOTE_ITEMS_MAP *folderNotes : m_allNotesMap->notes) {
+            folderNotes->lock.lockForRead();
+            for (VNoteItem *note : folderNotes->folderNotes) {
+                if (note->htmlCode.contains("data:image/") || note->htmlCode.contains(imageDir)) {
+                    inlineNotes.append({note->folderId, note->noteId, note->htmlCode});
+                }
+            }
+            folderNotes->lock.unlock();
+        }
+        m_allNotesMap->lock.unlock();
+    }
+
+    int count = 0;
+    for (const InlineNote &note : inlineNotes) {
+        QString newHtml = VNoteAttachmentStore::externalizeLocalPaths(VNoteAttachmentStore::externalizeDataUris(note.html));
+        if (newHtml != note.html) {
+            count++;
+            emit noteMigrated(note.folderId, note.noteId, note.html, newHtml);
+        }
+    }
+    if (count > 0) {
+        qInfo() << "externalize inline and local images of notes:" << count;
+    }
+    emit migrationFinished(count);
+}
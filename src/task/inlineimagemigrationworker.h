@@ -0,0 +1,57 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef INLINEIMAGEMIGRATIONWORKER_H
+#define INLINEIMAGEMIGRATIONWORKER_H
+
+#include "vntask.h"
+#include "datatypedef.h"
+
+/**
+ * @brief The InlineImageMigrationWorker class
+ * 旧数据迁移，笔记中data协议内嵌的图片和图片目录下的本地路径存入附件仓库，
+ * 替换为附件url后的内容由主线程保存
+ */
+class InlineImageMigrationWorker : public VNTask
+{
+    Q_OBJECT
+public:
+    explicit InlineImageMigrationWorker(VNOTE_ALL_NOTES_MAP *allNotesMap, QObject *parent = nullptr);
+
+signals:
+    /**
+     * @brief 一个笔记的内嵌图片或本地图片已存入
+     * @param folderId 记事本id
+     * @param noteId 笔记id
+     * @param html 替换前的内容，笔记内容已变化时不保存
+     * @param newHtml 替换后的内容
+     */
+    void noteMigrated(qint64 folderId, qint32 noteId, const QString &html, const QString &newHtml);
+    //所有笔记处理完成
+    void migrationFinished(int count);
+
+protected:
+    virtual void run() override;
+
+private:
+    VNOTE_ALL_NOTES_MAP *m_allNotesMap {nullptr}; //所有笔记数据
+};
+
+#endif // INLINEIMAGEMIGRATIONWORKER_H
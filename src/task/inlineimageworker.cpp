@@ -0,0 +1,54 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "inlineimageworker.h"
+#include "common/vnoteattachmentstore.h"
+#include "common/vnoteimagevariant.h"
+
+/**
+ * @brief InlineImageWorker::InlineImageWorker
+ * @param ids 网页中的图片id
+ * @param uris 图片的data协议url
+ * @param parent
+ */
+InlineImageWorker::InlineImageWorker(const QStringList &ids, const QStringList &uris, QObject *parent)
+    : VNTask(parent)
+    , m_ids(ids)
+    , m_uris(uris)
+{
+}
+
+/**
+ * @brief InlineImageWorker::run
+ * 逐个解码存入并生成副本，每张图片完成后立即通知
+ */
+void InlineImageWorker::run()
+{
+    for (int i = 0; i < m_ids.size() && i < m_uris.size(); i++) {
+        QString image = VNoteAttachmentStore::storeDataUri(m_uris.at(i));
+        //数据已存入，尽早释放
+        m_uris[i].clear();
+
+        if (!image.isEmpty() && !VNoteImageVariant::hasVariants(image)) {
+            VNoteImageVariant::generate(image);
+        }
+        emit imageIngested(m_ids.at(i), image);
+    }
+}
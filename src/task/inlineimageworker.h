@@ -0,0 +1,57 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef INLINEIMAGEWORKER_H
+#define INLINEIMAGEWORKER_H
+
+#include "vntask.h"
+
+#include <QStringList>
+
+//粘贴内容中data协议内嵌的图片存入附件仓库的线程
+class InlineImageWorker : public VNTask
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief InlineImageWorker
+     * @param ids 网页中的图片id
+     * @param uris 图片的data协议url
+     * @param parent
+     */
+    InlineImageWorker(const QStringList &ids, const QStringList &uris, QObject *parent = nullptr);
+
+signals:
+    /**
+     * @brief 一张图片存入完成
+     * @param id 网页中的图片id
+     * @param image 仓库中的图片路径，失败为空
+     */
+    void imageIngested(const QString &id, const QString &image);
+
+protected:
+    virtual void run() override;
+
+private:
+    QStringList m_ids;
+    QStringList m_uris;
+};
+
+#endif // INLINEIMAGEWORKER_H
@@ -0,0 +1,48 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "journalsyncworker.h"
+
+#include <unistd.h>
+
+/**
+ * @brief JournalSyncWorker::JournalSyncWorker
+ * @param fd 复制的文件描述符
+ * @param parent
+ */
+JournalSyncWorker::JournalSyncWorker(int fd, QObject *parent)
+    : VNTask(parent)
+    , m_fd(fd)
+{
+}
+
+/**
+ * @brief JournalSyncWorker::run
+ */
+void JournalSyncWorker::run()
+{
+    if (m_fd < 0) {
+        return;
+    }
+
+    ::fdatasync(m_fd);
+    ::close(m_fd);
+    m_fd = -1;
+}
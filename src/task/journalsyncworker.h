@@ -0,0 +1,41 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef JOURNALSYNCWORKER_H
+#define JOURNALSYNCWORKER_H
+
+#include "vntask.h"
+
+//编辑区日志落盘线程，落盘耗时不阻塞界面
+class JournalSyncWorker : public VNTask
+{
+    Q_OBJECT
+public:
+    //fd为复制的文件描述符，落盘后关闭
+    explicit JournalSyncWorker(int fd, QObject *parent = nullptr);
+
+protected:
+    virtual void run() override;
+
+private:
+    int m_fd {-1};
+};
+
+#endif // JOURNALSYNCWORKER_H
@@ -0,0 +1,255 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "libraryexportworker.h"
+#include "common/vnotearchive.h"
+#include "common/vnotedatamanager.h"
+#include "common/vnoteattachmentstore.h"
+#include "common/vnoteforlder.h"
+#include "common/vnoteitem.h"
+#include "db/vnoteattachmentoper.h"
+
+#include <QSaveFile>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+
+/**
+ * @brief LibraryExportWorker::LibraryExportWorker
+ * @param filePath 归档文件路径
+ * @param folders 导出的记事本
+ * @param parent
+ */
+LibraryExportWorker::LibraryExportWorker(const QString &filePath, const QList<VNoteFolder *> &folders, QObject *parent)
+    : VNTask(parent)
+    , m_filePath(filePath)
+{
+    for (auto folder : folders) {
+        if (nullptr == folder) {
+            continue;
+        }
+
+        VNoteLibraryFolder folderData;
+        folderData.id = folder->id;
+        folderData.name = folder->name;
+        folderData.defaultIcon = folder->defaultIcon;
+        folderData.createTime = folder->createTime;
+        folderData.modifyTime = folder->modifyTime;
+        m_folders.append(folderData);
+    }
+}
+
+/**
+ * @brief LibraryExportWorker::run
+ * 写入临时文件，全部成功后替换目标文件，失败时不留下不完整的归档
+ */
+void LibraryExportWorker::run()
+{
+    ExportState state = NoFolder;
+
+    if (!m_folders.isEmpty()) {
+        QSaveFile file(m_filePath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qCritical() << "open library archive failed:" << m_filePath << file.errorString();
+            state = PathDenied;
+        } else {
+            VNoteArchiveWriter writer(&file);
+            state = exportLibrary(writer);
+
+            if (ExportOK == state && !(writer.finish() && file.commit())) {
+                qCritical() << "write library archive failed:" << m_filePath << file.errorString();
+                state = ExportFailed;
+            }
+
+            if (ExportOK != state) {
+                file.cancelWriting();
+            }
+        }
+    }
+
+    emit exportFinished(state);
+}
+
+/**
+ * @brief LibraryExportWorker::exportLibrary
+ * 先记录要导出的笔记id，导出时逐个查找笔记，写入文件时不持有数据锁
+ * @param writer 归档
+ * @return 导出结果
+ */
+LibraryExportWorker::ExportState LibraryExportWorker::exportLibrary(VNoteArchiveWriter &writer)
+{
+    QVector<QPair<qint64, qint32>> noteIds;
+    VNOTE_ALL_NOTES_MAP *allNotes = VNoteDataManager::instance()->getAllNotesInFolder();
+
+    if (nullptr != allNotes) {
+        allNotes->lock.lockForRead();
+
+        for (auto &folder : m_folders) {
+            VNOTE_ALL_NOTES_DATA_MAP::iterator it = allNotes->notes.find(folder.id);
+            if (it == allNotes->notes.end()) {
+                continue;
+            }
+
+            VNOTE_ITEMS_MAP *folderNotes = *it;
+            folderNotes->lock.lockForRead();
+            for (auto note : folderNotes->folderNotes) {
+                noteIds.append(qMakePair(folder.id, note->noteId));
+            }
+            folderNotes->lock.unlock();
+        }
+
+        allNotes->lock.unlock();
+    }
+
+    if (!writer.addData(VNoteLibraryArchive::ManifestName, VNoteLibraryArchive::makeManifest(m_folders))) {
+        return ExportFailed;
+    }
+
+    for (int i = 0; i < noteIds.size(); i++) {
+        if (!exportNote(writer, noteIds.at(i).first, noteIds.at(i).second)) {
+            return ExportFailed;
+        }
+        emit exportProgress(i + 1, noteIds.size());
+    }
+
+    return ExportOK;
+}
+
+/**
+ * @brief LibraryExportWorker::exportNote
+ * @param writer 归档
+ * @param folderId 记事本id
+ * @param noteId 笔记id
+ * @return true 成功
+ */
+bool LibraryExportWorker::exportNote(VNoteArchiveWriter &writer, qint64 folderId, qint32 noteId)
+{
+    QString entryName;
+    QByteArray data;
+    QDateTime modifyTime;
+    QStringList hashes;
+    QMap<QString, QString> legacyFiles;
+    VNOTE_ALL_NOTES_MAP *allNotes = VNoteDataManager::instance()->getAllNotesInFolder();
+
+    allNotes->lock.lockForRead();
+
+    VNOTE_ALL_NOTES_DATA_MAP::iterator it = allNotes->notes.find(folderId);
+    if (it != allNotes->notes.end()) {
+        VNOTE_ITEMS_MAP *folderNotes = *it;
+
+        folderNotes->lock.lockForRead();
+        VNoteItem *note = folderNotes->folderNotes.value(noteId, nullptr);
+        if (nullptr != note) {
+            entryName = VNoteLibraryArchive::noteEntryName(note);
+            data = VNoteLibraryArchive::makeNote(note);
+            modifyTime = note->modifyTime;
+        }
+        folderNotes->lock.unlock();
+    }
+
+    allNotes->lock.unlock();
+
+    if (data.isEmpty()) {
+        return true;
+    }
+
+    //旧附件按内容哈希命名，计算哈希时不持有数据锁
+    QString legacyData = VNoteLibraryArchive::hashLegacyAttachments(QString::fromUtf8(data), legacyFiles);
+    if (!legacyFiles.isEmpty()) {
+        data = legacyData.toUtf8();
+    }
+    hashes = VNoteAttachmentOper::attachmentHashes(legacyData);
+
+    if (!writer.addData(entryName, data, modifyTime)) {
+        return false;
+    }
+
+    for (auto it = legacyFiles.begin(); it != legacyFiles.end(); ++it) {
+        if (!exportLegacyFile(writer, it.key(), it.value())) {
+            return false;
+        }
+    }
+
+    for (auto &hash : hashes) {
+        if (!exportAttachment(writer, hash)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief LibraryExportWorker::exportLegacyFile
+ * 旧附件不在附件仓库中，以哈希命名的条目写入旧文件的内容
+ * @param writer 归档
+ * @param hashPath 哈希命名的附件路径
+ * @param filePath 本地旧文件
+ * @return false 归档写入失败
+ */
+bool LibraryExportWorker::exportLegacyFile(VNoteArchiveWriter &writer, const QString &hashPath, const QString &filePath)
+{
+    QFileInfo hashInfo(hashPath);
+    if (m_exportedHashes.contains(hashInfo.completeBaseName())) {
+        return true;
+    }
+    m_exportedHashes.insert(hashInfo.completeBaseName());
+
+    VNoteAttachment attachment;
+    attachment.type = hashInfo.absolutePath() == QFileInfo(VNoteAttachmentStore::attachmentDir(VNoteAttachment::Voice)).absoluteFilePath()
+                          ? VNoteAttachment::Voice
+                          : VNoteAttachment::Image;
+    attachment.fileName = hashInfo.fileName();
+
+    writer.addFile(VNoteLibraryArchive::attachmentEntryName(attachment), filePath);
+    return writer.isOk();
+}
+
+/**
+ * @brief LibraryExportWorker::exportAttachment
+ * 多个笔记引用的附件只写入一次
+ * @param writer 归档
+ * @param hash 附件哈希值
+ * @return false 归档写入失败
+ */
+bool LibraryExportWorker::exportAttachment(VNoteArchiveWriter &writer, const QString &hash)
+{
+    if (m_exportedHashes.contains(hash)) {
+        return true;
+    }
+    m_exportedHashes.insert(hash);
+
+    VNoteAttachment attachment;
+    VNoteAttachmentOper attachmentOper;
+    if (!attachmentOper.getAttachment(hash, attachment)) {
+        qWarning() << "attachment not registered:" << hash;
+        return true;
+    }
+
+    QString filePath = VNoteAttachmentStore::attachmentDir(static_cast<VNoteAttachment::Type>(attachment.type)) + "/" + attachment.fileName;
+    if (!QFile::exists(filePath)) {
+        qWarning() << "attachment file missing:" << filePath;
+        return true;
+    }
+
+    //附件文件读取失败时跳过，导入后笔记中该附件无法显示
+    writer.addFile(VNoteLibraryArchive::attachmentEntryName(attachment), filePath);
+    return writer.isOk();
+}
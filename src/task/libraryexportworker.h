@@ -0,0 +1,76 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef LIBRARYEXPORTWORKER_H
+#define LIBRARYEXPORTWORKER_H
+
+#include "common/vnotelibraryarchive.h"
+#include "vntask.h"
+
+#include <QSet>
+
+class VNoteArchiveWriter;
+
+//记事本归档导出线程，笔记内容和附件依次直接写入归档文件，附件不复制到临时目录
+class LibraryExportWorker : public VNTask
+{
+    Q_OBJECT
+public:
+    enum ExportState {
+        ExportOK,
+        NoFolder, //没有可导出的记事本
+        PathDenied, //无法写入归档文件
+        ExportFailed //写入失败
+    };
+
+    /**
+     * @brief 在主线程中创建，记事本信息在创建时复制
+     * @param filePath 归档文件路径
+     * @param folders 导出的记事本
+     * @param parent
+     */
+    explicit LibraryExportWorker(const QString &filePath, const QList<VNoteFolder *> &folders, QObject *parent = nullptr);
+
+signals:
+    //一个笔记导出完成
+    void exportProgress(int finished, int total);
+    //导出完成
+    void exportFinished(int state);
+
+protected:
+    virtual void run() override;
+
+private:
+    //导出所有记事本
+    ExportState exportLibrary(VNoteArchiveWriter &writer);
+    //导出一个笔记及其引用的附件，笔记已被删除时跳过
+    bool exportNote(VNoteArchiveWriter &writer, qint64 folderId, qint32 noteId);
+    //导出一个附件，已导出或附件文件不存在时跳过
+    bool exportAttachment(VNoteArchiveWriter &writer, const QString &hash);
+    //导出一个不在附件仓库中的旧附件，已导出时跳过
+    bool exportLegacyFile(VNoteArchiveWriter &writer, const QString &hashPath, const QString &filePath);
+
+    QString m_filePath;
+    QVector<VNoteLibraryFolder> m_folders;
+    //已写入的附件
+    QSet<QString> m_exportedHashes;
+};
+
+#endif // LIBRARYEXPORTWORKER_H
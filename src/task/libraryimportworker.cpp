@@ -0,0 +1,223 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "libraryimportworker.h"
+#include "common/vnotearchive.h"
+#include "common/vnoteattachmentstore.h"
+#include "db/vnotedbmanager.h"
+#include "db/dbvisitor.h"
+
+#include <QThreadPool>
+#include <QThread>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSet>
+#include <QDebug>
+
+namespace {
+//解析一个笔记条目，结果写回笔记
+class ParseNoteTask : public QRunnable
+{
+public:
+    explicit ParseNoteTask(VNoteLibraryNote *note)
+        : m_note(note)
+    {
+    }
+
+    void run() override
+    {
+        VNoteLibraryArchive::parseNote(m_note);
+    }
+
+private:
+    VNoteLibraryNote *m_note {nullptr};
+};
+} // namespace
+
+/**
+ * @brief LibraryImportWorker::LibraryImportWorker
+ * 导入结果通过队列连接返回主线程，需注册参数类型
+ * @param filePath 归档文件路径
+ * @param parent
+ */
+LibraryImportWorker::LibraryImportWorker(const QString &filePath, QObject *parent)
+    : VNTask(parent)
+    , m_filePath(filePath)
+{
+    qRegisterMetaType<VNoteLibraryData *>("VNoteLibraryData*");
+}
+
+/**
+ * @brief LibraryImportWorker::run
+ * 读取失败时不写入数据库，已存入的附件没有笔记引用，由附件清理线程删除
+ */
+void LibraryImportWorker::run()
+{
+    QScopedPointer<VNoteLibraryData> library(new VNoteLibraryData());
+    ImportState state = OpenFailed;
+
+    QFile file(m_filePath);
+    if (file.open(QIODevice::ReadOnly)) {
+        QThreadPool parsePool;
+        parsePool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), static_cast<int>(MaxParseThreads)));
+
+        VNoteArchiveReader reader(&file);
+        state = readArchive(reader, library.data(), parsePool);
+        //解析任务引用笔记数据，需等待全部结束
+        parsePool.waitForDone();
+    } else {
+        qCritical() << "open library archive failed:" << m_filePath << file.errorString();
+    }
+
+    if (ImportOK == state) {
+        removeInvalid(library.data());
+        if (library->folders.isEmpty()) {
+            state = FormatError;
+        }
+    }
+
+    if (ImportOK == state) {
+        ImportLibraryDbVisitor importVisitor(VNoteDbManager::instance()->getVNoteDb(), library.data(), library.data());
+        if (!VNoteDbManager::instance()->insertDataInTransaction(&importVisitor)) {
+            state = ImportFailed;
+        }
+    }
+
+    emit importFinished(state, ImportOK == state ? library.take() : nullptr);
+}
+
+/**
+ * @brief LibraryImportWorker::readArchive
+ * 笔记条目读出后立即提交解析，与后续附件的读取同时进行
+ * @param reader 归档
+ * @param library 导入数据
+ * @param parsePool 解析线程池
+ * @return 读取结果
+ */
+LibraryImportWorker::ImportState LibraryImportWorker::readArchive(VNoteArchiveReader &reader, VNoteLibraryData *library, QThreadPool &parsePool)
+{
+    bool hasManifest = false;
+    VNoteArchiveReader::Entry entry;
+
+    while (reader.next(entry)) {
+        if (!entry.isFile) {
+            continue;
+        }
+
+        if (entry.name == VNoteLibraryArchive::ManifestName) {
+            if (!VNoteLibraryArchive::parseManifest(reader.readAll(), library->folders)) {
+                return FormatError;
+            }
+            hasManifest = true;
+        } else if (entry.name.startsWith(VNoteLibraryArchive::NotePrefix)) {
+            if (entry.size > MaxNoteEntrySize) {
+                qWarning() << "archive note too large:" << entry.name << entry.size;
+                continue;
+            }
+
+            VNoteLibraryNote *note = new VNoteLibraryNote();
+            note->json = reader.readAll();
+            library->notes.append(note);
+            parsePool.start(new ParseNoteTask(note));
+        } else if (entry.name.startsWith(VNoteLibraryArchive::AttachmentPrefix)) {
+            storeAttachment(reader, entry.name);
+        }
+    }
+
+    if (reader.hasError() || !hasManifest) {
+        qCritical() << "invalid library archive:" << m_filePath;
+        return FormatError;
+    }
+
+    return ImportOK;
+}
+
+/**
+ * @brief LibraryImportWorker::storeAttachment
+ * 先写入附件目录中的临时文件，再移动为哈希命名的文件，附件仓库已有相同文件时不再读取内容
+ * @param reader 归档
+ * @param name 条目名称
+ */
+void LibraryImportWorker::storeAttachment(VNoteArchiveReader &reader, const QString &name)
+{
+    VNoteAttachment::Type type = VNoteAttachment::Image;
+    QString fileName;
+    if (!VNoteLibraryArchive::parseAttachmentEntry(name, type, fileName)) {
+        qWarning() << "skip archive entry:" << name;
+        return;
+    }
+
+    QString dirPath = VNoteAttachmentStore::attachmentDir(type);
+    QString target = dirPath + "/" + fileName;
+    if (QFile::exists(target)) {
+        //重新登记，更新存入时间，避免导入完成前被清理
+        VNoteAttachmentStore::storeFile(target, type);
+        return;
+    }
+
+    QDir().mkpath(dirPath);
+    //临时文件保留原后缀，存入时按后缀登记，以.开头不会被文件清理线程扫描到
+    QString tempPath = QString("%1/.import-%2-%3").arg(dirPath).arg(reinterpret_cast<quintptr>(QThread::currentThreadId())).arg(fileName);
+    QFile tempFile(tempPath);
+    if (!tempFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "create attachment failed:" << tempPath << tempFile.errorString();
+        return;
+    }
+
+    bool copied = reader.copyTo(&tempFile);
+    tempFile.close();
+
+    QString stored = copied ? VNoteAttachmentStore::storeFile(tempPath, type, true) : QString();
+    if (stored.isEmpty()) {
+        qWarning() << "import attachment failed:" << name;
+        QFile::remove(tempPath);
+    } else if (QFileInfo(stored).fileName() != fileName) {
+        qWarning() << "archive attachment content mismatch:" << name;
+    }
+}
+
+/**
+ * @brief LibraryImportWorker::removeInvalid
+ * @param library 导入数据
+ */
+void LibraryImportWorker::removeInvalid(VNoteLibraryData *library)
+{
+    QSet<qint64> folderIds;
+    for (int i = 0; i < library->folders.size();) {
+        if (folderIds.contains(library->folders.at(i).id)) {
+            library->folders.remove(i);
+        } else {
+            folderIds.insert(library->folders.at(i).id);
+            i++;
+        }
+    }
+
+    for (int i = 0; i < library->notes.size();) {
+        VNoteLibraryNote *note = library->notes.at(i);
+        if (!note->valid || !folderIds.contains(note->folderId)) {
+            qWarning() << "skip archive note, folder:" << note->folderId << "valid:" << note->valid;
+            delete note;
+            library->notes.remove(i);
+        } else {
+            i++;
+        }
+    }
+}
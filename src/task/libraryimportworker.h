@@ -0,0 +1,72 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef LIBRARYIMPORTWORKER_H
+#define LIBRARYIMPORTWORKER_H
+
+#include "common/vnotelibraryarchive.h"
+#include "vntask.h"
+
+class QThreadPool;
+class VNoteArchiveReader;
+
+//记事本归档导入线程，顺序读取归档，附件直接写入附件仓库，笔记条目交给解析线程池并行解析，
+//全部读取完成后在一个事务中插入所有记事本和笔记
+class LibraryImportWorker : public VNTask
+{
+    Q_OBJECT
+public:
+    enum ImportState {
+        ImportOK,
+        OpenFailed, //无法读取归档文件
+        FormatError, //不是记事本归档或版本不支持
+        ImportFailed //写入数据库失败
+    };
+
+    enum {
+        MaxParseThreads = 4, //最多同时解析笔记的线程数
+        MaxNoteEntrySize = 64 * 1024 * 1024 //单个笔记条目的最大大小
+    };
+
+    explicit LibraryImportWorker(const QString &filePath, QObject *parent = nullptr);
+
+signals:
+    /**
+     * @brief 导入完成
+     * @param state 导入结果
+     * @param library 导入的记事本和笔记，已填入新的id，由接收者释放，失败时为空
+     */
+    void importFinished(int state, VNoteLibraryData *library);
+
+protected:
+    virtual void run() override;
+
+private:
+    //读取归档，笔记条目提交解析
+    ImportState readArchive(VNoteArchiveReader &reader, VNoteLibraryData *library, QThreadPool &parsePool);
+    //附件条目存入附件仓库
+    void storeAttachment(VNoteArchiveReader &reader, const QString &name);
+    //去掉解析失败、记事本不存在的笔记和重复的记事本
+    static void removeInvalid(VNoteLibraryData *library);
+
+    QString m_filePath;
+};
+
+#endif // LIBRARYIMPORTWORKER_H
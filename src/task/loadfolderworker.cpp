@@ -21,6 +21,7 @@
 #include "loadfolderworker.h"
 #include "common/vnoteforlder.h"
 #include "db/vnotefolderoper.h"
+#include "common/vnotetitleindex.h"
 #include "globaldef.h"
 
 #include <DLog>
@@ -47,6 +48,14 @@ void LoadFolderWorker::run()
     VNoteFolderOper folderOper;
     VNOTE_FOLDERS_MAP *foldersMap = folderOper.loadVNoteFolders();
 
+    //在加载线程中建立名称索引，拼音转换不占用主线程
+    VNoteTitleIndex::instance()->clear(VNoteTitleIndex::FolderName);
+    if (nullptr != foldersMap) {
+        for (auto folder : foldersMap->folders) {
+            VNoteTitleIndex::instance()->updateTitle(VNoteTitleIndex::FolderName, folder->id, folder->name);
+        }
+    }
+
     gettimeofday(&end, nullptr);
 
     qDebug() << "LoadFolderWorker(ms):" << TM(start, end);
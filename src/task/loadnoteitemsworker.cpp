@@ -20,6 +20,9 @@
 */
 #include "loadnoteitemsworker.h"
 #include "db/vnoteitemoper.h"
+#include "common/vnoteitem.h"
+#include "common/vnotetitleindex.h"
+#include "common/vnoteattributeindex.h"
 #include "globaldef.h"
 
 #include <DLog>
@@ -46,6 +49,19 @@ void LoadNoteItemsWorker::run()
     VNoteItemOper notesOper;
     VNOTE_ALL_NOTES_MAP *notesMap = notesOper.loadAllVNotes();
 
+    //在加载线程中建立标题和属性索引，拼音转换和内容解析不占用主线程
+    VNoteTitleIndex::instance()->clear(VNoteTitleIndex::NoteTitle);
+    VNoteAttributeIndex::instance()->clear();
+    if (nullptr != notesMap) {
+        for (auto folderNotes : notesMap->notes) {
+            for (auto note : folderNotes->folderNotes) {
+                VNoteTitleIndex::instance()->updateTitle(VNoteTitleIndex::NoteTitle, note->noteId,
+                                                         note->noteTitle, note->folderId);
+                VNoteAttributeIndex::instance()->updateNote(note);
+            }
+        }
+    }
+
     gettimeofday(&end, nullptr);
 
     qDebug() << "LoadNoteItemsWorker(ms):" << TM(start, end);
@@ -0,0 +1,126 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "searchnoteworker.h"
+#include "common/vnotesearchranker.h"
+
+/**
+ * @brief SearchNoteWorker::SearchNoteWorker
+ * @param context 搜索共享上下文
+ * @param parent
+ */
+SearchNoteWorker::SearchNoteWorker(const QSharedPointer<VNoteSearchContext> &context,
+                                   QObject *parent)
+    : VNTask(parent)
+    , m_context(context)
+{
+}
+
+/**
+ * @brief SearchNoteWorker::run
+ * 循环领取笔记进行搜索，直到队列为空或搜索被取消
+ */
+void SearchNoteWorker::run()
+{
+    if (m_context.isNull()) {
+        return;
+    }
+
+    VNOTE_SEARCH_HITS hits;
+
+    while (!isCancelled()) {
+        int begin = m_context->nextDoc.fetchAndAddOrdered(DocChunkSize);
+        if (begin >= m_context->docs.size()) {
+            break;
+        }
+
+        searchDocs(begin, qMin(begin + DocChunkSize, m_context->docs.size()), hits);
+        //每次领取的任务搜索完成后返回一次结果，保证结果及时显示
+        flushHits(hits);
+    }
+
+    //最后一个结束的线程通知搜索完成
+    if (!m_context->runningWorkers.deref()) {
+        emit searchFinished(m_context->queryId);
+    }
+}
+
+/**
+ * @brief SearchNoteWorker::isCancelled
+ * @return true 搜索已取消
+ */
+bool SearchNoteWorker::isCancelled() const
+{
+    return 0 != m_context->cancelled.loadAcquire();
+}
+
+/**
+ * @brief SearchNoteWorker::searchDocs
+ * @param begin 起始位置
+ * @param end 结束位置（不包含）
+ * @param hits 搜索结果缓存
+ */
+void SearchNoteWorker::searchDocs(int begin, int end, VNOTE_SEARCH_HITS &hits)
+{
+    for (int i = begin; i < end && !isCancelled(); i++) {
+        searchDoc(m_context->docs.at(i), hits);
+    }
+}
+
+/**
+ * @brief SearchNoteWorker::searchDoc
+ * @param doc 笔记内容
+ * @param hits 搜索结果缓存
+ */
+void SearchNoteWorker::searchDoc(const VNoteSearchDoc &doc, VNOTE_SEARCH_HITS &hits)
+{
+    if (m_context->matchedNoteIds.contains(doc.noteId)) {
+        return;
+    }
+
+    VNoteSearchHit hit;
+    int textLength = 0;
+    bool matched = VNoteSearchRanker::rankNote(doc, m_context->key, m_context->averageLength,
+                                               m_context->titleIndexHits.contains(doc.noteId), hit, &textLength);
+
+    m_context->totalLength.fetchAndAddRelaxed(textLength);
+    m_context->docCount.fetchAndAddRelaxed(1);
+
+    if (matched) {
+        hits.append(hit);
+
+        if (hits.size() >= BatchSize) {
+            flushHits(hits);
+        }
+    }
+}
+
+/**
+ * @brief SearchNoteWorker::flushHits
+ * @param hits 搜索结果缓存
+ */
+void SearchNoteWorker::flushHits(VNOTE_SEARCH_HITS &hits)
+{
+    if (!hits.isEmpty() && !isCancelled()) {
+        emit searchBatch(m_context->queryId, hits);
+    }
+
+    hits.clear();
+}
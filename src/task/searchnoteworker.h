@@ -0,0 +1,93 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef SEARCHNOTEWORKER_H
+#define SEARCHNOTEWORKER_H
+
+#include "common/datatypedef.h"
+#include "vntask.h"
+
+#include <QAtomicInt>
+#include <QSharedPointer>
+#include <QSet>
+
+//一次搜索所有线程共享的上下文
+struct VNoteSearchContext {
+    quint64 queryId {0};
+    QString key;
+    //待搜索笔记内容的快照，主线程生成，线程通过nextDoc分段领取
+    VNOTE_SEARCH_DOCS docs;
+    QAtomicInt nextDoc {0};
+    //只在上次的结果或过滤条件的候选中查找，不统计文档平均长度
+    bool narrowing {false};
+    //语音转写已命中的笔记，搜索线程不再重复查找
+    QSet<qint64> matchedNoteIds;
+    //标题索引拼音或模糊匹配的笔记
+    QSet<qint64> titleIndexHits;
+    //排序使用的文档平均长度，0表示未知
+    qreal averageLength {0};
+    //已搜索笔记的文本总长度和数量，用于更新平均长度
+    QAtomicInteger<qint64> totalLength {0};
+    QAtomicInt docCount {0};
+    //取消标志
+    QAtomicInt cancelled {0};
+    //未结束的线程数
+    QAtomicInt runningWorkers {0};
+};
+
+//搜索线程，多个线程从共享队列中分段领取笔记快照，分批返回结果
+//只读取快照，主线程修改笔记数据时不需要加锁
+class SearchNoteWorker : public VNTask
+{
+    Q_OBJECT
+public:
+    enum {
+        //每批返回的最大结果数
+        BatchSize = 32,
+        //每次领取的笔记数
+        DocChunkSize = 64
+    };
+
+    explicit SearchNoteWorker(const QSharedPointer<VNoteSearchContext> &context,
+                              QObject *parent = nullptr);
+
+signals:
+    //一批搜索结果
+    void searchBatch(quint64 queryId, const VNOTE_SEARCH_HITS &hits);
+    //所有线程搜索结束，只由最后一个结束的线程发送
+    void searchFinished(quint64 queryId);
+
+protected:
+    virtual void run() override;
+
+private:
+    //搜索是否已取消
+    bool isCancelled() const;
+    //搜索一段笔记
+    void searchDocs(int begin, int end, VNOTE_SEARCH_HITS &hits);
+    //搜索一个笔记，命中时计算排序分值、摘要并加入结果缓存
+    void searchDoc(const VNoteSearchDoc &doc, VNOTE_SEARCH_HITS &hits);
+    //发送缓存的结果
+    void flushHits(VNOTE_SEARCH_HITS &hits);
+
+    QSharedPointer<VNoteSearchContext> m_context;
+};
+
+#endif // SEARCHNOTEWORKER_H
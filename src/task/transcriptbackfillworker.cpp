@@ -0,0 +1,141 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "transcriptbackfillworker.h"
+#include "common/vnoteitem.h"
+#include "common/metadataparser.h"
+#include "db/vnotetranscriptoper.h"
+
+#include <QDebug>
+
+/**
+ * @brief TranscriptBackfillWorker::TranscriptBackfillWorker
+ * 只复制字符串，解析语音和写入数据库在线程中进行
+ * @param allNotesMap 所有笔记数据
+ * @param parent
+ */
+TranscriptBackfillWorker::TranscriptBackfillWorker(VNOTE_ALL_NOTES_MAP *allNotesMap, QObject *parent)
+    : VNTask(parent)
+{
+    if (nullptr == allNotesMap) {
+        return;
+    }
+
+    allNotesMap->lock.lockForRead();
+    for (VNOTE_ITEMS_MAP *folderNotes : allNotesMap->notes) {
+        folderNotes->lock.lockForRead();
+        for (VNoteItem *note : folderNotes->folderNotes) {
+            VoiceNote voiceNote;
+            voiceNote.folderId = note->folderId;
+            voiceNote.noteId = note->noteId;
+
+            if (!note->htmlCode.isEmpty()) {
+                if (note->htmlCode.contains("jsonkey")) {
+                    voiceNote.htmlCode = note->htmlCode;
+                    m_voiceNotes.append(voiceNote);
+                }
+                continue;
+            }
+
+            for (auto block : note->datas.dataConstRef()) {
+                if (VNoteBlock::Voice == block->getType() && !block->blockText.isEmpty()) {
+                    VNoteTranscript voice;
+                    voice.voicePath = block->ptrVoice->voicePath;
+                    voice.endTime = block->ptrVoice->voiceSize;
+                    voice.text = block->blockText;
+                    voiceNote.voices.append(voice);
+                }
+            }
+            if (!voiceNote.voices.isEmpty()) {
+                m_voiceNotes.append(voiceNote);
+            }
+        }
+        folderNotes->lock.unlock();
+    }
+    allNotesMap->lock.unlock();
+}
+
+/**
+ * @brief TranscriptBackfillWorker::run
+ * 写入时先删除同一语音已有的分段，重复执行不会产生重复数据
+ */
+void TranscriptBackfillWorker::run()
+{
+    int count = 0;
+    bool ok = true;
+    VNoteTranscriptOper transcriptOper;
+
+    for (VoiceNote &voiceNote : m_voiceNotes) {
+        if (!voiceNote.htmlCode.isEmpty()) {
+            voiceNote.voices = htmlVoices(voiceNote.htmlCode);
+        }
+
+        for (auto &voice : voiceNote.voices) {
+            VNOTE_TRANSCRIPTS transcripts = VNoteTranscriptOper::splitTranscript(voice.text, voice.endTime);
+            for (auto &it : transcripts) {
+                it.folderId = voiceNote.folderId;
+                it.noteId = voiceNote.noteId;
+                it.voicePath = voice.voicePath;
+            }
+
+            if (transcripts.isEmpty()) {
+                continue;
+            }
+
+            if (transcriptOper.addTranscripts(transcripts)) {
+                count++;
+            } else {
+                ok = false;
+            }
+        }
+    }
+
+    if (count > 0) {
+        qInfo() << "backfill voice transcripts:" << count;
+    }
+    emit backfillFinished(count, ok);
+}
+
+/**
+ * @brief TranscriptBackfillWorker::htmlVoices
+ * @param htmlCode 笔记内容
+ * @return 语音路径、时长及转写文本
+ */
+VNOTE_TRANSCRIPTS TranscriptBackfillWorker::htmlVoices(const QString &htmlCode)
+{
+    VNOTE_TRANSCRIPTS voices;
+    VNoteItem note;
+    note.htmlCode = htmlCode;
+    MetaDataParser dataParser;
+
+    for (auto &json : note.getVoiceJsons()) {
+        VNVoiceBlock voiceBlock;
+        if (dataParser.parse(json, &voiceBlock) && !voiceBlock.voicePath.isEmpty()
+                && !voiceBlock.blockText.isEmpty()) {
+            VNoteTranscript voice;
+            voice.voicePath = voiceBlock.voicePath;
+            voice.endTime = voiceBlock.voiceSize;
+            voice.text = voiceBlock.blockText;
+            voices.append(voice);
+        }
+    }
+
+    return voices;
+}
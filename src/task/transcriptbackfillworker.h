@@ -0,0 +1,64 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     V4fr3e <V4fr3e@deepin.io>
+*
+* Maintainer: V4fr3e <liujinli@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef TRANSCRIPTBACKFILLWORKER_H
+#define TRANSCRIPTBACKFILLWORKER_H
+
+#include "vntask.h"
+#include "datatypedef.h"
+
+/**
+ * @brief The TranscriptBackfillWorker class
+ * 旧数据迁移，转写分段表之前已保存在笔记中的语音转写文本拆分为分段写入数据库，使其可被搜索
+ */
+class TranscriptBackfillWorker : public VNTask
+{
+    Q_OBJECT
+public:
+    //在主线程中创建，包含语音的笔记内容在创建时复制
+    explicit TranscriptBackfillWorker(VNOTE_ALL_NOTES_MAP *allNotesMap, QObject *parent = nullptr);
+
+signals:
+    /**
+     * @brief 所有笔记处理完成
+     * @param count 写入的语音数量
+     * @param ok false 有语音写入失败
+     */
+    void backfillFinished(int count, bool ok);
+
+protected:
+    virtual void run() override;
+
+private:
+    //包含语音的笔记，旧版笔记直接保存语音转写文本，富文本笔记从html中解析
+    struct VoiceNote {
+        qint64 folderId {-1};
+        qint64 noteId {-1};
+        QString htmlCode;
+        VNOTE_TRANSCRIPTS voices;
+    };
+
+    //获取富文本笔记中的语音，转写文本为空的语音不返回
+    static VNOTE_TRANSCRIPTS htmlVoices(const QString &htmlCode);
+
+    QList<VoiceNote> m_voiceNotes;
+};
+
+#endif // TRANSCRIPTBACKFILLWORKER_H
@@ -22,6 +22,7 @@
 #include "leftviewsortfilter.h"
 #include "common/vnoteforlder.h"
 #include "common/standarditemcommon.h"
+#include "common/vnotetitleindex.h"
 
 /**
  * @brief LeftViewSortFilter::LeftViewSortFilter
@@ -76,6 +77,12 @@ bool LeftViewSortFilter::filterAcceptsRow(int source_row, const QModelIndex &sou
             return false;
         }
     }
+    //过滤时只显示名称匹配的记事本
+    if (!m_filterKeyword.isEmpty()
+        && StandardItemCommon::NOTEPADITEM == StandardItemCommon::getStandardItemType(index)
+        && nullptr != data && !m_filterFolderIds.contains(data->id)) {
+        return false;
+    }
     return true;
 }
 
@@ -88,3 +95,23 @@ void LeftViewSortFilter::setBlackFolders(const QList<VNoteFolder *> &folders)
     m_blackFolders = folders;
     invalidateFilter();
 }
+
+/**
+ * @brief LeftViewSortFilter::setFilterKeyword
+ * 关键字变化时查询一次名称索引，过滤时只做集合查找
+ * @param keyword 过滤关键字，为空时显示全部
+ */
+void LeftViewSortFilter::setFilterKeyword(const QString &keyword)
+{
+    m_filterKeyword = keyword.trimmed();
+    m_filterFolderIds.clear();
+
+    if (!m_filterKeyword.isEmpty()) {
+        QHash<qint64, qint64> results = VNoteTitleIndex::instance()->search(VNoteTitleIndex::FolderName, m_filterKeyword);
+        for (auto it = results.constBegin(); it != results.constEnd(); ++it) {
+            m_filterFolderIds.insert(it.key());
+        }
+    }
+
+    invalidateFilter();
+}
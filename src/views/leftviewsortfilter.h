@@ -23,6 +23,7 @@
 #define LEFTVIEWSORTFILTER_H
 #include <QSortFilterProxyModel>
 #include <QList>
+#include <QSet>
 
 struct VNoteFolder;
 //记事本排序过滤
@@ -32,6 +33,8 @@ public:
     explicit LeftViewSortFilter(QObject *parent = nullptr);
     //设置不显示项
     void setBlackFolders(const QList<VNoteFolder *> &folders);
+    //按名称过滤记事本，支持拼音、首字母及模糊匹配
+    void setFilterKeyword(const QString &keyword);
 
 protected:
     //处理排序
@@ -43,6 +46,9 @@ protected:
 
 private:
     QList<VNoteFolder *> m_blackFolders;
+    QString m_filterKeyword;
+    //名称索引中匹配关键字的记事本
+    QSet<qint64> m_filterFolderIds;
 };
 
 #endif // LEFTVIEWSORTFILTER_H
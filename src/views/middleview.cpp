@@ -28,7 +28,7 @@
 #include "common/standarditemcommon.h"
 #include "common/vnoteitem.h"
 #include "common/utils.h"
-#include "task/exportnoteworker.h"
+#include "common/vnoteexportengine.h"
 #include "common/setting.h"
 #include "db/vnoteitemoper.h"
 #include "moveview.h"
@@ -40,6 +40,7 @@
 #include <DWindowManagerHelper>
 
 #include <QMouseEvent>
+#include <algorithm>
 #include <QVBoxLayout>
 #include <QScrollBar>
 #include <QDrag>
@@ -79,6 +80,8 @@ void MiddleView::initModel()
     m_pSortViewFilter->setSourceModel(m_pDataModel);
 
     this->setModel(m_pSortViewFilter);
+
+    connect(m_pDataModel, &QStandardItemModel::rowsRemoved, this, &MiddleView::onModelRowsRemoved);
 }
 
 /**
@@ -167,12 +170,117 @@ void MiddleView::appendRow(VNoteItem *note)
     }
 }
 
+/**
+ * @brief MiddleView::appendRows
+ * 批量追加记事项，只触发一次行插入通知
+ * @param notes
+ */
+void MiddleView::appendRows(const QList<VNoteItem *> &notes)
+{
+    QList<QStandardItem *> items;
+    for (auto note : notes) {
+        if (nullptr != note) {
+            items.append(StandardItemCommon::createStandardItem(note, StandardItemCommon::NOTEITEM));
+        }
+    }
+
+    if (!items.isEmpty()) {
+        m_pDataModel->invisibleRootItem()->appendRows(items);
+    }
+}
+
+/**
+ * @brief MiddleView::mergeSearchRows
+ * 先对一批结果排序，再依次插入到已有结果中的位置，插入位置只向后查找
+ * 排序使用普通结构体，不读取数据项中的QVariant
+ * @param notes 一批搜索结果
+ * @param hits 搜索结果信息，与notes一一对应
+ */
+void MiddleView::mergeSearchRows(const QList<VNoteItem *> &notes, const VNOTE_SEARCH_HITS &hits)
+{
+    QVector<QPair<SearchRow, int>> batch;
+    for (int i = 0; i < notes.size() && i < hits.size(); i++) {
+        if (nullptr != notes.at(i)) {
+            SearchRow row;
+            row.score = hits.at(i).score;
+            row.modifyTime = notes.at(i)->modifyTime;
+            batch.append(qMakePair(row, i));
+        }
+    }
+
+    std::stable_sort(batch.begin(), batch.end(), [](const QPair<SearchRow, int> &left, const QPair<SearchRow, int> &right) {
+        return searchRowBefore(left.first, right.first);
+    });
+
+    syncSearchRows();
+
+    int pos = 0;
+    for (auto &it : batch) {
+        pos = static_cast<int>(std::upper_bound(m_searchRows.begin() + pos, m_searchRows.end(), it.first, searchRowBefore)
+                               - m_searchRows.begin());
+
+        QStandardItem *item = StandardItemCommon::createStandardItem(notes.at(it.second), StandardItemCommon::NOTEITEM);
+        StandardItemCommon::setStandardItemSearchHit(item, hits.at(it.second));
+        m_searchRows.insert(pos, it.first);
+        m_pDataModel->insertRow(pos, item);
+        pos++;
+    }
+}
+
+/**
+ * @brief MiddleView::searchRowBefore
+ * @param left
+ * @param right
+ * @return true left排在right之前
+ */
+bool MiddleView::searchRowBefore(const SearchRow &left, const SearchRow &right)
+{
+    if (!qFuzzyCompare(left.score, right.score)) {
+        return left.score > right.score;
+    }
+    return left.modifyTime > right.modifyTime;
+}
+
+/**
+ * @brief MiddleView::syncSearchRows
+ * 搜索结果只通过mergeSearchRows插入，其他方式插入行后才需要重新生成
+ */
+void MiddleView::syncSearchRows()
+{
+    int count = m_pDataModel->rowCount();
+    if (m_searchRows.size() == count) {
+        return;
+    }
+
+    m_searchRows.resize(count);
+    for (int i = 0; i < count; i++) {
+        QModelIndex index = m_pDataModel->index(i, 0);
+        VNoteItem *note = static_cast<VNoteItem *>(StandardItemCommon::getStandardItemData(index));
+        m_searchRows[i].score = StandardItemCommon::getStandardItemSearchHit(index).score;
+        m_searchRows[i].modifyTime = nullptr != note ? note->modifyTime : QDateTime();
+    }
+}
+
+/**
+ * @brief MiddleView::onModelRowsRemoved
+ * @param parent
+ * @param first 删除的第一行
+ * @param last 删除的最后一行
+ */
+void MiddleView::onModelRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (!parent.isValid() && last < m_searchRows.size()) {
+        m_searchRows.remove(first, last - first + 1);
+    }
+}
+
 /**
  * @brief MiddleView::clearAll
  */
 void MiddleView::clearAll()
 {
     m_pDataModel->clear();
+    m_searchRows.clear();
 }
 
 /**
@@ -281,6 +389,11 @@ void MiddleView::saveAs(SaveAsType type)
         return;
     }
 
+    //上次导出未完成时不再导出，进度提示中可取消
+    if (m_exportEngine->isExporting()) {
+        return;
+    }
+
     //文件筛选类型
     QStringList filterTypes {"TXT(*.txt);;HTML(*.html)", "TXT(*.txt)", "HTML(*.html)", "MP3(*.mp3)"};
     DFileDialog dialog(this);
@@ -361,11 +474,7 @@ void MiddleView::saveAs(SaveAsType type)
             defaultName += ".mp3";
         }
     }
-    ExportNoteWorker *exportWorker = new ExportNoteWorker(
-        exportDir, exportType, noteDataList, defaultName);
-    exportWorker->setAutoDelete(true);
-    connect(exportWorker, &ExportNoteWorker::exportFinished, this, &MiddleView::onExportFinished);
-    QThreadPool::globalInstance()->start(exportWorker);
+    m_exportEngine->exportNotes(exportDir, exportType, noteDataList, defaultName);
 }
 
 /**
@@ -1007,6 +1116,10 @@ void MiddleView::initUI()
     m_refreshTimer = new QTimer(this);
     connect(m_refreshTimer, &QTimer::timeout, this, &MiddleView::onRefresh);
     m_refreshTimer->start(30 * 1000);
+
+    m_exportEngine = new VNoteExportEngine(this);
+    connect(m_exportEngine, &VNoteExportEngine::exportProgress, this, &MiddleView::onExportProgress);
+    connect(m_exportEngine, &VNoteExportEngine::exportFinished, this, &MiddleView::onExportFinished);
 }
 
 /**
@@ -1122,7 +1235,9 @@ void MiddleView::noteStickOnTop()
  */
 void MiddleView::sortView(bool adjustCurrentItemBar)
 {
-    m_pSortViewFilter->sortView();
+    //搜索结果按相关度排序
+    m_pSortViewFilter->sortView(m_searchKey.isEmpty() ? MiddleViewSortFilter::modifyTime
+                                                      : MiddleViewSortFilter::score);
     if (adjustCurrentItemBar) {
         this->scrollTo(currentIndex(), DListView::PositionAtBottom);
     }
@@ -1376,6 +1491,10 @@ void MiddleView::onRefresh()
  */
 void MiddleView::onExportFinished(int err)
 {
+    if (m_exportMessage) {
+        m_exportMessage->setVisible(false);
+    }
+
     //保存文件失败
     if (ExportNoteWorker::Savefailed == err) {
         VNoteMessageDialog audioOutLimit(VNoteMessageDialog::SaveFailed);
@@ -1388,3 +1507,30 @@ void MiddleView::onExportFinished(int err)
         audioOutLimit.exec();
     }
 }
+
+/**
+ * @brief MiddleView::onExportProgress
+ * 导出多个笔记时显示进度
+ * @param finished 已导出的笔记数
+ * @param total 笔记总数
+ */
+void MiddleView::onExportProgress(int finished, int total)
+{
+    if (total <= 1 || !m_exportEngine->isExporting()) {
+        return;
+    }
+
+    if (nullptr == m_exportMessage) {
+        m_exportMessage = new DFloatingMessage(DFloatingMessage::ResidentType, this);
+        connect(m_exportMessage, &DFloatingMessage::closeButtonClicked, this, [this] {
+            m_exportEngine->cancel();
+            m_exportMessage->setVisible(false);
+        });
+    }
+
+    m_exportMessage->setMessage(DApplication::translate("MiddleView", "Exporting notes: %1/%2").arg(finished).arg(total));
+    m_exportMessage->setMaximumWidth(width());
+    m_exportMessage->adjustSize();
+    m_exportMessage->move((width() - m_exportMessage->width()) / 2, height() - m_exportMessage->height() - 5);
+    m_exportMessage->setVisible(true);
+}
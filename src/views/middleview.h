@@ -23,10 +23,12 @@
 #define MIDDLEVIEW_H
 
 #include "widgets/vnoterightmenu.h"
+#include "common/datatypedef.h"
 
 #include <DListView>
 #include <DMenu>
 #include <DLabel>
+#include <DFloatingMessage>
 
 #include <QDateTime>
 
@@ -34,6 +36,7 @@ DWIDGET_USE_NAMESPACE
 class MiddleViewDelegate;
 class MiddleViewSortFilter;
 class MoveView;
+class VNoteExportEngine;
 
 struct VNoteItem;
 //记事项列表
@@ -90,6 +93,10 @@ public:
     void addRowAtHead(VNoteItem *note);
     //尾部追加记事项
     void appendRow(VNoteItem *note);
+    //尾部批量追加记事项
+    void appendRows(const QList<VNoteItem *> &notes);
+    //按相关度合并一批搜索结果，已有结果不重新排序
+    void mergeSearchRows(const QList<VNoteItem *> &notes, const VNOTE_SEARCH_HITS &hits);
     //清除记事项
     void clearAll();
     //根据索引选中记事本
@@ -153,6 +160,8 @@ public slots:
     void onRefresh();
     //文件导出完成
     void onExportFinished(int err);
+    //文件导出进度
+    void onExportProgress(int finished, int total);
 
 protected:
     //鼠标事件
@@ -183,6 +192,18 @@ protected:
     void setMouseState(const MouseState &mouseState);
 
 private:
+    //搜索结果的排序信息，与数据模型中的行一一对应，按相关度从高到低排列
+    struct SearchRow {
+        qreal score {0};
+        QDateTime modifyTime;
+    };
+
+    //left是否排在right之前，相关度相同时修改时间较新的在前
+    static bool searchRowBefore(const SearchRow &left, const SearchRow &right);
+    //数据模型中的行与排序信息不一致时重新生成排序信息
+    void syncSearchRows();
+    //数据模型中删除行时同步删除排序信息
+    void onModelRowsRemoved(const QModelIndex &parent, int first, int last);
     //初始化代理模块
     void initDelegate();
     //初始化数据模块
@@ -208,6 +229,7 @@ private:
     VNoteRightMenu *m_noteMenu {nullptr};
 
     QStandardItemModel *m_pDataModel {nullptr};
+    QVector<SearchRow> m_searchRows;
     MiddleViewDelegate *m_pItemDelegate {nullptr};
     MiddleViewSortFilter *m_pSortViewFilter {nullptr};
     MoveView *m_MoveView {nullptr};
@@ -233,6 +255,10 @@ private:
     //拖拽完成标志
     bool m_dragSuccess {false};
     QTimer *m_refreshTimer {nullptr};
+    //笔记导出
+    VNoteExportEngine *m_exportEngine {nullptr};
+    //导出进度提示，关闭时取消导出
+    DFloatingMessage *m_exportMessage {nullptr};
 };
 
 #endif // MIDDLEVIEW_H
@@ -38,9 +38,11 @@
 #include <QDebug>
 
 static VNoteFolderOper FolderOper;
+//搜索项摘要行高度
+static const int SNIPPET_HEIGHT = 20;
 /**
  * @brief The VNoteTextPHelper struct
- * 搜索关键字分割字符串高亮显示
+ * 按搜索时计算好的高亮区间分割字符串显示
  */
 struct VNoteTextPHelper {
     VNoteTextPHelper(QPainter *painter, QFontMetrics fontMetrics, QRect nameRect)
@@ -71,8 +73,10 @@ struct VNoteTextPHelper {
         FolderPen,
         PenCount
     };
-    //分割字符串
-    void spiltByKeyword(const QString &text, const QString &keyword);
+    //按高亮区间分割字符串
+    void splitByRanges(const QString &text, const VNOTE_TEXT_RANGES &ranges);
+    //添加一段文本
+    void appendText(const QString &text, bool isKeyword);
     //绘制文本
     void paintText(bool isSelected = false);
 
@@ -84,60 +88,54 @@ struct VNoteTextPHelper {
 };
 
 /**
- * @brief VNoteTextPHelper::spiltByKeyword
- * @param text 记事项名称
- * @param keyword 搜索关键字
+ * @brief VNoteTextPHelper::splitByRanges
+ * @param text 显示文本
+ * @param ranges 高亮区间，按位置升序
  */
-void VNoteTextPHelper::spiltByKeyword(const QString &text, const QString &keyword)
+void VNoteTextPHelper::splitByRanges(const QString &text, const VNOTE_TEXT_RANGES &ranges)
 {
     //Check if text exceed the name rect, elide the
     //text first
     QString elideText = m_fontMetrics.elidedText(text, Qt::ElideRight, m_nameRect.width());
-
-    int keyLen = keyword.length();
-    int textLen = text.length();
+    //省略后只有省略号之前的内容可以高亮
+    int visibleLen = (elideText == text) ? text.length() : elideText.length() - 1;
     int startPos = 0;
     m_textsVector.clear();
 
-    if (!keyword.isEmpty()) {
-        int pos = 0;
-        while ((pos = elideText.indexOf(keyword, startPos, Qt::CaseInsensitive)) != -1) {
-            Text tb;
-
-            if (startPos != pos) {
-                int extraLen = pos - startPos;
-                tb.text = elideText.mid(startPos, extraLen);
-                startPos += extraLen;
-
-                tb.rect = QRect(0, 0, m_fontMetrics.width(tb.text), m_fontMetrics.height());
-
-                m_textsVector.push_back(tb);
-
-                tb.text = elideText.mid(pos, keyLen);
-                tb.rect = QRect(0, 0, m_fontMetrics.width(tb.text), m_fontMetrics.height());
-                tb.isKeyword = true;
-                m_textsVector.push_back(tb);
-            } else {
-                tb.text = elideText.mid(pos, keyLen);
-                tb.rect = QRect(0, 0, m_fontMetrics.width(tb.text), m_fontMetrics.height());
-                tb.isKeyword = true;
-                m_textsVector.push_back(tb);
-            }
+    for (auto &range : ranges) {
+        int pos = qMax(range.first, startPos);
+        int end = qMin(range.first + range.second, visibleLen);
+        if (pos >= end) {
+            continue;
+        }
 
-            startPos += keyLen;
+        if (startPos != pos) {
+            appendText(elideText.mid(startPos, pos - startPos), false);
         }
+
+        appendText(elideText.mid(pos, end - pos), true);
+        startPos = end;
     }
 
     if (startPos < elideText.length()) {
-        Text tb;
-
-        tb.text = elideText.mid(startPos, (textLen - startPos));
-        tb.rect = QRect(0, 0, m_fontMetrics.width(tb.text), m_fontMetrics.height());
-
-        m_textsVector.push_back(tb);
+        appendText(elideText.mid(startPos), false);
     }
 }
 
+/**
+ * @brief VNoteTextPHelper::appendText
+ * @param text 文本
+ * @param isKeyword true 高亮显示
+ */
+void VNoteTextPHelper::appendText(const QString &text, bool isKeyword)
+{
+    Text tb;
+    tb.text = text;
+    tb.rect = QRect(0, 0, m_fontMetrics.width(tb.text), m_fontMetrics.height());
+    tb.isKeyword = isKeyword;
+    m_textsVector.push_back(tb);
+}
+
 /**
  * @brief VNoteTextPHelper::paintText
  * @param isSelected true 绘制项为选中项
@@ -250,7 +248,8 @@ QSize MiddleViewDelegate::sizeHint(const QStyleOptionViewItem &option, const QMo
         }
         return QSize(option.rect.width(), height);
     } else {
-        return QSize(option.rect.width(), 102);
+        //搜索项多一行正文摘要
+        return QSize(option.rect.width(), 102 + SNIPPET_HEIGHT);
     }
 }
 
@@ -495,8 +494,11 @@ void MiddleViewDelegate::paintSearchItem(QPainter *painter, const QStyleOptionVi
     painter->setFont(DFontSizeManager::instance()->get(DFontSizeManager::T6));
     paintItemBase(painter, option, paintRect, isSelect);
 
+    //排序分值、摘要及高亮区间在搜索时已计算，绘制时不再查找关键字
+    VNoteSearchHit searchHit = StandardItemCommon::getStandardItemSearchHit(index);
     QRect itemRect = paintRect;
-    itemRect.setHeight(itemRect.height() - 34);
+    itemRect.setHeight(itemRect.height() - 34 - SNIPPET_HEIGHT);
+    QRect snippetRect(itemRect.left() + 20, itemRect.bottom(), itemRect.width() - 40, SNIPPET_HEIGHT);
     painter->setFont(DFontSizeManager::instance()->get(DFontSizeManager::T6));
     QFontMetrics fontMetrics = painter->fontMetrics();
 
@@ -506,7 +508,7 @@ void MiddleViewDelegate::paintSearchItem(QPainter *painter, const QStyleOptionVi
         space += fontMetrics.height();
         QRect timeRect(itemRect.left() + 20, space, itemRect.width() - 40, fontMetrics.height());
         VNoteTextPHelper vfnphelper(painter, fontMetrics, nameRect);
-        vfnphelper.spiltByKeyword(noteData->noteTitle, m_searchKey);
+        vfnphelper.splitByRanges(noteData->noteTitle, searchHit.titleRanges);
         vfnphelper.paintText(isSelect);
 
         if (!isSelect) {
@@ -522,11 +524,17 @@ void MiddleViewDelegate::paintSearchItem(QPainter *painter, const QStyleOptionVi
         painter->setFont(DFontSizeManager::instance()->get(DFontSizeManager::T8));
     }
 
+    if (!searchHit.snippet.isEmpty()) {
+        VNoteTextPHelper snippetHelper(painter, painter->fontMetrics(), snippetRect);
+        snippetHelper.splitByRanges(searchHit.snippet, searchHit.snippetRanges);
+        snippetHelper.paintText(isSelect);
+    }
+
     VNoteFolder *folderData = FolderOper.getFolder(noteData->folderId);
     if (folderData) {
         fontMetrics = painter->fontMetrics();
         QRect folderRect = itemRect;
-        folderRect.setY(itemRect.bottom());
+        folderRect.setY(snippetRect.bottom());
         QRect iconRect(folderRect.left() + 20, folderRect.top() + (fontMetrics.height() - 24) / 2, 24, 24);
         painter->drawPixmap(iconRect, folderData->UI.icon);
         QRect folderNameRect(iconRect.right() + 12, folderRect.top(),
@@ -44,7 +44,8 @@ void MiddleViewSortFilter::sortView(MiddleViewSortFilter::sortFeild feild,
 {
     m_sortFeild = feild;
 
-    sort(column, order);
+    //搜索结果在插入时已按相关度排列，保持数据模型中的顺序
+    sort(score == feild ? -1 : column, order);
 }
 
 /**
@@ -74,6 +75,8 @@ bool MiddleViewSortFilter::lessThan(
             return (leftNote->createTime < rightNote->createTime);
         case title:
             return (leftNote->noteTitle < rightNote->noteTitle);
+        case score:
+            break;
         }
     }
 
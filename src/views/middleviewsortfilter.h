@@ -33,6 +33,7 @@ public:
         title,
         createTime,
         modifyTime,
+        score,
     };
     //执行排序
     void sortView(
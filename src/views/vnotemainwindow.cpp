@@ -35,6 +35,10 @@
 #include "common/vnoteforlder.h"
 #include "common/actionmanager.h"
 #include "common/metadataparser.h"
+#include "common/vnotesearchengine.h"
+#include "common/vnotesearchquery.h"
+#include "common/vnoteattachmentstore.h"
+#include "common/vnoteeditorjournal.h"
 
 #include "widgets/vnotemultiplechoiceoptionwidget.h"
 
@@ -47,6 +51,7 @@
 #include "db/vnotefolderoper.h"
 #include "db/vnoteitemoper.h"
 #include "db/vnotedbmanager.h"
+#include "db/vnotetranscriptoper.h"
 
 #include "dbus/dbuslogin1manager.h"
 
@@ -55,6 +60,10 @@
 #include "widgets/vnoteiconbutton.h"
 #include "task/vnmainwnddelayinittask.h"
 #include "task/filecleanupworker.h"
+#include "task/inlineimagemigrationworker.h"
+#include "task/transcriptbackfillworker.h"
+#include "task/libraryexportworker.h"
+#include "task/libraryimportworker.h"
 
 #ifdef IMPORT_OLD_VERSION_DATA
 #include "importolddata/upgradeview.h"
@@ -95,10 +104,13 @@ VNoteMainWindow::VNoteMainWindow(QWidget *parent)
     initData();
     initShortcuts();
     initA2TManager();
+    initSearchEngine();
     //Init the login manager
     initLogin1Manager();
     //Init delay task
     delayInitTasks();
+    //编辑器页面在窗口显示后创建，与笔记数据加载并行
+    QTimer::singleShot(0, m_richTextEdit, &WebRichTextEditor::preparePage);
 }
 
 /**
@@ -206,6 +218,7 @@ void VNoteMainWindow::initConnections()
             this, &VNoteMainWindow::onThemeChanged);
     connect(JsContent::instance(), &JsContent::playVoice, this, &VNoteMainWindow::onWebVoicePlay);
     connect(m_richTextEdit, &WebRichTextEditor::currentSearchEmpty, this, &VNoteMainWindow::onWebSearchEmpty);
+    connect(m_richTextEdit, &WebRichTextEditor::searchMatchChanged, this, &VNoteMainWindow::onWebSearchMatchChanged);
     connect(m_richTextEdit, &WebRichTextEditor::contentChanged, m_middleView, &MiddleView::onNoteChanged, Qt::QueuedConnection);
     //创建笔记
     connect(JsContent::instance(), &JsContent::createNote, this, &VNoteMainWindow::onAddNoteShortcut, Qt::QueuedConnection);
@@ -219,6 +232,8 @@ void VNoteMainWindow::changeRightView(bool isMultiple)
 {
     m_multipleSelectWidget->setNoteNumber(m_middleView->getSelectedCount());
     if (isMultiple) {
+        //多选时详情页不显示笔记，取消未开始的加载
+        m_richTextEdit->cancelPendingLoad();
         if (m_stackedRightMainWidget->currentWidget() == m_rightViewHolder) {
             m_stackedRightMainWidget->setCurrentWidget(m_multipleSelectWidget);
         }
@@ -235,7 +250,7 @@ void VNoteMainWindow::changeRightView(bool isMultiple)
         if (m_stackedRightMainWidget->currentWidget() == m_multipleSelectWidget) {
             m_stackedRightMainWidget->setCurrentWidget(m_rightViewHolder);
             //多选切换为详情页时，刷新数据
-            m_richTextEdit->initData(m_middleView->getCurrVNotedata(), m_searchKey);
+            m_richTextEdit->initData(m_middleView->getCurrVNotedata(), m_searchKeyword);
         }
         //恢复单选如果有笔记图片按钮可用
         if (nullptr != m_middleView->getCurrVNotedata()) {
@@ -371,8 +386,19 @@ void VNoteMainWindow::initTitleBar()
     m_noteSearchEdit->setPlaceHolder(DApplication::translate("TitleBar", "Search"));
     m_noteSearchEdit->lineEdit()->installEventFilter(this);
 
+    //搜索框右侧显示当前笔记的命中位置
+    m_searchMatchLabel = new DLabel(this);
+    DFontSizeManager::instance()->bind(m_searchMatchLabel, DFontSizeManager::T8);
+    m_searchMatchLabel->setFixedWidth(60);
+    QWidget *searchWidget = new QWidget();
+    QHBoxLayout *searchLayout = new QHBoxLayout(searchWidget);
+    searchLayout->setContentsMargins(0, 0, 0, 0);
+    searchLayout->setSpacing(5);
+    searchLayout->addWidget(m_noteSearchEdit);
+    searchLayout->addWidget(m_searchMatchLabel);
+
     titlebar()->addWidget(titleWidget, Qt::AlignLeft); //图标控件居左显示
-    titlebar()->addWidget(m_noteSearchEdit, Qt::AlignCenter); //将搜索框添加到标题栏居中显示
+    titlebar()->addWidget(searchWidget, Qt::AlignCenter); //将搜索框添加到标题栏居中显示
 
     QWidget::setTabOrder(titlebar(), m_viewChange); //设置title焦点传递的下一个控件
     QWidget::setTabOrder(m_viewChange, m_imgInsert); //设置焦点传递顺序
@@ -587,6 +613,25 @@ void VNoteMainWindow::initA2TManager()
     connect(m_a2tManager, &VNoteA2TManager::asrSuccess, this, &VNoteMainWindow::onA2TSuccess);
 }
 
+/**
+ * @brief VNoteMainWindow::initSearchEngine
+ */
+void VNoteMainWindow::initSearchEngine()
+{
+    m_searchEngine = new VNoteSearchEngine(this);
+
+    m_searchDelayTimer = new QTimer(this);
+    m_searchDelayTimer->setSingleShot(true);
+    m_searchDelayTimer->setInterval(SEARCH_INPUT_DELAY_TIME);
+    connect(m_searchDelayTimer, &QTimer::timeout,
+            this, &VNoteMainWindow::onSearchDelayTimeout);
+
+    connect(m_searchEngine, &VNoteSearchEngine::searchResultReady,
+            this, &VNoteMainWindow::onSearchResultReady);
+    connect(m_searchEngine, &VNoteSearchEngine::searchFinished,
+            this, &VNoteMainWindow::onSearchFinished);
+}
+
 /**
  * @brief VNoteMainWindow::initLogin1Manager
  */
@@ -655,6 +700,33 @@ void VNoteMainWindow::delayInitTasks()
     QThreadPool::globalInstance()->start(pMainWndDelayTask);
 }
 
+/**
+ * @brief VNoteMainWindow::recoverEditorJournal
+ * 正常退出时日志为空，只在网页或程序崩溃后有内容
+ * @return false 有笔记保存失败，日志保留到下次启动
+ */
+bool VNoteMainWindow::recoverEditorJournal()
+{
+    QMap<VNoteJournalKey, QString> notes = VNoteEditorJournal::replay();
+    VNoteItemOper noteOper;
+    for (auto it = notes.begin(); it != notes.end(); ++it) {
+        VNoteItem *note = noteOper.getNote(it.key().first, it.key().second);
+        if (nullptr == note || note->htmlCode == it.value()) {
+            continue;
+        }
+
+        qInfo() << "recover note from editor journal:" << note->noteId;
+        note->htmlCode = it.value();
+        VNoteItemOper noteOps(note);
+        if (!noteOps.updateNote()) {
+            //保存失败时保留日志，下次启动再恢复
+            return false;
+        }
+    }
+    VNoteEditorJournal::discard();
+    return true;
+}
+
 /**
  * @brief VNoteMainWindow::onVNoteFoldersLoaded
  */
@@ -668,6 +740,9 @@ void VNoteMainWindow::onVNoteFoldersLoaded()
     }
 #endif
 
+    //打开笔记前恢复日志中的内容
+    bool journalRecovered = recoverEditorJournal();
+
     //If have folders show note view,else show
     //default home page
     if (loadNotepads() > 0) {
@@ -680,11 +755,257 @@ void VNoteMainWindow::onVNoteFoldersLoaded()
     PerformanceMonitor::initializeAppFinish();
 
     //注册文件清理工作
-    FileCleanupWorker *pFileCleanupWorker =
-        new FileCleanupWorker(VNoteDataManager::instance()->getAllNotesInFolder(), this);
-    pFileCleanupWorker->setAutoDelete(true);
-    pFileCleanupWorker->setObjectName("FileCleanupWorker");
-    QThreadPool::globalInstance()->start(pFileCleanupWorker);
+    //日志未恢复时其中引用的附件未计入引用，本次启动不清理
+    if (journalRecovered) {
+        FileCleanupWorker *pFileCleanupWorker =
+            new FileCleanupWorker(VNoteDataManager::instance()->getAllNotesInFolder(), this);
+        pFileCleanupWorker->setAutoDelete(true);
+        pFileCleanupWorker->setObjectName("FileCleanupWorker");
+        QThreadPool::globalInstance()->start(pFileCleanupWorker);
+    } else {
+        qWarning() << "editor journal pending, skip file cleanup";
+    }
+
+    migrateInlineImages();
+    backfillTranscripts();
+}
+
+/**
+ * @brief VNoteMainWindow::migrateInlineImages
+ * 旧版本粘贴的网页图片以data协议保存在笔记内容中，插入的图片以本地路径保存，
+ * 迁移后都替换为附件url，新插入的图片由编辑区存入
+ */
+void VNoteMainWindow::migrateInlineImages()
+{
+    if (setting::instance()->getOption(VNOTE_INLINE_IMAGE_MIGRATED_KEY).toBool()) {
+        return;
+    }
+
+    m_inlineMigrationFailed = false;
+    InlineImageMigrationWorker *worker =
+        new InlineImageMigrationWorker(VNoteDataManager::instance()->getAllNotesInFolder());
+    worker->setAutoDelete(true);
+    worker->setObjectName("InlineImageMigrationWorker");
+    connect(worker, &InlineImageMigrationWorker::noteMigrated,
+            this, &VNoteMainWindow::onInlineImagesMigrated, Qt::QueuedConnection);
+    connect(worker, &InlineImageMigrationWorker::migrationFinished,
+            this, &VNoteMainWindow::onInlineImageMigrationFinished, Qt::QueuedConnection);
+    QThreadPool::globalInstance()->start(worker);
+}
+
+/**
+ * @brief VNoteMainWindow::onInlineImagesMigrated
+ * 迁移期间笔记已被编辑或删除时不保存，编辑区打开笔记时会存入其中的内嵌图片
+ * @param folderId 记事本id
+ * @param noteId 笔记id
+ * @param html 迁移前的内容
+ * @param newHtml 迁移后的内容
+ */
+void VNoteMainWindow::onInlineImagesMigrated(qint64 folderId, qint32 noteId, const QString &html, const QString &newHtml)
+{
+    VNoteItemOper noteOper;
+    VNoteItem *note = noteOper.getNote(folderId, noteId);
+    if (nullptr == note || note->htmlCode != html) {
+        return;
+    }
+
+    note->htmlCode = newHtml;
+    VNoteItemOper noteOps(note);
+    if (!noteOps.updateNote(false)) {
+        note->htmlCode = html;
+        m_inlineMigrationFailed = true;
+    }
+}
+
+/**
+ * @brief VNoteMainWindow::onInlineImageMigrationFinished
+ */
+void VNoteMainWindow::onInlineImageMigrationFinished()
+{
+    if (!m_inlineMigrationFailed) {
+        setting::instance()->setOption(VNOTE_INLINE_IMAGE_MIGRATED_KEY, true);
+    }
+}
+
+/**
+ * @brief VNoteMainWindow::backfillTranscripts
+ * 转写分段表之前转写的语音只保存在笔记内容中，写入分段表后才能被搜索到
+ */
+void VNoteMainWindow::backfillTranscripts()
+{
+    if (setting::instance()->getOption(VNOTE_TRANSCRIPT_BACKFILLED_KEY).toBool()) {
+        return;
+    }
+
+    TranscriptBackfillWorker *worker =
+        new TranscriptBackfillWorker(VNoteDataManager::instance()->getAllNotesInFolder());
+    worker->setAutoDelete(true);
+    worker->setObjectName("TranscriptBackfillWorker");
+    connect(worker, &TranscriptBackfillWorker::backfillFinished,
+            this, &VNoteMainWindow::onTranscriptBackfillFinished, Qt::QueuedConnection);
+    QThreadPool::globalInstance()->start(worker);
+}
+
+/**
+ * @brief VNoteMainWindow::onTranscriptBackfillFinished
+ * 有语音写入失败时下次启动重新执行
+ * @param count 写入的语音数量
+ * @param ok 全部写入成功
+ */
+void VNoteMainWindow::onTranscriptBackfillFinished(int count, bool ok)
+{
+    Q_UNUSED(count);
+    if (ok) {
+        setting::instance()->setOption(VNOTE_TRANSCRIPT_BACKFILLED_KEY, true);
+    }
+}
+
+/**
+ * @brief VNoteMainWindow::exportLibrary
+ * 记事本、笔记及引用的附件导出为一个归档文件，可在其他设备上导入
+ * @param folders 导出的记事本
+ */
+void VNoteMainWindow::exportLibrary(const QList<VNoteFolder *> &folders)
+{
+    if (m_libraryBusy || folders.isEmpty()) {
+        return;
+    }
+
+    QString historyDir = setting::instance()->getOption(VNOTE_EXPORT_TEXT_PATH_KEY).toString();
+    if (historyDir.isEmpty()) {
+        historyDir = QStandardPaths::writableLocation(QStandardPaths::DesktopLocation);
+    }
+
+    QString defaultName = 1 == folders.size() ? folders.first()->name
+                                              : DApplication::translate("VNoteMainWindow", "Notebooks");
+    QString filePath = DFileDialog::getSaveFileName(
+        this,
+        "",
+        historyDir + "/" + Utils::filteredFileName(defaultName + ".tar"),
+        "Notebook archive(*.tar)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+    if (!filePath.endsWith(".tar")) {
+        filePath += ".tar";
+    }
+
+    m_libraryBusy = true;
+    LibraryExportWorker *worker = new LibraryExportWorker(filePath, folders);
+    worker->setAutoDelete(true);
+    worker->setObjectName("LibraryExportWorker");
+    connect(worker, &LibraryExportWorker::exportFinished,
+            this, &VNoteMainWindow::onLibraryExportFinished, Qt::QueuedConnection);
+    QThreadPool::globalInstance()->start(worker);
+}
+
+/**
+ * @brief VNoteMainWindow::exportAllFolders
+ */
+void VNoteMainWindow::exportAllFolders()
+{
+    QList<VNoteFolder *> folders;
+    VNOTE_FOLDERS_MAP *foldersMap = VNoteDataManager::instance()->getNoteFolders();
+
+    if (nullptr != foldersMap) {
+        foldersMap->lock.lockForRead();
+        folders = foldersMap->folders.values();
+        foldersMap->lock.unlock();
+    }
+
+    exportLibrary(folders);
+}
+
+/**
+ * @brief VNoteMainWindow::importLibrary
+ * 归档中的记事本作为新记事本导入，不与已有记事本合并
+ */
+void VNoteMainWindow::importLibrary()
+{
+    if (m_libraryBusy) {
+        return;
+    }
+
+    QString filePath = DFileDialog::getOpenFileName(
+        this,
+        "",
+        QStandardPaths::writableLocation(QStandardPaths::DesktopLocation),
+        "Notebook archive(*.tar)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    m_libraryBusy = true;
+    LibraryImportWorker *worker = new LibraryImportWorker(filePath);
+    worker->setAutoDelete(true);
+    worker->setObjectName("LibraryImportWorker");
+    connect(worker, &LibraryImportWorker::importFinished,
+            this, &VNoteMainWindow::onLibraryImportFinished, Qt::QueuedConnection);
+    QThreadPool::globalInstance()->start(worker);
+}
+
+/**
+ * @brief VNoteMainWindow::onLibraryExportFinished
+ * @param state 导出结果
+ */
+void VNoteMainWindow::onLibraryExportFinished(int state)
+{
+    m_libraryBusy = false;
+
+    if (LibraryExportWorker::ExportOK != state) {
+        showAsrErrMessage(DApplication::translate("VNoteMainWindow", "Failed to export notebooks"));
+    }
+}
+
+/**
+ * @brief VNoteMainWindow::onLibraryImportFinished
+ * 导入的记事本排在已有记事本之前，选中最后一个导入的记事本
+ * @param state 导入结果
+ * @param library 导入数据
+ */
+void VNoteMainWindow::onLibraryImportFinished(int state, VNoteLibraryData *library)
+{
+    QScopedPointer<VNoteLibraryData> autoRelease(library);
+    m_libraryBusy = false;
+
+    if (LibraryImportWorker::ImportOK != state || nullptr == library) {
+        showAsrErrMessage(DApplication::translate("VNoteMainWindow", "Failed to import notebooks"));
+        return;
+    }
+
+    VNoteFolderOper folderOper;
+    QList<VNoteFolder *> folders = folderOper.addImportedFolders(library);
+    if (folders.isEmpty()) {
+        return;
+    }
+
+    switchWidget(WndNoteShow);
+    m_richTextEdit->unboundCurrentNoteData();
+
+    bool sortEnable = false;
+    VNoteFolder *firstFolder = m_leftView->getFirstFolder();
+    qint32 sortNumber = -1;
+    if (firstFolder && -1 != firstFolder->sortNumber) {
+        sortNumber = firstFolder->sortNumber;
+        sortEnable = true;
+    }
+
+    for (int i = 0; i < folders.size(); i++) {
+        if (sortEnable) {
+            folders.at(i)->sortNumber = ++sortNumber;
+        }
+        //只选中最后一个，避免逐个加载笔记列表
+        if (i == folders.size() - 1) {
+            m_leftView->addFolder(folders.at(i));
+        } else {
+            m_leftView->appendFolder(folders.at(i));
+        }
+    }
+    m_leftView->sort();
+
+    if (sortEnable) {
+        setting::instance()->setOption(VNOTE_FOLDER_SORT, m_leftView->getFolderSort());
+    }
 }
 
 /**
@@ -693,19 +1014,23 @@ void VNoteMainWindow::onVNoteFoldersLoaded()
 void VNoteMainWindow::onVNoteSearch()
 {
     if (m_noteSearchEdit->lineEdit()->hasFocus()) {
+        //回车立即搜索，无需等待输入停顿
+        m_searchDelayTimer->stop();
         QString text = m_noteSearchEdit->text();
         if (!text.isEmpty()) {
             //搜索内容不为空，切换为单选详情页面
             changeRightView(false);
             setSpecialStatus(SearchStart);
-            if (m_searchKey == text && m_stackedRightMainWidget->currentWidget() == m_richTextEdit) { //搜索关键字不变只更新当前笔记搜索
-                m_richTextEdit->searchText(m_searchKey);
+            if (m_searchKey == text && m_searchEngine->isCompleted()
+                && m_stackedRightMainWidget->currentWidget() == m_richTextEdit) { //搜索关键字不变跳转到下一个命中位置，Shift+回车跳转到上一个
+                m_richTextEdit->findNext(QApplication::keyboardModifiers() & Qt::ShiftModifier);
             } else {
                 m_searchKey = text;
+                m_searchKeyword = VNoteSearchQuery::parse(text).keyword();
                 //重新搜索之前先更新笔记内容
-                m_richTextEdit->updateNote();
-                //重新搜索
-                loadSearchNotes(m_searchKey);
+                m_richTextEdit->updateNote([this] {
+                    onNoteUpdatedForSearch();
+                });
             }
         } else {
             setSpecialStatus(SearchEnd);
@@ -719,8 +1044,45 @@ void VNoteMainWindow::onVNoteSearch()
  */
 void VNoteMainWindow::onVNoteSearchTextChange(const QString &text)
 {
+    //关键字改变后正在进行的搜索已无效
+    m_searchEngine->cancel();
     if (text.isEmpty()) {
+        m_searchDelayTimer->stop();
         setSpecialStatus(SearchEnd);
+    } else {
+        //输入停顿后再搜索，避免每次按键都触发搜索
+        m_searchDelayTimer->start();
+    }
+}
+
+/**
+ * @brief VNoteMainWindow::onSearchDelayTimeout
+ */
+void VNoteMainWindow::onSearchDelayTimeout()
+{
+    QString text = m_noteSearchEdit->text();
+    if (text.isEmpty() || (m_searchKey == text && m_searchEngine->isCompleted())) {
+        return;
+    }
+
+    changeRightView(false);
+    setSpecialStatus(SearchStart);
+    m_searchKey = text;
+    m_searchKeyword = VNoteSearchQuery::parse(text).keyword();
+    //重新搜索之前先更新笔记内容
+    m_richTextEdit->updateNote([this] {
+        onNoteUpdatedForSearch();
+    });
+}
+
+/**
+ * @brief VNoteMainWindow::onNoteUpdatedForSearch
+ * 笔记内容保存完成后开始搜索，保存期间关键字已修改时由新的关键字重新搜索
+ */
+void VNoteMainWindow::onNoteUpdatedForSearch()
+{
+    if (!m_searchKey.isEmpty() && m_noteSearchEdit->text() == m_searchKey) {
+        loadSearchNotes(m_searchKey);
     }
 }
 
@@ -738,7 +1100,7 @@ void VNoteMainWindow::onVNoteFolderChange(const QModelIndex &current, const QMod
     VNoteFolder *data = static_cast<VNoteFolder *>(StandardItemCommon::getStandardItemData(current));
     if (!loadNotes(data)) {
         m_stackedRightMainWidget->setCurrentWidget(m_rightViewHolder);
-        m_richTextEdit->initData(nullptr, m_searchKey, false);
+        m_richTextEdit->initData(nullptr, m_searchKeyword, false);
         m_imgInsert->setDisabled(true);
         m_recordBar->setVisible(false);
     }
@@ -829,7 +1191,9 @@ void VNoteMainWindow::onStartRecord(const QString &path)
 void VNoteMainWindow::onFinshRecord(const QString &voicePath, qint64 voiceSize)
 {
     if (voiceSize >= 1000) {
-        m_richTextEdit->insertVoiceItem(voicePath, voiceSize);
+        //录音文件移入附件仓库，失败时使用原文件
+        QString storePath = VNoteAttachmentStore::storeFile(voicePath, VNoteAttachment::Voice, true);
+        m_richTextEdit->insertVoiceItem(storePath.isEmpty() ? voicePath : storePath, voiceSize);
     }
     setSpecialStatus(RecordEnd);
 
@@ -860,6 +1224,12 @@ void VNoteMainWindow::onA2TStart(const VNVoiceBlock *voiceBlock)
         audioOutLimit.exec();
     } else {
         setSpecialStatus(VoiceToTextStart); //更新状态
+        //记录转写的语音所属笔记，转写过程中可能切换笔记
+        VNoteItem *note = m_middleView->getCurrVNotedata();
+        m_asrVoice.folderId = note ? note->folderId : -1;
+        m_asrVoice.noteId = note ? note->noteId : -1;
+        m_asrVoice.voicePath = m_voiceBlock->voicePath;
+        m_asrVoice.endTime = m_voiceBlock->voiceSize;
         QTimer::singleShot(0, this, [this]() {
             m_a2tManager->startAsr(m_voiceBlock->voicePath, m_voiceBlock->voiceSize); //开始转文字
         });
@@ -897,6 +1267,14 @@ void VNoteMainWindow::onA2TSuccess(const QString &text)
 {
     emit JsContent::instance()->callJsSetVoiceText(text, JsContent::AsrFlag::End); //将转写后的文本发送到web端
     setSpecialStatus(VoiceToTextEnd); //更新状态
+
+    //保存转写分段，搜索时可定位到语音中的位置
+    VNoteItemOper noteOper;
+    VNoteItem *note = noteOper.getNote(m_asrVoice.folderId, static_cast<qint32>(m_asrVoice.noteId));
+    if (nullptr != note) {
+        VNoteTranscriptOper transcriptOper(note);
+        transcriptOper.saveTranscript(m_asrVoice.voicePath, m_asrVoice.endTime, text);
+    }
 }
 
 /**
@@ -1123,7 +1501,7 @@ void VNoteMainWindow::onVNoteChange(const QModelIndex &previous)
     }
     //多选笔记时不更新详情页内容
     if (!m_middleView->isMultipleSelected()) {
-        m_richTextEdit->initData(data, m_searchKey, m_rightViewHasFouse);
+        m_richTextEdit->initData(data, m_searchKeyword, m_rightViewHasFouse);
     }
     //没有数据，插入图片按钮禁用
     m_imgInsert->setDisabled(nullptr == data);
@@ -1150,6 +1528,12 @@ void VNoteMainWindow::onMenuAction(QAction *action)
     case ActionManager::NotebookAddNew:
         addNote();
         break;
+    case ActionManager::NotebookExport: {
+        VNoteFolder *folder = static_cast<VNoteFolder *>(StandardItemCommon::getStandardItemData(m_leftView->currentIndex()));
+        if (nullptr != folder) {
+            exportLibrary({folder});
+        }
+    } break;
     case ActionManager::NoteDelete: {
         VNoteMessageDialog confirmDialog(VNoteMessageDialog::DeleteNote, this, m_middleView->getSelectedCount());
         if (VNoteBaseDialog::Accepted == confirmDialog.exec()) {
@@ -1268,6 +1652,8 @@ void VNoteMainWindow::onMenuAbout2Show()
             ActionManager::Instance()->enableAction(ActionManager::NotebookAddNew, false);
             ActionManager::Instance()->enableAction(ActionManager::NotebookDelete, false);
         }
+
+        ActionManager::Instance()->enableAction(ActionManager::NotebookExport, !m_libraryBusy);
     }
 }
 
@@ -1478,38 +1864,58 @@ int VNoteMainWindow::loadNotes(VNoteFolder *folder)
 /**
  * @brief VNoteMainWindow::loadSearchNotes
  * @param key
- * @return 记事项数量
  */
-int VNoteMainWindow::loadSearchNotes(const QString &key)
+void VNoteMainWindow::loadSearchNotes(const QString &key)
 {
     m_middleView->clearAll();
     m_middleView->setSearchKey(key);
-    VNOTE_ALL_NOTES_MAP *noteAll = VNoteDataManager::instance()->getAllNotesInFolder();
-    if (noteAll) {
-        noteAll->lock.lockForRead();
-        for (auto &foldeNotes : noteAll->notes) {
-            for (auto note : foldeNotes->folderNotes) {
-                if (note->search(key)) {
-                    m_middleView->appendRow(note);
-                }
-            }
-        }
-        noteAll->lock.unlock();
-        if (m_middleView->rowCount() == 0) {
-            m_middleView->setVisibleEmptySearch(true);
-            m_stackedRightMainWidget->setCurrentWidget(m_rightViewHolder);
-            m_richTextEdit->initData(nullptr, m_searchKey);
-            m_imgInsert->setDisabled(true);
-            m_recordBar->setVisible(false);
-        } else {
-            m_middleView->sortView(false);
-            m_middleView->setVisibleEmptySearch(false);
-            m_middleView->setCurrentIndex(0);
-        }
-        //刷新详情页-切换至当前笔记
+    //搜索结果按相关度插入，列表保持插入顺序
+    m_middleView->sortView(false);
+    m_middleView->setVisibleEmptySearch(false);
+    //刷新详情页-切换至当前笔记
+    m_stackedRightMainWidget->setCurrentWidget(m_rightViewHolder);
+    //搜索结果由搜索线程分批返回
+    m_searchEngine->search(key);
+}
+
+/**
+ * @brief VNoteMainWindow::onSearchResultReady
+ * @param queryId 搜索id
+ * @param notes 一批搜索结果
+ * @param hits 结果的排序分值、摘要及高亮区间
+ */
+void VNoteMainWindow::onSearchResultReady(quint64 queryId, const QList<VNoteItem *> &notes, const VNOTE_SEARCH_HITS &hits)
+{
+    if (queryId != m_searchEngine->currentQueryId() || !stateOperation->isSearching()) {
+        return;
+    }
+
+    bool isFirstBatch = (0 == m_middleView->rowCount());
+    m_middleView->mergeSearchRows(notes, hits);
+    //第一批结果返回时选中第一项，后续结果不改变当前选中
+    if (isFirstBatch) {
+        m_middleView->setCurrentIndex(0);
+    }
+}
+
+/**
+ * @brief VNoteMainWindow::onSearchFinished
+ * @param queryId 搜索id
+ * @param count 搜索结果数量
+ */
+void VNoteMainWindow::onSearchFinished(quint64 queryId, int count)
+{
+    if (queryId != m_searchEngine->currentQueryId() || !stateOperation->isSearching()) {
+        return;
+    }
+
+    if (0 == count) {
+        m_middleView->setVisibleEmptySearch(true);
         m_stackedRightMainWidget->setCurrentWidget(m_rightViewHolder);
+        m_richTextEdit->initData(nullptr, m_searchKeyword);
+        m_imgInsert->setDisabled(true);
+        m_recordBar->setVisible(false);
     }
-    return m_middleView->rowCount();
 }
 
 /**
@@ -1612,7 +2018,9 @@ void VNoteMainWindow::setSpecialStatus(SpecialStatus status)
         break;
     case SearchEnd:
         if (stateOperation->isSearching()) {
+            m_searchEngine->cancel();
             m_searchKey = "";
+            m_searchKeyword = "";
             m_middleView->setSearchKey(m_searchKey);
             m_leftView->setEnabled(true);
             m_addNotepadBtn->setVisible(true);
@@ -1835,7 +2243,7 @@ void VNoteMainWindow::release()
     }
 
     VTextSpeechAndTrManager::onStopTextToSpeech();
-    m_richTextEdit->updateNote();
+    m_richTextEdit->updateNoteBeforeQuit();
 
     if (stateOperation->isVoice2Text()) {
         QScopedPointer<VNoteA2TManager> releaseA2TManger(m_a2tManager);
@@ -1885,13 +2293,25 @@ void VNoteMainWindow::onShowSettingDialog()
 void VNoteMainWindow::initMenuExtension()
 {
     m_menuExtension = new DMenu(this);
+    QAction *importLibraryAction = new QAction(DApplication::translate("TitleBar", "Import notebooks"), m_menuExtension);
+    QAction *exportLibraryAction = new QAction(DApplication::translate("TitleBar", "Export all notebooks"), m_menuExtension);
     QAction *setting = new QAction(DApplication::translate("TitleBar", "Settings"), m_menuExtension);
     QAction *privacy = new QAction(DApplication::translate("TitleBar", "Privacy Policy"), m_menuExtension);
+    m_menuExtension->addAction(importLibraryAction);
+    m_menuExtension->addAction(exportLibraryAction);
+    m_menuExtension->addSeparator();
     m_menuExtension->addAction(setting);
     m_menuExtension->addAction(privacy);
     m_menuExtension->addSeparator();
+    connect(importLibraryAction, &QAction::triggered, this, &VNoteMainWindow::importLibrary);
+    connect(exportLibraryAction, &QAction::triggered, this, &VNoteMainWindow::exportAllFolders);
     connect(privacy, &QAction::triggered, this, &VNoteMainWindow::onShowPrivacy);
     connect(setting, &QAction::triggered, this, &VNoteMainWindow::onShowSettingDialog);
+    //导入导出进行中时不能再次开始
+    connect(m_menuExtension, &DMenu::aboutToShow, this, [=] {
+        importLibraryAction->setEnabled(!m_libraryBusy);
+        exportLibraryAction->setEnabled(!m_libraryBusy);
+    });
 }
 
 /**
@@ -2336,7 +2756,13 @@ void VNoteMainWindow::onWebVoicePlay(const QVariant &json, bool bIsSame)
         return;
     }
 
-    m_recordBar->playVoice(m_currentPlayVoice.get(), bIsSame);
+    //搜索状态下从转写命中的位置开始播放
+    qint64 startPos = 0;
+    if (!bIsSame && stateOperation->isSearching()) {
+        startPos = qMax(static_cast<qint64>(0), m_searchEngine->transcriptOffset(m_currentPlayVoice->voicePath));
+    }
+
+    m_recordBar->playVoice(m_currentPlayVoice.get(), bIsSame, startPos);
 }
 
 /**
@@ -2371,6 +2797,20 @@ void VNoteMainWindow::onWebSearchEmpty()
     }
 }
 
+/**
+ * @brief VNoteMainWindow::onWebSearchMatchChanged
+ * @param current 当前命中序号
+ * @param count 命中数量
+ */
+void VNoteMainWindow::onWebSearchMatchChanged(int current, int count)
+{
+    if (count > 0 && stateOperation->isSearching()) {
+        m_searchMatchLabel->setText(QString("%1/%2").arg(current + 1).arg(count));
+    } else {
+        m_searchMatchLabel->clear();
+    }
+}
+
 void VNoteMainWindow::showNotepadList()
 {
     //切换主题色/图标
@@ -48,6 +48,7 @@ DWIDGET_USE_NAMESPACE
 class VNoteRecordBar;
 class VNoteIconButton;
 class VNoteA2TManager;
+class VNoteSearchEngine;
 class LeftView;
 class MiddleView;
 class WebRichTextEditor;
@@ -59,6 +60,7 @@ class VNMainWndDelayInitTask;
 class UpgradeView;
 //多选操作页面
 class VnoteMultipleChoiceOptionWidget;
+struct VNoteLibraryData;
 class VNoteMainWindow : public DMainWindow
 {
     Q_OBJECT
@@ -124,6 +126,8 @@ protected:
     void initRightView();
     //初始化语音转文字模块
     void initA2TManager();
+    //初始化搜索引擎
+    void initSearchEngine();
     //初始化系统注销关机提示模块
     void initLogin1Manager();
     //阻塞关机/注销
@@ -237,6 +241,14 @@ public slots:
     void onWebVoicePlay(const QVariant &json, bool bIsSame);
     //当前编辑区内容搜索为空
     void onWebSearchEmpty();
+    //当前编辑区命中位置变化
+    void onWebSearchMatchChanged(int current, int count);
+    //返回一批搜索结果
+    void onSearchResultReady(quint64 queryId, const QList<VNoteItem *> &notes, const VNOTE_SEARCH_HITS &hits);
+    //搜索完成
+    void onSearchFinished(quint64 queryId, int count);
+    //输入停顿后开始搜索
+    void onSearchDelayTimeout();
 
 private:
     //左侧列表视图操作相关
@@ -248,6 +260,28 @@ private:
     void delNotepad();
     //初始化数据
     int loadNotepads();
+    //重放编辑区日志，恢复异常退出前未保存到数据库的笔记内容，保存失败保留日志时返回false
+    bool recoverEditorJournal();
+    //笔记中data协议内嵌的图片存入附件仓库，只迁移一次
+    void migrateInlineImages();
+    //保存内嵌图片迁移后的笔记内容
+    void onInlineImagesMigrated(qint64 folderId, qint32 noteId, const QString &html, const QString &newHtml);
+    //内嵌图片迁移完成
+    void onInlineImageMigrationFinished();
+    //已有语音的转写文本写入转写分段表，只执行一次
+    void backfillTranscripts();
+    //转写文本写入完成
+    void onTranscriptBackfillFinished(int count, bool ok);
+    //导出记事本归档
+    void exportLibrary(const QList<VNoteFolder *> &folders);
+    //导出所有记事本
+    void exportAllFolders();
+    //导入记事本归档
+    void importLibrary();
+    //记事本归档导出完成
+    void onLibraryExportFinished(int state);
+    //记事本归档导入完成，导入的记事本加入列表
+    void onLibraryImportFinished(int state, VNoteLibraryData *library);
 
     //中间列表视图操作
     //添加记事项
@@ -258,8 +292,10 @@ private:
     void delNote();
     //初始化数据
     int loadNotes(VNoteFolder *folder);
-    //根据搜索关键字加载数据
-    int loadSearchNotes(const QString &key);
+    //根据搜索关键字开始搜索，结果由搜索线程分批返回
+    void loadSearchNotes(const QString &key);
+    //笔记内容保存完成后开始搜索
+    void onNoteUpdatedForSearch();
 
     //Check if wen can do shortcuts
     bool canDoShortcutAction() const;
@@ -286,6 +322,7 @@ private:
 
 private:
     DSearchEdit *m_noteSearchEdit {nullptr};
+    DLabel *m_searchMatchLabel {nullptr}; //当前笔记命中位置，如"1/5"
 
 #ifdef IMPORT_OLD_VERSION_DATA
     //*******Upgrade old Db code here only********
@@ -311,6 +348,8 @@ private:
 
     VNoteRecordBar *m_recordBar {nullptr};
     VNoteA2TManager *m_a2tManager {nullptr};
+    VNoteSearchEngine *m_searchEngine {nullptr};
+    QTimer *m_searchDelayTimer {nullptr}; //输入搜索关键字防抖
 
     DIconButton *m_viewChange {nullptr}; //记事本列表收起控件
     VNoteIconButton *m_imgInsert {nullptr}; //图片插入控件
@@ -323,6 +362,9 @@ private:
     bool m_showSearchEditMenu {false};
     bool m_needShowMax {false};
     const VNVoiceBlock *m_voiceBlock {nullptr}; //语音数据
+    bool m_inlineMigrationFailed {false}; //内嵌图片迁移时有笔记保存失败，下次启动重新迁移
+    bool m_libraryBusy {false}; //正在导入或导出记事本归档
+    VNoteTranscript m_asrVoice; //正在转写的语音，转写成功后保存分段用于搜索
 
     QScopedPointer<VNVoiceBlock> m_currentPlayVoice {nullptr};
 
@@ -347,6 +389,8 @@ private:
     //*****************Shortcut keys end**********************
 
     QString m_searchKey;
+    //去除过滤条件后的关键字，用于详情页高亮
+    QString m_searchKeyword;
     DFloatingMessage *m_asrErrMeassage {nullptr};
     DFloatingMessage *m_pDeviceExceptionMsg {nullptr};
     DMenu *m_menuExtension {nullptr};
@@ -196,13 +196,14 @@ void VNoteRecordBar::onClosePlayWidget(VNVoiceBlock *voiceData)
  * @brief VNoteRecordBar::playVoice
  * @param voiceData
  * @param bIsSame
+ * @param startPos 起始播放位置
  */
-void VNoteRecordBar::playVoice(VNVoiceBlock *voiceData, bool bIsSame)
+void VNoteRecordBar::playVoice(VNVoiceBlock *voiceData, bool bIsSame, qint64 startPos)
 {
     //焦点切换到当前窗口，响应播放快捷键
     setFocus();
     m_mainLayout->setCurrentWidget(m_playPanel);
-    m_playPanel->playVoice(voiceData, bIsSame);
+    m_playPanel->playVoice(voiceData, bIsSame, startPos);
 }
 
 /**
@@ -46,7 +46,7 @@ public:
      * @param voiceData :语音信息
      * @param bIsSame :此次播放的语音是否与上一次操作的语音相同
      */
-    void playVoice(VNVoiceBlock *voiceData, bool bIsSame);
+    void playVoice(VNVoiceBlock *voiceData, bool bIsSame, qint64 startPos = 0);
     //停止播放
     void stopPlay();
 
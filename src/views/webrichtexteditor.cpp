@@ -24,6 +24,11 @@
 #include "common/vnoteitem.h"
 #include "common/metadataparser.h"
 #include "common/vtextspeechandtrmanager.h"
+#include "common/vnotesearchranker.h"
+#include "common/performancemonitor.h"
+#include "common/vnoteattachmentstore.h"
+#include "common/vnoteattachmentschemehandler.h"
+#include "common/vnotefilecopier.h"
 #include "dialog/imageviewerdialog.h"
 #include "common/setting.h"
 #include "task/exportnoteworker.h"
@@ -41,16 +46,24 @@
 #include <QApplication>
 #include <QStandardPaths>
 #include <QThreadPool>
+#include <QPointer>
+#include <QSharedPointer>
 
 static const char webPage[] = WEB_PATH "/index.html";
 
 WebRichTextEditor::WebRichTextEditor(QWidget *parent)
     : QWebEngineView(parent)
 {
-    initFontsInformation();
-    initWebView();
+    //网页引擎与字体信息在preparePage中初始化，不阻塞主窗口显示
     initRightMenu();
     initUpdateTimer();
+    initLoadTimer();
+
+    //缓存上限设置单位为KB，0不缓存
+    QVariant cacheSize = setting::instance()->getOption(VNOTE_EDITOR_CACHE_SIZE);
+    if (cacheSize.isValid()) {
+        m_noteCache.setLimit(cacheSize.toLongLong() * 1024);
+    }
 }
 
 WebRichTextEditor::~WebRichTextEditor()
@@ -60,12 +73,25 @@ WebRichTextEditor::~WebRichTextEditor()
     }
 }
 
+void WebRichTextEditor::preparePage()
+{
+    if (m_pagePrepared) {
+        return;
+    }
+
+    m_pagePrepared = true;
+    initFontsInformation();
+    initWebView();
+}
+
 void WebRichTextEditor::initWebView()
 {
     QWebChannel *channel = new QWebChannel(this);
     JsContent *content = JsContent::instance();
     channel->registerObject("webobj", content);
     page()->setWebChannel(channel);
+    //笔记中的附件通过vnote协议加载
+    VNoteAttachmentSchemeHandler::install(page()->profile());
     QFileInfo info(webPage);
     load(QUrl::fromLocalFile(info.absoluteFilePath()));
     page()->setBackgroundColor(DGuiApplicationHelper::instance()->applicationPalette().base().color());
@@ -81,6 +107,9 @@ void WebRichTextEditor::initWebView()
             this, &WebRichTextEditor::onThemeChanged);
 
     connect(content, &JsContent::getfontinfo, this, &WebRichTextEditor::onSetFontListInfo);
+    connect(content, &JsContent::searchMatchCountChanged, this, &WebRichTextEditor::onSearchMatchCountChanged);
+    connect(content, &JsContent::noteCacheMiss, this, &WebRichTextEditor::onNoteCacheMiss);
+    connect(content, &JsContent::editorChanges, this, &WebRichTextEditor::onEditorChanges);
 
     if (nullptr != focusProxy()) {
         focusProxy()->installEventFilter(this);
@@ -145,19 +174,61 @@ void WebRichTextEditor::initRightMenu()
 void WebRichTextEditor::initUpdateTimer()
 {
     m_updateTimer = new QTimer(this);
-    m_updateTimer->setInterval(1000);
-    connect(m_updateTimer, &QTimer::timeout, this, &WebRichTextEditor::updateNote);
+    m_updateTimer->setInterval(JournalInterval);
+    connect(m_updateTimer, &QTimer::timeout, this, [this] {
+        journalNote();
+    });
+    //变更已写入日志，完整内容可以较长时间保存一次
+    m_saveTimer = new QTimer(this);
+    m_saveTimer->setInterval(SaveInterval);
+    connect(m_saveTimer, &QTimer::timeout, this, [this] {
+        saveNoteBody(m_noteData);
+    });
+    m_saveTimer->start();
+}
+
+void WebRichTextEditor::initLoadTimer()
+{
+    m_loadTimer = new QTimer(this);
+    m_loadTimer->setSingleShot(true);
+    connect(m_loadTimer, &QTimer::timeout, this, [this] {
+        VNoteItem *data = m_pendingData;
+        m_pendingData = nullptr;
+        //等待期间笔记可能已被删除
+        VNoteItemOper noteOper;
+        if (nullptr != data && data != noteOper.getNote(m_pendingFolderId, m_pendingNoteId)) {
+            qInfo() << "pending note removed before loading:" << m_pendingNoteId;
+            return;
+        }
+        setData(data, m_pendingSearchKey);
+    });
 }
 
 void WebRichTextEditor::initData(VNoteItem *data, const QString &reg, bool focus)
 {
+    if (nullptr != data) {
+        PerformanceMonitor::firstNoteOpenStart();
+    }
     //重置鼠标点击位置
     m_mouseClickPos = QPoint(-1, -1);
     m_setFocus = focus;
+    m_pendingData = data;
+    m_pendingSearchKey = reg;
+    if (nullptr != data) {
+        m_pendingFolderId = data->folderId;
+        m_pendingNoteId = data->noteId;
+    }
     //富文本设置异步操作，解决笔记列表不实时刷新
-    QTimer::singleShot(0, this, [=] {
-        setData(data, reg);
-    });
+    //按住方向键连续切换时推迟加载，未加载的笔记被后面的请求替换，列表选择不受影响
+    bool rapid = m_loadRequestTime.isValid() && m_loadRequestTime.elapsed() < LoadDebounceInterval;
+    m_loadRequestTime.start();
+    m_loadTimer->start(rapid ? LoadDebounceInterval : 0);
+}
+
+void WebRichTextEditor::cancelPendingLoad()
+{
+    m_loadTimer->stop();
+    m_pendingData = nullptr;
 }
 
 void WebRichTextEditor::insertVoiceItem(const QString &voicePath, qint64 voiceSize)
@@ -176,38 +247,251 @@ void WebRichTextEditor::insertVoiceItem(const QString &voicePath, qint64 voiceSi
     if (OpsStateInterface::instance()->isAppQuit()) {
         JsContent::instance()->callJsSynchronous(page(), QString("insertVoiceItem('%1')").arg(value.toString()));
         m_textChange = true;
-        update();
+        updateNoteBeforeQuit();
         return;
     }
     emit JsContent::instance()->callJsInsertVoice(value.toString());
 }
 
-void WebRichTextEditor::updateNote()
+void WebRichTextEditor::updateNote(const std::function<void()> &finished)
+{
+    if (nullptr == m_noteData || !m_textChange) {
+        //编辑区没有新的修改，只保存日志中的内容
+        saveNoteBody(m_noteData);
+        if (finished) {
+            finished();
+        }
+        return;
+    }
+
+    //请求期间的修改会重新设置修改标志，在下次更新时保存
+    m_textChange = false;
+    requestEditorChanges(m_noteData, m_editorSync.version(), finished);
+}
+
+void WebRichTextEditor::updateNoteBeforeQuit()
+{
+    if (nullptr == m_noteData || !m_textChange) {
+        saveNoteBody(m_noteData);
+        m_journal.sync();
+        return;
+    }
+
+    m_textChange = false;
+    //未返回的异步请求结果先于本次结果返回，版本不一致时编辑区返回全部内容块
+    QVariant result = JsContent::instance()->callJsSynchronous(page(), QString("getChanges(%1)").arg(m_editorSync.version()));
+    if (!result.isValid()) {
+        //编辑区无响应时不再重试，先保存日志中已有的内容
+        qWarning() << __FUNCTION__ << "editor not responding, save journaled content";
+        saveNoteBody(m_noteData);
+    } else if (!saveEditorChanges(m_noteData, result)) {
+        result = JsContent::instance()->callJsSynchronous(page(), QString("getChanges(-1)"));
+        if (!saveEditorChanges(m_noteData, result)) {
+            saveNoteBody(m_noteData);
+        }
+    }
+    m_journal.sync();
+}
+
+void WebRichTextEditor::journalNote()
+{
+    if (nullptr == m_noteData || !m_textChange) {
+        return;
+    }
+
+    m_textChange = false;
+    requestEditorChanges(m_noteData, m_editorSync.version(), nullptr, false);
+}
+
+void WebRichTextEditor::saveNoteBody(VNoteItem *note)
 {
-    if (m_noteData) {
-        if (m_textChange) {
-            QVariant result = JsContent::instance()->callJsSynchronous(page(), QString("getHtml()"));
-            if (result.isValid()) {
-                m_noteData->htmlCode = result.toString();
-                VNoteItemOper noteOps(m_noteData);
-                if (!noteOps.updateNote()) {
-                    qInfo() << "Save note error";
-                }
+    if (!m_journal.isPending(note)) {
+        return;
+    }
+
+    VNoteItemOper noteOps(note);
+    if (!noteOps.updateNote()) {
+        //保存失败时保留日志，下次继续保存
+        qInfo() << "Save note error";
+        return;
+    }
+    m_journal.checkpoint(note);
+}
+
+void WebRichTextEditor::requestEditorChanges(VNoteItem *note, int version, const std::function<void()> &finished, bool persist)
+{
+    QPointer<WebRichTextEditor> editor(this);
+    qint64 folderId = note->folderId;
+    qint32 noteId = note->noteId;
+    //超时和之后返回的结果共用，finished只调用一次
+    QSharedPointer<bool> notified(new bool(false));
+    auto notify = [=] {
+        if (!*notified) {
+            *notified = true;
+            if (finished) {
+                finished();
             }
-            m_textChange = false;
         }
+    };
+    //只获取上次同步后变化的块，保存耗时与修改量相关，与笔记大小无关
+    //超时后继续等待结果，结果按顺序返回，笔记切换后仍合并并保存到发起请求的笔记
+    JsContent::instance()->callJsAsync(page(), QString("getChanges(%1)").arg(version), [=](bool ok, const QVariant &result) {
+        if (editor.isNull()) {
+            return;
+        }
+
+        if (!ok) {
+            //编辑区暂未返回，保留修改标志，下次更新时再次获取
+            qWarning() << __FUNCTION__ << "editor changes timeout, wait for result";
+            if (note == m_noteData) {
+                m_textChange = true;
+            }
+        } else {
+            //请求期间笔记可能已被删除，此时只合并内容块不保存
+            VNoteItemOper noteOper;
+            bool exist = (note == m_noteData || note == noteOper.getNote(folderId, noteId));
+            if (saveEditorChanges(exist ? note : nullptr, result, persist)) {
+                setSyncNote(exist ? note : nullptr, folderId, noteId);
+            } else if (version >= 0 && note == m_noteData) {
+                //版本不一致时获取全部内容块，笔记已切换时编辑区不再是该笔记的内容
+                qInfo() << __FUNCTION__ << "editor sync version mismatch, request full content";
+                requestEditorChanges(note, -1, *notified ? nullptr : finished, persist);
+                *notified = true;
+                return;
+            }
+        }
+
+        notify();
+    }, JsContent::DefaultJsTimeout, true);
+}
+
+void WebRichTextEditor::onEditorChanges(const QVariant &changes)
+{
+    //推送与获取共用版本号，版本不一致时推送的内容已由获取得到或需要获取全部内容块
+    if (changes.toMap().value("base", -1).toInt() != m_editorSync.version()) {
+        m_textChange = true;
+        return;
+    }
+
+    //版本号只对应一次设置的内容，笔记切换前推送的变更属于已同步的笔记
+    VNoteItemOper noteOper;
+    VNoteItem *note = m_syncNote;
+    if (nullptr != note && note != m_noteData && note != noteOper.getNote(m_syncFolderId, m_syncNoteId)) {
+        note = nullptr;
+    }
+
+    //离开的笔记不再定时保存，直接保存到数据库
+    if (!saveEditorChanges(note, changes, note != m_noteData)) {
+        m_textChange = true;
+    } else if (nullptr != note && note == m_noteData) {
+        //推送之后的修改会重新设置修改标志
+        m_textChange = false;
+    }
+}
+
+void WebRichTextEditor::setSyncNote(VNoteItem *note, qint64 folderId, qint32 noteId)
+{
+    m_syncNote = note;
+    m_syncFolderId = folderId;
+    m_syncNoteId = noteId;
+}
+
+bool WebRichTextEditor::saveEditorChanges(VNoteItem *note, const QVariant &changes, bool persist)
+{
+    //请求按顺序返回，笔记切换前的结果仍对应旧笔记的内容块，合并后才能保持版本一致
+    QVariantMap changesMap = changes.toMap();
+    if (!m_editorSync.applyChanges(changesMap)) {
+        return false;
+    }
+
+    if (nullptr == note) {
+        return true;
     }
+    note->htmlCode = m_editorSync.html();
+    //日志写入失败时直接保存完整内容
+    if (!persist && m_journal.append(note, changesMap, m_editorSync)) {
+        return true;
+    }
+
+    VNoteItemOper noteOps(note);
+    if (!noteOps.updateNote()) {
+        qInfo() << "Save note error";
+    } else {
+        m_journal.checkpoint(note);
+    }
+    return true;
 }
 
 void WebRichTextEditor::searchText(const QString &searchKey)
 {
-    findText(searchKey, QWebEnginePage::FindFlags(), [=](const bool &result) {
-        if (result == false) {
+    m_searchKey = searchKey;
+    //先保存编辑内容，保证命中位置与编辑区一致
+    updateNote([this] {
+        updateSearchMatches();
+
+        //语音块中的文本不参与定位，只在语音块中命中时笔记仍保留在搜索结果中
+        if (!m_searchKey.isEmpty() && 0 == m_searchMatchCount && nullptr != m_noteData
+                && !m_noteData->htmlCode.isEmpty()
+                && !VNoteSearchRanker::htmlText(m_noteData->htmlCode).contains(m_searchKey, Qt::CaseInsensitive)) {
             emit currentSearchEmpty();
         }
     });
 }
 
+void WebRichTextEditor::findNext(bool backward)
+{
+    if (nullptr == m_noteData || m_searchKey.isEmpty()) {
+        return;
+    }
+
+    if (m_searchMatchesDirty) {
+        searchText(m_searchKey);
+        return;
+    }
+
+    if (m_searchMatchCount > 0) {
+        m_searchMatchIndex = (m_searchMatchIndex + (backward ? m_searchMatchCount - 1 : 1)) % m_searchMatchCount;
+        emit JsContent::instance()->callJsGotoSearchMatch(m_searchMatchIndex);
+        emit searchMatchChanged(m_searchMatchIndex, m_searchMatchCount);
+    }
+}
+
+int WebRichTextEditor::searchMatchCount() const
+{
+    return m_searchMatchCount;
+}
+
+int WebRichTextEditor::currentSearchMatch() const
+{
+    return m_searchMatchIndex;
+}
+
+void WebRichTextEditor::updateSearchMatches()
+{
+    QVariantList offsets;
+
+    if (nullptr != m_noteData && !m_searchKey.isEmpty()) {
+        QString text = VNoteSearchRanker::noteEditorText(m_noteData);
+        for (auto &range : VNoteSearchRanker::findRanges(text, m_searchKey)) {
+            offsets.append(range.first);
+        }
+    }
+
+    m_searchMatchesDirty = false;
+    m_searchMatchCount = offsets.size();
+    m_searchMatchIndex = m_searchMatchCount > 0 ? 0 : -1;
+
+    emit JsContent::instance()->callJsSetSearchMatches(m_searchKey, offsets, m_searchMatchIndex);
+    emit searchMatchChanged(m_searchMatchIndex, m_searchMatchCount);
+}
+
+void WebRichTextEditor::onSearchMatchCountChanged(int count)
+{
+    m_searchMatchCount = count;
+    m_searchMatchIndex = count > 0 ? qBound(0, m_searchMatchIndex, count - 1) : -1;
+    emit searchMatchChanged(m_searchMatchIndex, m_searchMatchCount);
+}
+
 void WebRichTextEditor::unboundCurrentNoteData()
 {
     //停止更新定时器
@@ -220,6 +504,7 @@ void WebRichTextEditor::unboundCurrentNoteData()
 
 void WebRichTextEditor::onTextChange()
 {
+    m_searchMatchesDirty = true;
     if (!m_textChange) {
         m_textChange = true;
         //更新修改时间
@@ -238,6 +523,7 @@ void WebRichTextEditor::saveMenuParam(int type, const QVariant &json)
 
 void WebRichTextEditor::onSetDataFinsh()
 {
+    PerformanceMonitor::firstNoteOpenFinish();
     //清除选中
     page()->triggerAction(QWebEnginePage::Unselect);
     //数据加载完成,需要设置焦点时需要先清除焦点再重新设置，解决编辑器无光标问题
@@ -245,10 +531,8 @@ void WebRichTextEditor::onSetDataFinsh()
         clearFocus();
         setFocus();
     }
-    //只有编辑区内容加载完成才能搜索
-    if (!m_searchKey.isEmpty()) {
-        findText(m_searchKey);
-    }
+    //只有编辑区内容加载完成才能设置命中位置
+    updateSearchMatches();
 }
 
 void WebRichTextEditor::showTxtMenu(const QPoint &pos)
@@ -382,7 +666,7 @@ void WebRichTextEditor::onMenuActionClicked(QAction *action)
     case ActionManager::PicturePaste:
     case ActionManager::TxtPaste:
         //粘贴事件，从剪贴板获取数据
-        onPaste(isVoicePaste());
+        pasteFromMenu();
         break;
     case ActionManager::PictureView:
         //查看图片
@@ -415,7 +699,7 @@ void WebRichTextEditor::onMenuActionClicked(QAction *action)
  */
 void WebRichTextEditor::savePictureAs()
 {
-    QString originalPath = m_menuJson.toString(); //获取原图片路径
+    QString originalPath = VNoteAttachmentStore::localPath(m_menuJson.toString()); //获取原图片路径
     saveAsFile(originalPath, QStandardPaths::writableLocation(QStandardPaths::PicturesLocation), "image");
 }
 
@@ -490,7 +774,7 @@ QString WebRichTextEditor::saveAsFile(const QString &originalPath, QString dirPa
     }
 
     //复制文件
-    if (!QFile::copy(originalPath, newPath)) {
+    if (!VNoteFileCopier::copy(originalPath, newPath)) {
         VNoteMessageDialog audioOutLimit(VNoteMessageDialog::SaveFailed);
         audioOutLimit.exec();
         qCritical() << "copy failed:" << originalPath << ";" << newPath;
@@ -510,7 +794,7 @@ void WebRichTextEditor::viewPicture(const QString &filePath)
         imgView = new ImageViewerDialog(this);
     }
     //加载图片并显示
-    imgView->open(filePath);
+    imgView->open(VNoteAttachmentStore::localPath(filePath));
 }
 
 void WebRichTextEditor::onPaste(bool isVoicePaste)
@@ -618,6 +902,11 @@ void WebRichTextEditor::deleteSelectText()
 
 void WebRichTextEditor::onThemeChanged()
 {
+    //页面创建前不设置主题，页面加载完成后会重新设置
+    if (!m_pagePrepared) {
+        return;
+    }
+
     DGuiApplicationHelper *dAppHelper = DGuiApplicationHelper::instance();
     DPalette dp = dAppHelper->applicationPalette();
     //获取系统高亮色
@@ -664,15 +953,55 @@ void WebRichTextEditor::onLoadFinsh()
 {
     //再次设置笔记内容
     if (m_noteData && !m_loadFinshSign) {
-        if (m_noteData->htmlCode.isEmpty()) {
-            emit JsContent::instance()->callJsInitData(m_noteData->metaDataRef().toString());
-        } else {
-            emit JsContent::instance()->callJsSetHtml(m_noteData->htmlCode);
-        }
+        setNoteContent(m_noteData);
     }
     m_loadFinshSign = true;
 }
 
+void WebRichTextEditor::setNoteContent(VNoteItem *data)
+{
+    if (data->htmlCode.isEmpty()) {
+        emit JsContent::instance()->callJsInitData(data->metaDataRef().toString());
+    } else {
+        emit JsContent::instance()->callJsSetHtml(data->htmlCode);
+    }
+}
+
+void WebRichTextEditor::switchNote(VNoteItem *data)
+{
+    QString openKey = VNoteEditorCache::noteKey(data);
+    //先取出打开的笔记，避免被离开的笔记淘汰
+    bool hit = m_noteCache.take(openKey);
+
+    QString cacheKey;
+    QStringList dropKeys;
+    if (nullptr != m_noteData) {
+        QString key = VNoteEditorCache::noteKey(m_noteData);
+        qint64 size = m_noteData->htmlCode.isEmpty() ? m_noteData->metaDataRef().toString().size()
+                                                     : m_noteData->htmlCode.size();
+        if (m_noteCache.insert(key, size, dropKeys)) {
+            cacheKey = key;
+        }
+    }
+
+    if (hit) {
+        emit JsContent::instance()->callJsSwitchNote(cacheKey, dropKeys, openKey, "", "");
+    } else if (data->htmlCode.isEmpty()) {
+        emit JsContent::instance()->callJsSwitchNote(cacheKey, dropKeys, "", "", data->metaDataRef().toString());
+    } else {
+        emit JsContent::instance()->callJsSwitchNote(cacheKey, dropKeys, "", data->htmlCode, "");
+    }
+}
+
+void WebRichTextEditor::onNoteCacheMiss()
+{
+    //网页已清除全部缓存
+    m_noteCache.clear();
+    if (nullptr != m_noteData) {
+        setNoteContent(m_noteData);
+    }
+}
+
 void WebRichTextEditor::setData(VNoteItem *data, const QString &reg)
 {
     //有焦点先隐藏编辑工具栏
@@ -688,37 +1017,47 @@ void WebRichTextEditor::setData(VNoteItem *data, const QString &reg)
         unboundCurrentNoteData();
         return;
     }
+    //预加载未开始时立即创建页面
+    preparePage();
     this->setVisible(true);
-    //清除选中需重新加载，解决匹配字符显示灰色问题
-    bool reSet = !m_searchKey.isEmpty() && reg.isEmpty();
     m_searchKey = reg;
-    if (m_noteData != data || reSet) { //笔记切换或清除搜索结果时设置笔记内容
+    if (m_noteData != data) { //笔记切换时设置笔记内容
         m_updateTimer->stop();
         updateNote();
-        m_noteData = data;
         if (m_loadFinshSign) {
-            if (data->htmlCode.isEmpty()) {
-                emit JsContent::instance()->callJsInitData(data->metaDataRef().toString());
-            } else {
-                emit JsContent::instance()->callJsSetHtml(data->htmlCode);
-            }
+            switchNote(data);
         }
+        m_noteData = data;
         m_updateTimer->start();
-    } else { //笔记相同时执行搜索
-        findText(reg);
+    } else { //笔记相同时只更新命中位置
+        updateSearchMatches();
     }
 }
 
-bool WebRichTextEditor::isVoicePaste()
+void WebRichTextEditor::pasteFromMenu()
 {
-    //调用web前端接口
-    return JsContent::instance()->callJsSynchronous(page(), "returnCopyFlag()").toBool();
+    QPointer<WebRichTextEditor> editor(this);
+    //调用web前端接口，查询是否为语音复制
+    JsContent::instance()->callJsAsync(page(), "returnCopyFlag()", [editor](bool ok, const QVariant &result) {
+        if (editor) {
+            editor->onPaste(ok && result.toBool());
+        }
+    });
 }
 
 void WebRichTextEditor::shortcutPopupMenu()
 {
-    //同步获取菜单类型与参数
-    QMap<QString, QVariant> param = JsContent::instance()->callJsSynchronous(page(), "isRangeVoice()").toMap();
+    QPointer<WebRichTextEditor> editor(this);
+    //异步获取菜单类型与参数
+    JsContent::instance()->callJsAsync(page(), "isRangeVoice()", [editor](bool ok, const QVariant &result) {
+        if (ok && editor) {
+            editor->popupMenuByParam(result.toMap());
+        }
+    });
+}
+
+void WebRichTextEditor::popupMenuByParam(const QVariantMap &param)
+{
     if (2 == param.size()) {
         m_menuType = static_cast<Menu>(param["flag"].toInt());
         m_menuJson = param["info"];
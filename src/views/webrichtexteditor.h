@@ -22,13 +22,19 @@
 #define WEBRICHTEXTEDITOR_H
 
 #include "common/vnoteitem.h"
+#include "common/vnoteeditorsync.h"
+#include "common/vnoteeditorcache.h"
+#include "common/vnoteeditorjournal.h"
 
 #include <QObject>
+#include <QElapsedTimer>
 #include <QtWebChannel/QWebChannel>
 #include <QtWebEngineWidgets/QWebEngineView>
 
 #include <QtDBus>
 #include <QDBusInterface>
+
+#include <functional>
 #include <com_deepin_daemon_appearance.h>
 
 
@@ -55,13 +61,33 @@ public:
         MaxMenu,
     };
 
+    //连续切换笔记的判断间隔，间隔内的切换合并为一次加载，单位:毫秒
+    enum {
+        LoadDebounceInterval = 80,
+        //获取编辑区变更并写入日志的间隔，单位:毫秒
+        //编辑区在输入停顿200毫秒或连续输入500毫秒后推送变更，推送无法合并时由定时获取，
+        //网页或程序崩溃时丢失的是尚未推送的修改
+        JournalInterval = 500,
+        //完整内容保存到数据库的间隔，期间已写入日志的变更崩溃后可以恢复
+        SaveInterval = 10000
+    };
+
     /**
-     * @brief 设置笔记内容
+     * @brief 创建网页并加载编辑器，只执行一次
+     * 主窗口显示后调用，与笔记数据加载并行，打开第一个笔记时未调用则立即执行
+     */
+    void preparePage();
+    /**
+     * @brief 设置笔记内容，异步加载，连续切换时只加载最后一个笔记
      * @param data: 笔记内容
      * @param reg: 搜索关键字
      * @param focus: 焦点
      */
     void initData(VNoteItem *data, const QString &reg, bool focus = false);
+    /**
+     * @brief 取消未开始的笔记加载
+     */
+    void cancelPendingLoad();
     /**
      * @brief 插入语音
      * @param voicePath：语音路径
@@ -69,14 +95,33 @@ public:
      */
     void insertVoiceItem(const QString &voicePath, qint64 voiceSize);
     /**
-     * @brief 更新编辑区内容
+     * @brief 异步获取编辑区修改的内容，与日志中未保存的内容一起保存到数据库
+     * @param finished 保存完成或无需保存时调用
+     */
+    void updateNote(const std::function<void()> &finished = nullptr);
+    /**
+     * @brief 程序退出时同步保存编辑区内容，最多等待JsContent::ShutdownJsTimeout，
+     * 超时后保存日志中已有的内容
      */
-    void updateNote();
+    void updateNoteBeforeQuit();
     /**
-     * @brief 搜索当前笔记
+     * @brief 搜索当前笔记，命中位置由笔记内容计算后一次发送到编辑区
      * @param searchKey : 搜索关键字
      */
     void searchText(const QString &searchKey);
+    /**
+     * @brief 跳转到下一个命中位置，内容修改后重新计算命中位置
+     * @param backward : true 跳转到上一个
+     */
+    void findNext(bool backward = false);
+    /**
+     * @brief 当前笔记的命中数量
+     */
+    int searchMatchCount() const;
+    /**
+     * @brief 当前命中序号，没有命中返回-1
+     */
+    int currentSearchMatch() const;
 
     /**
      * @brief 解除绑定的笔记数据
@@ -105,6 +150,13 @@ signals:
      */
     void contentChanged();
 
+    /**
+     * @brief 当前命中位置或命中数量变化
+     * @param current 当前命中序号，没有命中为-1
+     * @param count 命中数量
+     */
+    void searchMatchChanged(int current, int count);
+
 public slots:
     /**
     * @brief 编辑区内容变化
@@ -165,6 +217,21 @@ public slots:
      */
     void onSetFontListInfo();
 
+    /**
+     * @brief 网页重新查找后的命中数量
+     * @param count 命中数量
+     */
+    void onSearchMatchCountChanged(int count);
+    /**
+     * @brief 网页中笔记缓存未命中，重新设置当前笔记内容
+     */
+    void onNoteCacheMiss();
+    /**
+     * @brief 编辑区推送的变更与已同步版本一致时合并并写入日志
+     * @param changes 变化的内容块
+     */
+    void onEditorChanges(const QVariant &changes);
+
 protected:
     void contextMenuEvent(QContextMenuEvent *e) override;
     //拖拽事件
@@ -185,6 +252,10 @@ private:
      * @brief 初始化数据更新定时器
      */
     void initUpdateTimer();
+    /**
+     * @brief 初始化笔记加载定时器
+     */
+    void initLoadTimer();
     /**
      * @brief 初始化编辑区
      */
@@ -226,16 +297,84 @@ private:
     void setData(VNoteItem *data, const QString &reg);
 
     /**
-     * @brief 判断是否为语音粘贴
-     * @return
+     * @brief 设置编辑区内容为笔记内容
+     * @param data 笔记数据
+     */
+    void setNoteContent(VNoteItem *data);
+    /**
+     * @brief 切换编辑区笔记，离开的笔记加入缓存，打开的笔记命中缓存时不再发送内容
+     * @param data 打开的笔记
+     */
+    void switchNote(VNoteItem *data);
+    /**
+     * @brief 菜单粘贴，先异步查询是否为语音粘贴
+     */
+    void pasteFromMenu();
+    /**
+     * @brief 根据编辑区返回的菜单类型与参数弹出菜单
+     * @param param 菜单类型与参数
+     */
+    void popupMenuByParam(const QVariantMap &param);
+
+    /**
+     * @brief 根据笔记内容计算命中位置并发送到编辑区
+     */
+    void updateSearchMatches();
+
+    /**
+     * @brief 从编辑区异步获取变化的内容块，合并后保存到笔记，超时后仍等待结果保存到该笔记
+     * @param note 发起请求时绑定的笔记
+     * @param version 已同步的版本号，-1获取全部内容块
+     * @param finished 完成或超时后调用，只调用一次
+     * @param persist true 保存到数据库，false 只写入日志
+     */
+    void requestEditorChanges(VNoteItem *note, int version, const std::function<void()> &finished, bool persist = true);
+    /**
+     * @brief 记录同步的内容块所属的笔记
+     * @param note 笔记，已删除时为空
+     * @param folderId 记事本id
+     * @param noteId 笔记id
+     */
+    void setSyncNote(VNoteItem *note, qint64 folderId, qint32 noteId);
+    /**
+     * @brief 合并编辑区返回的内容块并保存到笔记
+     * @param note 发起请求时绑定的笔记，已删除时为空，只合并不保存
+     * @param changes 变化的内容块
+     * @param persist true 保存到数据库，false 只写入日志
+     * @return true 合并成功
+     */
+    bool saveEditorChanges(VNoteItem *note, const QVariant &changes, bool persist = true);
+    /**
+     * @brief 获取编辑区修改的内容写入日志
+     */
+    void journalNote();
+    /**
+     * @brief 日志中有未保存内容时将笔记完整内容保存到数据库，并写入检查点
+     * @param note 笔记
      */
-    bool isVoicePaste();
+    void saveNoteBody(VNoteItem *note);
 
 private:
     VNoteItem *m_noteData {nullptr};
-    QTimer *m_updateTimer {nullptr};
+    QTimer *m_updateTimer {nullptr}; //变更写入日志定时器
+    QTimer *m_saveTimer {nullptr}; //完整内容保存定时器
+    VNoteEditorJournal m_journal; //编辑区变更日志
+    QTimer *m_loadTimer {nullptr}; //笔记加载定时器，重新启动即取消之前的加载
+    VNoteItem *m_pendingData {nullptr}; //等待加载的笔记
+    qint64 m_pendingFolderId {-1}; //等待加载笔记的记事本id，加载前确认笔记未被删除
+    qint32 m_pendingNoteId {-1}; //等待加载笔记的id
+    QString m_pendingSearchKey; //等待加载笔记的搜索关键字
+    QElapsedTimer m_loadRequestTime; //上次请求加载的时间
     bool m_textChange {false};
     QString m_searchKey {""};
+    int m_searchMatchCount {0}; //命中数量
+    int m_searchMatchIndex {-1}; //当前命中序号
+    bool m_searchMatchesDirty {false}; //内容修改后命中位置需重新计算
+    VNoteEditorSync m_editorSync; //与编辑区同步的内容块
+    VNoteItem *m_syncNote {nullptr}; //同步的内容块所属的笔记
+    qint64 m_syncFolderId {-1}; //同步笔记的记事本id，合并推送前确认笔记未被删除
+    qint32 m_syncNoteId {-1}; //同步笔记的id
+    VNoteEditorCache m_noteCache; //网页中缓存的最近打开笔记
     Menu m_menuType = MaxMenu;
     QVariant m_menuJson = {};
     ImageViewerDialog *imgView {nullptr}; //
@@ -247,6 +386,7 @@ private:
     VNoteRightMenu *m_voiceRightMenu {nullptr}; //语音右键菜单
     VNoteRightMenu *m_txtRightMenu {nullptr}; //文字右键菜单
     bool m_loadFinshSign = false; //后台与web通信连通标志 true: 连通， false: 未联通
+    bool m_pagePrepared {false}; //网页是否已创建
 
     QScopedPointer<VNVoiceBlock> m_voiceBlock {nullptr}; //待另存的语音数据
     QScopedPointer<Appearance>  m_pDbusAppearance {nullptr};
@@ -253,7 +253,13 @@ void VNotePlayWidget::onPlayerBtnClicked()
     playVoice(m_voiceBlock, true);
 }
 
-void VNotePlayWidget::playVoice(VNVoiceBlock *voiceData, bool bIsSame)
+/**
+ * @brief VNotePlayWidget::playVoice
+ * @param voiceData 语音数据
+ * @param bIsSame 是否与上一次语音相同
+ * @param startPos 重新播放时的起始位置
+ */
+void VNotePlayWidget::playVoice(VNVoiceBlock *voiceData, bool bIsSame, qint64 startPos)
 {
     if (bIsSame && nullptr != m_voiceBlock) { //与上一次语音相同，执行继续/暂停操作
         VlcPalyer::VlcState status = getPlayerStatus();
@@ -267,11 +273,12 @@ void VNotePlayWidget::playVoice(VNVoiceBlock *voiceData, bool bIsSame)
             emit sigPlayVoice(m_voiceBlock);
         }
     } else if (nullptr != voiceData) { //与上一次语音不相同，重新播放语音
-        m_slider->setValue(0);
+        startPos = qBound(static_cast<qint64>(0), startPos, voiceData->voiceSize);
+        m_slider->setValue(static_cast<int>(startPos));
         m_voiceBlock = voiceData;
-        m_player->setFilePath(m_voiceBlock->voicePath);
+        m_player->setFilePath(m_voiceBlock->voicePath, startPos);
         m_nameLab->setText(voiceData->voiceTitle);
-        m_timeLab->setText(Utils::formatMillisecond(0, 0) + "/" + Utils::formatMillisecond(voiceData->voiceSize));
+        m_timeLab->setText(Utils::formatMillisecond(startPos, 0) + "/" + Utils::formatMillisecond(voiceData->voiceSize));
         m_playerBtn->setState(VNote2SIconButton::Press);
         m_player->play();
         emit sigPlayVoice(m_voiceBlock);
@@ -44,7 +44,7 @@ class VNotePlayWidget : public DFloatingWidget
 public:
     explicit VNotePlayWidget(QWidget *parent = nullptr);
     //播放
-    void playVoice(VNVoiceBlock *voiceData, bool bIsSame);
+    void playVoice(VNVoiceBlock *voiceData, bool bIsSame, qint64 startPos = 0);
     //获取状态
     VlcPalyer::VlcState getPlayerStatus();
 signals:
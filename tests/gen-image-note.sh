@@ -0,0 +1,48 @@
+#!/bin/bash
+#生成包含大量图片的笔记，用于测试图片延迟加载前后打开笔记的耗时与内存
+#用法: ./gen-image-note.sh [图片数量，默认500]
+#依赖 ImageMagick 与 sqlite3，运行前先关闭语音记事本
+#打开生成的笔记后，耗时见日志中的 POINT-02 firstnoteopen，内存为 QtWebEngineProcess 的 RSS
+count=${1:-500}
+datadir=$HOME/.local/share/deepin/deepin-voice-note
+db=$datadir/deepin-voice-note1.0.db
+imagedir=$datadir/images
+tmpdir=$(mktemp -d)
+
+if [ ! -f "$db" ]; then
+    echo "database not found: $db, start deepin-voice-note once first"
+    exit 1
+fi
+
+if pidof deepin-voice-note > /dev/null; then
+    echo "close deepin-voice-note first"
+    exit 1
+fi
+
+mkdir -p "$imagedir"
+
+html=""
+hashes=""
+sql="BEGIN;"
+for ((i = 1; i <= count; i++)); do
+    #每张图片内容不同，避免按哈希去重成同一个附件
+    convert -size 1920x1080 "xc:hsl($((i * 37 % 360)),60%,70%)" -pointsize 240 -annotate +120+640 "$i" "$tmpdir/$i.png" || exit 1
+    hash=$(sha256sum "$tmpdir/$i.png" | cut -d ' ' -f 1)
+    size=$(stat -c %s "$tmpdir/$i.png")
+    mv "$tmpdir/$i.png" "$imagedir/$hash.png"
+    hashes="$hashes${hashes:+,}'$hash'"
+    html="$html<p><img src=\\\"vnote://attachment/$hash.png\\\" style=\\\"width: 100%;\\\"></p>"
+    sql="$sql INSERT OR IGNORE INTO vnote_attachment_tbl(hash, file_name, file_type, file_size) VALUES('$hash', '$hash.png', 0, $size);"
+done
+rm -r "$tmpdir"
+
+sql="$sql INSERT INTO vnote_folder_tbl(folder_name, max_noteid) VALUES('image benchmark $count', 1);"
+sql="$sql INSERT INTO vnote_items_tbl(folder_id, note_type, note_title, meta_data)
+    VALUES((SELECT MAX(folder_id) FROM vnote_folder_tbl), 0, '$count images', '{\"htmlCode\":\"$html\"}');"
+sql="$sql INSERT INTO vnote_attachment_ref_tbl(hash, folder_id, note_id)
+    SELECT hash, (SELECT MAX(folder_id) FROM vnote_folder_tbl), (SELECT MAX(note_id) FROM vnote_items_tbl)
+    FROM vnote_attachment_tbl WHERE hash IN ($hashes);"
+sql="$sql COMMIT;"
+
+echo "$sql" | sqlite3 "$db" || exit 1
+echo "created note \"$count images\" in folder \"image benchmark $count\""
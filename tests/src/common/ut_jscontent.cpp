@@ -21,6 +21,8 @@
 #include "ut_jscontent.h"
 #include "jscontent.h"
 
+#include <QSignalSpy>
+
 UT_JsContent::UT_JsContent()
 {
 }
@@ -46,11 +48,87 @@ TEST_F(UT_JsContent, UT_JsContent_insertImages_002)
     EXPECT_FALSE(instance->insertImages(image));
 }
 
+TEST_F(UT_JsContent, UT_JsContent_onImageIngested_001)
+{
+    JsContent *instance = JsContent::instance();
+    instance->m_ingestTotal = 2;
+    instance->m_ingestFinished = 0;
+    QSignalSpy ingestSpy(instance, &JsContent::callJsImageIngested);
+    QSignalSpy progressSpy(instance, &JsContent::callJsSetIngestProgress);
+
+    instance->onImageIngested(1, 0, "");
+    ASSERT_EQ(1, ingestSpy.count());
+    EXPECT_EQ(QString("1-0"), ingestSpy.at(0).at(0).toString());
+    EXPECT_TRUE(ingestSpy.at(0).at(1).toString().isEmpty());
+    EXPECT_EQ(1, progressSpy.at(0).at(0).toInt());
+    EXPECT_EQ(2, progressSpy.at(0).at(1).toInt());
+
+    //全部完成后进度清零
+    instance->onImageIngested(1, 1, "");
+    EXPECT_EQ(0, instance->m_ingestTotal);
+    EXPECT_EQ(0, progressSpy.at(1).at(1).toInt());
+}
+
+TEST_F(UT_JsContent, UT_JsContent_jsCallIngestInlineImages_001)
+{
+    JsContent *instance = JsContent::instance();
+    instance->m_ingestTotal = 0;
+    instance->m_ingestFinished = 0;
+    QSignalSpy progressSpy(instance, &JsContent::callJsSetIngestProgress);
+
+    //id与图片数量不一致时不处理
+    instance->jsCallIngestInlineImages(QStringList("inline-1"), QStringList());
+    EXPECT_EQ(0, progressSpy.count());
+    EXPECT_EQ(0, instance->m_ingestTotal);
+}
+
+TEST_F(UT_JsContent, UT_JsContent_onImageEncoded_001)
+{
+    JsContent *instance = JsContent::instance();
+    instance->m_imageEncodeStatistics.clear();
+    instance->onImageEncoded("png", 100, 30);
+    instance->onImageEncoded("png", 300, 10);
+
+    JsContent::ImageEncodeStatistics stat = instance->imageEncodeStatistics("png");
+    EXPECT_EQ(2, stat.count);
+    EXPECT_EQ(40, stat.totalTime);
+    EXPECT_EQ(30, stat.maxTime);
+    EXPECT_EQ(400, stat.totalSize);
+    EXPECT_EQ(0, instance->imageEncodeStatistics("jpeg").count);
+}
+
+TEST_F(UT_JsContent, UT_JsContent_onImageVariantsReady_001)
+{
+    JsContent *instance = JsContent::instance();
+    instance->m_variantPending = {"/tmp/1.png", "/tmp/2.png"};
+    QSignalSpy spy(instance, &JsContent::callJsImageVariantsReady);
+    instance->onImageVariantsReady(QStringList("/tmp/1.png"), QStringList("/tmp/2.png"));
+    EXPECT_TRUE(instance->m_variantPending.isEmpty());
+    EXPECT_TRUE(instance->m_variantFailed.contains("/tmp/2.png"));
+    ASSERT_EQ(1, spy.count());
+    EXPECT_EQ(QStringList("/tmp/1.png"), spy.at(0).at(0).toStringList());
+
+    //生成失败的图片不再重试
+    instance->generateImageVariants(QStringList("/tmp/2.png"));
+    EXPECT_TRUE(instance->m_variantPending.isEmpty());
+    instance->m_variantFailed.clear();
+}
+
 TEST_F(UT_JsContent, UT_JsContent_jsCallTxtChange_001)
 {
     JsContent::instance()->jsCallTxtChange();
 }
 
+TEST_F(UT_JsContent, UT_JsContent_jsCallEditorChanges_001)
+{
+    QSignalSpy spy(JsContent::instance(), &JsContent::editorChanges);
+    QVariantMap changes;
+    changes.insert("base", 1);
+    JsContent::instance()->jsCallEditorChanges(changes);
+    ASSERT_EQ(1, spy.count());
+    EXPECT_EQ(1, spy.at(0).at(0).toMap().value("base").toInt());
+}
+
 TEST_F(UT_JsContent, UT_JsContent_jsCallChannleFinish_001)
 {
     JsContent::instance()->jsCallChannleFinish();
@@ -76,6 +154,103 @@ TEST_F(UT_JsContent, UT_JsContent_callJsSynchronous_001)
     EXPECT_TRUE(JsContent::instance()->callJsSynchronous(nullptr, "").isNull());
 }
 
+TEST_F(UT_JsContent, UT_JsContent_callJsAsync_001)
+{
+    bool called = false;
+    bool result = true;
+    EXPECT_EQ(0, JsContent::instance()->callJsAsync(nullptr, "getChanges(-1)", [&](bool ok, const QVariant &) {
+        called = true;
+        result = ok;
+    }));
+    EXPECT_TRUE(called);
+    EXPECT_FALSE(result);
+}
+
+TEST_F(UT_JsContent, UT_JsContent_finishJsCall_001)
+{
+    JsContent *content = JsContent::instance();
+    JsContent::JsCallStatistics stat = content->jsCallStatistics("returnCopyFlag");
+    int count = 0;
+    QVariant value;
+
+    JsContent::JsRequest &request = content->m_jsRequests[1000];
+    request.name = "returnCopyFlag";
+    request.callback = [&](bool ok, const QVariant &result) {
+        count++;
+        value = ok ? result : QVariant();
+    };
+    request.timer.start();
+    QTimer *timeoutTimer = new QTimer(content);
+    timeoutTimer->start(1000);
+    request.timeoutTimer = timeoutTimer;
+    EXPECT_TRUE(content->isJsCallPending(1000));
+
+    content->finishJsCall(1000, true, true);
+    EXPECT_FALSE(content->isJsCallPending(1000));
+    //请求结束后超时定时器停止
+    EXPECT_FALSE(timeoutTimer->isActive());
+    EXPECT_EQ(1, count);
+    EXPECT_TRUE(value.toBool());
+    EXPECT_EQ(stat.count + 1, content->jsCallStatistics("returnCopyFlag").count);
+
+    //已结束的请求超时后不再回调
+    content->finishJsCall(1000, false, QVariant());
+    EXPECT_EQ(1, count);
+    EXPECT_EQ(stat.timeouts, content->jsCallStatistics("returnCopyFlag").timeouts);
+}
+
+TEST_F(UT_JsContent, UT_JsContent_finishJsCall_002)
+{
+    JsContent *content = JsContent::instance();
+    QList<bool> results;
+    QVariant value;
+
+    JsContent::JsRequest &request = content->m_jsRequests[1002];
+    request.name = "getChanges";
+    request.callback = [&](bool ok, const QVariant &result) {
+        results << ok;
+        value = result;
+    };
+    request.timer.start();
+    request.waitAfterTimeout = true;
+    QTimer *timeoutTimer = new QTimer(content);
+    timeoutTimer->start(1000);
+    request.timeoutTimer = timeoutTimer;
+
+    //超时后先回调失败，请求保留
+    content->finishJsCall(1002, false, QVariant());
+    EXPECT_TRUE(content->isJsCallPending(1002));
+    EXPECT_FALSE(timeoutTimer->isActive());
+    EXPECT_EQ(QList<bool>({false}), results);
+
+    //之后返回的结果仍回调
+    content->finishJsCall(1002, true, 1);
+    EXPECT_FALSE(content->isJsCallPending(1002));
+    EXPECT_EQ(QList<bool>({false, true}), results);
+    EXPECT_EQ(1, value.toInt());
+}
+
+TEST_F(UT_JsContent, UT_JsContent_cancelJsCall_001)
+{
+    JsContent *content = JsContent::instance();
+    bool called = false;
+    JsContent::JsRequest &request = content->m_jsRequests[1001];
+    request.name = "isRangeVoice";
+    request.callback = [&](bool, const QVariant &) {
+        called = true;
+    };
+    request.timer.start();
+    QTimer *timeoutTimer = new QTimer(content);
+    timeoutTimer->start(1000);
+    request.timeoutTimer = timeoutTimer;
+
+    content->cancelJsCall(1001);
+    EXPECT_FALSE(timeoutTimer->isActive());
+    content->finishJsCall(1001, false, QVariant());
+    EXPECT_FALSE(called);
+    EXPECT_FALSE(content->isJsCallPending(1001));
+}
+
 TEST_F(UT_JsContent, UT_JsContent_jsCallSetDataFinsh_001)
 {
     JsContent::instance()->jsCallSetDataFinsh();
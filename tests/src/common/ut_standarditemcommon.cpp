@@ -53,3 +53,23 @@ TEST_F(UT_StandardItemCommon, UT_StandardItemCommon_getStandardItemType_001)
     EXPECT_FALSE(m_standarditemcommon->getStandardItemData(index)) << "getStandardItemData, index(0, 1)";
     delete pDataModel;
 }
+
+TEST_F(UT_StandardItemCommon, UT_StandardItemCommon_getStandardItemSearchHit_001)
+{
+    QStandardItemModel *pDataModel = new QStandardItemModel();
+    QStandardItem *pItem = m_standarditemcommon->createStandardItem(nullptr, StandardItemCommon::NOTEITEM);
+    pDataModel->appendRow(pItem);
+    QModelIndex index = pDataModel->index(0, 0);
+    EXPECT_EQ(-1, m_standarditemcommon->getStandardItemSearchHit(index).noteId);
+
+    VNoteSearchHit hit;
+    hit.noteId = 1;
+    hit.score = 2.5;
+    hit.titleRanges.append(qMakePair(0, 2));
+    m_standarditemcommon->setStandardItemSearchHit(pItem, hit);
+    VNoteSearchHit result = m_standarditemcommon->getStandardItemSearchHit(index);
+    EXPECT_EQ(1, result.noteId);
+    EXPECT_DOUBLE_EQ(2.5, result.score);
+    EXPECT_EQ(1, result.titleRanges.size());
+    delete pDataModel;
+}
@@ -0,0 +1,120 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnotearchive.h"
+#include "vnotearchive.h"
+
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <QFile>
+
+UT_VNoteArchive::UT_VNoteArchive()
+{
+}
+
+TEST_F(UT_VNoteArchive, UT_VNoteArchive_addData_001)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    VNoteArchiveWriter closed(&buffer);
+    EXPECT_FALSE(closed.addData("a.json", "{}"));
+
+    buffer.open(QIODevice::WriteOnly);
+    VNoteArchiveWriter writer(&buffer);
+    EXPECT_FALSE(writer.addData(QString(100, 'a'), "{}"));
+    EXPECT_TRUE(writer.isOk());
+    EXPECT_TRUE(writer.addData("a.json", "{}"));
+    EXPECT_TRUE(writer.finish());
+    //条目头、补齐后的内容及两个结束块
+    EXPECT_EQ(VNoteArchiveWriter::BlockSize * 4, data.size());
+    EXPECT_EQ(QByteArray("ustar"), data.mid(257, 5));
+}
+
+TEST_F(UT_VNoteArchive, UT_VNoteArchive_next_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QString filePath = dir.filePath("voice.mp3");
+    QByteArray content(VNoteArchiveWriter::CopyChunkSize * 2 + 100, 'v');
+    QFile file(filePath);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(content);
+    file.close();
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    VNoteArchiveWriter writer(&buffer);
+    EXPECT_FALSE(writer.addFile("none", dir.filePath("none.mp3")));
+    EXPECT_TRUE(writer.addData("manifest.json", "{\"version\":1}"));
+    EXPECT_TRUE(writer.addFile("attachments/voicenote/voice.mp3", filePath));
+    EXPECT_TRUE(writer.addData("notes/1-1.json", "{}"));
+    EXPECT_TRUE(writer.finish());
+    buffer.close();
+
+    buffer.open(QIODevice::ReadOnly);
+    VNoteArchiveReader reader(&buffer);
+    VNoteArchiveReader::Entry entry;
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(QString("manifest.json"), entry.name);
+    EXPECT_TRUE(entry.isFile);
+    EXPECT_EQ(QByteArray("{\"version\":1}"), reader.readAll());
+
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(content.size(), entry.size);
+    QByteArray copied;
+    QBuffer output(&copied);
+    output.open(QIODevice::WriteOnly);
+    EXPECT_TRUE(reader.copyTo(&output));
+    EXPECT_EQ(content, copied);
+
+    //未读取的条目内容被跳过
+    ASSERT_TRUE(reader.next(entry));
+    EXPECT_EQ(QString("notes/1-1.json"), entry.name);
+    EXPECT_FALSE(reader.next(entry));
+    EXPECT_FALSE(reader.hasError());
+}
+
+TEST_F(UT_VNoteArchive, UT_VNoteArchive_next_002)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    VNoteArchiveWriter writer(&buffer);
+    writer.addData("a.json", "{}");
+    buffer.close();
+
+    //没有结束标记的归档
+    QByteArray truncated = data;
+    QBuffer truncatedBuffer(&truncated);
+    truncatedBuffer.open(QIODevice::ReadOnly);
+    VNoteArchiveReader truncatedReader(&truncatedBuffer);
+    VNoteArchiveReader::Entry entry;
+    EXPECT_TRUE(truncatedReader.next(entry));
+    EXPECT_FALSE(truncatedReader.next(entry));
+    EXPECT_TRUE(truncatedReader.hasError());
+
+    //校验和错误
+    data[0] = 'b';
+    buffer.open(QIODevice::ReadOnly);
+    VNoteArchiveReader reader(&buffer);
+    EXPECT_FALSE(reader.next(entry));
+    EXPECT_TRUE(reader.hasError());
+}
@@ -0,0 +1,47 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnoteattachmentschemehandler.h"
+#include "vnoteattachmentschemehandler.h"
+
+#include <QWebEngineProfile>
+
+UT_VNoteAttachmentSchemeHandler::UT_VNoteAttachmentSchemeHandler()
+{
+}
+
+TEST_F(UT_VNoteAttachmentSchemeHandler, UT_VNoteAttachmentSchemeHandler_mimeType_001)
+{
+    EXPECT_EQ(QByteArray("image/png"), VNoteAttachmentSchemeHandler::mimeType("/tmp/a.png"));
+    EXPECT_EQ(QByteArray("image/jpeg"), VNoteAttachmentSchemeHandler::mimeType("/tmp/a.jpg"));
+    EXPECT_EQ(QByteArray("audio/mpeg"), VNoteAttachmentSchemeHandler::mimeType("/tmp/a.mp3"));
+}
+
+TEST_F(UT_VNoteAttachmentSchemeHandler, UT_VNoteAttachmentSchemeHandler_install_001)
+{
+    QWebEngineProfile profile;
+    VNoteAttachmentSchemeHandler::install(&profile);
+    const QWebEngineUrlSchemeHandler *handler = profile.urlSchemeHandler(VNoteAttachmentSchemeHandler::Scheme);
+    EXPECT_TRUE(nullptr != handler);
+
+    //重复安装时不再创建
+    VNoteAttachmentSchemeHandler::install(&profile);
+    EXPECT_EQ(handler, profile.urlSchemeHandler(VNoteAttachmentSchemeHandler::Scheme));
+}
@@ -0,0 +1,268 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnoteattachmentstore.h"
+#include "vnoteattachmentstore.h"
+#include "db/vnoteattachmentoper.h"
+#include "common/vnoteimagevariant.h"
+#include <stub.h>
+
+#include <QTemporaryDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QImage>
+#include <QImageWriter>
+#include <QBuffer>
+
+static QString g_attachmentDir;
+
+static QString stub_attachmentDir()
+{
+    return g_attachmentDir;
+}
+
+static bool stub_true()
+{
+    return true;
+}
+
+UT_VNoteAttachmentStore::UT_VNoteAttachmentStore()
+{
+}
+
+TEST_F(UT_VNoteAttachmentStore, UT_VNoteAttachmentStore_isStoreFileName_001)
+{
+    EXPECT_TRUE(VNoteAttachmentStore::isStoreFileName(QString(64, 'a') + ".png"));
+    EXPECT_FALSE(VNoteAttachmentStore::isStoreFileName(QString(64, 'A') + ".png"));
+    EXPECT_FALSE(VNoteAttachmentStore::isStoreFileName(QString(63, 'a') + ".png"));
+    EXPECT_FALSE(VNoteAttachmentStore::isStoreFileName("20200101120000.png"));
+}
+
+TEST_F(UT_VNoteAttachmentStore, UT_VNoteAttachmentStore_fileHash_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QFile file(dir.filePath("test.txt"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("abc");
+    file.close();
+
+    EXPECT_EQ(QString("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"),
+              VNoteAttachmentStore::fileHash(file.fileName()));
+    EXPECT_TRUE(VNoteAttachmentStore::fileHash(dir.filePath("none.txt")).isEmpty());
+}
+
+TEST_F(UT_VNoteAttachmentStore, UT_VNoteAttachmentStore_storeData_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    g_attachmentDir = dir.path();
+
+    Stub stub;
+    stub.set(ADDR(VNoteAttachmentStore, attachmentDir), stub_attachmentDir);
+    stub.set(ADDR(VNoteAttachmentOper, addAttachment), stub_true);
+
+    EXPECT_TRUE(VNoteAttachmentStore::storeData(QByteArray(), "png", VNoteAttachment::Image).isEmpty());
+
+    //相同内容只保存一份
+    QString path = VNoteAttachmentStore::storeData("abc", "png", VNoteAttachment::Image);
+    EXPECT_TRUE(QFile::exists(path));
+    EXPECT_TRUE(VNoteAttachmentStore::isStoreFileName(QFileInfo(path).fileName()));
+    EXPECT_EQ(path, VNoteAttachmentStore::storeData("abc", "png", VNoteAttachment::Image));
+    EXPECT_EQ(1u, QDir(dir.path()).entryList(QDir::Files).size());
+}
+
+TEST_F(UT_VNoteAttachmentStore, UT_VNoteAttachmentStore_storeFile_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    g_attachmentDir = dir.filePath("store");
+
+    Stub stub;
+    stub.set(ADDR(VNoteAttachmentStore, attachmentDir), stub_attachmentDir);
+    stub.set(ADDR(VNoteAttachmentOper, addAttachment), stub_true);
+
+    QString source = dir.filePath("test.mp3");
+    QFile file(source);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("voice");
+    file.close();
+
+    QString copied = VNoteAttachmentStore::storeFile(source, VNoteAttachment::Voice);
+    EXPECT_TRUE(QFile::exists(copied));
+    EXPECT_TRUE(QFile::exists(source));
+
+    //移动已存在的内容时只删除源文件
+    EXPECT_EQ(copied, VNoteAttachmentStore::storeFile(source, VNoteAttachment::Voice, true));
+    EXPECT_FALSE(QFile::exists(source));
+    EXPECT_TRUE(VNoteAttachmentStore::storeFile(source, VNoteAttachment::Voice).isEmpty());
+}
+
+TEST_F(UT_VNoteAttachmentStore, UT_VNoteAttachmentStore_encodeImage_001)
+{
+    QByteArray data;
+    EXPECT_TRUE(VNoteAttachmentStore::encodeImage(QImage(), "png", -1, data).isEmpty());
+
+    QImage image(64, 32, QImage::Format_ARGB32);
+    image.fill(Qt::red);
+    //像素全部不透明时可以使用jpeg
+    EXPECT_EQ(QByteArray("jpeg"), VNoteAttachmentStore::encodeImage(image, "jpg", 200, data));
+    EXPECT_EQ(QSize(64, 32), QImage::fromData(data).size());
+
+    //存在透明像素或格式不支持时使用png
+    image.fill(Qt::transparent);
+    EXPECT_EQ(QByteArray("png"), VNoteAttachmentStore::encodeImage(image, "jpeg", -1, data));
+    EXPECT_EQ(QByteArray("png"), VNoteAttachmentStore::encodeImage(image, "gif", -1, data));
+
+    QByteArray webp = QImageWriter::supportedImageFormats().contains("webp") ? "webp" : "png";
+    EXPECT_EQ(webp, VNoteAttachmentStore::encodeImage(image, "webp", -1, data));
+}
+
+TEST_F(UT_VNoteAttachmentStore, UT_VNoteAttachmentStore_localPath_001)
+{
+    g_attachmentDir = "/tmp/store";
+
+    Stub stub;
+    stub.set(ADDR(VNoteAttachmentStore, attachmentDir), stub_attachmentDir);
+
+    QString name = QString(64, 'a') + ".png";
+    EXPECT_EQ(QString("vnote://attachment/") + name, VNoteAttachmentStore::attachmentUrl("/tmp/store/" + name));
+    EXPECT_EQ(QString("file:///tmp/test.png"), VNoteAttachmentStore::attachmentUrl("/tmp/test.png"));
+
+    EXPECT_EQ("/tmp/store/" + name, VNoteAttachmentStore::localPath("vnote://attachment/" + name));
+    EXPECT_EQ(QString("/tmp/test.png"), VNoteAttachmentStore::localPath("file:///tmp/test.png"));
+    EXPECT_EQ(VNoteImageVariant::variantPath("/tmp/store/" + name, VNoteImageVariant::Thumbnail),
+              VNoteAttachmentStore::localPath("vnote://attachment/" + name + "?variant=thumb"));
+
+    //只能访问附件目录中的文件
+    EXPECT_TRUE(VNoteAttachmentStore::localPath("vnote://other/" + name).isEmpty());
+    EXPECT_TRUE(VNoteAttachmentStore::localPath("vnote://attachment/../test.png").isEmpty());
+}
+
+TEST_F(UT_VNoteAttachmentStore, UT_VNoteAttachmentStore_resolveUrls_001)
+{
+    g_attachmentDir = "/tmp/store";
+
+    Stub stub;
+    stub.set(ADDR(VNoteAttachmentStore, attachmentDir), stub_attachmentDir);
+
+    QString html = "<p>text</p>";
+    EXPECT_EQ(html, VNoteAttachmentStore::resolveUrls(html));
+
+    html = "<img src=\"vnote://attachment/a.png\"><img src=\"vnote://attachment/b.jpg\">";
+    EXPECT_EQ(QString("<img src=\"/tmp/store/a.png\"><img src=\"/tmp/store/b.jpg\">"), VNoteAttachmentStore::resolveUrls(html));
+}
+
+TEST_F(UT_VNoteAttachmentStore, UT_VNoteAttachmentStore_storeDataUri_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    g_attachmentDir = dir.filePath("store");
+
+    Stub stub;
+    stub.set(ADDR(VNoteAttachmentStore, attachmentDir), stub_attachmentDir);
+    stub.set(ADDR(VNoteAttachmentOper, addAttachment), stub_true);
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    QImage image(8, 8, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    ASSERT_TRUE(image.save(&buffer, "png"));
+
+    //保存原始数据，不重新编码
+    QString path = VNoteAttachmentStore::storeDataUri("data:image/png;base64," + QString::fromLatin1(data.toBase64()));
+    EXPECT_EQ(QString("png"), QFileInfo(path).suffix());
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    EXPECT_EQ(data, file.readAll());
+
+    EXPECT_TRUE(VNoteAttachmentStore::storeDataUri("data:image/png;base64,").isEmpty());
+    EXPECT_TRUE(VNoteAttachmentStore::storeDataUri("data:text/plain;base64,YWJj").isEmpty());
+    EXPECT_TRUE(VNoteAttachmentStore::storeDataUri("data:image/svg+xml,%3Csvg%3E%3C/svg%3E").isEmpty());
+}
+
+TEST_F(UT_VNoteAttachmentStore, UT_VNoteAttachmentStore_externalizeDataUris_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    g_attachmentDir = dir.filePath("store");
+
+    Stub stub;
+    stub.set(ADDR(VNoteAttachmentStore, attachmentDir), stub_attachmentDir);
+    stub.set(ADDR(VNoteAttachmentOper, addAttachment), stub_true);
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    QImage image(8, 8, QImage::Format_RGB32);
+    image.fill(Qt::blue);
+    ASSERT_TRUE(image.save(&buffer, "jpg"));
+    QString uri = "data:image/jpeg;base64," + QString::fromLatin1(data.toBase64());
+
+    QString html = "<p>data:image/png</p>";
+    EXPECT_EQ(html, VNoteAttachmentStore::externalizeDataUris(html));
+
+    QStringList images;
+    html = QString("<img src=\"%1\"><img class=\"a\" src='%1'><img src=\"data:image/gif;base64,R0lG\">").arg(uri);
+    QString result = VNoteAttachmentStore::externalizeDataUris(html, &images);
+    ASSERT_EQ(2, images.size());
+    EXPECT_EQ(images.at(0), images.at(1));
+
+    QString url = VNoteAttachmentStore::attachmentUrl(images.at(0));
+    EXPECT_EQ(QString("<img src=\"%1\"><img class=\"a\" src='%1'><img src=\"data:image/gif;base64,R0lG\">").arg(url), result);
+}
+
+TEST_F(UT_VNoteAttachmentStore, UT_VNoteAttachmentStore_externalizeLocalPaths_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    g_attachmentDir = dir.filePath("store");
+    ASSERT_TRUE(QDir().mkpath(g_attachmentDir));
+
+    Stub stub;
+    stub.set(ADDR(VNoteAttachmentStore, attachmentDir), stub_attachmentDir);
+    stub.set(ADDR(VNoteAttachmentOper, addAttachment), stub_true);
+
+    QString html = "<img src=\"vnote://attachment/a.png\">";
+    EXPECT_EQ(html, VNoteAttachmentStore::externalizeLocalPaths(html));
+
+    //旧版本按时间命名的图片
+    QString legacy = g_attachmentDir + "/20200101120000.png";
+    QImage image(8, 8, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    ASSERT_TRUE(image.save(legacy, "png"));
+    QString outside = dir.filePath("outside.png");
+    ASSERT_TRUE(image.save(outside, "png"));
+
+    QStringList images;
+    html = QString("<img src=\"%1\"><img src='file://%1'><img src=\"%2\"><img src=\"%3\">")
+           .arg(legacy).arg(outside).arg(g_attachmentDir + "/none.png");
+    QString result = VNoteAttachmentStore::externalizeLocalPaths(html, &images);
+    ASSERT_EQ(2, images.size());
+    EXPECT_TRUE(VNoteAttachmentStore::isStoreFileName(QFileInfo(images.at(0)).fileName()));
+    EXPECT_TRUE(QFile::exists(images.at(0)));
+    //旧文件保留，无引用后由清理线程删除
+    EXPECT_TRUE(QFile::exists(legacy));
+
+    //图片目录外和不存在的图片不替换
+    QString url = VNoteAttachmentStore::attachmentUrl(images.at(0));
+    EXPECT_EQ(QString("<img src=\"%1\"><img src='%1'><img src=\"%2\"><img src=\"%3\">")
+              .arg(url).arg(outside).arg(g_attachmentDir + "/none.png"), result);
+}
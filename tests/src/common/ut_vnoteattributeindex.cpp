@@ -0,0 +1,117 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnoteattributeindex.h"
+#include "vnoteattributeindex.h"
+#include "vnoteitem.h"
+
+//测试使用的id不与实际数据冲突
+static const qint64 TEST_ID_BASE = 900000;
+
+UT_VNoteAttributeIndex::UT_VNoteAttributeIndex()
+{
+}
+
+void UT_VNoteAttributeIndex::TearDown()
+{
+    VNoteAttributeIndex::instance()->removeFolder(TEST_ID_BASE);
+    VNoteAttributeIndex::instance()->removeFolder(TEST_ID_BASE + 1);
+}
+
+TEST_F(UT_VNoteAttributeIndex, UT_VNoteAttributeIndex_query_001)
+{
+    VNoteAttributeIndex *index = VNoteAttributeIndex::instance();
+    QDateTime now = QDateTime::currentDateTime();
+
+    VNoteItem voiceNote;
+    voiceNote.folderId = TEST_ID_BASE;
+    voiceNote.noteId = TEST_ID_BASE;
+    voiceNote.isTop = 1;
+    voiceNote.modifyTime = now.addDays(-10);
+    voiceNote.htmlCode = "<div jsonkey=\"{}\"></div>";
+    index->updateNote(&voiceNote);
+
+    VNoteItem imageNote;
+    imageNote.folderId = TEST_ID_BASE + 1;
+    imageNote.noteId = TEST_ID_BASE + 1;
+    imageNote.modifyTime = now;
+    imageNote.htmlCode = "<p><IMG src=\"a.png\"></p>";
+    index->updateNote(&imageNote);
+
+    VNoteAttributeIndex::Filter filter;
+    filter.limitFolders = true;
+    filter.folderIds.insert(TEST_ID_BASE + 1);
+    VNOTE_SEARCH_HITS hits = index->query(filter);
+    ASSERT_EQ(1, hits.size());
+    EXPECT_EQ(TEST_ID_BASE + 1, hits.at(0).noteId);
+    EXPECT_EQ(TEST_ID_BASE + 1, hits.at(0).folderId);
+
+    //各条件取交集
+    filter = VNoteAttributeIndex::Filter();
+    filter.hasVoice = true;
+    filter.pinned = 1;
+    hits = index->query(filter);
+    ASSERT_EQ(1, hits.size());
+    EXPECT_EQ(TEST_ID_BASE, hits.at(0).noteId);
+    filter.hasImage = true;
+    EXPECT_TRUE(index->query(filter).isEmpty());
+
+    filter = VNoteAttributeIndex::Filter();
+    filter.limitFolders = true;
+    filter.folderIds << TEST_ID_BASE << TEST_ID_BASE + 1;
+    filter.after = now.addDays(-1);
+    hits = index->query(filter);
+    ASSERT_EQ(1, hits.size());
+    EXPECT_EQ(TEST_ID_BASE + 1, hits.at(0).noteId);
+    filter.pinned = 0;
+    EXPECT_EQ(1, index->query(filter).size());
+
+    //没有匹配的记事本时没有结果
+    filter = VNoteAttributeIndex::Filter();
+    filter.limitFolders = true;
+    EXPECT_TRUE(index->query(filter).isEmpty());
+}
+
+TEST_F(UT_VNoteAttributeIndex, UT_VNoteAttributeIndex_updateNote_001)
+{
+    VNoteAttributeIndex *index = VNoteAttributeIndex::instance();
+    int count = index->count();
+
+    VNoteItem note;
+    note.folderId = TEST_ID_BASE;
+    note.noteId = TEST_ID_BASE + 2;
+    note.modifyTime = QDateTime::currentDateTime();
+    index->updateNote(&note);
+    EXPECT_EQ(count + 1, index->count());
+
+    //移动到其他记事本后索引随之更新
+    note.folderId = TEST_ID_BASE + 1;
+    index->updateNote(&note);
+    EXPECT_EQ(count + 1, index->count());
+    VNoteAttributeIndex::Filter filter;
+    filter.limitFolders = true;
+    filter.folderIds.insert(TEST_ID_BASE);
+    EXPECT_TRUE(index->query(filter).isEmpty());
+
+    index->removeNote(note.noteId);
+    EXPECT_EQ(count, index->count());
+    index->updateNote(nullptr);
+    EXPECT_EQ(count, index->count());
+}
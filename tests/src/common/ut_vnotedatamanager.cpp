@@ -113,3 +113,11 @@ TEST_F(UT_VnoteDataManager, UT_VnoteDataManager_reqNoteDefIcons_001)
     VNoteDataManager vnotedatamanager;
     vnotedatamanager.reqNoteDefIcons();
 }
+
+TEST_F(UT_VnoteDataManager, UT_VnoteDataManager_updateDataVersion_001)
+{
+    VNoteDataManager vnotedatamanager;
+    int version = vnotedatamanager.dataVersion();
+    vnotedatamanager.updateDataVersion();
+    EXPECT_EQ(version + 1, vnotedatamanager.dataVersion());
+}
@@ -0,0 +1,93 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnoteeditorcache.h"
+#include "vnoteeditorcache.h"
+
+UT_VNoteEditorCache::UT_VNoteEditorCache()
+{
+}
+
+TEST_F(UT_VNoteEditorCache, UT_VNoteEditorCache_noteKey_001)
+{
+    VNoteItem note;
+    note.folderId = 1;
+    note.noteId = 2;
+    note.modifyTime = QDateTime::fromMSecsSinceEpoch(1000);
+    EXPECT_EQ(QString("1_2_1000"), VNoteEditorCache::noteKey(&note));
+
+    //修改后键值变化
+    note.modifyTime = QDateTime::fromMSecsSinceEpoch(2000);
+    EXPECT_EQ(QString("1_2_2000"), VNoteEditorCache::noteKey(&note));
+}
+
+TEST_F(UT_VNoteEditorCache, UT_VNoteEditorCache_insert_001)
+{
+    VNoteEditorCache cache;
+    cache.setLimit(100);
+    QStringList evicted;
+
+    EXPECT_TRUE(cache.insert("a", 40, evicted));
+    EXPECT_TRUE(cache.insert("b", 40, evicted));
+    EXPECT_TRUE(evicted.isEmpty());
+    EXPECT_EQ(80, cache.size());
+
+    //取出后重新加入，a成为最近使用
+    EXPECT_TRUE(cache.take("a"));
+    EXPECT_FALSE(cache.take("a"));
+    EXPECT_TRUE(cache.insert("a", 40, evicted));
+
+    //超出上限时淘汰最久未使用的b
+    EXPECT_TRUE(cache.insert("c", 40, evicted));
+    EXPECT_EQ(QStringList({"b"}), evicted);
+    EXPECT_FALSE(cache.contains("b"));
+    EXPECT_EQ(2, cache.count());
+    EXPECT_EQ(80, cache.size());
+
+    //超过上限的内容不缓存
+    evicted.clear();
+    EXPECT_FALSE(cache.insert("d", 101, evicted));
+    EXPECT_FALSE(cache.contains("d"));
+    EXPECT_TRUE(evicted.isEmpty());
+}
+
+TEST_F(UT_VNoteEditorCache, UT_VNoteEditorCache_setLimit_001)
+{
+    VNoteEditorCache cache;
+    QStringList evicted;
+    cache.insert("a", 10, evicted);
+    cache.insert("b", 10, evicted);
+    cache.insert("c", 10, evicted);
+
+    EXPECT_EQ(QStringList({"a", "b"}), cache.setLimit(15));
+    EXPECT_EQ(15, cache.limit());
+    EXPECT_TRUE(cache.contains("c"));
+
+    //上限为0时不缓存
+    EXPECT_EQ(QStringList({"c"}), cache.setLimit(0));
+    EXPECT_FALSE(cache.insert("d", 1, evicted));
+    EXPECT_EQ(0, cache.count());
+
+    cache.setLimit(100);
+    cache.insert("e", 1, evicted);
+    cache.clear();
+    EXPECT_EQ(0, cache.count());
+    EXPECT_EQ(0, cache.size());
+}
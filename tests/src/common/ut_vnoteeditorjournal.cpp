@@ -0,0 +1,141 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnoteeditorjournal.h"
+#include "vnoteeditorjournal.h"
+#include "vnoteitem.h"
+
+#include <QTemporaryDir>
+#include <QFile>
+#include <QFileInfo>
+
+UT_VNoteEditorJournal::UT_VNoteEditorJournal()
+{
+}
+
+static QVariantMap fullChanges(int version, const QStringList &blocks)
+{
+    QVariantMap changes;
+    changes.insert("version", version);
+    changes.insert("full", true);
+    changes.insert("blocks", blocks);
+    return changes;
+}
+
+static QVariantMap insertChanges(int base, int version, int count, const QString &block)
+{
+    QVariantMap keep;
+    keep.insert("keep", count - 1);
+    QVariantMap insert;
+    insert.insert("insert", QStringList(block));
+    QVariantMap changes;
+    changes.insert("version", version);
+    changes.insert("base", base);
+    changes.insert("count", count);
+    changes.insert("ops", QVariantList({keep, insert}));
+    return changes;
+}
+
+TEST_F(UT_VNoteEditorJournal, UT_VNoteEditorJournal_replay_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QString path = dir.filePath("editor.journal");
+
+    VNoteItem note;
+    note.folderId = 1;
+    note.noteId = 2;
+    VNoteEditorSync sync;
+    {
+        VNoteEditorJournal journal(path);
+        //检查点后的第一条增量记录写入全部内容块
+        sync.applyChanges(fullChanges(1, {"<p>a</p>"}));
+        QVariantMap changes = insertChanges(1, 2, 2, "<p>b</p>");
+        sync.applyChanges(changes);
+        EXPECT_TRUE(journal.append(&note, changes, sync));
+        EXPECT_TRUE(journal.isPending(&note));
+
+        changes = insertChanges(2, 3, 3, "<p>c</p>");
+        sync.applyChanges(changes);
+        EXPECT_TRUE(journal.append(&note, changes, sync));
+    }
+
+    QMap<VNoteJournalKey, QString> notes = VNoteEditorJournal::replay(path);
+    ASSERT_EQ(1, notes.size());
+    EXPECT_EQ(QString("<p>a</p><p>b</p><p>c</p>"), notes.value(VNoteJournalKey(1, 2)));
+
+    VNoteEditorJournal::discard(path);
+    EXPECT_FALSE(QFile::exists(path));
+    EXPECT_TRUE(VNoteEditorJournal::replay(path).isEmpty());
+}
+
+TEST_F(UT_VNoteEditorJournal, UT_VNoteEditorJournal_checkpoint_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QString path = dir.filePath("editor.journal");
+
+    VNoteItem noteA;
+    noteA.noteId = 1;
+    VNoteItem noteB;
+    noteB.noteId = 2;
+    VNoteEditorSync sync;
+    sync.applyChanges(fullChanges(1, {"<p>a</p>"}));
+
+    VNoteEditorJournal journal(path);
+    journal.append(&noteA, QVariantMap(), sync);
+    journal.append(&noteB, QVariantMap(), sync);
+
+    //还有其他笔记的记录时写入检查点
+    journal.checkpoint(&noteA);
+    EXPECT_FALSE(journal.isPending(&noteA));
+    QMap<VNoteJournalKey, QString> notes = VNoteEditorJournal::replay(path);
+    ASSERT_EQ(1, notes.size());
+    EXPECT_TRUE(notes.contains(VNoteJournalKey(0, 2)));
+
+    //全部保存后清空日志
+    journal.checkpoint(&noteB);
+    EXPECT_EQ(0, QFileInfo(path).size());
+}
+
+TEST_F(UT_VNoteEditorJournal, UT_VNoteEditorJournal_replay_002)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QString path = dir.filePath("editor.journal");
+
+    VNoteItem note;
+    VNoteEditorSync sync;
+    sync.applyChanges(fullChanges(1, {"<p>a</p>"}));
+    {
+        VNoteEditorJournal journal(path);
+        journal.append(&note, QVariantMap(), sync);
+        QVariantMap changes = insertChanges(1, 2, 2, "<p>b</p>");
+        sync.applyChanges(changes);
+        journal.append(&note, changes, sync);
+    }
+
+    //末尾不完整的记录丢弃
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    file.resize(file.size() - 3);
+    file.close();
+    EXPECT_EQ(QString("<p>a</p>"), VNoteEditorJournal::replay(path).value(VNoteJournalKey(0, 0)));
+}
@@ -0,0 +1,100 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnoteeditorsync.h"
+#include "vnoteeditorsync.h"
+
+UT_VNoteEditorSync::UT_VNoteEditorSync()
+{
+}
+
+static QVariantMap makeOp(const QString &type, const QVariant &value)
+{
+    QVariantMap op;
+    op.insert(type, value);
+    return op;
+}
+
+TEST_F(UT_VNoteEditorSync, UT_VNoteEditorSync_applyChanges_001)
+{
+    VNoteEditorSync sync;
+    EXPECT_EQ(-1, sync.version());
+
+    QVariantMap full;
+    full.insert("version", 1);
+    full.insert("full", true);
+    full.insert("blocks", QStringList({"<p>a</p>", "<p>b</p>", "<p>c</p>"}));
+    EXPECT_TRUE(sync.applyChanges(full));
+    EXPECT_EQ(1, sync.version());
+    EXPECT_EQ(3, sync.blockCount());
+
+    //修改第二块，末尾插入一块
+    QVariantMap delta;
+    delta.insert("version", 2);
+    delta.insert("base", 1);
+    delta.insert("count", 4);
+    delta.insert("ops", QVariantList({makeOp("keep", 1), makeOp("skip", 1),
+                                      makeOp("insert", QStringList({"<p>B</p>"})),
+                                      makeOp("keep", 1), makeOp("insert", QStringList({"<p>d</p>"}))}));
+    EXPECT_TRUE(sync.applyChanges(delta));
+    EXPECT_EQ(2, sync.version());
+    EXPECT_EQ(QString("<p>a</p><p>B</p><p>c</p><p>d</p>"), sync.html());
+
+    //删除首块，其余保留
+    delta.insert("version", 3);
+    delta.insert("base", 2);
+    delta.insert("count", 3);
+    delta.insert("ops", QVariantList({makeOp("skip", 1)}));
+    EXPECT_TRUE(sync.applyChanges(delta));
+    EXPECT_EQ(QString("<p>B</p><p>c</p><p>d</p>"), sync.html());
+}
+
+TEST_F(UT_VNoteEditorSync, UT_VNoteEditorSync_applyChanges_002)
+{
+    VNoteEditorSync sync;
+    QVariantMap full;
+    full.insert("version", 5);
+    full.insert("full", true);
+    full.insert("blocks", QStringList({"<p>a</p>"}));
+    sync.applyChanges(full);
+
+    //基准版本不一致
+    QVariantMap delta;
+    delta.insert("version", 7);
+    delta.insert("base", 6);
+    delta.insert("count", 1);
+    EXPECT_FALSE(sync.applyChanges(delta));
+    EXPECT_EQ(-1, sync.version());
+    EXPECT_EQ(0, sync.blockCount());
+
+    //块数不一致
+    sync.applyChanges(full);
+    delta.insert("base", 5);
+    delta.insert("count", 2);
+    delta.insert("ops", QVariantList({makeOp("keep", 1)}));
+    EXPECT_FALSE(sync.applyChanges(delta));
+
+    //越界操作
+    sync.applyChanges(full);
+    delta.insert("count", 1);
+    delta.insert("ops", QVariantList({makeOp("skip", 2)}));
+    EXPECT_FALSE(sync.applyChanges(delta));
+    EXPECT_FALSE(sync.applyChanges(QVariantMap()));
+}
@@ -0,0 +1,112 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnotefilecopier.h"
+#include "vnotefilecopier.h"
+
+#include <QTemporaryDir>
+#include <QFile>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+static void writeTestFile(const QString &path, int size)
+{
+    QByteArray data;
+    for (int i = 0; i < size; i++) {
+        data.append(static_cast<char>(i * 7));
+    }
+    QFile file(path);
+    file.open(QIODevice::WriteOnly);
+    file.write(data);
+    file.close();
+}
+
+static QByteArray readTestFile(const QString &path)
+{
+    QFile file(path);
+    file.open(QIODevice::ReadOnly);
+    return file.readAll();
+}
+
+static int totalCopyCount()
+{
+    int count = totalCopyCount();
+    return count;
+}
+
+UT_VNoteFileCopier::UT_VNoteFileCopier()
+{
+}
+
+TEST_F(UT_VNoteFileCopier, UT_VNoteFileCopier_copy_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QString source = dir.filePath("source.mp3");
+    QString target = dir.filePath("target.mp3");
+    writeTestFile(source, 3 * VNoteFileCopier::BufferSize + 100);
+
+    VNoteFileCopier::Method method = VNoteFileCopier::MethodCount;
+    int count = totalCopyCount();
+
+    EXPECT_TRUE(VNoteFileCopier::copy(source, target, &method));
+    EXPECT_EQ(readTestFile(source), readTestFile(target));
+    EXPECT_EQ(QFile::permissions(source), QFile::permissions(target));
+    EXPECT_NE(VNoteFileCopier::MethodCount, method);
+    EXPECT_EQ(count + 1, totalCopyCount());
+
+    //目标文件已存在时不覆盖
+    EXPECT_FALSE(VNoteFileCopier::copy(source, target));
+    EXPECT_FALSE(VNoteFileCopier::copy(dir.filePath("none.mp3"), dir.filePath("none2.mp3")));
+    EXPECT_FALSE(QFile::exists(dir.filePath("none2.mp3")));
+}
+
+TEST_F(UT_VNoteFileCopier, UT_VNoteFileCopier_copyBuffered_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QString source = dir.filePath("source.mp3");
+    QString target = dir.filePath("target.mp3");
+    writeTestFile(source, VNoteFileCopier::BufferSize + 10);
+    QByteArray data = readTestFile(source);
+
+    //从已复制的位置继续
+    QFile file(target);
+    file.open(QIODevice::WriteOnly);
+    file.write(data.left(10));
+    file.close();
+
+    int sourceFd = ::open(QFile::encodeName(source).constData(), O_RDONLY);
+    int targetFd = ::open(QFile::encodeName(target).constData(), O_WRONLY);
+    qint64 copied = 10;
+    EXPECT_EQ(VNoteFileCopier::CopyDone, VNoteFileCopier::copyBuffered(sourceFd, targetFd, copied));
+    ::close(sourceFd);
+    ::close(targetFd);
+
+    EXPECT_EQ(data.size(), copied);
+    EXPECT_EQ(data, readTestFile(target));
+}
+
+TEST_F(UT_VNoteFileCopier, UT_VNoteFileCopier_methodName_001)
+{
+    EXPECT_STREQ("reflink", VNoteFileCopier::methodName(VNoteFileCopier::Reflink));
+    EXPECT_STREQ("buffered", VNoteFileCopier::methodName(VNoteFileCopier::Buffered));
+}
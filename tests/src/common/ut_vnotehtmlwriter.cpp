@@ -0,0 +1,85 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnotehtmlwriter.h"
+#include "vnotehtmlwriter.h"
+
+#include <QBuffer>
+#include <QImage>
+#include <QTemporaryDir>
+#include <QFile>
+
+UT_VNoteHtmlWriter::UT_VNoteHtmlWriter()
+{
+}
+
+TEST_F(UT_VNoteHtmlWriter, UT_VNoteHtmlWriter_write_001)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    VNoteHtmlWriter closed(&buffer);
+    closed.write("abc");
+    EXPECT_FALSE(closed.isOk());
+
+    buffer.open(QIODevice::WriteOnly);
+    VNoteHtmlWriter writer(&buffer);
+    writer.write("<p>文本</p>");
+    EXPECT_TRUE(writer.isOk());
+    EXPECT_EQ(QString("<p>文本</p>").toUtf8(), data);
+}
+
+TEST_F(UT_VNoteHtmlWriter, UT_VNoteHtmlWriter_writeImage_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    EXPECT_FALSE(VNoteHtmlWriter::isImage(dir.filePath("none.png")));
+
+    //小图直接编码文件内容，分块编码结果与整体编码一致
+    QImage image(300, 200, QImage::Format_RGB32);
+    image.fill(Qt::green);
+    QString small = dir.filePath("small.png");
+    ASSERT_TRUE(image.save(small));
+    ASSERT_TRUE(VNoteHtmlWriter::isImage(small));
+
+    QFile file(small);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    QByteArray expected = "data:image/png;base64," + file.readAll().toBase64();
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    VNoteHtmlWriter writer(&buffer);
+    writer.writeImage(small);
+    EXPECT_TRUE(writer.isOk());
+    EXPECT_EQ(expected, data);
+
+    //超过最大宽度的图片缩小后编码
+    QImage large(2000, 1000, QImage::Format_RGB32);
+    large.fill(Qt::blue);
+    QString largePath = dir.filePath("large.jpg");
+    ASSERT_TRUE(large.save(largePath));
+
+    data.clear();
+    buffer.seek(0);
+    writer.writeImage(largePath);
+    ASSERT_TRUE(data.startsWith("data:image/jpeg;base64,"));
+    QImage decoded = QImage::fromData(QByteArray::fromBase64(data.mid(data.indexOf(',') + 1)));
+    EXPECT_EQ(static_cast<int>(VNoteHtmlWriter::MaxImageWidth), decoded.width());
+}
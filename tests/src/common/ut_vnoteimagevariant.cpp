@@ -0,0 +1,87 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnoteimagevariant.h"
+#include "vnoteimagevariant.h"
+
+#include <QTemporaryDir>
+#include <QImage>
+#include <QImageReader>
+#include <QFile>
+
+UT_VNoteImageVariant::UT_VNoteImageVariant()
+{
+}
+
+TEST_F(UT_VNoteImageVariant, UT_VNoteImageVariant_variantPath_001)
+{
+    QString original = "/tmp/images/1.png";
+    EXPECT_EQ(original, VNoteImageVariant::variantPath(original, VNoteImageVariant::Original));
+    EXPECT_EQ(QString("/tmp/images/display/1.png"), VNoteImageVariant::variantPath(original, VNoteImageVariant::Display));
+    EXPECT_EQ(QString("/tmp/images/thumb/1.png"), VNoteImageVariant::variantPath(original, VNoteImageVariant::Thumbnail));
+}
+
+TEST_F(UT_VNoteImageVariant, UT_VNoteImageVariant_generate_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QString original = dir.filePath("1.png");
+    QImage image(2000, 1000, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    ASSERT_TRUE(image.save(original));
+
+    //没有副本时使用原图
+    EXPECT_FALSE(VNoteImageVariant::hasVariants(original));
+    EXPECT_EQ(original, VNoteImageVariant::bestPath(original, VNoteImageVariant::Thumbnail));
+
+    EXPECT_TRUE(VNoteImageVariant::generate(original));
+    EXPECT_TRUE(VNoteImageVariant::hasVariants(original));
+    QString display = VNoteImageVariant::variantPath(original, VNoteImageVariant::Display);
+    QString thumb = VNoteImageVariant::variantPath(original, VNoteImageVariant::Thumbnail);
+    EXPECT_EQ(QSize(1600, 800), QImageReader(display).size());
+    EXPECT_EQ(QSize(256, 128), QImageReader(thumb).size());
+
+    EXPECT_EQ(thumb, VNoteImageVariant::pathForSize(original, QSize(200, 100)));
+    EXPECT_EQ(display, VNoteImageVariant::pathForSize(original, QSize(1200, 800)));
+    EXPECT_EQ(original, VNoteImageVariant::pathForSize(original, QSize(3000, 2000)));
+
+    VNoteImageVariant::removeVariants(original);
+    EXPECT_FALSE(QFile::exists(display));
+    EXPECT_FALSE(QFile::exists(thumb));
+}
+
+TEST_F(UT_VNoteImageVariant, UT_VNoteImageVariant_generate_002)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QString original = dir.filePath("2.jpg");
+    QImage image(800, 600, QImage::Format_RGB32);
+    image.fill(Qt::blue);
+    ASSERT_TRUE(image.save(original));
+
+    //小图不生成显示图，显示图退回原图
+    EXPECT_TRUE(VNoteImageVariant::generate(original));
+    EXPECT_FALSE(QFile::exists(VNoteImageVariant::variantPath(original, VNoteImageVariant::Display)));
+    EXPECT_EQ(original, VNoteImageVariant::bestPath(original, VNoteImageVariant::Display));
+    EXPECT_EQ(QSize(256, 192), QImageReader(VNoteImageVariant::variantPath(original, VNoteImageVariant::Thumbnail)).size());
+
+    //无效图片
+    EXPECT_FALSE(VNoteImageVariant::generate(dir.filePath("3.png")));
+}
@@ -0,0 +1,196 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnotelibraryarchive.h"
+#include "vnotelibraryarchive.h"
+#include "vnoteattachmentstore.h"
+#include "vnoteitem.h"
+#include "db/vnoteattachmentoper.h"
+
+#include <stub.h>
+
+#include <QTemporaryDir>
+#include <QDir>
+#include <QFile>
+
+static QString stub_attachmentDir()
+{
+    return "/local";
+}
+
+static QString g_dataDir;
+
+static QString stub_typeAttachmentDir(VNoteAttachment::Type type)
+{
+    return g_dataDir + (VNoteAttachment::Voice == type ? "/voicenote" : "/images");
+}
+
+UT_VNoteLibraryArchive::UT_VNoteLibraryArchive()
+{
+}
+
+TEST_F(UT_VNoteLibraryArchive, UT_VNoteLibraryArchive_parseManifest_001)
+{
+    QVector<VNoteLibraryFolder> folders;
+    EXPECT_FALSE(VNoteLibraryArchive::parseManifest("{}", folders));
+    EXPECT_FALSE(VNoteLibraryArchive::parseManifest("{\"version\":99}", folders));
+
+    VNoteLibraryFolder folder;
+    folder.id = 12;
+    folder.name = "记事本";
+    folder.defaultIcon = 3;
+    folder.createTime = QDateTime::currentDateTime();
+    folder.modifyTime = folder.createTime;
+    VNoteLibraryFolder unnamed;
+    unnamed.id = 13;
+    QVector<VNoteLibraryFolder> exported {folder, unnamed};
+
+    ASSERT_TRUE(VNoteLibraryArchive::parseManifest(VNoteLibraryArchive::makeManifest(exported), folders));
+    ASSERT_EQ(1, folders.size());
+    EXPECT_EQ(12, folders.at(0).id);
+    EXPECT_EQ(folder.name, folders.at(0).name);
+    EXPECT_EQ(3, folders.at(0).defaultIcon);
+    EXPECT_EQ(folder.createTime, folders.at(0).createTime);
+}
+
+TEST_F(UT_VNoteLibraryArchive, UT_VNoteLibraryArchive_parseNote_001)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteAttachmentStore, attachmentDir), stub_attachmentDir);
+
+    QString hash(64, 'c');
+    VNoteItem item;
+    item.folderId = 5;
+    item.noteId = 8;
+    item.noteTitle = "note";
+    item.isTop = 1;
+    item.createTime = QDateTime::currentDateTime();
+    item.modifyTime = item.createTime;
+    item.setMetadata(QString("{\"voicePath\":\"/home/a/voicenote/%1.mp3\"}").arg(hash));
+    EXPECT_EQ(QString("notes/5-8.json"), VNoteLibraryArchive::noteEntryName(&item));
+
+    VNoteLibraryNote note;
+    note.json = VNoteLibraryArchive::makeNote(&item);
+    EXPECT_TRUE(VNoteLibraryArchive::parseNote(&note));
+    EXPECT_TRUE(note.json.isEmpty());
+    EXPECT_EQ(5, note.folderId);
+    EXPECT_EQ(item.noteTitle, note.title);
+    EXPECT_EQ(1, note.isTop);
+    EXPECT_EQ(item.modifyTime, note.modifyTime);
+    EXPECT_EQ(QString("{\"voicePath\":\"/local/%1.mp3\"}").arg(hash), note.metaData);
+    EXPECT_EQ(QStringList {hash}, note.hashes);
+
+    VNoteLibraryNote invalid;
+    invalid.json = "{";
+    EXPECT_FALSE(VNoteLibraryArchive::parseNote(&invalid));
+    EXPECT_FALSE(invalid.valid);
+}
+
+TEST_F(UT_VNoteLibraryArchive, UT_VNoteLibraryArchive_parseAttachmentEntry_001)
+{
+    QString fileName = QString(64, 'd') + ".png";
+    VNoteAttachment attachment;
+    attachment.type = VNoteAttachment::Voice;
+    attachment.fileName = QString(64, 'e') + ".mp3";
+    EXPECT_EQ("attachments/voicenote/" + attachment.fileName, VNoteLibraryArchive::attachmentEntryName(attachment));
+
+    VNoteAttachment::Type type = VNoteAttachment::Image;
+    QString name;
+    EXPECT_TRUE(VNoteLibraryArchive::parseAttachmentEntry(VNoteLibraryArchive::attachmentEntryName(attachment), type, name));
+    EXPECT_EQ(VNoteAttachment::Voice, type);
+    EXPECT_EQ(attachment.fileName, name);
+
+    EXPECT_TRUE(VNoteLibraryArchive::parseAttachmentEntry("attachments/images/" + fileName, type, name));
+    EXPECT_EQ(VNoteAttachment::Image, type);
+    EXPECT_FALSE(VNoteLibraryArchive::parseAttachmentEntry("attachments/images/../" + fileName, type, name));
+    EXPECT_FALSE(VNoteLibraryArchive::parseAttachmentEntry("attachments/other/" + fileName, type, name));
+    EXPECT_FALSE(VNoteLibraryArchive::parseAttachmentEntry("attachments/images/a.png", type, name));
+}
+
+TEST_F(UT_VNoteLibraryArchive, UT_VNoteLibraryArchive_relocateAttachments_001)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteAttachmentStore, attachmentDir), stub_attachmentDir);
+
+    QString fileName = QString(64, 'f') + ".png";
+    //附件url不含目录，保持不变
+    QString url = "<img src=\"vnote://attachment/" + fileName + "\">";
+    EXPECT_EQ(url, VNoteLibraryArchive::relocateAttachments(url));
+
+    QString html = "<img src=\\\"/home/u/.local/share/images/" + fileName + "\\\">";
+    EXPECT_EQ("<img src=\\\"/local/" + fileName + "\\\">", VNoteLibraryArchive::relocateAttachments(html));
+
+    QString entity = "&quot;/home/u/voicenote/" + fileName + "&quot;";
+    EXPECT_EQ("&quot;/local/" + fileName + "&quot;", VNoteLibraryArchive::relocateAttachments(entity));
+}
+
+TEST_F(UT_VNoteLibraryArchive, UT_VNoteLibraryArchive_hashLegacyAttachments_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    g_dataDir = dir.path();
+    ASSERT_TRUE(QDir().mkpath(g_dataDir + "/images"));
+    ASSERT_TRUE(QDir().mkpath(g_dataDir + "/voicenote"));
+
+    Stub stub;
+    stub.set(ADDR(VNoteAttachmentStore, attachmentDir), stub_typeAttachmentDir);
+
+    //旧版本按时间命名的图片和录音文件
+    QString image = g_dataDir + "/images/20200101120000.png";
+    QString voice = g_dataDir + "/voicenote/20200101120100.mp3";
+    QFile imageFile(image);
+    ASSERT_TRUE(imageFile.open(QIODevice::WriteOnly));
+    imageFile.write("image");
+    imageFile.close();
+    QFile voiceFile(voice);
+    ASSERT_TRUE(voiceFile.open(QIODevice::WriteOnly));
+    voiceFile.write("voice");
+    voiceFile.close();
+    QString imageHash = VNoteAttachmentStore::fileHash(image);
+    QString voiceHash = VNoteAttachmentStore::fileHash(voice);
+
+    QString stored = g_dataDir + "/images/" + QString(64, 'a') + ".png";
+    QString content = QString("<img src=\\\"%1\\\"><div jsonKey=\\\"{&quot;voicePath&quot;:&quot;%2&quot;}\\\">"
+                              "<img src=\\\"%3\\\"><img src=\\\"%4\\\">")
+                      .arg(image).arg(voice).arg(stored).arg(g_dataDir + "/images/none.png");
+    QMap<QString, QString> files;
+    QString result = VNoteLibraryArchive::hashLegacyAttachments(content, files);
+
+    //旧文件替换为哈希命名的路径，仓库中的附件和不存在的文件不变
+    QString imageHashPath = g_dataDir + "/images/" + imageHash + ".png";
+    QString voiceHashPath = g_dataDir + "/voicenote/" + voiceHash + ".mp3";
+    ASSERT_EQ(2, files.size());
+    EXPECT_EQ(image, files.value(imageHashPath));
+    EXPECT_EQ(voice, files.value(voiceHashPath));
+    EXPECT_EQ(QString(content).replace(image, imageHashPath).replace(voice, voiceHashPath), result);
+    EXPECT_EQ((QStringList {imageHash, voiceHash, QString(64, 'a')}), VNoteAttachmentOper::attachmentHashes(result));
+
+    //导入时与其他附件一样替换为本机附件目录
+    g_dataDir = "/other";
+    QString relocated = VNoteLibraryArchive::relocateAttachments(result);
+    EXPECT_TRUE(relocated.contains("/other/images/" + imageHash + ".png"));
+    EXPECT_TRUE(relocated.contains("/other/voicenote/" + voiceHash + ".mp3"));
+    EXPECT_FALSE(relocated.contains(image));
+    EXPECT_FALSE(relocated.contains(voice));
+
+    files.clear();
+    EXPECT_EQ(relocated, VNoteLibraryArchive::hashLegacyAttachments(relocated, files));
+    EXPECT_TRUE(files.isEmpty());
+}
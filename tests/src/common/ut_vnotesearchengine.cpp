@@ -0,0 +1,188 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnotesearchengine.h"
+#include "vnotesearchengine.h"
+#include "vnotedatamanager.h"
+#include "vnotetranscriptoper.h"
+#include "common/vnoteitem.h"
+#include "db/vnoteitemoper.h"
+#include <stub.h>
+
+#include <QSignalSpy>
+
+static VNoteItem *g_transcriptNote = nullptr;
+
+static VNOTE_TRANSCRIPTS stub_searchTranscripts()
+{
+    VNOTE_TRANSCRIPTS transcripts;
+    VNoteTranscript transcript;
+    transcript.folderId = 1;
+    transcript.noteId = 2;
+    transcript.voicePath = "/tmp/test.mp3";
+    transcript.startTime = 3000;
+    transcript.text = "a test segment";
+    transcripts.append(transcript);
+    transcript.startTime = 6000;
+    transcripts.append(transcript);
+    transcript.voicePath = "/tmp/deleted.mp3";
+    transcripts.append(transcript);
+    return transcripts;
+}
+
+static VNoteItem *stub_getNote()
+{
+    return g_transcriptNote;
+}
+
+UT_VNoteSearchEngine::UT_VNoteSearchEngine()
+{
+}
+
+TEST_F(UT_VNoteSearchEngine, UT_VNoteSearchEngine_search_001)
+{
+    VNoteSearchEngine engine;
+    QSignalSpy finishSpy(&engine, &VNoteSearchEngine::searchFinished);
+    quint64 queryId = engine.search("test");
+    EXPECT_EQ(queryId, engine.currentQueryId());
+    EXPECT_TRUE(engine.isSearching());
+    EXPECT_TRUE(finishSpy.wait(5000));
+    EXPECT_FALSE(engine.isSearching());
+    EXPECT_TRUE(engine.isCompleted());
+}
+
+TEST_F(UT_VNoteSearchEngine, UT_VNoteSearchEngine_cancel_001)
+{
+    VNoteSearchEngine engine;
+    quint64 firstId = engine.search("test");
+    quint64 secondId = engine.search("test2");
+    EXPECT_NE(firstId, secondId);
+    engine.cancel();
+    EXPECT_FALSE(engine.isSearching());
+    EXPECT_FALSE(engine.isCompleted());
+}
+
+TEST_F(UT_VNoteSearchEngine, UT_VNoteSearchEngine_onSearchBatch_001)
+{
+    VNoteSearchEngine engine;
+    QSignalSpy resultSpy(&engine, &VNoteSearchEngine::searchResultReady);
+    VNOTE_SEARCH_HITS hits;
+    hits.append(VNoteSearchHit());
+    //过期的搜索结果被丢弃
+    engine.onSearchBatch(engine.currentQueryId() + 1, hits);
+    EXPECT_EQ(0, resultSpy.count());
+    //不存在的笔记被过滤
+    quint64 queryId = engine.search("test");
+    engine.onSearchBatch(queryId, hits);
+    EXPECT_EQ(0, resultSpy.count());
+}
+
+TEST_F(UT_VNoteSearchEngine, UT_VNoteSearchEngine_onSearchFinished_001)
+{
+    VNoteSearchEngine engine;
+    QSignalSpy finishSpy(&engine, &VNoteSearchEngine::searchFinished);
+    quint64 queryId = engine.search("test");
+    engine.onSearchFinished(queryId + 1);
+    EXPECT_EQ(0, finishSpy.count());
+    engine.onSearchFinished(queryId);
+    EXPECT_EQ(1, finishSpy.count());
+    EXPECT_TRUE(engine.isCompleted());
+}
+
+TEST_F(UT_VNoteSearchEngine, UT_VNoteSearchEngine_saveCache_001)
+{
+    VNoteSearchEngine engine;
+    VNOTE_SEARCH_HITS hits;
+    hits.append(VNoteSearchHit());
+    for (int i = 0; i < VNoteSearchEngine::MaxCacheCount + 2; i++) {
+        engine.saveCache(QString("key%1").arg(i), false, hits);
+    }
+    EXPECT_EQ(VNoteSearchEngine::MaxCacheCount, engine.m_cache.size());
+    EXPECT_EQ(-1, engine.findCache("key0"));
+    EXPECT_EQ(engine.m_cache.size() - 1, engine.findCache("KEY17"));
+    engine.clearCache();
+    EXPECT_TRUE(engine.m_cache.isEmpty());
+}
+
+TEST_F(UT_VNoteSearchEngine, UT_VNoteSearchEngine_findNarrowingCache_001)
+{
+    VNoteSearchEngine engine;
+    VNOTE_SEARCH_HITS hits;
+    engine.saveCache("a", false, hits);
+    engine.saveCache("ab", false, hits);
+    engine.saveCache("x", false, hits);
+    EXPECT_EQ(1, engine.findNarrowingCache("ABc"));
+    EXPECT_EQ(-1, engine.findNarrowingCache("c"));
+    //带过滤条件的结果不能用于缩小范围
+    engine.saveCache("abc has:voice", true, hits);
+    EXPECT_EQ(1, engine.findNarrowingCache("abc has:voice2"));
+}
+
+TEST_F(UT_VNoteSearchEngine, UT_VNoteSearchEngine_removeInvalidCache_001)
+{
+    VNoteSearchEngine engine;
+    VNOTE_SEARCH_HITS hits;
+    engine.m_dataVersion = VNoteDataManager::instance()->dataVersion() - 1;
+    engine.saveCache("a", false, hits);
+    engine.removeInvalidCache();
+    EXPECT_TRUE(engine.m_cache.isEmpty());
+}
+
+TEST_F(UT_VNoteSearchEngine, UT_VNoteSearchEngine_search_002)
+{
+    VNoteSearchEngine engine;
+    QSignalSpy finishSpy(&engine, &VNoteSearchEngine::searchFinished);
+    engine.m_dataVersion = VNoteDataManager::instance()->dataVersion();
+    engine.saveCache("cached", false, VNOTE_SEARCH_HITS());
+    //命中缓存时同步返回结果
+    engine.search("cached");
+    EXPECT_EQ(1, finishSpy.count());
+    EXPECT_TRUE(engine.isCompleted());
+
+    //在缓存结果中缩小范围
+    engine.search("cached2");
+    EXPECT_TRUE(engine.m_context->narrowing);
+    EXPECT_TRUE(finishSpy.wait(5000));
+}
+
+TEST_F(UT_VNoteSearchEngine, UT_VNoteSearchEngine_searchTranscripts_001)
+{
+    VNoteItem note;
+    note.folderId = 1;
+    note.noteId = 2;
+    note.htmlCode = "<div jsonkey=\"/tmp/test.mp3\"></div>";
+    g_transcriptNote = &note;
+
+    Stub stub;
+    stub.set(ADDR(VNoteTranscriptOper, searchTranscripts), stub_searchTranscripts);
+    stub.set(ADDR(VNoteItemOper, getNote), stub_getNote);
+
+    VNoteSearchEngine engine;
+    VNOTE_SEARCH_HITS hits = engine.searchTranscripts("test");
+    //同一笔记只返回一次，已从笔记中删除的语音被过滤
+    ASSERT_EQ(1, hits.size());
+    EXPECT_EQ(2, hits.at(0).noteId);
+    //摘要取自命中的转写分段
+    EXPECT_EQ(QString("a test segment"), hits.at(0).snippet);
+    EXPECT_GT(hits.at(0).score, 0);
+    EXPECT_EQ(3000, engine.transcriptOffset("/tmp/test.mp3"));
+    EXPECT_EQ(-1, engine.transcriptOffset("/tmp/deleted.mp3"));
+    g_transcriptNote = nullptr;
+}
@@ -0,0 +1,80 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnotesearchquery.h"
+#include "vnotesearchquery.h"
+#include "vnotetitleindex.h"
+
+//测试使用的id不与实际数据冲突
+static const qint64 TEST_ID_BASE = 900000;
+
+UT_VNoteSearchQuery::UT_VNoteSearchQuery()
+{
+}
+
+void UT_VNoteSearchQuery::TearDown()
+{
+    VNoteTitleIndex::instance()->removeTitle(VNoteTitleIndex::FolderName, TEST_ID_BASE);
+}
+
+TEST_F(UT_VNoteSearchQuery, UT_VNoteSearchQuery_parse_001)
+{
+    VNoteSearchQuery query = VNoteSearchQuery::parse(QString::fromUtf8("has:voice 会议 pinned：yes \"weekly plan\""));
+    EXPECT_TRUE(query.hasFilters());
+    EXPECT_EQ(QString::fromUtf8("会议 weekly plan"), query.keyword());
+    EXPECT_TRUE(query.m_hasVoice);
+    EXPECT_FALSE(query.m_hasImage);
+    EXPECT_EQ(1, query.m_pinned);
+
+    query = VNoteSearchQuery::parse("folder:\"my notes\" after:2020-01-02 before:2020/02/03");
+    EXPECT_TRUE(query.keyword().isEmpty());
+    EXPECT_EQ(QStringList("my notes"), query.m_folderNames);
+    EXPECT_EQ(QDate(2020, 1, 2), query.m_after);
+    EXPECT_EQ(QDate(2020, 2, 3), query.m_before);
+
+    //无法识别的条件按关键字处理
+    query = VNoteSearchQuery::parse("has:video http://a before:2020-13-01 pinned:");
+    EXPECT_FALSE(query.hasFilters());
+    EXPECT_EQ(QString("has:video http://a before:2020-13-01 pinned:"), query.keyword());
+}
+
+TEST_F(UT_VNoteSearchQuery, UT_VNoteSearchQuery_parseDate_001)
+{
+    QDate today(2020, 6, 15);
+    EXPECT_EQ(today, VNoteSearchQuery::parseDate("Today", today));
+    EXPECT_EQ(QDate(2020, 6, 14), VNoteSearchQuery::parseDate("yesterday", today));
+    EXPECT_EQ(QDate(2020, 6, 12), VNoteSearchQuery::parseDate("3d", today));
+    EXPECT_EQ(QDate(2020, 6, 1), VNoteSearchQuery::parseDate("2w", today));
+    EXPECT_FALSE(VNoteSearchQuery::parseDate("last week", today).isValid());
+}
+
+TEST_F(UT_VNoteSearchQuery, UT_VNoteSearchQuery_compile_001)
+{
+    VNoteTitleIndex::instance()->updateTitle(VNoteTitleIndex::FolderName, TEST_ID_BASE, QString::fromUtf8("工作计划"));
+
+    VNoteAttributeIndex::Filter filter = VNoteSearchQuery::parse("folder:gzjh has:image pinned:no before:2020-01-01").compile();
+    EXPECT_TRUE(filter.limitFolders);
+    EXPECT_TRUE(filter.folderIds.contains(TEST_ID_BASE));
+    EXPECT_TRUE(filter.hasImage);
+    EXPECT_FALSE(filter.hasVoice);
+    EXPECT_EQ(0, filter.pinned);
+    EXPECT_FALSE(filter.after.isValid());
+    EXPECT_EQ(QDateTime(QDate(2020, 1, 1)), filter.before);
+}
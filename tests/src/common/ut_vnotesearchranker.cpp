@@ -0,0 +1,134 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnotesearchranker.h"
+#include "vnotesearchranker.h"
+#include "common/vnoteitem.h"
+
+UT_VNoteSearchRanker::UT_VNoteSearchRanker()
+{
+}
+
+TEST_F(UT_VNoteSearchRanker, UT_VNoteSearchRanker_rankNote_001)
+{
+    VNoteItem note;
+    note.folderId = 1;
+    note.noteId = 2;
+    note.noteTitle = "Test title";
+    note.htmlCode = "<p>body without keyword</p>";
+    VNoteSearchDoc doc = VNoteSearchRanker::makeDoc(&note);
+    //快照不受笔记之后的修改影响
+    note.noteTitle = "changed";
+    EXPECT_EQ(QString("Test title"), doc.title);
+
+    VNoteSearchHit hit;
+    int textLength = 0;
+    EXPECT_TRUE(VNoteSearchRanker::rankNote(doc, "test", 0, false, hit, &textLength));
+    EXPECT_EQ(2, hit.noteId);
+    EXPECT_GT(hit.score, 0);
+    ASSERT_EQ(1, hit.titleRanges.size());
+    EXPECT_EQ(qMakePair(0, 4), hit.titleRanges.at(0));
+    EXPECT_TRUE(hit.snippetRanges.isEmpty());
+    EXPECT_GT(textLength, doc.title.length());
+
+    EXPECT_FALSE(VNoteSearchRanker::rankNote(doc, "missing", 0, false, hit));
+    //标题索引匹配的笔记没有高亮区间
+    EXPECT_TRUE(VNoteSearchRanker::rankNote(doc, "missing", 0, true, hit));
+    EXPECT_TRUE(hit.titleRanges.isEmpty());
+    EXPECT_GT(hit.score, 0);
+}
+
+TEST_F(UT_VNoteSearchRanker, UT_VNoteSearchRanker_score_001)
+{
+    //标题命中高于正文命中
+    qreal titleScore = VNoteSearchRanker::score("key", "body", "key", 0);
+    qreal bodyScore = VNoteSearchRanker::score("title", "body key", "key", 0);
+    EXPECT_GT(titleScore, bodyScore);
+    //词频越高分值越高
+    EXPECT_GT(VNoteSearchRanker::score("title", "key key", "key", 0), bodyScore);
+    //长文档分值较低
+    QString longBody = QString("key ") + QString(200, 'x');
+    EXPECT_GT(VNoteSearchRanker::score("title", "key", "key", 50),
+              VNoteSearchRanker::score("title", longBody, "key", 50));
+    EXPECT_DOUBLE_EQ(0, VNoteSearchRanker::score("title", "body", "key", 0));
+}
+
+TEST_F(UT_VNoteSearchRanker, UT_VNoteSearchRanker_makeSnippet_001)
+{
+    VNOTE_TEXT_RANGES ranges;
+    QString text = QString(40, 'a') + "\nKey" + QString(100, 'b');
+    QString snippet = VNoteSearchRanker::makeSnippet(text, "key", ranges);
+    EXPECT_TRUE(snippet.startsWith(QChar(0x2026)));
+    EXPECT_TRUE(snippet.endsWith(QChar(0x2026)));
+    EXPECT_FALSE(snippet.contains('\n'));
+    ASSERT_EQ(1, ranges.size());
+    EXPECT_EQ(QString("Key"), snippet.mid(ranges.at(0).first, ranges.at(0).second));
+
+    snippet = VNoteSearchRanker::makeSnippet("short text", "none", ranges);
+    EXPECT_EQ(QString("short text"), snippet);
+    EXPECT_TRUE(ranges.isEmpty());
+}
+
+TEST_F(UT_VNoteSearchRanker, UT_VNoteSearchRanker_findRanges_001)
+{
+    VNOTE_TEXT_RANGES ranges = VNoteSearchRanker::findRanges("abABab", "ab");
+    EXPECT_EQ(3, ranges.size());
+    EXPECT_TRUE(VNoteSearchRanker::findRanges("abc", "").isEmpty());
+}
+
+TEST_F(UT_VNoteSearchRanker, UT_VNoteSearchRanker_htmlText_001)
+{
+    //属性中的'>'不作为标签结束，空白保持不变
+    QString html = "<div jsonKey=\"{&quot;t&quot;:&quot;b>c&quot;}\">x</div>\n<p>1 &lt; 2&nbsp;&#65;&#x42;&unknown;</p>";
+    EXPECT_EQ(QString("x\n1 < 2") + QChar(0x00a0) + QString("AB&unknown;"), VNoteSearchRanker::htmlText(html));
+}
+
+TEST_F(UT_VNoteSearchRanker, UT_VNoteSearchRanker_editorText_001)
+{
+    //语音块及其中嵌套的内容不计入，字符实体按网页中的字符计算
+    QString html = "<p>a &amp; b</p>"
+                   "<div class=\"li voiceBox\" contenteditable=\"false\" jsonKey=\"{&quot;text&quot;:&quot;key&quot;}\">"
+                   "<div class=\"voiceInfoBox\"><div class=\"title\">key voice</div></div>"
+                   "<div class=\"translate\">key</div></div>"
+                   "<p>find key</p>";
+    QString text = VNoteSearchRanker::editorText(html);
+    EXPECT_EQ(QString("a & bfind key"), text);
+
+    VNOTE_TEXT_RANGES ranges = VNoteSearchRanker::findRanges(text, "key");
+    ASSERT_EQ(1, ranges.size());
+    EXPECT_EQ(10, ranges.at(0).first);
+}
+
+TEST_F(UT_VNoteSearchRanker, UT_VNoteSearchRanker_noteEditorText_001)
+{
+    //旧版笔记每行生成一个段落，语音块不计入
+    VNoteItem note;
+    VNoteBlock *textBlock = note.newBlock(VNoteBlock::Text);
+    textBlock->blockText = "first &amp; line\nsecond";
+    note.addBlock(textBlock);
+    VNoteBlock *voiceBlock = note.newBlock(VNoteBlock::Voice);
+    voiceBlock->blockText = "voice";
+    note.addBlock(voiceBlock);
+
+    EXPECT_EQ(QString("first & linesecond"), VNoteSearchRanker::noteEditorText(&note));
+
+    note.htmlCode = "<p>html</p>";
+    EXPECT_EQ(QString("html"), VNoteSearchRanker::noteEditorText(&note));
+}
@@ -0,0 +1,84 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnotetitleindex.h"
+#include "vnotetitleindex.h"
+
+//测试使用的id不与实际数据冲突
+static const qint64 TEST_ID_BASE = 900000;
+
+UT_VNoteTitleIndex::UT_VNoteTitleIndex()
+{
+}
+
+void UT_VNoteTitleIndex::TearDown()
+{
+    for (qint64 i = 0; i < 10; i++) {
+        VNoteTitleIndex::instance()->removeTitle(VNoteTitleIndex::FolderName, TEST_ID_BASE + i);
+    }
+}
+
+TEST_F(UT_VNoteTitleIndex, UT_VNoteTitleIndex_toPinyin_001)
+{
+    QString fullPinyin;
+    QString initials;
+    VNoteTitleIndex::toPinyin(QString::fromUtf8("会议 Note"), fullPinyin, initials);
+    EXPECT_EQ(QString("huiyinote"), fullPinyin);
+    EXPECT_EQ(QString("hynote"), initials);
+}
+
+TEST_F(UT_VNoteTitleIndex, UT_VNoteTitleIndex_trigrams_001)
+{
+    EXPECT_TRUE(VNoteTitleIndex::trigrams("ab").isEmpty());
+    EXPECT_EQ(2, VNoteTitleIndex::trigrams("abcd").size());
+}
+
+TEST_F(UT_VNoteTitleIndex, UT_VNoteTitleIndex_search_001)
+{
+    VNoteTitleIndex *index = VNoteTitleIndex::instance();
+    index->updateTitle(VNoteTitleIndex::FolderName, TEST_ID_BASE, QString::fromUtf8("项目会议"), 7);
+    index->updateTitle(VNoteTitleIndex::FolderName, TEST_ID_BASE + 1, "Weekly meeting");
+
+    //首字母、全拼及原文匹配
+    QHash<qint64, qint64> results = index->search(VNoteTitleIndex::FolderName, "xmhy");
+    EXPECT_TRUE(results.contains(TEST_ID_BASE));
+    EXPECT_EQ(7, results.value(TEST_ID_BASE));
+    EXPECT_TRUE(index->search(VNoteTitleIndex::FolderName, "huiyi").contains(TEST_ID_BASE));
+    EXPECT_TRUE(index->search(VNoteTitleIndex::FolderName, QString::fromUtf8("会议")).contains(TEST_ID_BASE));
+    //错字模糊匹配
+    EXPECT_TRUE(index->search(VNoteTitleIndex::FolderName, "meetign").contains(TEST_ID_BASE + 1));
+    EXPECT_FALSE(index->search(VNoteTitleIndex::FolderName, "meetign").contains(TEST_ID_BASE));
+    EXPECT_TRUE(index->search(VNoteTitleIndex::FolderName, " ").isEmpty());
+}
+
+TEST_F(UT_VNoteTitleIndex, UT_VNoteTitleIndex_updateTitle_001)
+{
+    VNoteTitleIndex *index = VNoteTitleIndex::instance();
+    index->updateTitle(VNoteTitleIndex::FolderName, TEST_ID_BASE + 2, "before rename", 1);
+    index->updateTitle(VNoteTitleIndex::FolderName, TEST_ID_BASE + 2, "after change", 1);
+    EXPECT_FALSE(index->search(VNoteTitleIndex::FolderName, "before").contains(TEST_ID_BASE + 2));
+    EXPECT_TRUE(index->search(VNoteTitleIndex::FolderName, "after").contains(TEST_ID_BASE + 2));
+
+    index->updateParent(VNoteTitleIndex::FolderName, TEST_ID_BASE + 2, 2);
+    EXPECT_EQ(2, index->search(VNoteTitleIndex::FolderName, "after").value(TEST_ID_BASE + 2));
+
+    index->removeChildren(VNoteTitleIndex::FolderName, 2);
+    EXPECT_FALSE(index->search(VNoteTitleIndex::FolderName, "after").contains(TEST_ID_BASE + 2));
+}
@@ -21,6 +21,7 @@
 #include "vnotedbmanager.h"
 #include "common/vnoteitem.h"
 #include "common/vnoteforlder.h"
+#include "common/vnotelibraryarchive.h"
 
 UT_DbVisitor::UT_DbVisitor()
 {
@@ -198,3 +199,64 @@ TEST_F(UT_DbVisitor, UT_DbVisitor_DelNoteDbVisitor_002)
     delete note;
     delete dbvisitor;
 }
+
+TEST_F(UT_DbVisitor, UT_DbVisitor_AddTranscriptDbVisitor_001)
+{
+    DbVisitor *dbvisitor;
+    QSqlDatabase db = VNoteDbManager::instance()->getVNoteDb();
+    dbvisitor = new AddTranscriptDbVisitor(db, nullptr, nullptr);
+    EXPECT_FALSE(dbvisitor->prepareSqls());
+
+    VNoteTranscript transcript;
+    transcript.voicePath = "/tmp/it's.mp3";
+    transcript.text = "test";
+    VNOTE_TRANSCRIPTS transcripts;
+    transcripts.append(transcript);
+    transcripts.append(transcript);
+    dbvisitor->param.transcripts = &transcripts;
+    EXPECT_TRUE(dbvisitor->prepareSqls());
+    EXPECT_EQ(3, dbvisitor->m_dbvSqls.size());
+    EXPECT_TRUE(dbvisitor->m_dbvSqls.at(0).contains("it''s"));
+    delete dbvisitor;
+}
+
+TEST_F(UT_DbVisitor, UT_DbVisitor_TranscriptQryDbVisitor_001)
+{
+    VNOTE_TRANSCRIPTS transcripts;
+    QString keyword = "50%_";
+    DbVisitor *dbvisitor;
+    QSqlDatabase db = VNoteDbManager::instance()->getVNoteDb();
+    dbvisitor = new TranscriptQryDbVisitor(db, &keyword, &transcripts);
+    EXPECT_TRUE(dbvisitor->prepareSqls());
+    EXPECT_TRUE(dbvisitor->m_dbvSqls.at(0).contains("50\\%\\_"));
+    delete dbvisitor;
+}
+
+TEST_F(UT_DbVisitor, UT_DbVisitor_ImportLibraryDbVisitor_001)
+{
+    VNoteLibraryData library;
+    QSqlDatabase db = VNoteDbManager::instance()->getVNoteDb();
+    ImportLibraryDbVisitor emptyVisitor(db, &library, &library);
+    EXPECT_FALSE(emptyVisitor.prepareSqls());
+
+    VNoteLibraryFolder folder;
+    folder.id = 3;
+    folder.name = "it's";
+    library.folders.append(folder);
+    //记事本不存在和解析失败的笔记不插入
+    for (int i = 0; i < 3; i++) {
+        VNoteLibraryNote *note = new VNoteLibraryNote();
+        note->valid = i != 2;
+        note->folderId = i == 1 ? 4 : 3;
+        note->title = "note";
+        note->hashes << QString(64, 'a');
+        library.notes.append(note);
+    }
+
+    ImportLibraryDbVisitor importVisitor(db, &library, &library);
+    EXPECT_TRUE(importVisitor.prepareSqls());
+    //建表、清空、记事本及对应关系、笔记及对应关系、附件引用、查询对应关系
+    EXPECT_EQ(8, importVisitor.m_dbvSqls.size());
+    EXPECT_TRUE(importVisitor.m_dbvSqls.at(2).contains("it''s"));
+    EXPECT_TRUE(importVisitor.m_dbvSqls.at(6).contains(QString(64, 'a')));
+}
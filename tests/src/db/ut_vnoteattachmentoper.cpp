@@ -0,0 +1,48 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnoteattachmentoper.h"
+#include "db/vnoteattachmentoper.h"
+
+UT_VNoteAttachmentOper::UT_VNoteAttachmentOper()
+{
+}
+
+TEST_F(UT_VNoteAttachmentOper, UT_VNoteAttachmentOper_attachmentHashes_001)
+{
+    QString imageHash(64, 'a');
+    QString voiceHash(64, 'b');
+    QString content = QString("<img src=\"file:///home/uos/.local/share/deepin/deepin-voice-note/images/%1.png\">"
+                              "<div jsonkey=\"{&quot;voicePath&quot;:&quot;/home/uos/voicenote/%2.mp3&quot;}\"></div>"
+                              "<img src=\"/images/%1.png\"><img src=\"/images/20200101120000.png\">")
+                          .arg(imageHash)
+                          .arg(voiceHash);
+
+    QStringList hashes = VNoteAttachmentOper::attachmentHashes(content);
+    ASSERT_EQ(2, hashes.size());
+    EXPECT_EQ(imageHash, hashes.at(0));
+    EXPECT_EQ(voiceHash, hashes.at(1));
+    EXPECT_TRUE(VNoteAttachmentOper::attachmentHashes("").isEmpty());
+
+    //附件url引用的附件
+    hashes = VNoteAttachmentOper::attachmentHashes(QString("<img src=\"vnote://attachment/%1.png\">").arg(imageHash));
+    ASSERT_EQ(1, hashes.size());
+    EXPECT_EQ(imageHash, hashes.at(0));
+}
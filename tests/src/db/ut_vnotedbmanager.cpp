@@ -23,6 +23,7 @@
 #include "vnoteitemoper.h"
 #include "vnoteitem.h"
 #include "db/dbvisitor.h"
+#include "common/vnotelibraryarchive.h"
 #include <stub.h>
 
 static bool stub_true()
@@ -67,6 +68,34 @@ TEST_F(UT_VNoteDbManager, UT_VNoteDbManager_insertData_002)
     EXPECT_FALSE(instance->deleteData(&noteVisitor));
 }
 
+TEST_F(UT_VNoteDbManager, UT_VNoteDbManager_insertDataInTransaction_001)
+{
+    VNoteDbManager *instance = VNoteDbManager::instance();
+    EXPECT_FALSE(instance->insertDataInTransaction(nullptr));
+
+    VNoteLibraryData library;
+    ImportLibraryDbVisitor emptyVisitor(instance->getVNoteDb(), &library, &library);
+    EXPECT_FALSE(instance->insertDataInTransaction(&emptyVisitor));
+
+    VNoteLibraryFolder folder;
+    folder.id = 7;
+    folder.name = "import";
+    library.folders.append(folder);
+    VNoteLibraryNote *note = new VNoteLibraryNote();
+    note->valid = true;
+    note->folderId = 7;
+    note->title = "note";
+    note->createTime = QDateTime::currentDateTime();
+    note->modifyTime = note->createTime;
+    library.notes.append(note);
+
+    ImportLibraryDbVisitor importVisitor(instance->getVNoteDb(), &library, &library);
+    EXPECT_TRUE(instance->insertDataInTransaction(&importVisitor));
+    EXPECT_GT(library.folders.at(0).newId, 0);
+    EXPECT_GT(note->newNoteId, 0);
+    EXPECT_EQ(library.folders.at(0).newId, note->newFolderId);
+}
+
 TEST_F(UT_VNoteDbManager, UT_VNoteDbManager_insertData_003)
 {
     VNoteFolder *folder = new VNoteFolder;
@@ -0,0 +1,150 @@
+/*
+* Copyright (C) 2019 ~ 2020 Deepin Technology Co., Ltd.
+*
+* Author:     zhangteng <zhangteng@uniontech.com>
+* Maintainer: zhangteng <zhangteng@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnotetranscriptoper.h"
+#include "vnotetranscriptoper.h"
+#include "db/vnotedbmanager.h"
+#include "db/dbvisitor.h"
+#include "common/vnoteitem.h"
+#include "common/vnoteattachmentstore.h"
+#include <stub.h>
+
+#include <QSet>
+#include <QSqlQuery>
+
+static bool stub_true()
+{
+    return true;
+}
+
+static bool stub_false()
+{
+    return false;
+}
+
+UT_VNoteTranscriptOper::UT_VNoteTranscriptOper()
+{
+}
+
+TEST_F(UT_VNoteTranscriptOper, UT_VNoteTranscriptOper_splitTranscript_001)
+{
+    QString text = QString::fromUtf8("今天开会。下午三点出发！");
+    VNOTE_TRANSCRIPTS transcripts = VNoteTranscriptOper::splitTranscript(text, 11000);
+    ASSERT_EQ(2, transcripts.size());
+    EXPECT_EQ(QString::fromUtf8("今天开会。"), transcripts.at(0).text);
+    EXPECT_EQ(0, transcripts.at(0).startTime);
+    EXPECT_EQ(5000, transcripts.at(0).endTime);
+    EXPECT_EQ(5000, transcripts.at(1).startTime);
+    EXPECT_EQ(11000, transcripts.at(1).endTime);
+}
+
+TEST_F(UT_VNoteTranscriptOper, UT_VNoteTranscriptOper_splitTranscript_002)
+{
+    EXPECT_TRUE(VNoteTranscriptOper::splitTranscript("", 1000).isEmpty());
+    EXPECT_TRUE(VNoteTranscriptOper::splitTranscript(" \n ", 1000).isEmpty());
+
+    VNOTE_TRANSCRIPTS transcripts = VNoteTranscriptOper::splitTranscript("no punctuation", 1000);
+    ASSERT_EQ(1, transcripts.size());
+    EXPECT_EQ(1000, transcripts.at(0).endTime);
+}
+
+TEST_F(UT_VNoteTranscriptOper, UT_VNoteTranscriptOper_saveTranscript_001)
+{
+    VNoteTranscriptOper nullOper;
+    EXPECT_FALSE(nullOper.saveTranscript("/tmp/test.mp3", 1000, "test"));
+
+    VNoteItem note;
+    note.folderId = 1;
+    note.noteId = 2;
+    VNoteTranscriptOper transcriptOper(&note);
+    EXPECT_FALSE(transcriptOper.saveTranscript("", 1000, "test"));
+    EXPECT_FALSE(transcriptOper.saveTranscript("/tmp/test.mp3", 1000, ""));
+
+    Stub stub;
+    stub.set(ADDR(VNoteDbManager, insertData), stub_true);
+    EXPECT_TRUE(transcriptOper.saveTranscript("/tmp/test.mp3", 1000, "test"));
+}
+
+TEST_F(UT_VNoteTranscriptOper, UT_VNoteTranscriptOper_addTranscripts_001)
+{
+    VNoteTranscriptOper transcriptOper;
+    EXPECT_FALSE(transcriptOper.addTranscripts(VNOTE_TRANSCRIPTS()));
+
+    VNoteTranscript transcript;
+    transcript.voicePath = "/tmp/test.mp3";
+    transcript.text = "test";
+    VNOTE_TRANSCRIPTS transcripts;
+    transcripts.append(transcript);
+
+    Stub stub;
+    stub.set(ADDR(VNoteDbManager, insertData), stub_false);
+    EXPECT_FALSE(transcriptOper.addTranscripts(transcripts));
+}
+
+TEST_F(UT_VNoteTranscriptOper, UT_VNoteTranscriptOper_searchTranscripts_001)
+{
+    VNoteTranscriptOper transcriptOper;
+    EXPECT_TRUE(transcriptOper.searchTranscripts("").isEmpty());
+    transcriptOper.searchTranscripts("test");
+}
+
+TEST_F(UT_VNoteTranscriptOper, UT_VNoteTranscriptOper_addTranscripts_002)
+{
+    //附件仓库中两个笔记共用的语音
+    QString voicePath = VNoteAttachmentStore::attachmentDir(VNoteAttachment::Voice)
+                        + "/" + QString(64, 'e') + ".mp3";
+
+    VNoteItem note1;
+    note1.folderId = 900100;
+    note1.noteId = 900101;
+    VNoteItem note2;
+    note2.folderId = 900100;
+    note2.noteId = 900102;
+    EXPECT_TRUE(VNoteTranscriptOper(&note1).saveTranscript(voicePath, 1000, "shared voice first"));
+    EXPECT_TRUE(VNoteTranscriptOper(&note2).saveTranscript(voicePath, 1000, "shared voice second"));
+
+    //重新转写只替换本笔记的分段
+    QSet<qint64> noteIds;
+    for (auto &it : VNoteTranscriptOper().searchTranscripts("shared voice")) {
+        noteIds.insert(it.noteId);
+    }
+    EXPECT_TRUE(noteIds.contains(900101));
+    EXPECT_TRUE(noteIds.contains(900102));
+
+    //引用该语音的笔记保存时复制已有的分段，重复保存不重复复制
+    VNoteItem note3;
+    note3.folderId = 900100;
+    note3.noteId = 900103;
+    note3.setMetadata(QString("{\"voicePath\":\"%1\"}").arg(voicePath));
+    for (int i = 0; i < 2; i++) {
+        UpdateNoteDbVisitor updateVisitor(VNoteDbManager::instance()->getVNoteDb(), &note3, nullptr);
+        EXPECT_TRUE(VNoteDbManager::instance()->updateData(&updateVisitor));
+    }
+
+    int copied = 0;
+    for (auto &it : VNoteTranscriptOper().searchTranscripts("shared voice first")) {
+        if (900103 == it.noteId) {
+            copied++;
+            EXPECT_EQ(voicePath, it.voicePath);
+        }
+    }
+    EXPECT_EQ(1, copied);
+
+    QSqlQuery query(VNoteDbManager::instance()->getVNoteDb());
+    query.exec(QString("DELETE FROM %1 WHERE note_id IN (900101,900102,900103);").arg(VNoteDbManager::TRANSCRIPT_TABLE_NAME));
+    query.exec(QString("DELETE FROM %1 WHERE note_id=900103;").arg(VNoteDbManager::ATTACHMENT_REF_TABLE_NAME));
+}
@@ -0,0 +1,143 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_vnotesearchprovider.h"
+#include "vnotesearchprovider.h"
+#include "db/vnotedbmanager.h"
+#include "db/vnoteitemoper.h"
+#include "common/vnotedatamanager.h"
+#include <stub.h>
+
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+static bool g_iconLoaded = false;
+
+static QPixmap stub_getDefaultIcon()
+{
+    g_iconLoaded = true;
+    return QPixmap();
+}
+
+UT_VNoteSearchProvider::UT_VNoteSearchProvider()
+{
+}
+
+TEST_F(UT_VNoteSearchProvider, UT_VNoteSearchProvider_Search_001)
+{
+    VNoteSearchProvider provider;
+    //数据未变化，不从数据库重新加载
+    provider.m_dataTime = QFileInfo(VNoteDbManager::instance()->getVNoteDb().databaseName()).lastModified();
+    provider.m_averageLength = 20;
+
+    provider.m_notes[900001].folderId = 1;
+    provider.m_notes[900001].title = "meeting notes";
+    provider.m_notes[900001].text = "agenda for the meeting";
+    provider.m_notes[900002].folderId = 2;
+    provider.m_notes[900002].title = "todo";
+    provider.m_notes[900002].text = "buy milk before meeting";
+    provider.m_notes[900003].title = "other";
+    provider.m_folderNames[1] = "work";
+
+    //标题命中排在前面，分页返回
+    QJsonObject result = QJsonDocument::fromJson(provider.Search("meeting", 0, 1).toUtf8()).object();
+    EXPECT_EQ(2, result.value("total").toInt());
+    QJsonArray results = result.value("results").toArray();
+    ASSERT_EQ(1, results.size());
+    EXPECT_EQ(900001, results.at(0).toObject().value("noteId").toInt());
+    EXPECT_EQ(QString("work"), results.at(0).toObject().value("folderName").toString());
+
+    result = QJsonDocument::fromJson(provider.Search("meeting", 1, VNoteSearchProvider::MaxResultLimit + 1).toUtf8()).object();
+    results = result.value("results").toArray();
+    ASSERT_EQ(1, results.size());
+    EXPECT_EQ(900002, results.at(0).toObject().value("noteId").toInt());
+    EXPECT_FALSE(results.at(0).toObject().value("snippet").toString().isEmpty());
+    EXPECT_EQ(QString("meeting"), provider.m_lastQuery);
+
+    result = QJsonDocument::fromJson(provider.Search(" ", 0, 0).toUtf8()).object();
+    EXPECT_EQ(0, result.value("total").toInt());
+}
+
+TEST_F(UT_VNoteSearchProvider, UT_VNoteSearchProvider_makeResult_001)
+{
+    VNoteSearchProvider provider;
+    VNOTE_SEARCH_HITS hits(3);
+
+    //起始位置超出结果数时不溢出，返回空结果
+    QJsonObject result = QJsonDocument::fromJson(provider.makeResult(hits, INT_MAX, INT_MAX).toUtf8()).object();
+    EXPECT_EQ(3, result.value("total").toInt());
+    EXPECT_EQ(3, result.value("offset").toInt());
+    EXPECT_TRUE(result.value("results").toArray().isEmpty());
+
+    result = QJsonDocument::fromJson(provider.makeResult(hits, 1, INT_MAX).toUtf8()).object();
+    EXPECT_EQ(2, result.value("results").toArray().size());
+
+    result = QJsonDocument::fromJson(provider.makeResult(hits, 1, 1).toUtf8()).object();
+    EXPECT_EQ(1, result.value("results").toArray().size());
+}
+
+TEST_F(UT_VNoteSearchProvider, UT_VNoteSearchProvider_loadNotes_001)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteDataManager, getDefaultIcon), stub_getDefaultIcon);
+    g_iconLoaded = false;
+
+    //首次查询从数据库加载，不加载图标
+    VNoteSearchProvider provider;
+    provider.Search("", 0, 0);
+    EXPECT_FALSE(g_iconLoaded);
+    EXPECT_TRUE(provider.m_dataTime.isValid());
+
+    VNOTE_ITEM_STATES states = VNoteItemOper().loadNoteStates();
+    EXPECT_EQ(states.size(), provider.m_notes.size());
+    for (auto it = states.constBegin(); it != states.constEnd(); ++it) {
+        EXPECT_EQ(it->modifyTime, provider.m_notes.value(it.key()).modifyTime);
+    }
+}
+
+TEST_F(UT_VNoteSearchProvider, UT_VNoteSearchProvider_loadNotes_002)
+{
+    VNoteSearchProvider provider;
+    provider.reloadIfNeed();
+
+    //已删除的笔记从缓存中移除
+    provider.m_notes[-100].title = "deleted";
+    provider.m_totalLength += 7;
+
+    VNOTE_ITEM_STATES states = VNoteItemOper().loadNoteStates();
+    QList<qint64> noteIds = states.keys();
+    if (noteIds.size() >= 2) {
+        //修改时间变化的笔记重新加载，未变化的保留缓存内容
+        provider.m_notes[noteIds.at(0)].modifyTime = QDateTime();
+        provider.m_notes[noteIds.at(1)].title = "unchanged";
+    }
+
+    provider.m_dataTime = QDateTime();
+    provider.reloadIfNeed();
+
+    EXPECT_FALSE(provider.m_notes.contains(-100));
+    EXPECT_EQ(states.size(), provider.m_notes.size());
+    if (noteIds.size() >= 2) {
+        EXPECT_EQ(states.value(noteIds.at(0)).modifyTime, provider.m_notes.value(noteIds.at(0)).modifyTime);
+        EXPECT_EQ(QString("unchanged"), provider.m_notes.value(noteIds.at(1)).title);
+    }
+}
@@ -91,3 +91,16 @@ TEST_F(UT_FolderSelectDialog, UT_FolderSelectDialog_setFolderBlack_001)
     EXPECT_EQ(blackList, folderselectdialog.m_model->m_blackFolders);
     delete folder1;
 }
+
+TEST_F(UT_FolderSelectDialog, UT_FolderSelectDialog_onFilterTextChanged_001)
+{
+    QStandardItemModel dataModel;
+    FolderSelectDialog folderselectdialog(&dataModel);
+    folderselectdialog.m_searchEdit->setText("test");
+    EXPECT_EQ(QString("test"), folderselectdialog.m_model->m_filterKeyword);
+    EXPECT_FALSE(folderselectdialog.m_confirmBtn->isEnabled());
+
+    QHideEvent event;
+    folderselectdialog.hideEvent(&event);
+    EXPECT_TRUE(folderselectdialog.m_model->m_filterKeyword.isEmpty());
+}
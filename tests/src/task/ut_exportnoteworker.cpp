@@ -5,6 +5,9 @@
 
 #include <QApplication>
 #include <QList>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QFile>
 
 void UT_ExportNoteWorker::SetUp()
 {
@@ -70,7 +73,7 @@ TEST_F(UT_ExportNoteWorker, UT_ExportNoteWorker_exportAsHtml_001)
 {
     ExportNoteWorker work("test", ExportNoteWorker::ExportHtml, m_noteList);
     work.run();
-    EXPECT_EQ(ExportNoteWorker::ExportOK, work.exportAsHtml());
+    EXPECT_EQ(ExportNoteWorker::ExportOK, work.exportAsHtml(note));
     EXPECT_EQ(work.m_exportType, ExportNoteWorker::ExportHtml);
 }
 
@@ -78,7 +81,7 @@ TEST_F(UT_ExportNoteWorker, UT_ExportNoteWorker_exportAsHtml_002)
 {
     ExportNoteWorker work("/test", ExportNoteWorker::ExportHtml, m_noteList);
     work.run();
-    EXPECT_EQ(ExportNoteWorker::Savefailed, work.exportAsHtml());
+    EXPECT_EQ(ExportNoteWorker::Savefailed, work.exportAsHtml(note));
     EXPECT_EQ(work.m_exportType, ExportNoteWorker::ExportHtml);
 }
 
@@ -87,3 +90,69 @@ TEST_F(UT_ExportNoteWorker, UT_ExportNoteWorker_getExportFileName_001)
     ExportNoteWorker work("/test", ExportNoteWorker::ExportHtml, m_noteList);
     EXPECT_EQ("123.txt", work.getExportFileName("123", ".txt"));
 }
+
+TEST_F(UT_ExportNoteWorker, UT_ExportNoteWorker_getExportFileName_002)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QFile file(dir.filePath("note.txt"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.close();
+
+    ExportNoteWorker work(dir.path(), ExportNoteWorker::ExportText, m_noteList);
+    QString baseName = dir.path() + "/note";
+    //目录中已有的文件及已分配的名称不再使用
+    EXPECT_EQ(baseName + "(1).txt", work.getExportFileName(baseName, ".txt"));
+    EXPECT_EQ(baseName + "(2).txt", work.getExportFileName(baseName, ".txt"));
+    EXPECT_EQ(baseName + "(1)(1).txt", work.getExportFileName(baseName + "(1)", ".txt"));
+    EXPECT_EQ(baseName + ".html", work.getExportFileName(baseName, ".html"));
+}
+
+TEST_F(UT_ExportNoteWorker, UT_ExportNoteWorker_run_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    QList<VNoteItem *> notes {note, note, note};
+    QSharedPointer<VNoteExportContext> context(new VNoteExportContext);
+    context->exportType = ExportNoteWorker::ExportHtml;
+    context->exportPath = dir.path();
+    context->notes = notes;
+    context->runningWorkers = 2;
+
+    ExportNoteWorker first(context);
+    ExportNoteWorker second(context);
+    QSignalSpy progressSpy(&first, &ExportNoteWorker::exportProgress);
+    QSignalSpy firstSpy(&first, &ExportNoteWorker::exportFinished);
+    QSignalSpy secondSpy(&second, &ExportNoteWorker::exportFinished);
+    first.run();
+    //其他线程未结束时不通知完成
+    EXPECT_EQ(0, firstSpy.count());
+    EXPECT_EQ(3, progressSpy.count());
+    EXPECT_EQ(3, progressSpy.at(2).at(0).toInt());
+
+    second.run();
+    ASSERT_EQ(1, secondSpy.count());
+    EXPECT_EQ(ExportNoteWorker::ExportOK, secondSpy.at(0).at(0).toInt());
+}
+
+TEST_F(UT_ExportNoteWorker, UT_ExportNoteWorker_run_002)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    QSharedPointer<VNoteExportContext> context(new VNoteExportContext);
+    context->exportType = ExportNoteWorker::ExportHtml;
+    context->exportPath = dir.path();
+    context->notes = QList<VNoteItem *> {note, note};
+    context->runningWorkers = 1;
+    context->cancelled = 1;
+
+    ExportNoteWorker work(context);
+    QSignalSpy progressSpy(&work, &ExportNoteWorker::exportProgress);
+    QSignalSpy finishedSpy(&work, &ExportNoteWorker::exportFinished);
+    work.run();
+    EXPECT_EQ(0, progressSpy.count());
+    ASSERT_EQ(1, finishedSpy.count());
+    EXPECT_EQ(ExportNoteWorker::ExportCancelled, finishedSpy.at(0).at(0).toInt());
+}
@@ -0,0 +1,52 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_imageencodeworker.h"
+#include "imageencodeworker.h"
+#include "common/vnoteattachmentstore.h"
+#include <stub.h>
+
+#include <QSignalSpy>
+
+static QString stub_storeImage()
+{
+    return QString();
+}
+
+UT_ImageEncodeWorker::UT_ImageEncodeWorker()
+{
+}
+
+TEST_F(UT_ImageEncodeWorker, UT_ImageEncodeWorker_run_001)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteAttachmentStore, storeImage), stub_storeImage);
+
+    ImageEncodeWorker worker(5, QImage(10, 10, QImage::Format_RGB32), "png", -1);
+    QSignalSpy ingestSpy(&worker, &ImageEncodeWorker::imageIngested);
+    QSignalSpy encodeSpy(&worker, &ImageEncodeWorker::imageEncoded);
+    worker.run();
+    //存入失败时不统计耗时
+    EXPECT_EQ(0, encodeSpy.count());
+    ASSERT_EQ(1, ingestSpy.count());
+    EXPECT_EQ(5u, ingestSpy.at(0).at(0).toULongLong());
+    EXPECT_TRUE(ingestSpy.at(0).at(2).toString().isEmpty());
+    EXPECT_TRUE(worker.m_image.isNull());
+}
@@ -0,0 +1,60 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_imageingestworker.h"
+#include "imageingestworker.h"
+
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QFile>
+
+UT_ImageIngestWorker::UT_ImageIngestWorker()
+{
+}
+
+TEST_F(UT_ImageIngestWorker, UT_ImageIngestWorker_ingestImage_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    //后缀为图片但内容不是图片
+    QFile file(dir.filePath("1.png"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write("not image");
+    file.close();
+
+    EXPECT_TRUE(ImageIngestWorker::ingestImage(file.fileName()).isEmpty());
+    EXPECT_TRUE(ImageIngestWorker::ingestImage(dir.filePath("2.png")).isEmpty());
+}
+
+TEST_F(UT_ImageIngestWorker, UT_ImageIngestWorker_run_001)
+{
+    QSharedPointer<VNoteIngestContext> context(new VNoteIngestContext);
+    context->batchId = 3;
+    context->files = QStringList({"/tmp/none_1.png", "/tmp/none_2.png"});
+
+    ImageIngestWorker worker(context);
+    QSignalSpy spy(&worker, &ImageIngestWorker::imageIngested);
+    worker.run();
+    ASSERT_EQ(2, spy.count());
+    EXPECT_EQ(3u, spy.at(0).at(0).toULongLong());
+    EXPECT_EQ(0, spy.at(0).at(1).toInt());
+    EXPECT_EQ(1, spy.at(1).at(1).toInt());
+    EXPECT_TRUE(spy.at(1).at(2).toString().isEmpty());
+}
@@ -0,0 +1,104 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_inlineimagemigrationworker.h"
+#include "inlineimagemigrationworker.h"
+#include "common/vnoteitem.h"
+#include "common/vnoteattachmentstore.h"
+#include <stub.h>
+
+#include <QSignalSpy>
+
+static QString stub_externalizeDataUris()
+{
+    return QString("<img src=\"vnote://attachment/a.png\">");
+}
+
+static QString stub_attachmentDir()
+{
+    return QString("/tmp/store");
+}
+
+static QString stub_externalizeLocalPaths()
+{
+    return QString("<img src=\"vnote://attachment/b.png\">");
+}
+
+UT_InlineImageMigrationWorker::UT_InlineImageMigrationWorker()
+{
+}
+
+TEST_F(UT_InlineImageMigrationWorker, UT_InlineImageMigrationWorker_run_001)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteAttachmentStore, externalizeDataUris), stub_externalizeDataUris);
+
+    VNOTE_ALL_NOTES_MAP allNotesMap;
+    allNotesMap.autoRelease = true;
+    VNOTE_ITEMS_MAP *folderNotes = new VNOTE_ITEMS_MAP();
+    folderNotes->autoRelease = true;
+    for (int noteId = 1; noteId <= 2; noteId++) {
+        VNoteItem *note = new VNoteItem();
+        note->folderId = 1;
+        note->noteId = noteId;
+        note->htmlCode = noteId == 1 ? "<img src=\"data:image/png;base64,AAAA\">" : "<p>text</p>";
+        folderNotes->folderNotes.insert(noteId, note);
+    }
+    allNotesMap.notes.insert(1, folderNotes);
+
+    InlineImageMigrationWorker worker(&allNotesMap);
+    QSignalSpy migratedSpy(&worker, &InlineImageMigrationWorker::noteMigrated);
+    QSignalSpy finishedSpy(&worker, &InlineImageMigrationWorker::migrationFinished);
+    worker.run();
+
+    //只处理包含内嵌图片的笔记
+    ASSERT_EQ(1, migratedSpy.count());
+    EXPECT_EQ(1, migratedSpy.at(0).at(0).toLongLong());
+    EXPECT_EQ(1, migratedSpy.at(0).at(1).toInt());
+    EXPECT_EQ(QString("<img src=\"vnote://attachment/a.png\">"), migratedSpy.at(0).at(3).toString());
+    ASSERT_EQ(1, finishedSpy.count());
+    EXPECT_EQ(1, finishedSpy.at(0).at(0).toInt());
+}
+
+TEST_F(UT_InlineImageMigrationWorker, UT_InlineImageMigrationWorker_run_002)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteAttachmentStore, attachmentDir), stub_attachmentDir);
+    stub.set(ADDR(VNoteAttachmentStore, externalizeLocalPaths), stub_externalizeLocalPaths);
+
+    VNOTE_ALL_NOTES_MAP allNotesMap;
+    allNotesMap.autoRelease = true;
+    VNOTE_ITEMS_MAP *folderNotes = new VNOTE_ITEMS_MAP();
+    folderNotes->autoRelease = true;
+    VNoteItem *note = new VNoteItem();
+    note->folderId = 1;
+    note->noteId = 1;
+    note->htmlCode = "<img src=\"/tmp/store/20200101120000.png\">";
+    folderNotes->folderNotes.insert(1, note);
+    allNotesMap.notes.insert(1, folderNotes);
+
+    InlineImageMigrationWorker worker(&allNotesMap);
+    QSignalSpy migratedSpy(&worker, &InlineImageMigrationWorker::noteMigrated);
+    worker.run();
+
+    //图片目录下的本地路径替换为附件url
+    ASSERT_EQ(1, migratedSpy.count());
+    EXPECT_EQ(QString("<img src=\"vnote://attachment/b.png\">"), migratedSpy.at(0).at(3).toString());
+}
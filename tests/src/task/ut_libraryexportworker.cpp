@@ -0,0 +1,108 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_libraryexportworker.h"
+#include "libraryexportworker.h"
+#include "common/vnoteforlder.h"
+#include "common/vnotearchive.h"
+#include "common/vnoteattachmentstore.h"
+#include <stub.h>
+
+#include <QSignalSpy>
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <QFile>
+
+static QString g_dataDir;
+
+static QString stub_attachmentDir(VNoteAttachment::Type type)
+{
+    return g_dataDir + (VNoteAttachment::Voice == type ? "/voicenote" : "/images");
+}
+
+UT_LibraryExportWorker::UT_LibraryExportWorker()
+{
+}
+
+TEST_F(UT_LibraryExportWorker, UT_LibraryExportWorker_run_001)
+{
+    LibraryExportWorker worker("/tmp/vnote-library.tar", QList<VNoteFolder *>());
+    QSignalSpy finishedSpy(&worker, &LibraryExportWorker::exportFinished);
+    worker.run();
+    ASSERT_EQ(1, finishedSpy.count());
+    EXPECT_EQ(LibraryExportWorker::NoFolder, finishedSpy.at(0).at(0).toInt());
+}
+
+TEST_F(UT_LibraryExportWorker, UT_LibraryExportWorker_run_002)
+{
+    VNoteFolder folder;
+    folder.id = 1;
+    folder.name = "folder";
+    QList<VNoteFolder *> folders;
+    folders.append(&folder);
+
+    //目录不存在，无法创建归档文件
+    LibraryExportWorker worker("/nonexistent-vnote-dir/library.tar", folders);
+    QSignalSpy finishedSpy(&worker, &LibraryExportWorker::exportFinished);
+    worker.run();
+    ASSERT_EQ(1, finishedSpy.count());
+    EXPECT_EQ(LibraryExportWorker::PathDenied, finishedSpy.at(0).at(0).toInt());
+}
+
+TEST_F(UT_LibraryExportWorker, UT_LibraryExportWorker_exportLegacyFile_001)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    g_dataDir = dir.path();
+
+    Stub stub;
+    stub.set(ADDR(VNoteAttachmentStore, attachmentDir), stub_attachmentDir);
+
+    QString voice = dir.filePath("20200101120100.mp3");
+    QFile voiceFile(voice);
+    ASSERT_TRUE(voiceFile.open(QIODevice::WriteOnly));
+    voiceFile.write("voice");
+    voiceFile.close();
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    ASSERT_TRUE(buffer.open(QIODevice::WriteOnly));
+    VNoteArchiveWriter writer(&buffer);
+    LibraryExportWorker worker("/tmp/vnote-library.tar", QList<VNoteFolder *>());
+
+    //旧文件以哈希命名的条目写入，相同内容只写入一次
+    QString hashName = QString(64, 'b') + ".mp3";
+    EXPECT_TRUE(worker.exportLegacyFile(writer, g_dataDir + "/voicenote/" + hashName, voice));
+    EXPECT_TRUE(worker.exportLegacyFile(writer, g_dataDir + "/voicenote/" + hashName, voice));
+    ASSERT_TRUE(writer.finish());
+    buffer.close();
+
+    ASSERT_TRUE(buffer.open(QIODevice::ReadOnly));
+    VNoteArchiveReader reader(&buffer);
+    VNoteArchiveReader::Entry entry;
+    QStringList names;
+    while (reader.next(entry)) {
+        names.append(entry.name);
+        if (entry.isFile) {
+            EXPECT_EQ(QByteArray("voice"), reader.readAll());
+        }
+    }
+    EXPECT_EQ(QStringList {"attachments/voicenote/" + hashName}, names);
+}
@@ -0,0 +1,61 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_libraryimportworker.h"
+#include "libraryimportworker.h"
+#include "common/vnotearchive.h"
+
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QFile>
+
+UT_LibraryImportWorker::UT_LibraryImportWorker()
+{
+}
+
+TEST_F(UT_LibraryImportWorker, UT_LibraryImportWorker_run_001)
+{
+    LibraryImportWorker worker("/nonexistent-vnote-dir/library.tar");
+    QSignalSpy finishedSpy(&worker, &LibraryImportWorker::importFinished);
+    worker.run();
+    ASSERT_EQ(1, finishedSpy.count());
+    EXPECT_EQ(LibraryImportWorker::OpenFailed, finishedSpy.at(0).at(0).toInt());
+}
+
+TEST_F(UT_LibraryImportWorker, UT_LibraryImportWorker_run_002)
+{
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QString filePath = dir.filePath("library.tar");
+
+    //没有清单的归档
+    QFile file(filePath);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    VNoteArchiveWriter writer(&file);
+    writer.addData("notes/1-1.json", "{}");
+    writer.finish();
+    file.close();
+
+    LibraryImportWorker worker(filePath);
+    QSignalSpy finishedSpy(&worker, &LibraryImportWorker::importFinished);
+    worker.run();
+    ASSERT_EQ(1, finishedSpy.count());
+    EXPECT_EQ(LibraryImportWorker::FormatError, finishedSpy.at(0).at(0).toInt());
+}
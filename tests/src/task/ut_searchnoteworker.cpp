@@ -0,0 +1,120 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_searchnoteworker.h"
+
+#include <QSignalSpy>
+
+UT_SearchNoteWorker::UT_SearchNoteWorker()
+{
+}
+
+void UT_SearchNoteWorker::SetUp()
+{
+    m_context.reset(new VNoteSearchContext);
+    m_context->queryId = 1;
+    m_context->key = "note2";
+    for (int folderId = 1; folderId <= 2; folderId++) {
+        for (int noteId = 1; noteId <= 3; noteId++) {
+            VNoteSearchDoc doc;
+            doc.folderId = folderId;
+            doc.noteId = noteId;
+            doc.title = QString("note%1").arg(noteId);
+            m_context->docs.append(doc);
+        }
+    }
+    m_context->runningWorkers.storeRelease(1);
+}
+
+void UT_SearchNoteWorker::TearDown()
+{
+    m_context.reset();
+}
+
+TEST_F(UT_SearchNoteWorker, UT_SearchNoteWorker_run_001)
+{
+    SearchNoteWorker work(m_context);
+    QSignalSpy batchSpy(&work, &SearchNoteWorker::searchBatch);
+    QSignalSpy finishSpy(&work, &SearchNoteWorker::searchFinished);
+    work.run();
+
+    //所有笔记在一次领取中搜索完成
+    ASSERT_EQ(1, batchSpy.count());
+    EXPECT_EQ(2, batchSpy.at(0).at(1).value<VNOTE_SEARCH_HITS>().size());
+    EXPECT_EQ(1, finishSpy.count());
+    EXPECT_EQ(0, m_context->runningWorkers.loadAcquire());
+    EXPECT_EQ(m_context->docs.size(), m_context->docCount.loadAcquire());
+}
+
+TEST_F(UT_SearchNoteWorker, UT_SearchNoteWorker_run_002)
+{
+    m_context->cancelled.storeRelease(1);
+    SearchNoteWorker work(m_context);
+    QSignalSpy batchSpy(&work, &SearchNoteWorker::searchBatch);
+    QSignalSpy finishSpy(&work, &SearchNoteWorker::searchFinished);
+    work.run();
+
+    EXPECT_EQ(0, batchSpy.count());
+    EXPECT_EQ(1, finishSpy.count());
+}
+
+TEST_F(UT_SearchNoteWorker, UT_SearchNoteWorker_run_003)
+{
+    m_context->docs.clear();
+    SearchNoteWorker work(m_context);
+    QSignalSpy finishSpy(&work, &SearchNoteWorker::searchFinished);
+    work.run();
+
+    EXPECT_EQ(1, finishSpy.count());
+}
+
+TEST_F(UT_SearchNoteWorker, UT_SearchNoteWorker_searchDocs_001)
+{
+    SearchNoteWorker work(m_context);
+    VNOTE_SEARCH_HITS hits;
+    work.searchDocs(0, 3, hits);
+    ASSERT_EQ(1, hits.size());
+    EXPECT_EQ(1, hits.at(0).folderId);
+    EXPECT_EQ(2, hits.at(0).noteId);
+}
+
+TEST_F(UT_SearchNoteWorker, UT_SearchNoteWorker_flushHits_001)
+{
+    SearchNoteWorker work(m_context);
+    QSignalSpy batchSpy(&work, &SearchNoteWorker::searchBatch);
+    VNOTE_SEARCH_HITS hits;
+    work.flushHits(hits);
+    EXPECT_EQ(0, batchSpy.count());
+
+    hits.append(VNoteSearchHit());
+    work.flushHits(hits);
+    EXPECT_EQ(1, batchSpy.count());
+    EXPECT_TRUE(hits.isEmpty());
+}
+
+TEST_F(UT_SearchNoteWorker, UT_SearchNoteWorker_searchDoc_001)
+{
+    SearchNoteWorker work(m_context);
+    VNOTE_SEARCH_HITS hits;
+    //语音转写已命中的笔记不再重复返回
+    m_context->matchedNoteIds.insert(2);
+    work.searchDoc(m_context->docs.at(1), hits);
+    EXPECT_TRUE(hits.isEmpty());
+}
@@ -0,0 +1,81 @@
+/*
+* Copyright (C) 2019 ~ 2020 Uniontech Software Technology Co.,Ltd.
+*
+* Author:     liuyanga <liuyanga@uniontech.com>
+*
+* Maintainer: liuyanga <liuyanga@uniontech.com>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "ut_transcriptbackfillworker.h"
+#include "transcriptbackfillworker.h"
+#include "common/vnoteitem.h"
+#include "db/vnotetranscriptoper.h"
+#include <stub.h>
+
+#include <QSignalSpy>
+
+static VNOTE_TRANSCRIPTS g_addedTranscripts;
+
+static bool stub_addTranscripts(void *, const VNOTE_TRANSCRIPTS &transcripts)
+{
+    g_addedTranscripts += transcripts;
+    return true;
+}
+
+UT_TranscriptBackfillWorker::UT_TranscriptBackfillWorker()
+{
+}
+
+TEST_F(UT_TranscriptBackfillWorker, UT_TranscriptBackfillWorker_run_001)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteTranscriptOper, addTranscripts), stub_addTranscripts);
+    g_addedTranscripts.clear();
+
+    VNOTE_ALL_NOTES_MAP allNotesMap;
+    allNotesMap.autoRelease = true;
+    VNOTE_ITEMS_MAP *folderNotes = new VNOTE_ITEMS_MAP();
+    folderNotes->autoRelease = true;
+    QString voiceJson = "{&quot;type&quot;:2,&quot;voicePath&quot;:&quot;/tmp/a.mp3&quot;,"
+                        "&quot;voiceSize&quot;:4000,&quot;text&quot;:&quot;first. second.&quot;}";
+    for (int noteId = 1; noteId <= 3; noteId++) {
+        VNoteItem *note = new VNoteItem();
+        note->folderId = 1;
+        note->noteId = noteId;
+        note->htmlCode = "<p>text</p>";
+        folderNotes->folderNotes.insert(noteId, note);
+    }
+    //有转写文本的语音
+    folderNotes->folderNotes.value(1)->htmlCode = QString("<div jsonkey=\"%1\"></div>").arg(voiceJson);
+    //未转写的语音
+    folderNotes->folderNotes.value(2)->htmlCode = "<div jsonkey=\"{&quot;type&quot;:2,&quot;voicePath&quot;:&quot;/tmp/b.mp3&quot;}\"></div>";
+    allNotesMap.notes.insert(1, folderNotes);
+
+    TranscriptBackfillWorker worker(&allNotesMap);
+    //创建后笔记内容被修改不影响写入
+    folderNotes->folderNotes.value(1)->htmlCode.clear();
+    QSignalSpy finishedSpy(&worker, &TranscriptBackfillWorker::backfillFinished);
+    worker.run();
+
+    ASSERT_EQ(1, finishedSpy.count());
+    EXPECT_EQ(1, finishedSpy.at(0).at(0).toInt());
+    EXPECT_TRUE(finishedSpy.at(0).at(1).toBool());
+    ASSERT_EQ(2, g_addedTranscripts.size());
+    EXPECT_EQ(QString("/tmp/a.mp3"), g_addedTranscripts.at(0).voicePath);
+    EXPECT_EQ(1, g_addedTranscripts.at(0).noteId);
+    EXPECT_EQ(QString("second."), g_addedTranscripts.at(1).text);
+    EXPECT_EQ(4000, g_addedTranscripts.at(1).endTime);
+    g_addedTranscripts.clear();
+}
@@ -251,6 +251,19 @@ TEST_F(UT_MiddleView, addRowAtHead)
     delete vnoteitem;
 }
 
+TEST_F(UT_MiddleView, appendRows)
+{
+    MiddleView middleview;
+    VNoteItem *noteData = new VNoteItem;
+    VNoteItem *noteData1 = new VNoteItem;
+    middleview.appendRows({noteData, nullptr, noteData1});
+    EXPECT_EQ(2, middleview.rowCount());
+    middleview.appendRows({});
+    EXPECT_EQ(2, middleview.rowCount());
+    delete noteData;
+    delete noteData1;
+}
+
 TEST_F(UT_MiddleView, appendRow)
 {
     MiddleView middleview;
@@ -535,3 +548,49 @@ TEST_F(UT_MiddleView, UT_MiddleView_onExportFinished_001)
     m_middleView->onExportFinished(3);
     m_middleView->onExportFinished(4);
 }
+
+TEST_F(UT_MiddleView, UT_MiddleView_onExportProgress_001)
+{
+    //没有正在进行的导出时不显示进度
+    m_middleView->onExportProgress(1, 10);
+    EXPECT_TRUE(nullptr == m_middleView->m_exportMessage);
+}
+
+TEST_F(UT_MiddleView, mergeSearchRows_001)
+{
+    MiddleView middleview;
+    VNoteItem *noteData = new VNoteItem;
+    VNoteItem *noteData1 = new VNoteItem;
+    VNoteItem *noteData2 = new VNoteItem;
+    noteData->noteId = 1;
+    noteData1->noteId = 2;
+    noteData2->noteId = 3;
+    VNOTE_SEARCH_HITS hits(2);
+    hits[0].score = 1.0;
+    hits[1].score = 3.0;
+    middleview.setSearchKey("test");
+    middleview.sortView(false);
+    middleview.mergeSearchRows({noteData, noteData1}, hits);
+    //后返回的结果按相关度插入到已有结果之间
+    VNOTE_SEARCH_HITS laterHits(1);
+    laterHits[0].score = 2.0;
+    middleview.mergeSearchRows({noteData2}, laterHits);
+
+    //搜索结果按相关度从高到低排序
+    ASSERT_EQ(3, middleview.rowCount());
+    EXPECT_EQ(noteData1, StandardItemCommon::getStandardItemData(middleview.m_pSortViewFilter->index(0, 0)));
+    EXPECT_EQ(noteData2, StandardItemCommon::getStandardItemData(middleview.m_pSortViewFilter->index(1, 0)));
+    EXPECT_EQ(noteData, StandardItemCommon::getStandardItemData(middleview.m_pSortViewFilter->index(2, 0)));
+    EXPECT_DOUBLE_EQ(3.0, StandardItemCommon::getStandardItemSearchHit(middleview.m_pSortViewFilter->index(0, 0)).score);
+
+    //删除行后排序信息同步删除
+    middleview.m_pDataModel->removeRow(0);
+    EXPECT_EQ(2, middleview.m_searchRows.size());
+    EXPECT_DOUBLE_EQ(2.0, middleview.m_searchRows.first().score);
+    middleview.clearAll();
+    EXPECT_TRUE(middleview.m_searchRows.isEmpty());
+    middleview.setSearchKey("");
+    delete noteData;
+    delete noteData1;
+    delete noteData2;
+}
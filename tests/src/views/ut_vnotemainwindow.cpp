@@ -26,6 +26,7 @@
 #include "standarditemcommon.h"
 #include "vnotedatamanager.h"
 #include "vnotea2tmanager.h"
+#include "vnotesearchengine.h"
 #include "vnoteitem.h"
 #include "vnoteforlder.h"
 #include "actionmanager.h"
@@ -41,6 +42,7 @@
 #include "vnoteiconbutton.h"
 #include "vnmainwnddelayinittask.h"
 #include "webrichtexteditor.h"
+#include "vnoteeditorjournal.h"
 
 #include "upgradeview.h"
 #include "upgradedbutil.h"
@@ -81,6 +83,24 @@ QObject *stub_nullptr()
     return nullptr;
 }
 
+static QMap<VNoteJournalKey, QString> g_journalNotes;
+static bool g_journalDiscarded = false;
+
+static QMap<VNoteJournalKey, QString> stub_replay()
+{
+    return g_journalNotes;
+}
+
+static void stub_discard()
+{
+    g_journalDiscarded = true;
+}
+
+static bool stub_false()
+{
+    return false;
+}
+
 UT_VNoteMainWindow::UT_VNoteMainWindow()
 {
 }
@@ -143,6 +163,34 @@ TEST_F(UT_VNoteMainWindow, UT_VNoteMainWindow_holdHaltLock_001)
     EXPECT_FALSE(m_mainWindow->m_stackedWidget->currentIndex() != VNoteMainWindow::WndNoteShow);
 }
 
+TEST_F(UT_VNoteMainWindow, UT_VNoteMainWindow_recoverEditorJournal_001)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteEditorJournal, replay), stub_replay);
+    stub.set(ADDR(VNoteEditorJournal, discard), stub_discard);
+    stub.set(ADDR(VNoteItemOper, updateNote), stub_false);
+
+    g_journalNotes.clear();
+    g_journalDiscarded = false;
+    EXPECT_TRUE(m_mainWindow->recoverEditorJournal());
+    EXPECT_TRUE(g_journalDiscarded);
+
+    VNOTE_ALL_NOTES_MAP *notes = VNoteDataManager::instance()->getAllNotesInFolder();
+    if (nullptr == notes || notes->notes.isEmpty() || notes->notes.first()->folderNotes.isEmpty()) {
+        return;
+    }
+
+    //保存失败时保留日志，不清理附件
+    VNoteItem *note = notes->notes.first()->folderNotes.first();
+    QString html = note->htmlCode;
+    g_journalNotes.insert(VNoteJournalKey(note->folderId, note->noteId), html + "<p>journal</p>");
+    g_journalDiscarded = false;
+    EXPECT_FALSE(m_mainWindow->recoverEditorJournal());
+    EXPECT_FALSE(g_journalDiscarded);
+    note->htmlCode = html;
+    g_journalNotes.clear();
+}
+
 TEST_F(UT_VNoteMainWindow, UT_VNoteMainWindow_onVNoteSearch_001)
 {
     Stub stub;
@@ -180,6 +228,26 @@ TEST_F(UT_VNoteMainWindow, UT_VNoteMainWindow_onVNoteSearchTextChange_001)
     EXPECT_EQ(OpsStateInterface::instance()->isSearching(), false);
 }
 
+TEST_F(UT_VNoteMainWindow, UT_VNoteMainWindow_onVNoteSearchTextChange_002)
+{
+    m_mainWindow->onVNoteSearchTextChange("a");
+    EXPECT_TRUE(m_mainWindow->m_searchDelayTimer->isActive());
+    m_mainWindow->onVNoteSearchTextChange("");
+    EXPECT_FALSE(m_mainWindow->m_searchDelayTimer->isActive());
+}
+
+TEST_F(UT_VNoteMainWindow, UT_VNoteMainWindow_onSearchDelayTimeout_001)
+{
+    Stub stub;
+    stub.set(ADDR(QWebEngineView, findText), stub_vnotemainwindow);
+    m_mainWindow->m_noteSearchEdit->setText("b");
+    m_mainWindow->onSearchDelayTimeout();
+    EXPECT_EQ("b", m_mainWindow->m_searchKey);
+    EXPECT_TRUE(OpsStateInterface::instance()->isSearching());
+    m_mainWindow->m_noteSearchEdit->clear();
+    EXPECT_FALSE(OpsStateInterface::instance()->isSearching());
+}
+
 TEST_F(UT_VNoteMainWindow, UT_VNoteMainWindow_onVNoteFolderChange_001)
 {
     m_mainWindow->onVNoteFolderChange(m_mainWindow->m_leftView->restoreNotepadItem(), QModelIndex());
@@ -244,7 +312,26 @@ TEST_F(UT_VNoteMainWindow, UT_VNoteMainWindow_loadNotes_001)
 
 TEST_F(UT_VNoteMainWindow, UT_VNoteMainWindow_loadSearchNotes_001)
 {
-    EXPECT_FALSE(m_mainWindow->loadSearchNotes("本"));
+    quint64 queryId = m_mainWindow->m_searchEngine->currentQueryId();
+    m_mainWindow->loadSearchNotes("本");
+    EXPECT_EQ(queryId + 1, m_mainWindow->m_searchEngine->currentQueryId());
+}
+
+TEST_F(UT_VNoteMainWindow, UT_VNoteMainWindow_onSearchResultReady_001)
+{
+    m_mainWindow->m_middleView->clearAll();
+    VNoteItem note;
+    m_mainWindow->onSearchResultReady(m_mainWindow->m_searchEngine->currentQueryId() + 1, {&note}, VNOTE_SEARCH_HITS());
+    EXPECT_EQ(0, m_mainWindow->m_middleView->rowCount());
+}
+
+TEST_F(UT_VNoteMainWindow, UT_VNoteMainWindow_onSearchFinished_001)
+{
+    OpsStateInterface::instance()->operState(OpsStateInterface::StateSearching, true);
+    m_mainWindow->m_middleView->clearAll();
+    m_mainWindow->onSearchFinished(m_mainWindow->m_searchEngine->currentQueryId(), 0);
+    EXPECT_TRUE(m_mainWindow->m_middleView->m_emptySearch);
+    OpsStateInterface::instance()->operState(OpsStateInterface::StateSearching, false);
 }
 
 TEST_F(UT_VNoteMainWindow, UT_VNoteMainWindow_initDeviceExceptionErrMessage_001)
@@ -24,12 +24,14 @@
 #include "dialog/vnotemessagedialog.h"
 #include "common/actionmanager.h"
 #include "common/vtextspeechandtrmanager.h"
+#include "db/vnoteitemoper.h"
 
 #include <DFileDialog>
 
 #include <QClipboard>
 #include <QMimeData>
 #include <QWebEngineContextMenuData>
+#include <QSignalSpy>
 
 static QWebChannel *webchannel;
 
@@ -47,6 +49,78 @@ static QVariant stub_callJsSynchronous()
     return QVariant("");
 }
 
+static QVariant stub_callJsSynchronousTimeout()
+{
+    return QVariant();
+}
+
+static VNoteItem *savedNote = nullptr;
+
+static void stub_saveNoteBody(void *obj, VNoteItem *note)
+{
+    Q_UNUSED(obj)
+    savedNote = note;
+}
+
+static QVariant stub_callJsGetChanges()
+{
+    QVariantMap changes;
+    changes.insert("version", 1);
+    changes.insert("full", true);
+    changes.insert("blocks", QStringList({"<p>a</p>", "<p>b</p>"}));
+    return changes;
+}
+
+static QVariant jsAsyncResult;
+
+static quint64 stub_callJsAsync(void *obj, QWebEnginePage *page, const QString &function,
+                                const JsContent::JsCallback &callback, int timeout, bool waitAfterTimeout)
+{
+    Q_UNUSED(obj)
+    Q_UNUSED(page)
+    Q_UNUSED(function)
+    Q_UNUSED(timeout)
+    Q_UNUSED(waitAfterTimeout)
+    if (callback) {
+        callback(true, jsAsyncResult);
+    }
+    return 1;
+}
+
+static JsContent::JsCallback jsTimeoutCallback;
+
+static quint64 stub_callJsAsyncTimeout(void *obj, QWebEnginePage *page, const QString &function,
+                                       const JsContent::JsCallback &callback, int timeout, bool waitAfterTimeout)
+{
+    Q_UNUSED(obj)
+    Q_UNUSED(page)
+    Q_UNUSED(function)
+    Q_UNUSED(timeout)
+    //超时后等待的请求保留回调，由用例返回结果
+    if (callback) {
+        callback(false, QVariant());
+        if (waitAfterTimeout) {
+            jsTimeoutCallback = callback;
+        }
+    }
+    return 1;
+}
+
+static VNoteItem *syncNote = nullptr;
+
+static VNoteItem *stub_getSyncNote(void *obj, qint64 folderId, qint32 noteId)
+{
+    Q_UNUSED(obj)
+    Q_UNUSED(folderId)
+    Q_UNUSED(noteId)
+    return syncNote;
+}
+
+static bool stub_true()
+{
+    return true;
+}
+
 static QVariant stub_imageVariant()
 {
     return QVariant(QImage());
@@ -77,10 +151,6 @@ void stub_WebRichTextEditor_setWebChannel(QWebChannel *channel)
     webchannel = channel;
 }
 
-bool stub_isVoicePaste()
-{
-    return false;
-}
 
 static void stub_findText(const QString &subString, QWebEnginePage::FindFlags options, const QWebEngineCallback<bool> &resultCallback) {
     Q_UNUSED(subString)
@@ -159,11 +229,47 @@ TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_initUpdateTimer_001)
     m_web->initUpdateTimer();
 }
 
+TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_preparePage_001)
+{
+    Stub stub;
+    stub.set(ADDR(WebRichTextEditor, initWebView), stub_WebRichTextEditor);
+    stub.set(ADDR(WebRichTextEditor, initFontsInformation), stub_WebRichTextEditor);
+
+    EXPECT_FALSE(m_web->m_pagePrepared);
+    m_web->preparePage();
+    EXPECT_TRUE(m_web->m_pagePrepared);
+    m_web->preparePage();
+    EXPECT_TRUE(m_web->m_pagePrepared);
+}
+
 TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_initData_001)
 {
     m_web->initData(nullptr, "", false);
 }
 
+TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_initData_002)
+{
+    VNoteItem noteA;
+    VNoteItem noteB;
+    m_web->m_loadRequestTime.invalidate();
+
+    //第一次切换立即加载
+    m_web->initData(&noteA, "");
+    EXPECT_EQ(&noteA, m_web->m_pendingData);
+    EXPECT_EQ(0, m_web->m_loadTimer->interval());
+
+    //连续切换时替换未加载的笔记并推迟加载
+    m_web->initData(&noteB, "b");
+    EXPECT_EQ(&noteB, m_web->m_pendingData);
+    EXPECT_EQ(QString("b"), m_web->m_pendingSearchKey);
+    EXPECT_EQ(WebRichTextEditor::LoadDebounceInterval, m_web->m_loadTimer->interval());
+    EXPECT_TRUE(m_web->m_loadTimer->isActive());
+
+    m_web->cancelPendingLoad();
+    EXPECT_FALSE(m_web->m_loadTimer->isActive());
+    EXPECT_EQ(nullptr, m_web->m_pendingData);
+}
+
 TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_insertVoiceItem_001)
 {
     m_web->insertVoiceItem("", 2);
@@ -174,20 +280,239 @@ TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_updateNote_001)
 {
     Stub stub;
     stub.set(ADDR(QWebEngineView, page), stub_WebRichTextEditor_page);
-    stub.set(ADDR(JsContent, callJsSynchronous), stub_callJsSynchronous);
 
     VNoteItem *note = new VNoteItem();
     m_web->m_textChange = true;
     m_web->m_noteData = note;
-    m_web->updateNote();
+    bool finished = false;
+    //页面无效时请求失败，内容仍标记为已修改
+    m_web->updateNote([&finished] {
+        finished = true;
+    });
+    EXPECT_TRUE(finished);
+    EXPECT_TRUE(m_web->m_textChange);
+
+    finished = false;
+    m_web->m_textChange = false;
+    m_web->updateNote([&finished] {
+        finished = true;
+    });
+    EXPECT_TRUE(finished);
+    m_web->m_noteData = nullptr;
     delete note;
 }
 
-TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_searchText_001)
+TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_updateNoteBeforeQuit_001)
 {
     Stub stub;
-    stub.set(ADDR(QWebEngineView, findText), stub_findText);
+    stub.set(ADDR(QWebEngineView, page), stub_WebRichTextEditor_page);
+    stub.set(ADDR(JsContent, callJsSynchronous), stub_callJsSynchronous);
+
+    VNoteItem note;
+    m_web->m_textChange = true;
+    m_web->m_noteData = &note;
+    m_web->updateNoteBeforeQuit();
+    EXPECT_FALSE(m_web->m_textChange);
+    m_web->m_noteData = nullptr;
+}
+
+TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_requestEditorChanges_001)
+{
+    Stub stub;
+    stub.set(ADDR(QWebEngineView, page), stub_WebRichTextEditor_page);
+    stub.set(ADDR(JsContent, callJsAsync), stub_callJsAsync);
+
+    VNoteItem note;
+    m_web->m_noteData = &note;
+    m_web->m_editorSync.reset();
+    jsAsyncResult = stub_callJsGetChanges();
+    int finished = 0;
+    m_web->requestEditorChanges(&note, -1, [&finished] {
+        finished++;
+    });
+    EXPECT_EQ(1, finished);
+    EXPECT_EQ(1, m_web->m_editorSync.version());
+    EXPECT_EQ(QString("<p>a</p><p>b</p>"), m_web->m_editorSync.html());
+
+    //返回内容无效时同步失败
+    jsAsyncResult = stub_callJsSynchronous();
+    m_web->requestEditorChanges(&note, -1, [&finished] {
+        finished++;
+    });
+    EXPECT_EQ(2, finished);
+    EXPECT_EQ(-1, m_web->m_editorSync.version());
+    m_web->m_noteData = nullptr;
+}
+
+TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_requestEditorChanges_002)
+{
+    Stub stub;
+    stub.set(ADDR(QWebEngineView, page), stub_WebRichTextEditor_page);
+    stub.set(ADDR(JsContent, callJsAsync), stub_callJsAsyncTimeout);
+
+    VNoteItem note;
+    VNoteItem otherNote;
+    m_web->m_noteData = &note;
+    m_web->m_textChange = false;
+    m_web->m_editorSync.reset();
+    jsTimeoutCallback = nullptr;
+    int finished = 0;
+    m_web->requestEditorChanges(&note, -1, [&finished] {
+        finished++;
+    }, false);
+    //超时后保留修改标志，继续等待结果
+    EXPECT_EQ(1, finished);
+    EXPECT_TRUE(m_web->m_textChange);
+    ASSERT_TRUE(jsTimeoutCallback);
+
+    //切换笔记后返回的结果仍保存到发起请求的笔记
+    m_web->m_noteData = &otherNote;
+    jsTimeoutCallback(true, stub_callJsGetChanges());
+    EXPECT_EQ(1, finished);
+    EXPECT_EQ(QString("<p>a</p><p>b</p>"), note.htmlCode);
+    EXPECT_TRUE(otherNote.htmlCode.isEmpty());
+    EXPECT_EQ(1, m_web->m_editorSync.version());
+
+    jsTimeoutCallback = nullptr;
+    m_web->m_journal.checkpoint(&note);
+    m_web->m_noteData = nullptr;
+}
+
+TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_updateNoteBeforeQuit_002)
+{
+    Stub stub;
+    stub.set(ADDR(QWebEngineView, page), stub_WebRichTextEditor_page);
+    stub.set(ADDR(JsContent, callJsSynchronous), stub_callJsSynchronousTimeout);
+    stub.set(ADDR(WebRichTextEditor, saveNoteBody), stub_saveNoteBody);
+
+    VNoteItem note;
+    m_web->m_textChange = true;
+    m_web->m_noteData = &note;
+    savedNote = nullptr;
+    //编辑区无响应时保存日志中已有的内容
+    m_web->updateNoteBeforeQuit();
+    EXPECT_EQ(&note, savedNote);
+    m_web->m_noteData = nullptr;
+}
+
+TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_shortcutPopupMenu_001)
+{
+    Stub stub;
+    stub.set(ADDR(QWebEngineView, page), stub_WebRichTextEditor_page);
+    stub.set(ADDR(JsContent, callJsAsync), stub_callJsAsync);
+    stub.set(ADDR(QWidget, focusProxy), ADDR(UT_WebRichTextEditor, stub_focusProxy));
+
+    QVariantMap param;
+    param.insert("flag", WebRichTextEditor::TxtMenu);
+    param.insert("info", "");
+    jsAsyncResult = param;
+    m_web->shortcutPopupMenu();
+    EXPECT_EQ(WebRichTextEditor::TxtMenu, m_web->m_menuType);
+}
+
+TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_switchNote_001)
+{
+    VNoteItem noteA;
+    noteA.noteId = 1;
+    noteA.htmlCode = "<p>a</p>";
+    VNoteItem noteB;
+    noteB.noteId = 2;
+    noteB.htmlCode = "<p>b</p>";
+    QSignalSpy switchSpy(JsContent::instance(), &JsContent::callJsSwitchNote);
+
+    m_web->m_noteCache.clear();
+    m_web->m_noteData = &noteA;
+    m_web->switchNote(&noteB);
+    ASSERT_EQ(1, switchSpy.count());
+    //离开的笔记加入缓存，打开的笔记未命中时发送内容
+    EXPECT_EQ(VNoteEditorCache::noteKey(&noteA), switchSpy.at(0).at(0).toString());
+    EXPECT_TRUE(switchSpy.at(0).at(2).toString().isEmpty());
+    EXPECT_EQ(noteB.htmlCode, switchSpy.at(0).at(3).toString());
+
+    //切回时命中缓存，不再发送内容
+    m_web->m_noteData = &noteB;
+    m_web->switchNote(&noteA);
+    ASSERT_EQ(2, switchSpy.count());
+    EXPECT_EQ(VNoteEditorCache::noteKey(&noteA), switchSpy.at(1).at(2).toString());
+    EXPECT_TRUE(switchSpy.at(1).at(3).toString().isEmpty());
+    EXPECT_FALSE(m_web->m_noteCache.contains(VNoteEditorCache::noteKey(&noteA)));
+    EXPECT_TRUE(m_web->m_noteCache.contains(VNoteEditorCache::noteKey(&noteB)));
+
+    //网页缓存未命中时清除缓存
+    m_web->m_noteData = nullptr;
+    m_web->onNoteCacheMiss();
+    EXPECT_EQ(0, m_web->m_noteCache.count());
+}
+
+TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_searchText_001)
+{
+    VNoteItem note;
+    note.htmlCode = "<p>Abc<b>a</b>&amp;a</p>";
+    m_web->m_noteData = &note;
+    QSignalSpy emptySpy(m_web, &WebRichTextEditor::currentSearchEmpty);
     m_web->searchText("a");
+    EXPECT_EQ(3, m_web->searchMatchCount());
+    EXPECT_EQ(0, m_web->currentSearchMatch());
+    EXPECT_EQ(0, emptySpy.count());
+
+    m_web->searchText("x");
+    EXPECT_EQ(0, m_web->searchMatchCount());
+    EXPECT_EQ(-1, m_web->currentSearchMatch());
+    EXPECT_EQ(1, emptySpy.count());
+    m_web->m_noteData = nullptr;
+}
+
+TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_searchText_002)
+{
+    VNoteItem note;
+    note.htmlCode = "<p>x &amp; y</p><div class=\"li voiceBox\" jsonKey=\"{&quot;text&quot;:&quot;key&quot;}\">"
+                    "<div class=\"title\">key</div></div><p>key</p>";
+    m_web->m_noteData = &note;
+    QSignalSpy emptySpy(m_web, &WebRichTextEditor::currentSearchEmpty);
+    QSignalSpy matchesSpy(JsContent::instance(), &JsContent::callJsSetSearchMatches);
+
+    //位置跳过语音块，实体按一个字符计算
+    m_web->searchText("key");
+    EXPECT_EQ(1, m_web->searchMatchCount());
+    ASSERT_EQ(1, matchesSpy.count());
+    EXPECT_EQ(QVariantList() << 5, matchesSpy.at(0).at(1).toList());
+    EXPECT_EQ(0, emptySpy.count());
+
+    //只在语音块中命中时不从搜索结果中移除
+    note.htmlCode = "<div class=\"li voiceBox\"><div class=\"title\">key</div></div><p>text</p>";
+    m_web->searchText("key");
+    EXPECT_EQ(0, m_web->searchMatchCount());
+    EXPECT_EQ(0, emptySpy.count());
+    m_web->m_noteData = nullptr;
+}
+
+TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_findNext_001)
+{
+    VNoteItem note;
+    note.htmlCode = "<p>a a a</p>";
+    m_web->m_noteData = &note;
+    m_web->searchText("a");
+    QSignalSpy changeSpy(m_web, &WebRichTextEditor::searchMatchChanged);
+    m_web->findNext();
+    EXPECT_EQ(1, m_web->currentSearchMatch());
+    m_web->findNext(true);
+    m_web->findNext(true);
+    EXPECT_EQ(2, m_web->currentSearchMatch());
+    EXPECT_EQ(3, changeSpy.count());
+
+    //网页重新查找后的数量
+    m_web->onSearchMatchCountChanged(2);
+    EXPECT_EQ(1, m_web->currentSearchMatch());
+
+    //内容修改后重新计算
+    m_web->m_textChange = true;
+    m_web->onTextChange();
+    EXPECT_TRUE(m_web->m_searchMatchesDirty);
+    m_web->m_textChange = false;
+    m_web->findNext();
+    EXPECT_FALSE(m_web->m_searchMatchesDirty);
+    EXPECT_EQ(0, m_web->currentSearchMatch());
+    m_web->m_noteData = nullptr;
 }
 
 TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_unboundCurrentNoteData_001)
@@ -206,6 +531,57 @@ TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_onTextChange_001)
     delete note;
 }
 
+TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_onEditorChanges_001)
+{
+    Stub stub;
+    stub.set(ADDR(VNoteItemOper, getNote), stub_getSyncNote);
+    stub.set(ADDR(VNoteItemOper, updateNote), stub_true);
+
+    VNoteItem note;
+    VNoteItem otherNote;
+    m_web->m_noteData = &note;
+    m_web->m_editorSync.reset();
+    m_web->m_editorSync.applyChanges(stub_callJsGetChanges().toMap());
+    m_web->setSyncNote(&note, note.folderId, note.noteId);
+
+    //版本一致时合并推送的内容块
+    QVariantMap changes;
+    changes.insert("base", 1);
+    changes.insert("version", 2);
+    changes.insert("count", 2);
+    changes.insert("ops", QVariantList({QVariantMap({{"keep", 1}}),
+                                        QVariantMap({{"insert", QStringList({"<p>c</p>"})}}),
+                                        QVariantMap({{"skip", 1}})}));
+    m_web->m_textChange = true;
+    m_web->onEditorChanges(changes);
+    EXPECT_FALSE(m_web->m_textChange);
+    EXPECT_EQ(QString("<p>a</p><p>c</p>"), note.htmlCode);
+    EXPECT_EQ(2, m_web->m_editorSync.version());
+    m_web->m_journal.checkpoint(&note);
+
+    //版本不一致时不合并，由定时获取
+    changes.insert("base", 5);
+    changes.insert("version", 6);
+    m_web->onEditorChanges(changes);
+    EXPECT_TRUE(m_web->m_textChange);
+    EXPECT_EQ(2, m_web->m_editorSync.version());
+
+    //笔记切换前推送的变更保存到已同步的笔记
+    syncNote = &note;
+    m_web->m_noteData = &otherNote;
+    changes.insert("base", 2);
+    changes.insert("version", 3);
+    changes.insert("count", 3);
+    changes.insert("ops", QVariantList({QVariantMap({{"insert", QStringList({"<p>d</p>"})}})}));
+    m_web->onEditorChanges(changes);
+    EXPECT_EQ(QString("<p>d</p><p>a</p><p>c</p>"), note.htmlCode);
+    EXPECT_TRUE(otherNote.htmlCode.isEmpty());
+
+    syncNote = nullptr;
+    m_web->setSyncNote(nullptr, -1, -1);
+    m_web->m_noteData = nullptr;
+}
+
 TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_saveMenuParam_001)
 {
     m_web->saveMenuParam(1, QVariant("a"));
@@ -297,7 +673,7 @@ TEST_F(UT_WebRichTextEditor, UT_WebRichTextEditor_onMenuActionClicked_001)
     stub.set(ADDR(QWidget, focusProxy), ADDR(UT_WebRichTextEditor, stub_focusProxy));
     stub.set(ADDR(QFileDialog, getSaveFileName), stub_emptyString);
     stub.set(ADDR(WebRichTextEditor, onPaste), stub_WebRichTextEditor);
-    stub.set(ADDR(WebRichTextEditor, isVoicePaste), stub_isVoicePaste);
+    stub.set(ADDR(WebRichTextEditor, pasteFromMenu), stub_WebRichTextEditor);
 
     ActionManager actionManager;
     QAction *pAction = actionManager.getActionById(ActionManager::VoiceAsSave);
@@ -213,3 +213,19 @@ TEST_F(UT_VNotePlayWidget, UT_VNotePlayWidget_playVoice_004)
 {
     m_vnoteplaywidget->playVoice(nullptr, false);
 }
+
+TEST_F(UT_VNotePlayWidget, UT_VNotePlayWidget_playVoice_005)
+{
+    Stub stub;
+    stub.set(ADDR(VlcPalyer, play), stub_void);
+    stub.set(ADDR(VlcPalyer, setFilePath), stub_void);
+    VNVoiceBlock *voiceBlock = new VNVoiceBlock;
+    voiceBlock->voicePath = "/tmp/test";
+    voiceBlock->voiceSize = 10000;
+    m_vnoteplaywidget->m_slider->setMaximum(10000);
+    m_vnoteplaywidget->playVoice(voiceBlock, false, 3000);
+    EXPECT_EQ(3000, m_vnoteplaywidget->m_slider->value());
+    m_vnoteplaywidget->playVoice(voiceBlock, false, 20000);
+    EXPECT_EQ(10000, m_vnoteplaywidget->m_slider->value());
+    delete voiceBlock;
+}